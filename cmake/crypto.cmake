@@ -8,6 +8,7 @@ set(
   ${CCF_DIR}/src/crypto/hash.cpp
   ${CCF_DIR}/src/crypto/public_key.cpp
   ${CCF_DIR}/src/crypto/sha256_hash.cpp
+  ${CCF_DIR}/src/crypto/sha256_multibuffer.cpp
   ${CCF_DIR}/src/crypto/symmetric_key.cpp
   ${CCF_DIR}/src/crypto/eddsa_key_pair.cpp
   ${CCF_DIR}/src/crypto/verifier.cpp
@@ -67,6 +67,32 @@ namespace ccf::crypto
     void deserialise(const std::vector<uint8_t>& serial);
   };
 
+  // A single message encrypted by KeyAesGcm::encrypt_batch()
+  struct GcmEncryptItem
+  {
+    std::span<const uint8_t> iv;
+    std::span<const uint8_t> plain;
+    std::span<const uint8_t> aad;
+
+    // Outputs
+    std::vector<uint8_t> cipher = {};
+    uint8_t tag[GCM_SIZE_TAG] = {};
+  };
+
+  // A single message decrypted by KeyAesGcm::decrypt_batch()
+  struct GcmDecryptItem
+  {
+    std::span<const uint8_t> iv;
+    // Must be GCM_SIZE_TAG bytes
+    std::span<const uint8_t> tag;
+    std::span<const uint8_t> cipher;
+    std::span<const uint8_t> aad;
+
+    // Outputs
+    std::vector<uint8_t> plain = {};
+    bool success = false;
+  };
+
   class KeyAesGcm
   {
   public:
@@ -89,8 +115,19 @@ namespace ccf::crypto
       std::span<const uint8_t> aad,
       std::vector<uint8_t>& plain) const = 0;
 
+    // AES-GCM encryption of many messages, equivalent to calling encrypt() on
+    // each item
+    virtual void encrypt_batch(std::span<GcmEncryptItem> items) const;
+
+    // AES-GCM decryption of many messages, equivalent to calling decrypt() on
+    // each item. Returns true if every item was successfully decrypted
+    virtual bool decrypt_batch(std::span<GcmDecryptItem> items) const;
+
     // Key size in bits
     [[nodiscard]] virtual size_t key_size() const = 0;
+
+  protected:
+    static void check_tag_size(std::span<const uint8_t> tag);
   };
 
   std::unique_ptr<KeyAesGcm> make_key_aes_gcm(std::span<const uint8_t> rawKey);
@@ -10,6 +10,7 @@
 #include "ccf/service/map.h"
 #include "ccf/service/operator_feature.h"
 
+#include <chrono>
 #include <string>
 #include <utility>
 
@@ -167,6 +168,21 @@ namespace ccf::endpoints
     nlohmann::json& schema,
     [[maybe_unused]] const InterpreterReusePolicy* policy);
 
+  /** Describes how concurrent requests to an endpoint may be collected into a
+   * batch, and executed together against a single read-only snapshot of the
+   * KV.
+   *
+   * @see Endpoint::set_read_only_batching
+   */
+  struct ReadOnlyBatchingPolicy
+  {
+    /// How long a batch stays open to further requests after its first. If
+    /// zero, the batch is executed as soon as a worker thread is free.
+    std::chrono::milliseconds window = std::chrono::milliseconds(0);
+    /// A batch is executed as soon as it contains this many requests
+    size_t max_batch_size = 64;
+  };
+
   struct EndpointProperties
   {
     /// Endpoint mode
@@ -243,6 +259,24 @@ namespace ccf::endpoints
     AuthnPolicies authn_policies;
 
     std::set<OperatorFeature> required_operator_features;
+
+    /// Set by EndpointRegistry::make_read_only_endpoint(), whose function
+    /// cannot write to the KV. Unlike properties.mode, this is not recorded
+    /// in the KV.
+    bool read_only_function = false;
+
+    /// True if this endpoint never writes to the KV, so can be executed in a
+    /// transaction which does not track its reads
+    bool is_read_only() const
+    {
+      return read_only_function || properties.mode == Mode::ReadOnly;
+    }
+
+    /** If set, requests to this endpoint may be executed in a batch with
+     * concurrent requests to the same endpoint, sharing a single read-only
+     * transaction.
+     */
+    std::optional<ReadOnlyBatchingPolicy> read_only_batching = std::nullopt;
   };
 
   using EndpointDefinitionPtr = std::shared_ptr<const EndpointDefinition>;
@@ -502,6 +536,25 @@ namespace ccf::endpoints
 
     Endpoint& set_redirection_strategy(RedirectionStrategy rs);
 
+    /** Allows concurrent requests to this endpoint to be executed together,
+     * against a single read-only transaction, rather than each constructing
+     * its own. This amortises the cost of the transaction, and of repeated
+     * authentication and KV lookups, across requests which arrive at around
+     * the same time. Each request may be delayed by up to policy.window
+     * while its batch fills, but no thread is blocked meanwhile.
+     *
+     * The endpoint must be read-only, either created by
+     * make_read_only_endpoint() or with mode Mode::ReadOnly. Requests which
+     * cannot have
+     * their response deferred, such as those forwarded from another node,
+     * are executed individually.
+     *
+     * @param policy Describes how batches are collected
+     * @return This Endpoint for further modification
+     * @throws std::logic_error if the endpoint is not read-only
+     */
+    Endpoint& set_read_only_batching(const ReadOnlyBatchingPolicy& policy = {});
+
     Endpoint& set_locally_committed_function(
       const LocallyCommittedEndpointFunction& lcf);
 
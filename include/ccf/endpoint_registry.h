@@ -213,6 +213,10 @@ namespace ccf::endpoints
       const AuthnPolicies& ap);
 
     /** Create a read-only endpoint.
+     *
+     * These are executed in a transaction which does not track its reads, as
+     * it can never conflict, and which cannot commit writes. Their mode is
+     * left unchanged. See make_endpoint().
      */
     virtual Endpoint make_read_only_endpoint(
       const std::string& method,
@@ -0,0 +1,231 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/byte_vector.h"
+#include "ccf/indexing/strategy.h"
+#include "ccf/node_context.h"
+#include "ccf/pal/locking.h"
+
+#include <concepts>
+#include <functional>
+
+namespace ccf::indexing::strategies
+{
+  /** Serialises secondary keys so that the order of their serialised bytes
+   * matches their natural order. Specialise this for other secondary key
+   * types, or pass a custom serialiser to KeysByField.
+   */
+  template <typename T>
+  struct OrderedSerialiser;
+
+  template <>
+  struct OrderedSerialiser<std::string>
+  {
+    static ccf::ByteVector to_serialised(const std::string& s)
+    {
+      return {s.begin(), s.end()};
+    }
+  };
+
+  template <>
+  struct OrderedSerialiser<ccf::ByteVector>
+  {
+    static ccf::ByteVector to_serialised(const ccf::ByteVector& v)
+    {
+      return v;
+    }
+  };
+
+  template <std::integral T>
+  struct OrderedSerialiser<T>
+  {
+    // Big-endian, with the sign bit flipped so that negative values sort
+    // before positive values
+    static ccf::ByteVector to_serialised(T t)
+    {
+      using U = std::make_unsigned_t<T>;
+      auto u = static_cast<U>(t);
+      if constexpr (std::is_signed_v<T>)
+      {
+        u ^= U(1) << (sizeof(U) * 8 - 1);
+      }
+
+      ccf::ByteVector v(sizeof(U));
+      for (auto it = v.rbegin(); it != v.rend(); ++it)
+      {
+        *it = static_cast<uint8_t>(u & 0xff);
+        u >>= 8;
+      }
+      return v;
+    }
+  };
+
+  /** Maintains an ordered secondary index over the current state of a map.
+   * A user-supplied extractor maps each (key, value) pair to an optional
+   * secondary key, and this index returns the primary keys of the entries
+   * which currently have a secondary key in a given range, or with a given
+   * prefix. Entries which are removed, or whose extracted secondary key is
+   * nullopt, are not indexed.
+   *
+   * The index is divided into pages covering contiguous ranges of secondary
+   * keys. If constructed with access to the LFS subsystem, only a limited
+   * number of recently used pages are held in memory, and the remainder are
+   * spilled to disk and fetched asynchronously on demand. The mapping from
+   * each primary key to its current secondary key is always held in memory.
+   */
+  class KeysByField_Untyped : public Strategy
+  {
+  public:
+    using Extractor = std::function<std::optional<ccf::ByteVector>(
+      const ccf::ByteVector& k, const ccf::ByteVector& v)>;
+
+  protected:
+    struct Impl;
+    std::shared_ptr<Impl> impl = nullptr;
+
+    std::string map_name;
+
+    // Protect access to current_txid
+    ccf::pal::Mutex current_txid_lock;
+
+    ccf::TxID current_txid = {};
+
+    // Returns the primary keys whose secondary keys are in [from, to], or have
+    // the given prefix, in secondary key order. Returns nullopt if part of the
+    // index must first be fetched from disk.
+    std::optional<std::vector<ccf::ByteVector>> get_keys_in_range_impl(
+      const ccf::ByteVector& from,
+      const ccf::ByteVector& to,
+      std::optional<size_t> max_keys);
+    std::optional<std::vector<ccf::ByteVector>> get_keys_with_prefix_impl(
+      const ccf::ByteVector& prefix, std::optional<size_t> max_keys);
+
+  public:
+    // Holds the entire index in-memory
+    KeysByField_Untyped(
+      const std::string& map_name_,
+      const std::string& field_name,
+      Extractor extractor);
+
+    // Holds at most max_resident_pages_ pages of (roughly) keys_per_page_
+    // entries in-memory, spilling the rest to disk
+    KeysByField_Untyped(
+      const std::string& map_name_,
+      const std::string& field_name,
+      Extractor extractor,
+      ccf::AbstractNodeContext& node_context,
+      size_t keys_per_page_ = 1000,
+      size_t max_resident_pages_ = 10);
+
+    void handle_committed_transaction(
+      const ccf::TxID& tx_id, const ccf::kv::ReadOnlyStorePtr& store) override;
+    std::optional<ccf::SeqNo> next_requested() override;
+
+    nlohmann::json describe() override;
+
+    ccf::TxID get_indexed_watermark();
+  };
+
+  template <
+    typename M,
+    typename SK,
+    typename SKSerialiser = OrderedSerialiser<SK>>
+  class KeysByField : public KeysByField_Untyped
+  {
+  public:
+    using K = typename M::Key;
+    using V = typename M::Value;
+    using FieldExtractor = std::function<std::optional<SK>(const K&, const V&)>;
+
+  protected:
+    static Extractor make_extractor(FieldExtractor extract)
+    {
+      return [extract = std::move(extract)](
+               const ccf::ByteVector& k,
+               const ccf::ByteVector& v) -> std::optional<ccf::ByteVector> {
+        const auto sk = extract(
+          M::KeySerialiser::from_serialised(k),
+          M::ValueSerialiser::from_serialised(v));
+        if (!sk.has_value())
+        {
+          return std::nullopt;
+        }
+        return SKSerialiser::to_serialised(*sk);
+      };
+    }
+
+    static std::optional<std::vector<K>> deserialise_keys(
+      std::optional<std::vector<ccf::ByteVector>>&& serialised_keys)
+    {
+      if (!serialised_keys.has_value())
+      {
+        return std::nullopt;
+      }
+
+      std::vector<K> keys;
+      keys.reserve(serialised_keys->size());
+      for (const auto& k : *serialised_keys)
+      {
+        keys.push_back(M::KeySerialiser::from_serialised(k));
+      }
+      return keys;
+    }
+
+  public:
+    KeysByField(
+      const M& map, const std::string& field_name, FieldExtractor extract) :
+      KeysByField_Untyped(
+        map.get_name(), field_name, make_extractor(std::move(extract)))
+    {}
+
+    KeysByField(
+      const M& map,
+      const std::string& field_name,
+      FieldExtractor extract,
+      ccf::AbstractNodeContext& node_context,
+      size_t keys_per_page_ = 1000,
+      size_t max_resident_pages_ = 10) :
+      KeysByField_Untyped(
+        map.get_name(),
+        field_name,
+        make_extractor(std::move(extract)),
+        node_context,
+        keys_per_page_,
+        max_resident_pages_)
+    {}
+
+    /** Returns the keys of current entries whose field is in [from, to],
+     * ordered by field. Returns nullopt if part of the index is being fetched
+     * from disk, in which case the caller should retry later.
+     */
+    std::optional<std::vector<K>> get_keys_in_range(
+      const SK& from,
+      const SK& to,
+      std::optional<size_t> max_keys = std::nullopt)
+    {
+      return deserialise_keys(get_keys_in_range_impl(
+        SKSerialiser::to_serialised(from),
+        SKSerialiser::to_serialised(to),
+        max_keys));
+    }
+
+    /** Returns the keys of current entries whose field is equal to sk */
+    std::optional<std::vector<K>> get_keys(
+      const SK& sk, std::optional<size_t> max_keys = std::nullopt)
+    {
+      return get_keys_in_range(sk, sk, max_keys);
+    }
+
+    /** Returns the keys of current entries whose serialised field starts with
+     * the serialised prefix, ordered by field. For string fields, this is a
+     * prefix match on the string.
+     */
+    std::optional<std::vector<K>> get_keys_with_prefix(
+      const SK& prefix, std::optional<size_t> max_keys = std::nullopt)
+    {
+      return deserialise_keys(get_keys_with_prefix_impl(
+        SKSerialiser::to_serialised(prefix), max_keys));
+    }
+  };
+}
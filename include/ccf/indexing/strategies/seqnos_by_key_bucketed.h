@@ -9,8 +9,10 @@
 namespace ccf::indexing::strategies
 {
   // Stores only a subset of results in-memory, on-demand, and dumps the
-  // remainder to disk. The size of the per-key buckets which will be retained,
-  // and the number of buckets which may be held in-memory, are configurable
+  // remainder to disk. Completed buckets are written as sorted runs of blocks
+  // covering all keys, which are periodically compacted. The size of the
+  // buckets (and blocks), and the number of buckets which may be requested at
+  // once, are configurable
   class SeqnosByKey_Bucketed_Untyped : public VisitEachEntryInMap
   {
   protected:
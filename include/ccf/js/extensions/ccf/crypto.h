@@ -11,6 +11,7 @@ namespace ccf::js::extensions
    *
    * - ccf.crypto.sign
    * - ccf.crypto.verifySignature
+   * - ccf.crypto.importPublicKey
    *
    * - ccf.crypto.pubPemToJwk
    * - ccf.crypto.pemToJwk
@@ -47,6 +47,17 @@ namespace ccf::js
     // been idle the longest when the cap is reached.
     virtual void set_max_cached_interpreters(size_t max) = 0;
 
+    // Record the bytecode of a module, read from the KV at freshness_marker.
+    // Fresh interpreters constructed ahead of time (for endpoints which do not
+    // permit reuse) will have every module recorded at the current marker
+    // loaded, but not evaluated, before they are returned. This does not share
+    // any state between requests, since each such interpreter is returned by
+    // get_interpreter at most once.
+    virtual void record_module_bytecode(
+      size_t freshness_marker,
+      std::string_view module_name,
+      const std::vector<uint8_t>& bytecode) = 0;
+
     virtual void set_interpreter_factory(const InterpreterFactory& ip) = 0;
   };
 }
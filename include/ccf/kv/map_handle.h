@@ -247,6 +247,63 @@ namespace ccf::kv
       write_handle.remove(KSerialiser::to_serialised(key));
     }
 
+    /** Update the value at key when this transaction commits.
+     *
+     * Unlike a get() followed by a put(), this does not read the key, so
+     * transactions which concurrently merge into the same key do not conflict
+     * with each other. Their updates are applied in the order in which the
+     * transactions commit, so should commute. The resulting value is recorded
+     * in the ledger as an ordinary write. If this transaction later reads the
+     * key, the merge is applied at that point, and the read may conflict as
+     * usual.
+     *
+     * @param key Key to update
+     * @param f Returns the new value, given the value at commit time (empty if
+     * the key is absent), or empty to remove the key. Called while the map is
+     * locked, so must be cheap and deterministic. If it throws, the
+     * transaction is not committed, and commit() rethrows the exception.
+     */
+    void merge(
+      const K& key,
+      const std::function<std::optional<V>(const std::optional<V>&)>& f)
+    {
+      write_handle.merge(
+        KSerialiser::to_serialised(key),
+        [f](const std::optional<ccf::kv::serialisers::SerialisedEntry>& rep)
+          -> std::optional<ccf::kv::serialisers::SerialisedEntry> {
+          std::optional<V> current = std::nullopt;
+          if (rep.has_value())
+          {
+            current = VSerialiser::from_serialised(*rep);
+          }
+
+          const auto updated = f(current);
+          if (!updated.has_value())
+          {
+            return std::nullopt;
+          }
+
+          return VSerialiser::to_serialised(*updated);
+        });
+    }
+
+    /** Add delta to the value at key when this transaction commits, treating
+     * an absent key as a default-constructed value.
+     *
+     * Transactions which concurrently add to the same key do not conflict.
+     *
+     * @param key Key to update
+     * @param delta Value to add
+     *
+     * @see merge
+     */
+    void add(const K& key, const V& delta)
+    {
+      merge(key, [delta](const std::optional<V>& current) -> std::optional<V> {
+        return current.value_or(V{}) + delta;
+      });
+    }
+
     /** Delete every key-value pair.
      */
     void clear()
@@ -5,6 +5,7 @@
 #include "ccf/kv/hooks.h"
 #include "ccf/kv/serialisers/serialised_entry.h"
 
+#include <functional>
 #include <map>
 #include <optional>
 
@@ -15,6 +16,15 @@ namespace ccf::kv::untyped
     ccf::kv::serialisers::SerialisedEntry,
     std::optional<ccf::kv::serialisers::SerialisedEntry>>;
 
+  // Computes the value of a key from its value when the transaction commits,
+  // for updates which commute. nullopt represents an absent key, or a
+  // deletion if returned.
+  using MergeFunction =
+    std::function<std::optional<ccf::kv::serialisers::SerialisedEntry>(
+      const std::optional<ccf::kv::serialisers::SerialisedEntry>&)>;
+
+  using Merges = std::map<ccf::kv::serialisers::SerialisedEntry, MergeFunction>;
+
   using CommitHook = ccf::kv::CommitHook<Write>;
   using MapHook = ccf::kv::MapHook<Write>;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "ccf/kv/abstract_handle.h"
 #include "ccf/kv/serialisers/serialised_entry.h"
+#include "ccf/kv/untyped.h"
 #include "ccf/kv/version.h"
 
 #include <functional>
@@ -63,6 +64,10 @@ namespace ccf::kv::untyped
 
     void remove(const KeyType& key);
 
+    // Updates the value at key when the transaction commits, without reading
+    // it now
+    void merge(const KeyType& key, const MergeFunction& f);
+
     void clear();
 
     void foreach(const ElementVisitorWithEarlyOut& fn);
@@ -74,5 +79,13 @@ namespace ccf::kv::untyped
       const ElementVisitor& fn,
       const std::optional<KeyType>& from,
       const std::optional<KeyType>& to);
+
+    // As above, but visits at most the first max_count keys of the range,
+    // without holding the rest of the range in memory.
+    void range(
+      const ElementVisitor& fn,
+      const std::optional<KeyType>& from,
+      const std::optional<KeyType>& to,
+      size_t max_count);
   };
 }
\ No newline at end of file
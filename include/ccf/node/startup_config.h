@@ -57,6 +57,7 @@ namespace ccf
     {
       size_t tx_count = 5000;
       ccf::ds::TimeString delay = {"1000ms"};
+      size_t receipt_window_tx_count = 10'000;
 
       bool operator==(const LedgerSignatures&) const = default;
     };
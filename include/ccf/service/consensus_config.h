@@ -5,6 +5,8 @@
 #include "ccf/ds/unit_strings.h"
 #include "ccf/service/consensus_type.h"
 
+#include <optional>
+
 namespace ccf::consensus
 {
   struct Configuration
@@ -12,6 +14,8 @@ namespace ccf::consensus
     ccf::ds::TimeString message_timeout = {"100ms"};
     ccf::ds::TimeString election_timeout = {"5000ms"};
     size_t max_uncommitted_tx_count = 10000;
+    bool durable_acks = false;
+    std::optional<ccf::ds::SizeString> append_entries_window = std::nullopt;
 
     bool operator==(const Configuration&) const = default;
     bool operator!=(const Configuration&) const = default;
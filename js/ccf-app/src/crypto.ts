@@ -57,6 +57,11 @@ export const sign = ccf.crypto.sign;
  */
 export const verifySignature = ccf.crypto.verifySignature;
 
+/**
+ * @inheritDoc global!CCFCrypto.importPublicKey
+ */
+export const importPublicKey = ccf.crypto.importPublicKey;
+
 /**
  * @inheritDoc global!CCFCrypto.digest
  */
@@ -143,6 +148,7 @@ export type {
   RsaOaepParams,
   RsaOaepAesKwpParams,
   CryptoKeyPair,
+  CryptoPublicKey,
   DigestAlgorithm,
   SigningAlgorithm,
 } from "./global";
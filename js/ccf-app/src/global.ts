@@ -47,6 +47,50 @@ export interface KvMap {
     callback: (value: ArrayBuffer, key: ArrayBuffer, kvmap: KvMap) => void,
   ): void;
   size: number;
+
+  /**
+   * Get the values of many keys at once. The result has one element per key,
+   * which is `undefined` if the key is not present.
+   */
+  getMany(keys: ArrayBuffer[]): (ArrayBuffer | undefined)[];
+
+  /**
+   * Set many key-value pairs at once. If any entry is not a pair of
+   * `ArrayBuffer`s then none are written.
+   */
+  setMany(entries: [ArrayBuffer, ArrayBuffer][]): KvMap;
+
+  /**
+   * Delete many keys at once. If any key is not an `ArrayBuffer` then none
+   * are deleted.
+   */
+  deleteMany(keys: ArrayBuffer[]): void;
+
+  /**
+   * Get the entries with keys in `[from, to)`, in order of their bytes.
+   * Either bound may be `undefined` to leave that end of the range open.
+   *
+   * At most `limit` entries are returned. If more are in range, the key of
+   * the first one not returned is given as `next`, and can be passed as
+   * `from` to a later call to continue from there.
+   */
+  range(
+    from?: ArrayBuffer,
+    to?: ArrayBuffer,
+    limit?: number,
+  ): KvRange<ArrayBuffer, ArrayBuffer>;
+}
+
+/**
+ * Entries returned by {@linkcode KvMap.range}.
+ */
+export interface KvRange<K, V> {
+  entries: [K, V][];
+
+  /**
+   * Key of the first entry in range which was not returned, if any.
+   */
+  next?: K;
 }
 
 /**
@@ -335,6 +379,14 @@ export interface JsonWebKeyEdDSAPrivate extends JsonWebKeyEdDSAPublic {
   d: string;
 }
 
+/**
+ * A public key parsed by {@linkcode CCFCrypto.importPublicKey}, for use with
+ * one signing algorithm. The key is opaque to JavaScript.
+ */
+export interface CryptoPublicKey {
+  readonly __brand: "CryptoPublicKey";
+}
+
 export interface CCFCrypto {
   /**
    * Generate a signature.
@@ -354,8 +406,12 @@ export interface CCFCrypto {
   /**
    * Returns whether digital signature is valid.
    *
+   * Parsed keys are cached by each node, so repeatedly verifying signatures
+   * against the same PEM-encoded key only parses it once.
+   *
    * @param algorithm Signing algorithm and parameters
-   * @param key A PEM-encoded public key or X.509 certificate
+   * @param key A PEM-encoded public key or X.509 certificate, or a key
+   *  returned by {@linkcode importPublicKey} for the same algorithm
    * @param signature Signature to verify
    * @param plaintext Input data that was signed
    * @throws Will throw an error if the key is not compatible with the
@@ -363,11 +419,30 @@ export interface CCFCrypto {
    */
   verifySignature(
     algorithm: SigningAlgorithm,
-    key: string,
+    key: string | CryptoPublicKey,
     signature: ArrayBuffer,
     plaintext: ArrayBuffer,
   ): boolean;
 
+  /**
+   * Parse a public key once, for verifying many signatures with
+   * {@linkcode verifySignature}.
+   *
+   * @param algorithm Signing algorithm the key will be used with. Only the
+   *  name is used.
+   * @param key A PEM-encoded public key or X.509 certificate, or a public JWK
+   * @throws Will throw an error if the key cannot be parsed for the given
+   *  algorithm.
+   */
+  importPublicKey(
+    algorithm: SigningAlgorithm,
+    key:
+      | string
+      | JsonWebKeyECPublic
+      | JsonWebKeyRSAPublic
+      | JsonWebKeyEdDSAPublic,
+  ): CryptoPublicKey;
+
   /**
    * Generate an AES key.
    *
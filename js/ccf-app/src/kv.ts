@@ -37,7 +37,7 @@
  * @module
  */
 
-import { type KvMap, type KvSet, ccf } from "./global.js";
+import { type KvMap, type KvRange, type KvSet, ccf } from "./global.js";
 import { type DataConverter } from "./converters.js";
 
 export class TypedKvMap<K, V> {
@@ -89,6 +89,44 @@ export class TypedKvMap<K, V> {
   get size(): number {
     return this.kv.size;
   }
+
+  getMany(keys: K[]): (V | undefined)[] {
+    const vs = this.kv.getMany(keys.map((k) => this.kt.encode(k)));
+    return vs.map((v) => (v === undefined ? undefined : this.vt.decode(v)));
+  }
+
+  setMany(entries: [K, V][]): TypedKvMap<K, V> {
+    this.kv.setMany(
+      entries.map(([k, v]): [ArrayBuffer, ArrayBuffer] => [
+        this.kt.encode(k),
+        this.vt.encode(v),
+      ]),
+    );
+    return this;
+  }
+
+  deleteMany(keys: K[]): void {
+    this.kv.deleteMany(keys.map((k) => this.kt.encode(k)));
+  }
+
+  /**
+   * Note that entries are ordered by their encoded keys, which for most
+   * converters is not the natural order of `K`.
+   */
+  range(from?: K, to?: K, limit?: number): KvRange<K, V> {
+    const r = this.kv.range(
+      from === undefined ? undefined : this.kt.encode(from),
+      to === undefined ? undefined : this.kt.encode(to),
+      limit,
+    );
+    return {
+      entries: r.entries.map(([k, v]): [K, V] => [
+        this.kt.decode(k),
+        this.vt.decode(v),
+      ]),
+      next: r.next === undefined ? undefined : this.kt.decode(r.next),
+    };
+  }
 }
 
 export class TypedKvSet<K> {
@@ -182,4 +220,4 @@ export function typedKvSet<K, V>(
  */
 export const rawKv = ccf.kv;
 
-export type { KvMap, KvSet, KvMaps } from "./global";
+export type { KvMap, KvRange, KvSet, KvMaps } from "./global";
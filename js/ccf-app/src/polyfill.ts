@@ -25,6 +25,7 @@ import type {
   CCF,
   KvMaps,
   KvMap,
+  KvRange,
   JsonCompatible,
   CryptoKeyPair,
   WrapAlgoParams,
@@ -32,6 +33,7 @@ import type {
   SnpAttestation,
   SnpAttestationResult,
   SigningAlgorithm,
+  CryptoPublicKey,
   JsonWebKey,
   JsonWebKeyECPublic,
   JsonWebKeyECPrivate,
@@ -42,6 +44,13 @@ import type {
 } from "./global.js";
 import { toArrayBuffer } from "./utils.js";
 
+class CryptoPublicKeyPolyfill {
+  constructor(
+    public algorithm: string,
+    public key: jscrypto.KeyObject,
+  ) {}
+}
+
 // JavaScript's Map uses reference equality for non-primitive types,
 // whereas CCF compares the content of the ArrayBuffer.
 // To achieve CCF's semantics, all keys are base64-encoded.
@@ -77,6 +86,46 @@ class KvMapPolyfill implements KvMap {
   get size(): number {
     return this.map.size;
   }
+  getMany(keys: ArrayBuffer[]): (ArrayBuffer | undefined)[] {
+    return keys.map((key) => this.get(key));
+  }
+  setMany(entries: [ArrayBuffer, ArrayBuffer][]): KvMap {
+    for (const [key, value] of entries) {
+      this.set(key, value);
+    }
+    return this;
+  }
+  deleteMany(keys: ArrayBuffer[]): void {
+    for (const key of keys) {
+      this.delete(key);
+    }
+  }
+  range(
+    from?: ArrayBuffer,
+    to?: ArrayBuffer,
+    limit?: number,
+  ): KvRange<ArrayBuffer, ArrayBuffer> {
+    // Keys are ordered by their bytes, as in CCF
+    const inRange = [...this.map.keys()]
+      .map((key) => Buffer.from(key, "base64"))
+      .filter(
+        (key) =>
+          (from === undefined || Buffer.compare(key, Buffer.from(from)) >= 0) &&
+          (to === undefined || Buffer.compare(key, Buffer.from(to)) < 0),
+      )
+      .sort(Buffer.compare);
+    const count = limit === undefined ? inRange.length : limit;
+    return {
+      entries: inRange
+        .slice(0, count)
+        .map((key): [ArrayBuffer, ArrayBuffer] => [
+          nodeBufToArrBuf(key),
+          this.map.get(key.toString("base64"))!,
+        ]),
+      next:
+        count < inRange.length ? nodeBufToArrBuf(inRange[count]) : undefined,
+    };
+  }
 }
 
 class CCFPolyfill implements CCF {
@@ -179,12 +228,22 @@ class CCFPolyfill implements CCF {
     },
     verifySignature(
       algorithm: SigningAlgorithm,
-      key: string,
+      key: string | CryptoPublicKey,
       signature: ArrayBuffer,
       data: ArrayBuffer,
     ): boolean {
       let padding = undefined;
-      const pubKey = jscrypto.createPublicKey(key);
+      let pubKey: jscrypto.KeyObject;
+      if (key instanceof CryptoPublicKeyPolyfill) {
+        if (key.algorithm !== algorithm.name) {
+          throw new Error(
+            `Key was imported for ${key.algorithm}, not ${algorithm.name}`,
+          );
+        }
+        pubKey = key.key;
+      } else {
+        pubKey = jscrypto.createPublicKey(key as string);
+      }
       if (pubKey.asymmetricKeyType == "rsa") {
         if (algorithm.name === "RSA-PSS") {
           padding = jscrypto.constants.RSA_PKCS1_PSS_PADDING;
@@ -223,6 +282,26 @@ class CCFPolyfill implements CCF {
         new Uint8Array(signature),
       );
     },
+    importPublicKey(
+      algorithm: SigningAlgorithm,
+      key:
+        | string
+        | JsonWebKeyECPublic
+        | JsonWebKeyRSAPublic
+        | JsonWebKeyEdDSAPublic,
+    ): CryptoPublicKey {
+      const pubKey =
+        typeof key === "string"
+          ? jscrypto.createPublicKey(key)
+          : jscrypto.createPublicKey({
+              key: key as jscrypto.JsonWebKey,
+              format: "jwk",
+            });
+      return new CryptoPublicKeyPolyfill(
+        algorithm.name,
+        pubKey,
+      ) as unknown as CryptoPublicKey;
+    },
     generateAesKey(size: number): ArrayBuffer {
       return nodeBufToArrBuf(jscrypto.randomBytes(size / 8));
     },
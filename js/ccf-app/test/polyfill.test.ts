@@ -7,6 +7,7 @@ import type {
   DigestAlgorithm,
   RsaOaepAesKwpParams,
   RsaOaepParams,
+  SigningAlgorithm,
 } from "../src/global.js";
 import { ccf } from "../src/global.js";
 import * as textcodec from "../src/textcodec.js";
@@ -305,6 +306,52 @@ describe("polyfill", function () {
         );
       }
     });
+    it("verifies signatures with imported public keys", function () {
+      const { publicKey, privateKey } = crypto.generateKeyPairSync("ec", {
+        namedCurve: "P-256",
+        publicKeyEncoding: {
+          type: "spki",
+          format: "pem",
+        },
+        privateKeyEncoding: {
+          type: "pkcs8",
+          format: "pem",
+        },
+      });
+      const algorithm: SigningAlgorithm = { name: "ECDSA", hash: "SHA-256" };
+      const data = ccf.strToBuf("foo");
+      const signature = ccf.crypto.sign(algorithm, privateKey, data);
+
+      const fromPem = ccf.crypto.importPublicKey(algorithm, publicKey);
+      assert.ok(
+        ccf.crypto.verifySignature(algorithm, fromPem, signature, data),
+      );
+      assert.ok(
+        !ccf.crypto.verifySignature(
+          algorithm,
+          fromPem,
+          signature,
+          ccf.strToBuf("bar"),
+        ),
+      );
+
+      const fromJwk = ccf.crypto.importPublicKey(
+        algorithm,
+        ccf.crypto.pubPemToJwk(publicKey),
+      );
+      assert.ok(
+        ccf.crypto.verifySignature(algorithm, fromJwk, signature, data),
+      );
+
+      assert.throws(() =>
+        ccf.crypto.verifySignature(
+          { name: "RSA-PSS", hash: "SHA-256" },
+          fromPem,
+          signature,
+          data,
+        ),
+      );
+    });
     it("performs EdDSA with Curve25519 sign correctly", function () {
       const { publicKey, privateKey } = crypto.generateKeyPairSync("ed25519", {
         publicKeyEncoding: {
@@ -761,6 +808,41 @@ describe("polyfill", function () {
       assert.ok(!foo.has(key_buf));
       assert.equal(foo.get(key_buf), undefined);
     });
+    it("batched", function () {
+      const foo = ccf.kv["foo"];
+      const keys = ["a", "b", "c", "d"].map((k) => ccf.strToBuf(k));
+      const vals = [1, 2, 3, 4].map((v) => ccf.jsonCompatibleToBuf(v));
+
+      foo.setMany([
+        [keys[3], vals[3]],
+        [keys[1], vals[1]],
+        [keys[0], vals[0]],
+        [keys[2], vals[2]],
+      ]);
+      assert.deepEqual(foo.getMany([keys[2], ccf.strToBuf("e"), keys[0]]), [
+        vals[2],
+        undefined,
+        vals[0],
+      ]);
+
+      const first = foo.range(undefined, keys[3], 2);
+      assert.deepEqual(first.entries, [
+        [keys[0], vals[0]],
+        [keys[1], vals[1]],
+      ]);
+      assert.deepEqual(first.next, keys[2]);
+      const second = foo.range(first.next, keys[3], 2);
+      assert.deepEqual(second.entries, [[keys[2], vals[2]]]);
+      assert.equal(second.next, undefined);
+
+      foo.deleteMany([keys[0], keys[1]]);
+      assert.deepEqual(foo.getMany(keys), [
+        undefined,
+        undefined,
+        vals[2],
+        vals[3],
+      ]);
+    });
   });
   // This test case should be the last until https://github.com/nodejs/node/pull/45377 is addressed.
   describe(
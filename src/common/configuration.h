@@ -39,6 +39,10 @@ struct EnclaveConfig
   ringbuffer::Offsets* from_enclave_buffer_offsets = nullptr;
 
   oversized::WriterConfig writer_config = {};
+
+  // Shared with the host, if large node-to-node payloads should bypass the
+  // ringbuffer
+  ringbuffer::BufferHandoffPtr buffer_handoff = nullptr;
 };
 
 static constexpr auto node_to_node_interface_name = "node_to_node_interface";
@@ -69,7 +73,8 @@ namespace ccf
 
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(CCFConfig::LedgerSignatures);
   DECLARE_JSON_REQUIRED_FIELDS(CCFConfig::LedgerSignatures);
-  DECLARE_JSON_OPTIONAL_FIELDS(CCFConfig::LedgerSignatures, tx_count, delay);
+  DECLARE_JSON_OPTIONAL_FIELDS(
+    CCFConfig::LedgerSignatures, tx_count, delay, receipt_window_tx_count);
 
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(CCFConfig::JWT);
   DECLARE_JSON_REQUIRED_FIELDS(CCFConfig::JWT);
@@ -21,6 +21,7 @@
 #include "service/tables/signatures.h"
 
 #include <algorithm>
+#include <deque>
 #include <list>
 #include <random>
 #include <unordered_map>
@@ -106,6 +107,16 @@ namespace aft
       // timeout tracking the last time an ack was received from the node
       std::chrono::milliseconds last_ack_timeout{0};
 
+      // When append_entries_window_bytes is set, the end index and estimated
+      // size of each batch of entries sent to the node but not yet acked
+      std::deque<std::pair<Index, size_t>> in_flight;
+      size_t in_flight_bytes = 0;
+
+      // The index sent_idx was last rewound to on a nack. Later nacks which
+      // would rewind to the same index respond to batches sent before that
+      // rewind, and are ignored until the next heartbeat.
+      std::optional<Index> rewound_to = std::nullopt;
+
       NodeState() = default;
 
       NodeState(
@@ -162,6 +173,33 @@ namespace aft
     size_t max_uncommitted_tx_count;
     bool ticking = false;
 
+    // When durable_acks is set, entries only count towards commit (on this
+    // node) and are only acknowledged (to the leader) once the host reports
+    // them durable. Each truncation is tagged with an id, which the host
+    // echoes once it has processed it, so that durability reports which
+    // precede the latest truncation are discarded.
+    bool durable_acks;
+    Index durable_idx = 0;
+    uint64_t truncation_id = 0;
+    // Latest ack withheld from the leader until its entries are durable
+    std::optional<std::pair<ccf::NodeId, Index>> pending_ack = std::nullopt;
+
+    // When append_entries_window_bytes is non-zero, the primary sends each
+    // node at most that many bytes of entries which it has not yet acked.
+    // Further entries are sent as acks arrive, rather than on the next
+    // periodic, and a nack is followed at once by a resend from the rewound
+    // index. When it is zero, all available entries are sent at once.
+    size_t append_entries_window_bytes;
+    // Cumulative sizes of the uncommitted entries held by this node, used to
+    // account for bytes in flight: entry_offsets[i] is the total size of the
+    // entries up to and including entry_offsets_start + i
+    std::deque<size_t> entry_offsets;
+    Index entry_offsets_start = 0;
+    size_t entry_offsets_base = 0;
+    // Average size of the most recently committed entries, used to estimate
+    // the size of entries which are no longer tracked
+    std::optional<size_t> committed_entry_size = std::nullopt;
+
     // Configurations
     std::list<Configuration> configurations;
     // Union of other nodes (i.e. all nodes but us) in each active
@@ -225,6 +263,11 @@ namespace aft
       request_timeout(settings_.message_timeout),
       election_timeout(settings_.election_timeout),
       max_uncommitted_tx_count(settings_.max_uncommitted_tx_count),
+      durable_acks(settings_.durable_acks),
+      append_entries_window_bytes(
+        settings_.append_entries_window.has_value() ?
+          settings_.append_entries_window->count_bytes() :
+          0),
 
       node_client(std::move(rpc_request_context_)),
       retired_node_cleanup(
@@ -400,6 +443,43 @@ namespace aft
       public_only = false;
     }
 
+    void set_ledger_durable_seqno(
+      Index seqno, uint64_t reported_truncation_id) override
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(state->lock);
+      if (!durable_acks)
+      {
+        return;
+      }
+
+      // Only once the host has processed the latest truncation does what it
+      // reports reflect the current ledger
+      if (reported_truncation_id == truncation_id)
+      {
+        durable_idx = std::max(durable_idx, std::min(seqno, state->last_idx));
+      }
+
+      if (state->leadership_state == ccf::kv::LeadershipState::Leader)
+      {
+        update_commit();
+      }
+      else if (
+        pending_ack.has_value() && pending_ack->first == leader_id &&
+        state->leadership_state == ccf::kv::LeadershipState::Follower)
+      {
+        const auto [to, idx] = pending_ack.value();
+        send_append_entries_response(
+          to,
+          AppendEntriesResponseType::OK,
+          state->current_view,
+          std::min(idx, durable_idx));
+        if (durable_idx >= idx)
+        {
+          pending_ack.reset();
+        }
+      }
+    }
+
     void force_become_primary() override
     {
       // This is unsafe and should only be called when the node is certain
@@ -411,6 +491,7 @@ namespace aft
       }
 
       std::lock_guard<ccf::pal::Mutex> guard(state->lock);
+      durable_idx = state->last_idx;
       state->current_view += starting_view_change;
       become_leader(true);
     }
@@ -432,6 +513,7 @@ namespace aft
       std::lock_guard<ccf::pal::Mutex> guard(state->lock);
       state->current_view = term;
       state->last_idx = index;
+      durable_idx = index;
       state->commit_idx = commit_idx_;
       state->view_history.initialise(terms);
       state->view_history.update(index, term);
@@ -450,6 +532,7 @@ namespace aft
       std::lock_guard<ccf::pal::Mutex> guard(state->lock);
 
       state->last_idx = index;
+      durable_idx = index;
       state->commit_idx = index;
 
       state->view_history.initialise(term_history);
@@ -709,6 +792,7 @@ namespace aft
         state->last_idx = index;
         ledger->put_entry(
           *data, globally_committable, state->current_view, index);
+        record_entry_size(index, data->size());
         entry_size_not_limited += data->size();
         entry_count++;
 
@@ -720,6 +804,11 @@ namespace aft
           entry_size_not_limited = 0;
           for (const auto& it : all_other_nodes)
           {
+            if (append_entries_window_full(it.second))
+            {
+              // Sent as acks arrive
+              continue;
+            }
             RAFT_DEBUG_FMT("Sending updates to follower {}", it.first);
             send_append_entries(it.first, it.second.sent_idx + 1);
           }
@@ -846,8 +935,9 @@ namespace aft
 
           update_batch_size();
           // Send newly available entries to all other nodes.
-          for (const auto& node : all_other_nodes)
+          for (auto& node : all_other_nodes)
           {
+            node.second.rewound_to.reset();
             send_append_entries(node.first, node.second.sent_idx + 1);
           }
         }
@@ -969,6 +1059,97 @@ namespace aft
       entries_batch_size = std::max((batch_window_sum / batch_window_size), 1);
     }
 
+    void record_entry_size(Index idx, size_t size)
+    {
+      if (append_entries_window_bytes == 0)
+      {
+        return;
+      }
+
+      if (
+        entry_offsets.empty() ||
+        idx != entry_offsets_start + entry_offsets.size())
+      {
+        // Not contiguous with the tracked entries, e.g. after a snapshot
+        entry_offsets.clear();
+        entry_offsets_start = idx;
+        entry_offsets_base = 0;
+      }
+
+      const auto offset =
+        entry_offsets.empty() ? entry_offsets_base : entry_offsets.back();
+      entry_offsets.push_back(offset + size);
+    }
+
+    size_t append_entries_bytes(Index start_idx, Index end_idx)
+    {
+      if (end_idx < start_idx)
+      {
+        return 0;
+      }
+
+      size_t bytes = 0;
+      size_t untracked_count = end_idx - start_idx + 1;
+      if (!entry_offsets.empty())
+      {
+        const auto last_tracked =
+          entry_offsets_start + entry_offsets.size() - 1;
+        const auto from = std::max(start_idx, entry_offsets_start);
+        const auto to = std::min(end_idx, last_tracked);
+        if (from <= to)
+        {
+          const auto before = from == entry_offsets_start ?
+            entry_offsets_base :
+            entry_offsets[from - entry_offsets_start - 1];
+          bytes = entry_offsets[to - entry_offsets_start] - before;
+          untracked_count -= to - from + 1;
+        }
+      }
+
+      // Until some entries have been committed, estimate from the batch size,
+      // which targets append_entries_size_limit bytes per batch
+      const auto untracked_size = committed_entry_size.value_or(
+        append_entries_size_limit / entries_batch_size);
+      return bytes + untracked_count * untracked_size;
+    }
+
+    bool append_entries_window_full(const NodeState& node) const
+    {
+      return append_entries_window_bytes != 0 &&
+        node.in_flight_bytes >= append_entries_window_bytes;
+    }
+
+    // Returns the highest index up to end_idx such that the entries from
+    // start_idx fit in the node's window, or start_idx - 1 if none do. If
+    // nothing is in flight, a single entry is sent even if it does not fit.
+    Index window_end_index(
+      const NodeState& node, Index start_idx, Index end_idx)
+    {
+      const auto available = append_entries_window_full(node) ?
+        0 :
+        append_entries_window_bytes - node.in_flight_bytes;
+      auto lo = start_idx - 1;
+      auto hi = end_idx;
+      while (lo < hi)
+      {
+        const auto mid = lo + (hi - lo + 1) / 2;
+        if (append_entries_bytes(start_idx, mid) <= available)
+        {
+          lo = mid;
+        }
+        else
+        {
+          hi = mid - 1;
+        }
+      }
+
+      if (lo < start_idx && node.in_flight.empty())
+      {
+        return start_idx;
+      }
+      return lo;
+    }
+
     Term get_term_internal(Index idx)
     {
       if (idx > state->last_idx)
@@ -1024,6 +1205,8 @@ namespace aft
         return std::min(start + entries_batch_size - 1, max_idx);
       };
 
+      const auto& node = all_other_nodes.at(to);
+      bool sent = false;
       Index end_idx = 0;
 
       // We break _after_ sending, so that in the case where this is called
@@ -1031,8 +1214,26 @@ namespace aft
       do
       {
         end_idx = calculate_end_index(start_idx);
+        if (append_entries_window_bytes != 0 && end_idx >= start_idx)
+        {
+          end_idx = window_end_index(node, start_idx, end_idx);
+          if (end_idx < start_idx)
+          {
+            RAFT_TRACE_FMT(
+              "Window to {} is full with {} bytes in flight",
+              to,
+              node.in_flight_bytes);
+            if (!sent)
+            {
+              // Heartbeat, after which the node reports any lost entries
+              send_append_entries_range(to, start_idx, start_idx - 1);
+            }
+            break;
+          }
+        }
         RAFT_TRACE_FMT("Sending sub range {} -> {}", start_idx, end_idx);
         send_append_entries_range(to, start_idx, end_idx);
+        sent = true;
         start_idx = std::min(end_idx + 1, state->last_idx);
       } while (end_idx != state->last_idx);
     }
@@ -1099,6 +1300,13 @@ namespace aft
 
       // Record the most recent index we have sent to this node.
       node.sent_idx = end_idx;
+
+      if (append_entries_window_bytes != 0 && end_idx >= start_idx)
+      {
+        const auto bytes = append_entries_bytes(start_idx, end_idx);
+        node.in_flight.emplace_back(end_idx, bytes);
+        node.in_flight_bytes += bytes;
+      }
     }
 
     void recv_append_entries(
@@ -1376,7 +1584,7 @@ namespace aft
           ds->apply(track_deletes_on_missing_keys);
         if (apply_success == ccf::kv::ApplyResult::FAIL)
         {
-          ledger->truncate(i - 1);
+          truncate_ledger(i - 1);
           send_append_entries_response_nack(from);
           return;
         }
@@ -1398,6 +1606,7 @@ namespace aft
 
         ledger->put_entry(
           entry, globally_committable, ds->get_term(), ds->get_index());
+        record_entry_size(ds->get_index(), entry.size());
 
         switch (apply_success)
         {
@@ -1405,7 +1614,7 @@ namespace aft
           {
             RAFT_FAIL_FMT("Follower failed to apply log entry: {}", i);
             state->last_idx--;
-            ledger->truncate(state->last_idx);
+            truncate_ledger(state->last_idx);
             send_append_entries_response_nack(from);
             break;
           }
@@ -1505,11 +1714,40 @@ namespace aft
       // If we get to here, we have applied up to r.idx in this AppendEntries.
       // We must only ACK this far, as we know nothing about the agreement of a
       // suffix we may still hold _after_ r.idx with the leader's log
-      const auto response_idx = ae.idx;
+      auto response_idx = ae.idx;
+      if (durable_acks && durable_idx < response_idx)
+      {
+        // The rest is acknowledged by set_ledger_durable_seqno()
+        pending_ack = std::make_pair(to, response_idx);
+        response_idx = durable_idx;
+      }
       send_append_entries_response(
         to, AppendEntriesResponseType::OK, state->current_view, response_idx);
     }
 
+    void truncate_ledger(Index idx)
+    {
+      ledger->truncate(idx, ++truncation_id);
+
+      if (idx < entry_offsets_start)
+      {
+        entry_offsets.clear();
+      }
+      else if (idx - entry_offsets_start + 1 < entry_offsets.size())
+      {
+        entry_offsets.resize(idx - entry_offsets_start + 1);
+      }
+
+      if (durable_acks)
+      {
+        durable_idx = std::min(durable_idx, idx);
+        if (pending_ack.has_value() && pending_ack->second > idx)
+        {
+          pending_ack->second = idx;
+        }
+      }
+    }
+
     void send_append_entries_response_nack(
       ccf::NodeId to, const ccf::TxID& rejected)
     {
@@ -1661,8 +1899,32 @@ namespace aft
           "Recv {} to {} from {}: failed", r.msg, state->node_id, from);
         const auto this_match =
           find_highest_possible_match({r.term, r.last_log_idx});
-        node->second.sent_idx = std::max(
+        const auto rewind_idx = std::max(
           std::min(this_match, node->second.sent_idx), node->second.match_idx);
+        if (append_entries_window_bytes == 0)
+        {
+          node->second.sent_idx = rewind_idx;
+          return;
+        }
+
+        if (node->second.rewound_to == rewind_idx)
+        {
+          RAFT_DEBUG_FMT(
+            "Recv {} to {} from {}: already rewound to {}",
+            r.msg,
+            state->node_id,
+            from,
+            rewind_idx);
+          return;
+        }
+
+        // Everything in flight is either lost or will be nacked, so resend
+        // from the rewound index without waiting for the next periodic
+        node->second.sent_idx = rewind_idx;
+        node->second.rewound_to = rewind_idx;
+        node->second.in_flight.clear();
+        node->second.in_flight_bytes = 0;
+        send_append_entries(from, rewind_idx + 1);
         return;
       }
 
@@ -1670,6 +1932,14 @@ namespace aft
       // response?!
       node->second.match_idx = std::max(node->second.match_idx, r.last_log_idx);
 
+      auto& in_flight = node->second.in_flight;
+      while (!in_flight.empty() &&
+             in_flight.front().first <= node->second.match_idx)
+      {
+        node->second.in_flight_bytes -= in_flight.front().second;
+        in_flight.pop_front();
+      }
+
       RAFT_DEBUG_FMT(
         "Recv {} to {} from {} for index {}: success",
         r.msg,
@@ -1677,6 +1947,21 @@ namespace aft
         from,
         r.last_log_idx);
       update_commit();
+
+      if (
+        append_entries_window_bytes != 0 &&
+        state->leadership_state == ccf::kv::LeadershipState::Leader)
+      {
+        // The ack may have opened the window, so send further entries now
+        node = all_other_nodes.find(from);
+        if (
+          node != all_other_nodes.end() &&
+          node->second.sent_idx < state->last_idx &&
+          !append_entries_window_full(node->second))
+        {
+          send_append_entries(from, node->second.sent_idx + 1);
+        }
+      }
     }
 
     void send_request_pre_vote(const ccf::NodeId& to)
@@ -2238,6 +2523,9 @@ namespace aft
       {
         node.second.match_idx = 0;
         node.second.sent_idx = next - 1;
+        node.second.in_flight.clear();
+        node.second.in_flight_bytes = 0;
+        node.second.rewound_to.reset();
 
         // Send an empty append_entries to all nodes.
         send_append_entries(node.first, next);
@@ -2476,7 +2764,9 @@ namespace aft
         {
           if (node.first == state->node_id)
           {
-            match.push_back(state->last_idx);
+            match.push_back(
+              durable_acks ? std::min(durable_idx, state->last_idx) :
+                             state->last_idx);
           }
           else
           {
@@ -2591,6 +2881,22 @@ namespace aft
 
       compact_committable_indices(idx);
 
+      // Committed entries are only sent to lagging nodes, whose window is
+      // accounted for with estimated entry sizes
+      const auto committed_from = entry_offsets_start;
+      const auto committed_base = entry_offsets_base;
+      while (!entry_offsets.empty() && entry_offsets_start <= idx)
+      {
+        entry_offsets_base = entry_offsets.front();
+        entry_offsets.pop_front();
+        ++entry_offsets_start;
+      }
+      if (entry_offsets_start > committed_from)
+      {
+        committed_entry_size = (entry_offsets_base - committed_base) /
+          (entry_offsets_start - committed_from);
+      }
+
       state->commit_idx = idx;
       if (
         is_retired() &&
@@ -2692,7 +2998,7 @@ namespace aft
       store->rollback({get_term_internal(idx), idx}, state->current_view);
 
       RAFT_DEBUG_FMT("Setting term in store to: {}", state->current_view);
-      ledger->truncate(idx);
+      truncate_ledger(idx);
       state->last_idx = idx;
       RAFT_DEBUG_FMT("Rolled back at {}", idx);
 
@@ -102,6 +102,10 @@ int main(int argc, char** argv)
         }
         break;
       }
+      case shash("append_entries_window"):
+        assert(items.size() == 2);
+        driver->set_append_entries_window(items[1]);
+        break;
       case shash("start_node"):
         assert(items.size() == 2);
         driver->create_start_node(items[1], lineno);
@@ -63,10 +63,10 @@ struct LedgerStubProxy_Mermaid : public aft::LedgerStubProxy
     aft::LedgerStubProxy::put_entry(data, globally_committable, term, index);
   }
 
-  void truncate(aft::Index idx) override
+  void truncate(aft::Index idx, uint64_t truncation_id = 0) override
   {
     RAFT_DRIVER_PRINT("{}->>{}: [ledger] truncating to {}", _id, _id, idx);
-    aft::LedgerStubProxy::truncate(idx);
+    aft::LedgerStubProxy::truncate(idx, truncation_id);
   }
 };
 
@@ -119,6 +119,7 @@ private:
   };
 
   bool pre_vote_enabled = true;
+  std::optional<ccf::ds::SizeString> append_entries_window = std::nullopt;
   std::map<ccf::NodeId, NodeDriver> _nodes;
   std::set<std::pair<ccf::NodeId, ccf::NodeId>> _connections;
 
@@ -194,7 +195,8 @@ private:
   void add_node(ccf::NodeId node_id)
   {
     auto kv = std::make_shared<Store>(node_id);
-    const ccf::consensus::Configuration settings{{"10ms"}, {"100ms"}};
+    ccf::consensus::Configuration settings{{"10ms"}, {"100ms"}};
+    settings.append_entries_window = append_entries_window;
     auto raft = std::make_shared<TRaft>(
       settings,
       std::make_unique<Adaptor>(kv),
@@ -1074,6 +1076,12 @@ public:
     pre_vote_enabled = enabled;
   }
 
+  // Applies to nodes created after this is called
+  void set_append_entries_window(const std::string& window)
+  {
+    append_entries_window = ccf::ds::SizeString(window);
+  }
+
   using Discrepancies = std::map<ccf::NodeId, std::vector<std::string>>;
 
   Discrepancies check_state_sync(const std::map<ccf::NodeId, NodeDriver> nodes)
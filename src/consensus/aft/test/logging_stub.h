@@ -128,7 +128,7 @@ namespace aft
       return payload;
     }
 
-    virtual void truncate(Index idx)
+    virtual void truncate(Index idx, uint64_t /*truncation_id*/ = 0)
     {
       ledger.resize(idx);
     }
@@ -1095,6 +1095,155 @@ DOCTEST_TEST_CASE(
     1);
 }
 
+DOCTEST_TEST_CASE("Durable acks" * doctest::test_suite("single"))
+{
+  ccf::NodeId node_id = ccf::kv::test::PrimaryNodeId;
+  auto kv_store = std::make_shared<Store>(node_id);
+
+  auto settings = raft_settings;
+  settings.durable_acks = true;
+
+  TRaft r0(
+    settings,
+    std::make_unique<Adaptor>(kv_store),
+    std::make_unique<aft::LedgerStubProxy>(node_id),
+    std::make_shared<aft::ChannelStubProxy>(),
+    std::make_shared<aft::State>(node_id),
+    nullptr);
+
+  aft::Configuration::Nodes config;
+  config[node_id] = {};
+  r0.add_configuration(0, config);
+
+  r0.start_ticking();
+  r0.periodic(election_timeout * 2);
+  DOCTEST_REQUIRE(r0.is_primary());
+
+  for (size_t i = 1; i <= 5; ++i)
+  {
+    auto entry = std::make_shared<std::vector<uint8_t>>(3, i);
+    r0.replicate(ccf::kv::BatchVector{{i, entry, true, hooks}}, 1);
+  }
+
+  DOCTEST_INFO("Nothing is committed until it is durable");
+  DOCTEST_REQUIRE(r0.get_last_idx() == 5);
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 0);
+
+  r0.set_ledger_durable_seqno(3, 0);
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 3);
+
+  DOCTEST_INFO("Reports which precede a truncation are ignored");
+  r0.rollback(4);
+  r0.replicate(
+    ccf::kv::BatchVector{
+      {5, std::make_shared<std::vector<uint8_t>>(3, 6), true, hooks}},
+    1);
+  r0.set_ledger_durable_seqno(5, 0);
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 3);
+
+  DOCTEST_INFO("Reports tagged with the latest truncation are used");
+  r0.set_ledger_durable_seqno(4, 1);
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 4);
+
+  r0.set_ledger_durable_seqno(5, 1);
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 5);
+}
+
+DOCTEST_TEST_CASE(
+  "Followers ack once entries are durable" * doctest::test_suite("multiple"))
+{
+  ccf::NodeId node_id0 = ccf::kv::test::PrimaryNodeId;
+  ccf::NodeId node_id1 = ccf::kv::test::FirstBackupNodeId;
+
+  auto kv_store0 = std::make_shared<Store>(node_id0);
+  auto kv_store1 = std::make_shared<Store>(node_id1);
+
+  auto settings = raft_settings;
+  settings.durable_acks = true;
+
+  TRaft r0(
+    settings,
+    std::make_unique<Adaptor>(kv_store0),
+    std::make_unique<aft::LedgerStubProxy>(node_id0),
+    std::make_shared<aft::ChannelStubProxy>(),
+    std::make_shared<aft::State>(node_id0),
+    nullptr);
+  TRaft r1(
+    settings,
+    std::make_unique<Adaptor>(kv_store1),
+    std::make_unique<aft::LedgerStubProxy>(node_id1),
+    std::make_shared<aft::ChannelStubProxy>(),
+    std::make_shared<aft::State>(node_id1),
+    nullptr);
+
+  aft::Configuration::Nodes config;
+  config[node_id0] = {};
+  config[node_id1] = {};
+  r0.add_configuration(0, config);
+  r1.add_configuration(0, config);
+
+  std::map<ccf::NodeId, TRaft*> nodes;
+  nodes[node_id0] = &r0;
+  nodes[node_id1] = &r1;
+
+  auto r0c = channel_stub_proxy(r0);
+  auto r1c = channel_stub_proxy(r1);
+
+  r0.start_ticking();
+  r0.periodic(election_timeout * 2);
+
+  // Pre-vote
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id0, r0c->messages));
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id1, r1c->messages));
+  // Vote
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id0, r0c->messages));
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id1, r1c->messages));
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id0, r0c->messages));
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id1, r1c->messages));
+  DOCTEST_REQUIRE(r0.is_primary());
+
+  for (size_t i = 1; i <= 3; ++i)
+  {
+    auto entry = std::make_shared<std::vector<uint8_t>>(3, i);
+    DOCTEST_REQUIRE(
+      r0.replicate(ccf::kv::BatchVector{{i, entry, true, hooks}}, 1));
+  }
+  r0.periodic(request_timeout);
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id0, r0c->messages));
+
+  DOCTEST_INFO("Node 1 does not ack entries which are not yet durable");
+  DOCTEST_REQUIRE(
+    1 ==
+    dispatch_all_and_DOCTEST_CHECK<aft::AppendEntriesResponse>(
+      nodes, node_id1, r1c->messages, [](const auto& msg) {
+        DOCTEST_REQUIRE(msg.last_log_idx == 0);
+        DOCTEST_REQUIRE(msg.success == aft::AppendEntriesResponseType::OK);
+      }));
+
+  DOCTEST_INFO("Node 1 acks entries once they are durable");
+  r1.set_ledger_durable_seqno(2, 0);
+  DOCTEST_REQUIRE(
+    1 ==
+    dispatch_all_and_DOCTEST_CHECK<aft::AppendEntriesResponse>(
+      nodes, node_id1, r1c->messages, [](const auto& msg) {
+        DOCTEST_REQUIRE(msg.last_log_idx == 2);
+        DOCTEST_REQUIRE(msg.success == aft::AppendEntriesResponseType::OK);
+      }));
+
+  DOCTEST_INFO("Node 0 only commits what is also durable locally");
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 0);
+  r0.set_ledger_durable_seqno(3, 0);
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 2);
+
+  r1.set_ledger_durable_seqno(3, 0);
+  DOCTEST_REQUIRE(1 == dispatch_all(nodes, node_id1, r1c->messages));
+  DOCTEST_REQUIRE(r0.get_committed_seqno() == 3);
+
+  DOCTEST_INFO("Nothing more is sent once all acks are sent");
+  r1.set_ledger_durable_seqno(3, 0);
+  DOCTEST_REQUIRE(r1c->messages.size() == 0);
+}
+
 int main(int argc, char** argv)
 {
   doctest::Context context;
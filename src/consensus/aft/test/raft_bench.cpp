@@ -0,0 +1,216 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "test_common.h"
+
+#include <queue>
+#include <thread>
+
+#define PICOBENCH_IMPLEMENT
+#include <picobench/picobench.hpp>
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  // One-way delay of every message between nodes, e.g. between availability
+  // zones
+  static constexpr auto link_latency = std::chrono::milliseconds(2);
+  // While waiting for each measured entry to commit, the primary keeps
+  // replicating other entries at this interval
+  static constexpr auto load_interval = std::chrono::microseconds(200);
+  static constexpr size_t entry_size = 256;
+
+  struct InFlight
+  {
+    Clock::time_point deliver_at;
+    ccf::NodeId from;
+    ccf::NodeId to;
+    std::vector<uint8_t> contents;
+
+    bool operator>(const InFlight& other) const
+    {
+      return deliver_at > other.deliver_at;
+    }
+  };
+
+  // Three nodes connected by links with link_latency, driven in real time
+  class Cluster
+  {
+    // Adaptor only holds a weak reference to each store
+    std::vector<std::shared_ptr<Store>> stores;
+    std::map<ccf::NodeId, std::shared_ptr<TRaft>> nodes;
+    std::priority_queue<InFlight, std::vector<InFlight>, std::greater<>>
+      in_flight;
+    Clock::time_point last_tick;
+    aft::Index last_idx = 0;
+
+    void collect_messages(Clock::time_point now)
+    {
+      for (auto& [from, raft] : nodes)
+      {
+        auto& messages = channel_stub_proxy(*raft)->messages;
+        for (auto& [to, contents] : messages)
+        {
+          in_flight.push({now + link_latency, from, to, std::move(contents)});
+        }
+        messages.clear();
+      }
+    }
+
+    void tick(Clock::time_point now)
+    {
+      const auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - last_tick);
+      if (elapsed.count() > 0)
+      {
+        for (auto& [_, raft] : nodes)
+        {
+          raft->periodic(elapsed);
+        }
+        last_tick += elapsed;
+      }
+
+      while (!in_flight.empty() && in_flight.top().deliver_at <= now)
+      {
+        auto message = in_flight.top();
+        in_flight.pop();
+        receive_message(
+          *nodes.at(message.from), *nodes.at(message.to), message.contents);
+      }
+
+      collect_messages(now);
+    }
+
+  public:
+    std::shared_ptr<TRaft> primary;
+
+    Cluster(std::optional<ccf::ds::SizeString> append_entries_window)
+    {
+      auto settings = raft_settings;
+      settings.append_entries_window = append_entries_window;
+
+      aft::Configuration::Nodes config;
+      for (const auto& node_id :
+           {ccf::kv::test::PrimaryNodeId,
+            ccf::kv::test::FirstBackupNodeId,
+            ccf::kv::test::SecondBackupNodeId})
+      {
+        auto store = stores.emplace_back(std::make_shared<Store>(node_id));
+        nodes[node_id] = std::make_shared<TRaft>(
+          settings,
+          std::make_unique<Adaptor>(store),
+          std::make_unique<aft::LedgerStubProxy>(node_id),
+          std::make_shared<aft::ChannelStubProxy>(),
+          std::make_shared<aft::State>(node_id),
+          nullptr);
+        config[node_id] = {};
+      }
+
+      for (auto& [_, raft] : nodes)
+      {
+        raft->add_configuration(0, config);
+      }
+
+      primary = nodes.at(ccf::kv::test::PrimaryNodeId);
+      primary->start_ticking();
+      primary->periodic(election_timeout * 2);
+      while (!primary->is_primary())
+      {
+        for (auto& [node_id, _] : nodes)
+        {
+          dispatch_all(nodes, node_id);
+        }
+      }
+
+      last_tick = Clock::now();
+    }
+
+    aft::Index replicate()
+    {
+      auto entry = std::make_shared<std::vector<uint8_t>>(entry_size);
+      ++last_idx;
+      primary->replicate(
+        ccf::kv::BatchVector{{last_idx, entry, true, hooks}},
+        primary->get_view());
+      collect_messages(Clock::now());
+      return last_idx;
+    }
+
+    void run_until_committed(aft::Index idx)
+    {
+      auto next_load = Clock::now() + load_interval;
+      while (primary->get_committed_seqno() < idx)
+      {
+        auto now = Clock::now();
+        if (now >= next_load)
+        {
+          replicate();
+          next_load += load_interval;
+        }
+        tick(now);
+
+        auto wake_at = next_load;
+        if (!in_flight.empty())
+        {
+          wake_at = std::min(wake_at, in_flight.top().deliver_at);
+        }
+        std::this_thread::sleep_until(wake_at);
+      }
+    }
+  };
+
+  // Measures the commit latency of each entry, while the primary is also
+  // replicating other entries. Without a window, entries are only sent to
+  // backups on each periodic (or once enough are pending), so latency is
+  // bound by the message timeout. With a window, acks from backups clock out
+  // further entries, so latency is bound by the round-trip time.
+  template <size_t WindowKB>
+  static void commit_latency(picobench::state& state)
+  {
+    std::optional<ccf::ds::SizeString> window = std::nullopt;
+    if constexpr (WindowKB != 0)
+    {
+      window = ccf::ds::SizeString(fmt::format("{}KB", WindowKB));
+    }
+    Cluster cluster(window);
+
+    state.start_timer();
+    for ([[maybe_unused]] auto iteration : state)
+    {
+      cluster.run_until_committed(cluster.replicate());
+    }
+    state.stop_timer();
+  }
+
+  static void commit_latency_no_window(picobench::state& state)
+  {
+    commit_latency<0>(state);
+  }
+
+  static void commit_latency_64kb_window(picobench::state& state)
+  {
+    commit_latency<64>(state);
+  }
+
+  static void commit_latency_1mb_window(picobench::state& state)
+  {
+    commit_latency<1024>(state);
+  }
+
+  const std::vector<int> latency_iterations = {10, 50};
+}
+
+PICOBENCH_SUITE("commit latency with simulated link latency");
+PICOBENCH(commit_latency_no_window).iterations(latency_iterations).baseline();
+PICOBENCH(commit_latency_64kb_window).iterations(latency_iterations);
+PICOBENCH(commit_latency_1mb_window).iterations(latency_iterations);
+
+int main(int argc, char* argv[])
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  return runner.run();
+}
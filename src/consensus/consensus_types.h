@@ -15,7 +15,12 @@ namespace ccf::consensus
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(Configuration);
   DECLARE_JSON_REQUIRED_FIELDS(Configuration);
   DECLARE_JSON_OPTIONAL_FIELDS(
-    Configuration, message_timeout, election_timeout, max_uncommitted_tx_count);
+    Configuration,
+    message_timeout,
+    election_timeout,
+    max_uncommitted_tx_count,
+    durable_acks,
+    append_entries_window);
 
 }
 
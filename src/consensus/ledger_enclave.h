@@ -98,11 +98,17 @@ namespace consensus
      * Truncate the ledger at a given index.
      *
      * @param idx Index to truncate from
+     * @param truncation_id Id echoed by the host in durability reports once
+     * it has processed this truncation
      */
-    void truncate(Index idx)
+    void truncate(Index idx, TruncationId truncation_id = 0)
     {
       RINGBUFFER_WRITE_MESSAGE(
-        ::consensus::ledger_truncate, to_host, idx, false /* no recovery */);
+        ::consensus::ledger_truncate,
+        to_host,
+        idx,
+        false /* no recovery */,
+        truncation_id);
     }
 
     /**
@@ -9,6 +9,11 @@
 namespace consensus
 {
   using Index = uint64_t;
+  // Identifies a truncation issued by consensus, so that durability reports
+  // from the host can be matched with the latest truncation it has processed.
+  // Truncations which are not issued by consensus (eg - during recovery) have
+  // the id 0.
+  using TruncationId = uint64_t;
 
   enum LedgerRequestPurpose : uint8_t
   {
@@ -32,6 +37,9 @@ namespace consensus
     DEFINE_RINGBUFFER_MSG_TYPE(ledger_commit),
     DEFINE_RINGBUFFER_MSG_TYPE(ledger_init),
     DEFINE_RINGBUFFER_MSG_TYPE(ledger_open),
+
+    /// Report how much of the ledger is durably written. Host -> Enclave
+    DEFINE_RINGBUFFER_MSG_TYPE(ledger_durable),
   };
 }
 
@@ -59,7 +67,14 @@ DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
   ::consensus::ledger_append, bool /* committable */, std::vector<uint8_t>);
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
-  ::consensus::ledger_truncate, ::consensus::Index, bool /* recovery mode */);
+  ::consensus::ledger_truncate,
+  ::consensus::Index,
+  bool /* recovery mode */,
+  ::consensus::TruncationId);
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
   ::consensus::ledger_commit, ::consensus::Index);
 DECLARE_RINGBUFFER_MESSAGE_NO_PAYLOAD(::consensus::ledger_open);
+DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
+  ::consensus::ledger_durable,
+  ::consensus::Index /* durable idx */,
+  ::consensus::TruncationId /* latest truncation processed */);
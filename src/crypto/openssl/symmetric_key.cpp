@@ -50,24 +50,58 @@ namespace ccf::crypto
     return key.size() * CHAR_BIT;
   }
 
-  void KeyAesGcm_OpenSSL::encrypt(
+  Unique_EVP_CIPHER_CTX KeyAesGcm_OpenSSL::acquire_context(
+    ContextPool& pool, bool for_encryption) const
+  {
+    {
+      std::lock_guard<std::mutex> guard(pool.lock);
+      if (!pool.contexts.empty())
+      {
+        auto ctx = std::move(pool.contexts.back());
+        pool.contexts.pop_back();
+        return ctx;
+      }
+    }
+
+    // The key schedule is only expanded here, when a context is created
+    Unique_EVP_CIPHER_CTX ctx;
+    if (for_encryption)
+    {
+      CHECK1(
+        EVP_EncryptInit_ex(ctx, evp_cipher, nullptr, key.data(), nullptr));
+    }
+    else
+    {
+      CHECK1(
+        EVP_DecryptInit_ex(ctx, evp_cipher, nullptr, key.data(), nullptr));
+    }
+    return ctx;
+  }
+
+  void KeyAesGcm_OpenSSL::release_context(
+    ContextPool& pool, Unique_EVP_CIPHER_CTX&& ctx)
+  {
+    std::lock_guard<std::mutex> guard(pool.lock);
+    pool.contexts.push_back(std::move(ctx));
+  }
+
+  void KeyAesGcm_OpenSSL::encrypt_with(
+    EVP_CIPHER_CTX* ctx,
     std::span<const uint8_t> iv,
     std::span<const uint8_t> plain,
     std::span<const uint8_t> aad,
     std::vector<uint8_t>& cipher,
-    uint8_t tag[GCM_SIZE_TAG]) const
+    uint8_t tag[GCM_SIZE_TAG])
   {
     if (aad.empty() && plain.empty())
     {
       throw std::logic_error("aad and plain cannot both be empty");
     }
 
-    Unique_EVP_CIPHER_CTX ctx;
-    CHECK1(EVP_EncryptInit_ex(ctx, evp_cipher, nullptr, key.data(), nullptr));
-
+    // The context is already keyed, so only the IV is set
     CHECK1(
       EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, iv.size(), nullptr));
-    CHECK1(EVP_EncryptInit_ex(ctx, nullptr, nullptr, key.data(), iv.data()));
+    CHECK1(EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, iv.data()));
 
     if (!aad.empty())
     {
@@ -106,19 +140,19 @@ namespace ccf::crypto
     }
   }
 
-  bool KeyAesGcm_OpenSSL::decrypt(
+  bool KeyAesGcm_OpenSSL::decrypt_with(
+    EVP_CIPHER_CTX* ctx,
     std::span<const uint8_t> iv,
     const uint8_t tag[GCM_SIZE_TAG],
     std::span<const uint8_t> cipher,
     std::span<const uint8_t> aad,
-    std::vector<uint8_t>& plain) const
+    std::vector<uint8_t>& plain)
   {
-    Unique_EVP_CIPHER_CTX ctx;
-    CHECK1(EVP_DecryptInit_ex(ctx, evp_cipher, nullptr, nullptr, nullptr));
+    // The context is already keyed, so only the IV is set
     CHECK1(
       EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, iv.size(), nullptr));
+    CHECK1(EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, iv.data()));
 
-    CHECK1(EVP_DecryptInit_ex(ctx, nullptr, nullptr, key.data(), iv.data()));
     if (!aad.empty())
     {
       int aad_outl{0};
@@ -162,6 +196,64 @@ namespace ccf::crypto
     return true;
   }
 
+  // If encryption or decryption throws, the context is discarded rather than
+  // returned to its pool
+  void KeyAesGcm_OpenSSL::encrypt(
+    std::span<const uint8_t> iv,
+    std::span<const uint8_t> plain,
+    std::span<const uint8_t> aad,
+    std::vector<uint8_t>& cipher,
+    uint8_t tag[GCM_SIZE_TAG]) const
+  {
+    auto ctx = acquire_context(encrypt_contexts, true);
+    encrypt_with(ctx, iv, plain, aad, cipher, tag);
+    release_context(encrypt_contexts, std::move(ctx));
+  }
+
+  bool KeyAesGcm_OpenSSL::decrypt(
+    std::span<const uint8_t> iv,
+    const uint8_t tag[GCM_SIZE_TAG],
+    std::span<const uint8_t> cipher,
+    std::span<const uint8_t> aad,
+    std::vector<uint8_t>& plain) const
+  {
+    auto ctx = acquire_context(decrypt_contexts, false);
+    const auto success = decrypt_with(ctx, iv, tag, cipher, aad, plain);
+    release_context(decrypt_contexts, std::move(ctx));
+    return success;
+  }
+
+  void KeyAesGcm_OpenSSL::encrypt_batch(std::span<GcmEncryptItem> items) const
+  {
+    auto ctx = acquire_context(encrypt_contexts, true);
+    for (auto& item : items)
+    {
+      encrypt_with(
+        ctx,
+        item.iv,
+        item.plain,
+        item.aad,
+        item.cipher,
+        static_cast<uint8_t*>(item.tag));
+    }
+    release_context(encrypt_contexts, std::move(ctx));
+  }
+
+  bool KeyAesGcm_OpenSSL::decrypt_batch(std::span<GcmDecryptItem> items) const
+  {
+    auto ctx = acquire_context(decrypt_contexts, false);
+    bool all_succeeded = true;
+    for (auto& item : items)
+    {
+      check_tag_size(item.tag);
+      item.success = decrypt_with(
+        ctx, item.iv, item.tag.data(), item.cipher, item.aad, item.plain);
+      all_succeeded &= item.success;
+    }
+    release_context(decrypt_contexts, std::move(ctx));
+    return all_succeeded;
+  }
+
   std::vector<uint8_t> KeyAesGcm_OpenSSL::ckm_aes_key_wrap_pad(
     std::span<const uint8_t> plain) const
   {
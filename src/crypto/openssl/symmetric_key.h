@@ -5,7 +5,9 @@
 #include "ccf/crypto/openssl/openssl_wrappers.h"
 #include "ccf/crypto/symmetric_key.h"
 
+#include <mutex>
 #include <openssl/crypto.h>
+#include <vector>
 
 namespace ccf::crypto
 {
@@ -16,6 +18,38 @@ namespace ccf::crypto
     const EVP_CIPHER* evp_cipher = nullptr;
     const EVP_CIPHER* evp_cipher_wrap_pad;
 
+    // Cipher contexts which have already been initialised with the key, so
+    // that each message only requires the IV to be reset. Each calling thread
+    // takes a context for the duration of its call, and then returns it.
+    struct ContextPool
+    {
+      std::mutex lock;
+      std::vector<OpenSSL::Unique_EVP_CIPHER_CTX> contexts;
+    };
+    mutable ContextPool encrypt_contexts;
+    mutable ContextPool decrypt_contexts;
+
+    OpenSSL::Unique_EVP_CIPHER_CTX acquire_context(
+      ContextPool& pool, bool for_encryption) const;
+    static void release_context(
+      ContextPool& pool, OpenSSL::Unique_EVP_CIPHER_CTX&& ctx);
+
+    static void encrypt_with(
+      EVP_CIPHER_CTX* ctx,
+      std::span<const uint8_t> iv,
+      std::span<const uint8_t> plain,
+      std::span<const uint8_t> aad,
+      std::vector<uint8_t>& cipher,
+      uint8_t tag[GCM_SIZE_TAG]);
+
+    static bool decrypt_with(
+      EVP_CIPHER_CTX* ctx,
+      std::span<const uint8_t> iv,
+      const uint8_t tag[GCM_SIZE_TAG],
+      std::span<const uint8_t> cipher,
+      std::span<const uint8_t> aad,
+      std::vector<uint8_t>& plain);
+
   public:
     KeyAesGcm_OpenSSL(std::span<const uint8_t> rawKey);
     KeyAesGcm_OpenSSL(const KeyAesGcm_OpenSSL& that) = delete;
@@ -41,6 +75,10 @@ namespace ccf::crypto
       std::span<const uint8_t> aad,
       std::vector<uint8_t>& plain) const override;
 
+    void encrypt_batch(std::span<GcmEncryptItem> items) const override;
+
+    bool decrypt_batch(std::span<GcmDecryptItem> items) const override;
+
     // @brief RFC 5649 AES key wrap with padding (CKM_AES_KEY_WRAP_PAD)
     // @param plain Plaintext key to wrap
     [[nodiscard]] std::vector<uint8_t> ckm_aes_key_wrap_pad(
@@ -0,0 +1,443 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "crypto/sha256_multibuffer.h"
+
+#include "crypto/openssl/hash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__)
+#  include <cpuid.h>
+#endif
+
+namespace ccf::crypto
+{
+  namespace
+  {
+    constexpr size_t block_size = 64;
+
+    constexpr uint32_t round_constants[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+      0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+      0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+      0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+      0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+      0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+      0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+      0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    constexpr uint32_t initial_state[8] = {
+      0x6a09e667,
+      0xbb67ae85,
+      0x3c6ef372,
+      0xa54ff53a,
+      0x510e527f,
+      0x9b05688c,
+      0x1f83d9ab,
+      0x5be0cd19};
+
+    // Generic vectors of 32-bit lanes. The instructions used for them depend
+    // on the target of the function they are inlined into.
+    using Lanes4 = uint32_t __attribute__((vector_size(16)));
+    using Lanes8 = uint32_t __attribute__((vector_size(32)));
+    using Lanes16 = uint32_t __attribute__((vector_size(64)));
+
+    // Applies the SHA-256 compression function to each lane of state, with
+    // the message schedule initialised from one block per lane. Vectors are
+    // only passed by reference, and rotations are written out in full, so
+    // that no function takes or returns a vector whose ABI depends on the
+    // target.
+    template <typename V>
+    [[gnu::always_inline]] inline void compress(V (&state)[8], V (&w)[16])
+    {
+      V a = state[0];
+      V b = state[1];
+      V c = state[2];
+      V d = state[3];
+      V e = state[4];
+      V f = state[5];
+      V g = state[6];
+      V h = state[7];
+
+#pragma GCC unroll 64
+      for (size_t i = 0; i < 64; ++i)
+      {
+        if (i >= 16)
+        {
+          const V& w2 = w[(i - 2) & 15];
+          const V& w15 = w[(i - 15) & 15];
+          const V sigma1 = ((w2 >> 17) | (w2 << 15)) ^
+            ((w2 >> 19) | (w2 << 13)) ^ (w2 >> 10);
+          const V sigma0 = ((w15 >> 7) | (w15 << 25)) ^
+            ((w15 >> 18) | (w15 << 14)) ^ (w15 >> 3);
+          w[i & 15] += sigma1 + w[(i - 7) & 15] + sigma0;
+        }
+
+        const V big_sigma1 = ((e >> 6) | (e << 26)) ^ ((e >> 11) | (e << 21)) ^
+          ((e >> 25) | (e << 7));
+        const V big_sigma0 = ((a >> 2) | (a << 30)) ^
+          ((a >> 13) | (a << 19)) ^ ((a >> 22) | (a << 10));
+        const V t1 = h + big_sigma1 + ((e & f) ^ (~e & g)) +
+          round_constants[i] + w[i & 15];
+        const V t2 = big_sigma0 + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+      }
+
+      state[0] += a;
+      state[1] += b;
+      state[2] += c;
+      state[3] += d;
+      state[4] += e;
+      state[5] += f;
+      state[6] += g;
+      state[7] += h;
+    }
+
+    // Produces the padded blocks of a single message
+    struct MessageBlocks
+    {
+      const uint8_t* data = nullptr;
+      size_t full_blocks = 0;
+      size_t total_blocks = 0;
+      size_t next = 0;
+      // Last bytes of the message, followed by the padding and bit length
+      uint8_t tail[2 * block_size] = {};
+
+      void reset(std::span<const uint8_t> message)
+      {
+        data = message.data();
+        full_blocks = message.size() / block_size;
+        next = 0;
+
+        const size_t remainder = message.size() % block_size;
+        const size_t tail_blocks =
+          remainder + 1 + sizeof(uint64_t) > block_size ? 2 : 1;
+        total_blocks = full_blocks + tail_blocks;
+
+        std::memset(tail, 0, sizeof(tail));
+        if (remainder != 0)
+        {
+          std::memcpy(tail, data + full_blocks * block_size, remainder);
+        }
+        tail[remainder] = 0x80;
+        const uint64_t bit_length = uint64_t(message.size()) * 8;
+        for (size_t i = 0; i < sizeof(uint64_t); ++i)
+        {
+          tail[tail_blocks * block_size - 1 - i] =
+            static_cast<uint8_t>(bit_length >> (8 * i));
+        }
+      }
+
+      const uint8_t* next_block()
+      {
+        const auto i = next++;
+        if (i < full_blocks)
+        {
+          return data + i * block_size;
+        }
+        return tail + (i - full_blocks) * block_size;
+      }
+
+      [[nodiscard]] bool done() const
+      {
+        return next == total_blocks;
+      }
+    };
+
+    inline uint32_t load_be32(const uint8_t* p)
+    {
+      return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+        (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    inline void store_be32(uint8_t* p, uint32_t v)
+    {
+      p[0] = static_cast<uint8_t>(v >> 24);
+      p[1] = static_cast<uint8_t>(v >> 16);
+      p[2] = static_cast<uint8_t>(v >> 8);
+      p[3] = static_cast<uint8_t>(v);
+    }
+
+    // Hashes messages in the given order, one per lane. Whenever a lane
+    // finishes its message, it starts on the next one, so all lanes stay busy
+    // until the last messages.
+    template <typename V>
+    [[gnu::always_inline]] inline void sha256_lanes(
+      std::span<const std::span<const uint8_t>> messages,
+      std::span<Sha256Hash> digests,
+      std::span<const size_t> order)
+    {
+      constexpr size_t lanes = sizeof(V) / sizeof(uint32_t);
+      static constexpr uint8_t idle_block[block_size] = {};
+
+      MessageBlocks blocks[lanes];
+      size_t message_of[lanes] = {};
+      bool active[lanes] = {};
+      size_t num_active = 0;
+      size_t next_message = 0;
+
+      alignas(sizeof(V)) uint32_t state_words[8][lanes] = {};
+      alignas(sizeof(V)) uint32_t block_words[16][lanes] = {};
+      V state[8];
+      V w[16];
+
+      for (size_t lane = 0; lane < lanes && next_message < order.size();
+           ++lane)
+      {
+        message_of[lane] = order[next_message++];
+        blocks[lane].reset(messages[message_of[lane]]);
+        active[lane] = true;
+        ++num_active;
+        for (size_t k = 0; k < 8; ++k)
+        {
+          state_words[k][lane] = initial_state[k];
+        }
+      }
+      std::memcpy(static_cast<void*>(state), state_words, sizeof(state));
+
+      while (num_active > 0)
+      {
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+          const uint8_t* block =
+            active[lane] ? blocks[lane].next_block() : idle_block;
+          for (size_t j = 0; j < 16; ++j)
+          {
+            block_words[j][lane] = load_be32(block + 4 * j);
+          }
+        }
+        std::memcpy(static_cast<void*>(w), block_words, sizeof(w));
+
+        compress(state, w);
+
+        bool restarted = false;
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+          if (!active[lane] || !blocks[lane].done())
+          {
+            continue;
+          }
+
+          if (!restarted)
+          {
+            std::memcpy(state_words, static_cast<void*>(state), sizeof(state));
+            restarted = true;
+          }
+
+          auto& digest = digests[message_of[lane]];
+          for (size_t k = 0; k < 8; ++k)
+          {
+            store_be32(digest.h.data() + 4 * k, state_words[k][lane]);
+          }
+
+          if (next_message < order.size())
+          {
+            message_of[lane] = order[next_message++];
+            blocks[lane].reset(messages[message_of[lane]]);
+            for (size_t k = 0; k < 8; ++k)
+            {
+              state_words[k][lane] = initial_state[k];
+            }
+          }
+          else
+          {
+            active[lane] = false;
+            --num_active;
+          }
+        }
+
+        if (restarted)
+        {
+          std::memcpy(static_cast<void*>(state), state_words, sizeof(state));
+        }
+      }
+    }
+
+    void sha256_simd4(
+      std::span<const std::span<const uint8_t>> messages,
+      std::span<Sha256Hash> digests,
+      std::span<const size_t> order)
+    {
+      sha256_lanes<Lanes4>(messages, digests, order);
+    }
+
+#if defined(__x86_64__)
+    __attribute__((target("avx2"))) void sha256_avx2(
+      std::span<const std::span<const uint8_t>> messages,
+      std::span<Sha256Hash> digests,
+      std::span<const size_t> order)
+    {
+      sha256_lanes<Lanes8>(messages, digests, order);
+    }
+
+    __attribute__((target("avx512f"))) void sha256_avx512(
+      std::span<const std::span<const uint8_t>> messages,
+      std::span<Sha256Hash> digests,
+      std::span<const size_t> order)
+    {
+      sha256_lanes<Lanes16>(messages, digests, order);
+    }
+
+    bool cpu_has_sha_ni()
+    {
+      unsigned int eax = 0;
+      unsigned int ebx = 0;
+      unsigned int ecx = 0;
+      unsigned int edx = 0;
+      if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+      {
+        return false;
+      }
+      return (ebx & (1U << 29)) != 0;
+    }
+#endif
+
+    size_t lanes_of(Sha256Kernel kernel)
+    {
+      switch (kernel)
+      {
+        case Sha256Kernel::Simd4:
+          return 4;
+        case Sha256Kernel::Avx2:
+          return 8;
+        case Sha256Kernel::Avx512:
+          return 16;
+        case Sha256Kernel::Auto:
+        case Sha256Kernel::OpenSSL:
+          return 1;
+      }
+      return 1;
+    }
+
+    Sha256Kernel select_default_kernel()
+    {
+#if defined(__x86_64__)
+      if (is_sha256_kernel_supported(Sha256Kernel::Avx512))
+      {
+        return Sha256Kernel::Avx512;
+      }
+      // With SHA-NI, OpenSSL hashes a single message faster than AVX2 can
+      // hash 8
+      if (cpu_has_sha_ni())
+      {
+        return Sha256Kernel::OpenSSL;
+      }
+      if (is_sha256_kernel_supported(Sha256Kernel::Avx2))
+      {
+        return Sha256Kernel::Avx2;
+      }
+#endif
+      return Sha256Kernel::OpenSSL;
+    }
+  }
+
+  bool is_sha256_kernel_supported(Sha256Kernel kernel)
+  {
+    switch (kernel)
+    {
+      case Sha256Kernel::Auto:
+      case Sha256Kernel::OpenSSL:
+      case Sha256Kernel::Simd4:
+        return true;
+      case Sha256Kernel::Avx2:
+#if defined(__x86_64__)
+        return __builtin_cpu_supports("avx2") != 0;
+#else
+        return false;
+#endif
+      case Sha256Kernel::Avx512:
+#if defined(__x86_64__)
+        return __builtin_cpu_supports("avx512f") != 0;
+#else
+        return false;
+#endif
+    }
+    return false;
+  }
+
+  Sha256Kernel get_default_sha256_kernel()
+  {
+    static const Sha256Kernel kernel = select_default_kernel();
+    return kernel;
+  }
+
+  void sha256_many(
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<Sha256Hash> digests,
+    Sha256Kernel kernel)
+  {
+    if (messages.size() != digests.size())
+    {
+      throw std::logic_error(fmt::format(
+        "Cannot hash {} messages into {} digests",
+        messages.size(),
+        digests.size()));
+    }
+
+    if (kernel == Sha256Kernel::Auto)
+    {
+      kernel = get_default_sha256_kernel();
+    }
+    else if (!is_sha256_kernel_supported(kernel))
+    {
+      throw std::logic_error("SHA-256 kernel is not supported on this CPU");
+    }
+
+    // When too few messages would fill the lanes, hash them one at a time
+    if (messages.size() * 2 <= lanes_of(kernel))
+    {
+      kernel = Sha256Kernel::OpenSSL;
+    }
+
+    if (kernel == Sha256Kernel::OpenSSL)
+    {
+      for (size_t i = 0; i < messages.size(); ++i)
+      {
+        openssl_sha256(messages[i], digests[i].h.data());
+      }
+      return;
+    }
+
+    // Longest messages first, so that lanes finish at similar times
+    std::vector<size_t> order(messages.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return messages[a].size() / block_size > messages[b].size() / block_size;
+    });
+
+    if (kernel == Sha256Kernel::Simd4)
+    {
+      sha256_simd4(messages, digests, order);
+      return;
+    }
+#if defined(__x86_64__)
+    if (kernel == Sha256Kernel::Avx2)
+    {
+      sha256_avx2(messages, digests, order);
+      return;
+    }
+    if (kernel == Sha256Kernel::Avx512)
+    {
+      sha256_avx512(messages, digests, order);
+      return;
+    }
+#endif
+    throw std::logic_error(fmt::format(
+      "Unexpected SHA-256 kernel {}", static_cast<int>(kernel)));
+  }
+}
@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/crypto/sha256_hash.h"
+
+#include <span>
+
+namespace ccf::crypto
+{
+  // Implementations of sha256_many(). The SIMD kernels hash one message per
+  // lane, so that many independent messages are hashed together.
+  enum class Sha256Kernel
+  {
+    // Chosen from the features of the current CPU
+    Auto,
+    // One message at a time through OpenSSL, which uses SHA-NI if available
+    OpenSSL,
+    // 4 messages at a time, with the baseline vector unit (SSE2 on x86-64)
+    Simd4,
+    // 8 messages at a time, with AVX2
+    Avx2,
+    // 16 messages at a time, with AVX-512
+    Avx512,
+  };
+
+  bool is_sha256_kernel_supported(Sha256Kernel kernel);
+
+  // The kernel used by Sha256Kernel::Auto on this CPU
+  Sha256Kernel get_default_sha256_kernel();
+
+  /** Compute the SHA-256 digest of each of @p messages
+   * @param messages The messages to hash
+   * @param digests Receives the digest of each message, so must be the same
+   * size as @p messages
+   * @param kernel The implementation to use, which must be supported by the
+   * current CPU
+   *
+   * Equivalent to constructing a Sha256Hash from each message in turn, but
+   * faster when there are many small messages, such as the nodes of a Merkle
+   * tree or the entries of a batch of transactions.
+   */
+  void sha256_many(
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<Sha256Hash> digests,
+    Sha256Kernel kernel = Sha256Kernel::Auto);
+}
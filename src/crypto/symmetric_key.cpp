@@ -96,6 +96,42 @@ namespace ccf::crypto
     cipher = serialized::read(data, size, size);
   }
 
+  /// KeyAesGcm implementation
+  void KeyAesGcm::check_tag_size(std::span<const uint8_t> tag)
+  {
+    if (tag.size() != GCM_SIZE_TAG)
+    {
+      throw std::logic_error(fmt::format(
+        "GCM tag must be of size {}, not {}", GCM_SIZE_TAG, tag.size()));
+    }
+  }
+
+  void KeyAesGcm::encrypt_batch(std::span<GcmEncryptItem> items) const
+  {
+    for (auto& item : items)
+    {
+      encrypt(
+        item.iv,
+        item.plain,
+        item.aad,
+        item.cipher,
+        static_cast<uint8_t*>(item.tag));
+    }
+  }
+
+  bool KeyAesGcm::decrypt_batch(std::span<GcmDecryptItem> items) const
+  {
+    bool all_succeeded = true;
+    for (auto& item : items)
+    {
+      check_tag_size(item.tag);
+      item.success =
+        decrypt(item.iv, item.tag.data(), item.cipher, item.aad, item.plain);
+      all_succeeded &= item.success;
+    }
+    return all_succeeded;
+  }
+
   /// Free function implementation
   std::unique_ptr<KeyAesGcm> make_key_aes_gcm(std::span<const uint8_t> rawKey)
   {
@@ -455,6 +455,73 @@ namespace Base64_bench
   PICOBENCH(openssl_base64_5000).PICO_HASH_SUFFIX();
 }
 
+PICOBENCH_SUITE("aes-gcm small messages");
+namespace AES_GCM_bench
+{
+  constexpr size_t messages_per_iteration = 100;
+
+  template <size_t NBytes, bool Batch>
+  static void benchmark_aes_gcm(picobench::state& s)
+  {
+    auto key = make_key_aes_gcm(std::vector<uint8_t>(GCM_DEFAULT_KEY_SIZE, 1));
+    const auto contents = make_contents<NBytes>();
+
+    std::vector<StandardGcmHeader> headers(messages_per_iteration);
+    for (auto& h : headers)
+    {
+      h.set_random_iv();
+    }
+
+    std::vector<GcmEncryptItem> items;
+    for (const auto& h : headers)
+    {
+      items.push_back({h.get_iv(), contents, {}});
+    }
+
+    s.start_timer();
+    for (auto _ : s)
+    {
+      (void)_;
+      if constexpr (Batch)
+      {
+        key->encrypt_batch(items);
+      }
+      else
+      {
+        for (auto& item : items)
+        {
+          key->encrypt(
+            item.iv,
+            item.plain,
+            item.aad,
+            item.cipher,
+            static_cast<uint8_t*>(item.tag));
+        }
+      }
+      do_not_optimize(items);
+      clobber_memory();
+    }
+    s.stop_timer();
+  }
+
+  const std::vector<int> aes_gcm_iterations = {100};
+
+  auto aes_gcm_64_single = benchmark_aes_gcm<64, false>;
+  PICOBENCH(aes_gcm_64_single).iterations(aes_gcm_iterations).baseline();
+  auto aes_gcm_64_batch = benchmark_aes_gcm<64, true>;
+  PICOBENCH(aes_gcm_64_batch).iterations(aes_gcm_iterations);
+
+  auto aes_gcm_256_single = benchmark_aes_gcm<256, false>;
+  PICOBENCH(aes_gcm_256_single).iterations(aes_gcm_iterations);
+  auto aes_gcm_256_batch = benchmark_aes_gcm<256, true>;
+  PICOBENCH(aes_gcm_256_batch).iterations(aes_gcm_iterations);
+
+  auto aes_gcm_1k_single = benchmark_aes_gcm<1024, false>;
+  PICOBENCH(aes_gcm_1k_single).iterations(aes_gcm_iterations);
+  auto aes_gcm_1k_batch = benchmark_aes_gcm<1024, true>;
+  PICOBENCH(aes_gcm_1k_batch).iterations(aes_gcm_iterations);
+}
+
 PICOBENCH_SUITE("hmac");
 namespace HMAC_bench
 {
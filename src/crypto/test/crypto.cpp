@@ -24,13 +24,16 @@
 #include "crypto/openssl/symmetric_key.h"
 #include "crypto/openssl/verifier.h"
 #include "crypto/openssl/x509_time.h"
+#include "crypto/sha256_multibuffer.h"
 
+#include <atomic>
 #include <chrono>
 #include <cstring>
 #include <ctime>
 #include <doctest/doctest.h>
 #include <optional>
 #include <span>
+#include <thread>
 
 using namespace std;
 using namespace ccf::crypto;
@@ -853,6 +856,114 @@ TEST_CASE("AES Key wrap with padding")
   REQUIRE(key_to_wrap == unwrapped);
 }
 
+TEST_CASE("AES-GCM batch")
+{
+  auto k = ccf::crypto::make_key_aes_gcm(get_raw_key());
+
+  constexpr size_t n_messages = 20;
+  std::vector<StandardGcmHeader> headers(n_messages);
+  std::vector<std::vector<uint8_t>> plains;
+  std::vector<uint8_t> aad(17, 'a');
+  std::vector<GcmEncryptItem> encrypt_items;
+  for (size_t i = 0; i < n_messages; ++i)
+  {
+    headers[i].set_random_iv();
+    plains.push_back(get_entropy()->random(i * 13));
+    encrypt_items.push_back({headers[i].get_iv(), plains.back(), aad});
+  }
+
+  k->encrypt_batch(encrypt_items);
+
+  INFO("Batch encryption matches single encryption");
+  {
+    for (size_t i = 0; i < n_messages; ++i)
+    {
+      const auto& item = encrypt_items[i];
+      std::vector<uint8_t> cipher;
+      uint8_t tag[GCM_SIZE_TAG] = {};
+      k->encrypt(item.iv, item.plain, item.aad, cipher, tag);
+      REQUIRE(cipher == item.cipher);
+      REQUIRE(std::memcmp(tag, item.tag, GCM_SIZE_TAG) == 0);
+    }
+  }
+
+  std::vector<GcmDecryptItem> decrypt_items;
+  for (const auto& item : encrypt_items)
+  {
+    decrypt_items.push_back({item.iv, item.tag, item.cipher, item.aad});
+  }
+
+  INFO("Batch decryption recovers each plaintext");
+  {
+    REQUIRE(k->decrypt_batch(decrypt_items));
+    for (size_t i = 0; i < n_messages; ++i)
+    {
+      REQUIRE(decrypt_items[i].success);
+      REQUIRE(decrypt_items[i].plain == plains[i]);
+    }
+  }
+
+  INFO("Failures are reported per message");
+  {
+    const size_t tampered = 3;
+    encrypt_items[tampered].tag[0] ^= 1;
+    for (auto& item : decrypt_items)
+    {
+      item.plain.clear();
+      item.success = false;
+    }
+
+    REQUIRE_FALSE(k->decrypt_batch(decrypt_items));
+    for (size_t i = 0; i < n_messages; ++i)
+    {
+      REQUIRE(decrypt_items[i].success == (i != tampered));
+      if (i != tampered)
+      {
+        REQUIRE(decrypt_items[i].plain == plains[i]);
+      }
+    }
+    encrypt_items[tampered].tag[0] ^= 1;
+  }
+
+  INFO("Tags of the wrong size are rejected");
+  {
+    decrypt_items[0].tag = decrypt_items[0].tag.subspan(1);
+    REQUIRE_THROWS(k->decrypt_batch(decrypt_items));
+  }
+
+  INFO("A key can be used concurrently from many threads");
+  {
+    constexpr size_t n_threads = 8;
+    std::atomic<size_t> failures = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; ++t)
+    {
+      threads.emplace_back([&]() {
+        for (size_t i = 0; i < 50; ++i)
+        {
+          StandardGcmHeader h;
+          h.set_random_iv();
+          const auto& plain = plains[i % n_messages];
+          std::vector<uint8_t> cipher;
+          k->encrypt(h.get_iv(), plain, aad, cipher, h.tag);
+          std::vector<uint8_t> decrypted;
+          if (
+            !k->decrypt(h.get_iv(), h.tag, cipher, aad, decrypted) ||
+            decrypted != plain)
+          {
+            ++failures;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    REQUIRE(failures == 0);
+  }
+}
+
 TEST_CASE("CKM_RSA_PKCS_OAEP")
 {
   auto key = get_raw_key();
@@ -1198,6 +1309,57 @@ TEST_CASE("Incremental hash")
   }
 }
 
+TEST_CASE("Multi-buffer SHA-256")
+{
+  // Every length around the padding boundaries of one and two blocks, and
+  // some longer messages
+  std::vector<std::vector<uint8_t>> messages;
+  for (size_t size = 0; size <= 130; ++size)
+  {
+    messages.push_back(get_entropy()->random(size));
+  }
+  for (size_t size : {1000, 4096, 10000})
+  {
+    messages.push_back(get_entropy()->random(size));
+  }
+  std::vector<std::span<const uint8_t>> spans(
+    messages.begin(), messages.end());
+
+  for (auto kernel :
+       {Sha256Kernel::Auto,
+        Sha256Kernel::OpenSSL,
+        Sha256Kernel::Simd4,
+        Sha256Kernel::Avx2,
+        Sha256Kernel::Avx512})
+  {
+    if (!is_sha256_kernel_supported(kernel))
+    {
+      continue;
+    }
+
+    INFO("Kernel " << static_cast<int>(kernel));
+    std::vector<Sha256Hash> digests(spans.size());
+    sha256_many(spans, digests, kernel);
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+      REQUIRE(digests[i] == Sha256Hash(messages[i]));
+    }
+
+    INFO("Fewer messages than lanes");
+    {
+      std::vector<Sha256Hash> few(3);
+      sha256_many(std::span(spans).subspan(60, 3), few, kernel);
+      for (size_t i = 0; i < few.size(); ++i)
+      {
+        REQUIRE(few[i] == Sha256Hash(messages[60 + i]));
+      }
+    }
+  }
+
+  std::vector<Sha256Hash> too_few(spans.size() - 1);
+  REQUIRE_THROWS_AS(sha256_many(spans, too_few), std::logic_error);
+}
+
 TEST_CASE("Sign and verify with RSA key")
 {
   const auto kp = ccf::crypto::make_rsa_key_pair();
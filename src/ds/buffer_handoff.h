@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <cstdint>
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace ringbuffer
+{
+  using SharedBuffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+  // A payload made of separately produced parts, which the reader consumes in
+  // order rather than having them concatenated by the writer
+  using SharedBuffers = std::vector<SharedBuffer>;
+
+  // In-process side channel for bulk payloads between the two ends of a
+  // ringbuffer::Circuit. Since the enclave and host run in the same process,
+  // a large payload does not need to be copied into (and fragmented across)
+  // the ringbuffer. Instead the writer deposits the buffers here, and sends
+  // only their handle in a small ringbuffer message. That preserves ordering
+  // relative to other messages on the ring, while the reader claims the
+  // buffers by handle and takes shared ownership of them.
+  //
+  // Deposited buffers are owned here until they are claimed. Handles are
+  // allocated and written to the ring under a single lock, so they reach the
+  // (single) reader in increasing order. A handle older than the one being
+  // claimed can therefore never be claimed, and its buffers are reclaimed
+  // rather than held forever. Anything still pending is released when the
+  // BufferHandoff is destroyed.
+  class BufferHandoff
+  {
+  public:
+    using Handle = uint64_t;
+
+  private:
+    std::mutex lock;
+    std::map<Handle, SharedBuffers> buffers;
+    Handle next_handle = 0;
+    size_t reclaimed = 0;
+
+    // Payloads smaller than this continue to be written to the ring
+    const size_t min_handoff_size;
+
+  public:
+    BufferHandoff(size_t min_handoff_size_) :
+      min_handoff_size(min_handoff_size_)
+    {}
+
+    [[nodiscard]] bool should_handoff(size_t size) const
+    {
+      return size >= min_handoff_size;
+    }
+
+    // Deposits parts, and calls write(handle) to pass their handle to the
+    // reader. write must not block (eg - it should use try_write), since the
+    // reader cannot claim anything while it runs. If write returns false or
+    // throws, the parts are released immediately and the caller remains
+    // responsible for sending the payload some other way.
+    template <typename F>
+    bool send(SharedBuffers parts, F&& write)
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      const auto handle = next_handle++;
+      const auto it = buffers.emplace(handle, std::move(parts)).first;
+
+      bool written = false;
+      try
+      {
+        written = write(handle);
+      }
+      catch (...)
+      {
+        buffers.erase(it);
+        throw;
+      }
+
+      if (!written)
+      {
+        buffers.erase(it);
+      }
+      return written;
+    }
+
+    // Each handle can be claimed exactly once. Claiming a handle also
+    // reclaims any older handles that are still pending, since the messages
+    // carrying them must have been dropped before reaching the reader.
+    SharedBuffers claim(Handle handle)
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      auto it = buffers.find(handle);
+      if (it == buffers.end())
+      {
+        throw std::logic_error(
+          fmt::format("No buffer deposited with handle {}", handle));
+      }
+
+      auto parts = std::move(it->second);
+      reclaimed += std::distance(buffers.begin(), it);
+      buffers.erase(buffers.begin(), std::next(it));
+      return parts;
+    }
+
+    size_t pending()
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      return buffers.size();
+    }
+
+    // Number of deposits released without ever being claimed
+    size_t reclaimed_count()
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      return reclaimed;
+    }
+  };
+
+  using BufferHandoffPtr = std::shared_ptr<BufferHandoff>;
+}
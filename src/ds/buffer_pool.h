@@ -0,0 +1,128 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace ccf::ds
+{
+  // Bounded pool of reusable byte buffers, for small scratch allocations which
+  // are made on every request (eg - serialised HTTP response headers). Buffers
+  // are handed out empty, but retain the capacity they had when released.
+  // Buffers which have grown beyond max_buffer_capacity are freed rather than
+  // returned to the pool, so a single large message cannot pin memory.
+  class BufferPool
+  {
+  private:
+    std::mutex lock;
+    std::vector<std::vector<uint8_t>> free_buffers;
+
+    const size_t max_pooled_buffers;
+    const size_t max_buffer_capacity;
+
+  public:
+    BufferPool(size_t max_pooled_buffers_, size_t max_buffer_capacity_) :
+      max_pooled_buffers(max_pooled_buffers_),
+      max_buffer_capacity(max_buffer_capacity_)
+    {}
+
+    std::vector<uint8_t> acquire()
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (free_buffers.empty())
+      {
+        return {};
+      }
+
+      auto buffer = std::move(free_buffers.back());
+      free_buffers.pop_back();
+      return buffer;
+    }
+
+    void release(std::vector<uint8_t>&& buffer)
+    {
+      if (buffer.capacity() == 0 || buffer.capacity() > max_buffer_capacity)
+      {
+        return;
+      }
+
+      buffer.clear();
+
+      std::lock_guard<std::mutex> guard(lock);
+      if (free_buffers.size() < max_pooled_buffers)
+      {
+        free_buffers.emplace_back(std::move(buffer));
+      }
+    }
+
+    size_t size()
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      return free_buffers.size();
+    }
+  };
+
+  using BufferPoolPtr = std::shared_ptr<BufferPool>;
+
+  // Owning handle to a buffer taken from a BufferPool, which returns the
+  // buffer to its pool on destruction. May be moved between threads.
+  class PooledBuffer
+  {
+  private:
+    BufferPoolPtr pool;
+    std::vector<uint8_t> buffer;
+
+  public:
+    PooledBuffer() = default;
+
+    PooledBuffer(BufferPoolPtr pool_) :
+      pool(std::move(pool_)),
+      buffer(pool->acquire())
+    {}
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    PooledBuffer(PooledBuffer&& other) noexcept = default;
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept
+    {
+      if (this != &other)
+      {
+        reset();
+        pool = std::move(other.pool);
+        buffer = std::move(other.buffer);
+      }
+      return *this;
+    }
+
+    ~PooledBuffer()
+    {
+      reset();
+    }
+
+    void reset()
+    {
+      if (pool != nullptr)
+      {
+        pool->release(std::move(buffer));
+        pool = nullptr;
+      }
+      buffer = {};
+    }
+
+    std::vector<uint8_t>& get()
+    {
+      return buffer;
+    }
+
+    [[nodiscard]] std::span<const uint8_t> span() const
+    {
+      return buffer;
+    }
+  };
+}
@@ -0,0 +1,537 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/ds/hash.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ccf::ds
+{
+  /**
+   * A bounded cache which may be read and written from many threads.
+   *
+   * Entries are spread across shards by the hash of their key. Lookups take no
+   * lock: each shard publishes an immutable snapshot of its index, and a hit
+   * only bumps a counter on the entry. Inserts take the lock of a single shard,
+   * copy that shard's index, and wait for readers of the previous snapshot to
+   * finish before freeing it. This suits caches where a miss is rare and much
+   * more expensive than that copy (eg - parsing a key or certificate, or
+   * constructing an interpreter).
+   *
+   * Eviction follows S3-FIFO (Yang et al., SOSP '23). New entries go to a small
+   * probationary FIFO, and are only moved to the main FIFO if they are read
+   * again before reaching its tail. Keys evicted from the probationary FIFO
+   * are remembered in a ghost FIFO, and go straight to the main FIFO if they
+   * are inserted again. A scan of keys which are each read once does not
+   * displace frequently read entries, as it would in an LRU.
+   *
+   * find() returns a copy of the cached value, so V should be cheap to copy
+   * (eg - a shared_ptr, or a small struct). Values are never modified in
+   * place.
+   */
+  template <typename K, typename V, typename Hash = std::hash<K>>
+  class ConcurrentCache
+  {
+  public:
+    struct Stats
+    {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t insertions = 0;
+      size_t evictions = 0;
+    };
+
+  private:
+    static constexpr size_t CACHELINE_SIZE = 64;
+    static constexpr size_t MAX_SHARDS = 16;
+    static constexpr size_t MIN_ENTRIES_PER_SHARD = 16;
+    static constexpr uint8_t MAX_FREQ = 3;
+
+    struct Entry
+    {
+      const size_t hash;
+      const K key;
+      const V value;
+
+      // Saturating count of reads, written without synchronisation by readers
+      std::atomic<uint8_t> freq = 0;
+
+      // The remaining fields are only accessed with the shard lock held. An
+      // entry is marked as removed once it is no longer indexed, so that it
+      // can be skipped when reached in a FIFO
+      bool in_main = false;
+      bool removed = false;
+
+      Entry(size_t h, const K& k, V&& v) : hash(h), key(k), value(std::move(v))
+      {}
+    };
+    // Entries are owned by the FIFO they are in
+    using EntryPtr = std::unique_ptr<Entry>;
+
+    // Sorted by hash, so that copying an index copies no keys or values
+    struct Indexed
+    {
+      size_t hash;
+      Entry* entry;
+    };
+    using Index = std::vector<Indexed>;
+
+    template <typename I>
+    static auto lower_bound(I& index, size_t h)
+    {
+      return std::lower_bound(
+        index.begin(), index.end(), h, [](const Indexed& e, size_t hash) {
+          return e.hash < hash;
+        });
+    }
+
+    static Entry* lookup(const Index& index, size_t h, const K& k)
+    {
+      for (auto it = lower_bound(index, h); it != index.end() && it->hash == h;
+           ++it)
+      {
+        if (it->entry->key == k)
+        {
+          return it->entry;
+        }
+      }
+      return nullptr;
+    }
+
+    static void unindex(Index& index, const Entry* entry)
+    {
+      auto it = lower_bound(index, entry->hash);
+      while (it->entry != entry)
+      {
+        ++it;
+      }
+      index.erase(it);
+    }
+
+    struct alignas(CACHELINE_SIZE) Shard
+    {
+      // Replaced (with lock held) rather than modified. Readers register in
+      // the current epoch before loading index, so a replaced index, and any
+      // entries evicted from it, can be freed once the epoch is advanced and
+      // its readers have drained.
+      std::atomic<const Index*> index = new Index();
+      std::atomic<size_t> epoch = 0;
+      std::array<std::atomic<size_t>, 2> readers = {};
+
+      // Only accessed with lock held
+      std::mutex lock;
+      size_t capacity = 0;
+      std::deque<EntryPtr> small;
+      size_t small_size = 0;
+      std::deque<EntryPtr> main;
+      size_t main_size = 0;
+      // Hashes of keys recently evicted from small, each with a unique id
+      // so that only its newest occurrence is removed from ghost_ids
+      std::deque<std::pair<size_t, uint64_t>> ghost;
+      std::unordered_map<size_t, uint64_t> ghost_ids;
+      uint64_t next_ghost_id = 0;
+
+      std::atomic<size_t> hits = 0;
+      std::atomic<size_t> misses = 0;
+      std::atomic<size_t> insertions = 0;
+      std::atomic<size_t> evictions = 0;
+
+      ~Shard()
+      {
+        delete index.load();
+      }
+    };
+
+    // Holds a reader's registration in a shard's epoch, during which the
+    // shard's current index will not be freed
+    class ReadGuard
+    {
+      std::atomic<size_t>& readers;
+
+      static std::atomic<size_t>& enter(Shard& shard)
+      {
+        while (true)
+        {
+          const auto e = shard.epoch.load();
+          auto& r = shard.readers[e % 2];
+          r.fetch_add(1);
+          // If a writer advanced the epoch meanwhile, it may not have seen
+          // this registration, so retry in the new epoch
+          if (shard.epoch.load() == e)
+          {
+            return r;
+          }
+          r.fetch_sub(1);
+        }
+      }
+
+    public:
+      const Index& index;
+
+      ReadGuard(Shard& shard) :
+        readers(enter(shard)),
+        index(*shard.index.load(std::memory_order_acquire))
+      {}
+
+      ~ReadGuard()
+      {
+        readers.fetch_sub(1, std::memory_order_release);
+      }
+
+      ReadGuard(const ReadGuard&) = delete;
+      ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    // Entries which are no longer indexed, but may still be seen by readers
+    // of the previous index
+    using Retired = std::vector<EntryPtr>;
+
+    // Must be called with shard.lock held. Returns once no reader can see the
+    // previous index, or the retired entries.
+    static void publish(Shard& shard, std::unique_ptr<Index> next)
+    {
+      std::unique_ptr<const Index> prev(shard.index.exchange(next.release()));
+
+      // Readers which may hold prev registered in the epoch being closed
+      const auto e = shard.epoch.fetch_add(1);
+      while (shard.readers[e % 2].load() != 0)
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    const size_t shard_count;
+    std::unique_ptr<Shard[]> shards;
+    std::atomic<size_t> max_size;
+
+    static size_t default_shard_count(size_t max_size)
+    {
+      return std::bit_floor(
+        std::clamp<size_t>(max_size / MIN_ENTRIES_PER_SHARD, 1, MAX_SHARDS));
+    }
+
+    Shard& shard_for(size_t h) const
+    {
+      // Fibonacci hashing, so that weak hashes (eg - identity on integers)
+      // still spread across shards
+      const uint64_t mixed = h * 0x9E3779B97F4A7C15ull;
+      return shards[(mixed >> 32) & (shard_count - 1)];
+    }
+
+    // Must be called with shard.lock held
+    void set_capacity(Shard& shard, size_t i, size_t total)
+    {
+      shard.capacity = total / shard_count + (i < total % shard_count ? 1 : 0);
+    }
+
+    // Must be called with shard.lock held
+    bool take_ghost(Shard& shard, size_t h)
+    {
+      return shard.ghost_ids.erase(h) != 0;
+    }
+
+    // Must be called with shard.lock held
+    void add_ghost(Shard& shard, size_t h)
+    {
+      const auto id = shard.next_ghost_id++;
+      shard.ghost_ids.insert_or_assign(h, id);
+      shard.ghost.emplace_back(h, id);
+
+      // Remember as many evicted keys as there are entries in the cache
+      while (shard.ghost.size() > shard.capacity)
+      {
+        const auto& [oldest, oldest_id] = shard.ghost.front();
+        const auto it = shard.ghost_ids.find(oldest);
+        if (it != shard.ghost_ids.end() && it->second == oldest_id)
+        {
+          shard.ghost_ids.erase(it);
+        }
+        shard.ghost.pop_front();
+      }
+    }
+
+    // Must be called with shard.lock held
+    void evict_entry(
+      Shard& shard, Index& index, EntryPtr&& entry, Retired& retired)
+    {
+      entry->removed = true;
+      unindex(index, entry.get());
+      retired.push_back(std::move(entry));
+      shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Must be called with shard.lock held
+    void evict(Shard& shard, Index& index, Retired& retired)
+    {
+      const size_t small_capacity = std::max<size_t>(shard.capacity / 10, 1);
+      while (shard.small_size + shard.main_size > shard.capacity)
+      {
+        if (shard.small_size >= small_capacity || shard.main_size == 0)
+        {
+          auto entry = std::move(shard.small.front());
+          shard.small.pop_front();
+          if (entry->removed)
+          {
+            retired.push_back(std::move(entry));
+            continue;
+          }
+          --shard.small_size;
+
+          if (entry->freq.load(std::memory_order_relaxed) > 0)
+          {
+            // Read while on probation - keep it
+            entry->freq.store(0, std::memory_order_relaxed);
+            entry->in_main = true;
+            shard.main.push_back(std::move(entry));
+            ++shard.main_size;
+          }
+          else
+          {
+            add_ghost(shard, entry->hash);
+            evict_entry(shard, index, std::move(entry), retired);
+          }
+        }
+        else
+        {
+          auto entry = std::move(shard.main.front());
+          shard.main.pop_front();
+          if (entry->removed)
+          {
+            retired.push_back(std::move(entry));
+            continue;
+          }
+
+          const auto freq = entry->freq.load(std::memory_order_relaxed);
+          if (freq > 0)
+          {
+            // Read since it last reached the tail - give it another lap
+            entry->freq.store(freq - 1, std::memory_order_relaxed);
+            shard.main.push_back(std::move(entry));
+          }
+          else
+          {
+            --shard.main_size;
+            evict_entry(shard, index, std::move(entry), retired);
+          }
+        }
+      }
+    }
+
+  public:
+    ConcurrentCache(size_t max_size_) :
+      ConcurrentCache(max_size_, default_shard_count(max_size_))
+    {}
+
+    // shard_count_ is rounded up to a power of 2
+    ConcurrentCache(size_t max_size_, size_t shard_count_) :
+      shard_count(std::bit_ceil(std::max<size_t>(shard_count_, 1))),
+      shards(std::make_unique<Shard[]>(shard_count)),
+      max_size(max_size_)
+    {
+      for (size_t i = 0; i < shard_count; ++i)
+      {
+        set_capacity(shards[i], i, max_size_);
+      }
+    }
+
+    // Returns the cached value for k, if there is one. This counts as an
+    // access for the purposes of eviction.
+    std::optional<V> find(const K& k) const
+    {
+      const auto h = Hash{}(k);
+      auto& shard = shard_for(h);
+      ReadGuard guard(shard);
+      auto* entry = lookup(guard.index, h, k);
+      if (entry == nullptr)
+      {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+
+      const auto f = entry->freq.load(std::memory_order_relaxed);
+      if (f < MAX_FREQ)
+      {
+        // Racing readers may lose increments, which is harmless
+        entry->freq.store(f + 1, std::memory_order_relaxed);
+      }
+      shard.hits.fetch_add(1, std::memory_order_relaxed);
+      return entry->value;
+    }
+
+    // Does not count as an access, or towards the hit and miss counts
+    [[nodiscard]] bool contains(const K& k) const
+    {
+      const auto h = Hash{}(k);
+      ReadGuard guard(shard_for(h));
+      return lookup(guard.index, h, k) != nullptr;
+    }
+
+    // Inserts v at k, unless there is already a value at k. Returns the value
+    // now at k, which is v unless another thread inserted first.
+    V insert(const K& k, V v)
+    {
+      const auto h = Hash{}(k);
+      auto& shard = shard_for(h);
+      Retired retired;
+      std::lock_guard<std::mutex> guard(shard.lock);
+
+      const auto& current = *shard.index.load(std::memory_order_relaxed);
+      const auto* existing = lookup(current, h, k);
+      if (existing != nullptr)
+      {
+        return existing->value;
+      }
+
+      auto entry = std::make_unique<Entry>(h, k, std::move(v));
+      V result = entry->value;
+
+      auto next = std::make_unique<Index>();
+      next->reserve(current.size() + 1);
+      const auto pos = lower_bound(current, h);
+      next->insert(next->end(), current.begin(), pos);
+      next->push_back({h, entry.get()});
+      next->insert(next->end(), pos, current.end());
+
+      if (take_ghost(shard, h))
+      {
+        entry->in_main = true;
+        shard.main.push_back(std::move(entry));
+        ++shard.main_size;
+      }
+      else
+      {
+        shard.small.push_back(std::move(entry));
+        ++shard.small_size;
+      }
+
+      evict(shard, *next, retired);
+      publish(shard, std::move(next));
+      shard.insertions.fetch_add(1, std::memory_order_relaxed);
+
+      return result;
+    }
+
+    // Returns the cached value for k, or inserts and returns the result of
+    // calling make(). make() is called without holding any lock, so may be
+    // called by several threads which miss on the same key at once, in which
+    // case the first result to be inserted is returned to all of them.
+    template <typename F>
+    V get_or_insert(const K& k, F&& make)
+    {
+      auto v = find(k);
+      if (v.has_value())
+      {
+        return std::move(v.value());
+      }
+
+      return insert(k, make());
+    }
+
+    void erase(const K& k)
+    {
+      const auto h = Hash{}(k);
+      auto& shard = shard_for(h);
+      std::lock_guard<std::mutex> guard(shard.lock);
+
+      const auto& current = *shard.index.load(std::memory_order_relaxed);
+      auto* entry = lookup(current, h, k);
+      if (entry == nullptr)
+      {
+        return;
+      }
+
+      // Entry stays in its FIFO until reached, but no longer counts towards
+      // its size
+      entry->removed = true;
+      --(entry->in_main ? shard.main_size : shard.small_size);
+
+      auto next = std::make_unique<Index>(current);
+      unindex(*next, entry);
+      publish(shard, std::move(next));
+    }
+
+    void clear()
+    {
+      for (size_t i = 0; i < shard_count; ++i)
+      {
+        auto& shard = shards[i];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        publish(shard, std::make_unique<Index>());
+        shard.small.clear();
+        shard.small_size = 0;
+        shard.main.clear();
+        shard.main_size = 0;
+        shard.ghost.clear();
+        shard.ghost_ids.clear();
+      }
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+      size_t n = 0;
+      for (size_t i = 0; i < shard_count; ++i)
+      {
+        ReadGuard guard(shards[i]);
+        n += guard.index.size();
+      }
+      return n;
+    }
+
+    void set_max_size(size_t ms)
+    {
+      if (max_size.exchange(ms) == ms)
+      {
+        return;
+      }
+
+      for (size_t i = 0; i < shard_count; ++i)
+      {
+        auto& shard = shards[i];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        set_capacity(shard, i, ms);
+        if (shard.small_size + shard.main_size <= shard.capacity)
+        {
+          continue;
+        }
+
+        Retired retired;
+        auto next =
+          std::make_unique<Index>(*shard.index.load(std::memory_order_relaxed));
+        evict(shard, *next, retired);
+        publish(shard, std::move(next));
+      }
+    }
+
+    [[nodiscard]] size_t get_max_size() const
+    {
+      return max_size.load();
+    }
+
+    [[nodiscard]] Stats get_stats() const
+    {
+      Stats stats;
+      for (size_t i = 0; i < shard_count; ++i)
+      {
+        const auto& shard = shards[i];
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.insertions += shard.insertions.load(std::memory_order_relaxed);
+        stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+      }
+      return stats;
+    }
+  };
+}
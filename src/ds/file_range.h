@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace ccf::ds
+{
+  // A range of bytes in an open file, which can be read in bounded chunks
+  // rather than held in memory. The file is shared, so that it stays readable
+  // even if it is renamed or removed after the range is constructed, but must
+  // only be read by one thread at a time.
+  struct FileRange
+  {
+    std::shared_ptr<std::istream> file;
+    size_t offset = 0;
+    size_t size = 0;
+
+    // Calls f with each successive chunk of the range, each of at most
+    // chunk_size bytes, reusing a single buffer. Returns false if the range
+    // could not be read in full.
+    template <typename F>
+    bool read_chunks(size_t chunk_size, F&& f) const
+    {
+      if (file == nullptr || chunk_size == 0)
+      {
+        return size == 0;
+      }
+
+      std::vector<uint8_t> chunk(std::min(chunk_size, size));
+      file->clear();
+      file->seekg(static_cast<std::streamoff>(offset));
+
+      size_t remaining = size;
+      while (remaining > 0)
+      {
+        const auto n = std::min(remaining, chunk.size());
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        file->read(reinterpret_cast<char*>(chunk.data()), n);
+        if (static_cast<size_t>(file->gcount()) != n)
+        {
+          return false;
+        }
+
+        f(std::span<const uint8_t>(chunk.data(), n));
+        remaining -= n;
+      }
+
+      return true;
+    }
+
+    // Reads the whole range into memory, for consumers which cannot stream it
+    [[nodiscard]] std::optional<std::vector<uint8_t>> read_all() const
+    {
+      std::vector<uint8_t> contents;
+      contents.reserve(size);
+      if (!read_chunks(size, [&contents](std::span<const uint8_t> chunk) {
+            contents.insert(contents.end(), chunk.begin(), chunk.end());
+          }))
+      {
+        return std::nullopt;
+      }
+      return contents;
+    }
+  };
+}
@@ -361,10 +361,17 @@ namespace oversized
 
     const WriterConfig config;
 
+    // If set, shared with the factory on the other end of the circuit
+    ringbuffer::BufferHandoffPtr buffer_handoff;
+
   public:
-    WriterFactory(AbstractWriterFactory& impl, const WriterConfig& config_) :
+    WriterFactory(
+      AbstractWriterFactory& impl,
+      const WriterConfig& config_,
+      ringbuffer::BufferHandoffPtr buffer_handoff_ = nullptr) :
       factory_impl(impl),
-      config(config_)
+      config(config_),
+      buffer_handoff(std::move(buffer_handoff_))
     {}
 
     std::shared_ptr<oversized::Writer> create_oversized_writer_to_outside()
@@ -394,5 +401,10 @@ namespace oversized
     {
       return create_oversized_writer_to_inside();
     }
+
+    ringbuffer::BufferHandoffPtr get_buffer_handoff() override
+    {
+      return buffer_handoff;
+    }
   };
 }
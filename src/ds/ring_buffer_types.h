@@ -4,6 +4,7 @@
 
 #include "ccf/ds/hash.h"
 #include "ccf/ds/nonstd.h"
+#include "buffer_handoff.h"
 #include "serializer.h"
 
 #include <atomic>
@@ -160,6 +161,14 @@ namespace ringbuffer
 
     virtual WriterPtr create_writer_to_outside() = 0;
     virtual WriterPtr create_writer_to_inside() = 0;
+
+    /// Returns the in-process side channel for bulk payloads shared by both
+    /// ends of this circuit, or nullptr if bulk payloads should be written to
+    /// the ring like any other message.
+    virtual BufferHandoffPtr get_buffer_handoff()
+    {
+      return nullptr;
+    }
   };
 
   /// Useful machinery
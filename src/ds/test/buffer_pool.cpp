@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "../buffer_pool.h"
+
+#include <doctest/doctest.h>
+
+TEST_CASE("BufferPool" * doctest::test_suite("buffer_pool"))
+{
+  constexpr auto max_pooled = 2;
+  constexpr auto max_capacity = 64;
+  auto pool = std::make_shared<ccf::ds::BufferPool>(max_pooled, max_capacity);
+
+  REQUIRE(pool->size() == 0);
+
+  {
+    INFO("Released buffers are reused, cleared but with their capacity");
+    {
+      ccf::ds::PooledBuffer buffer(pool);
+      buffer.get().assign(32, 'a');
+    }
+    REQUIRE(pool->size() == 1);
+
+    ccf::ds::PooledBuffer buffer(pool);
+    REQUIRE(pool->size() == 0);
+    REQUIRE(buffer.get().empty());
+    REQUIRE(buffer.get().capacity() >= 32);
+  }
+  REQUIRE(pool->size() == 1);
+
+  {
+    INFO("Oversized buffers are not returned to the pool");
+    {
+      ccf::ds::PooledBuffer buffer(pool);
+      buffer.get().assign(max_capacity + 1, 'b');
+    }
+    REQUIRE(pool->size() == 0);
+  }
+
+  {
+    INFO("Pool size is bounded");
+    {
+      ccf::ds::PooledBuffer a(pool);
+      ccf::ds::PooledBuffer b(pool);
+      ccf::ds::PooledBuffer c(pool);
+      a.get().push_back(1);
+      b.get().push_back(2);
+      c.get().push_back(3);
+    }
+    REQUIRE(pool->size() == max_pooled);
+  }
+
+  {
+    INFO("Moved-from buffers do not return to the pool twice");
+    const auto before = pool->size();
+    {
+      ccf::ds::PooledBuffer a(pool);
+      a.get().push_back(1);
+      ccf::ds::PooledBuffer b(std::move(a));
+    }
+    REQUIRE(pool->size() == before);
+  }
+}
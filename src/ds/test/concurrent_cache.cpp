@@ -0,0 +1,254 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "../concurrent_cache.h"
+
+#include "../lru.h"
+
+#include <doctest/doctest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Cache = ccf::ds::ConcurrentCache<size_t, std::string>;
+
+TEST_CASE("ConcurrentCache basic operations" * doctest::test_suite("cache"))
+{
+  Cache cache(10);
+  REQUIRE(cache.size() == 0);
+  REQUIRE_FALSE(cache.find(1).has_value());
+
+  REQUIRE(cache.insert(1, "a") == "a");
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.contains(1));
+  REQUIRE(cache.find(1) == "a");
+
+  {
+    INFO("Inserting at an existing key keeps the existing value");
+    REQUIRE(cache.insert(1, "b") == "a");
+    REQUIRE(cache.find(1) == "a");
+    REQUIRE(cache.size() == 1);
+  }
+
+  {
+    INFO("get_or_insert only constructs on a miss");
+    size_t calls = 0;
+    auto make = [&calls]() {
+      ++calls;
+      return std::string("c");
+    };
+    REQUIRE(cache.get_or_insert(2, make) == "c");
+    REQUIRE(cache.get_or_insert(2, make) == "c");
+    REQUIRE(calls == 1);
+  }
+
+  {
+    INFO("Erased keys can be reinserted");
+    cache.erase(1);
+    REQUIRE_FALSE(cache.contains(1));
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.insert(1, "d") == "d");
+    REQUIRE(cache.find(1) == "d");
+  }
+
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+  REQUIRE_FALSE(cache.contains(1));
+  REQUIRE_FALSE(cache.contains(2));
+
+  const auto stats = cache.get_stats();
+  REQUIRE(stats.insertions == 3);
+  REQUIRE(stats.evictions == 0);
+}
+
+struct CollidingHash
+{
+  size_t operator()(size_t k) const
+  {
+    return k % 3;
+  }
+};
+
+TEST_CASE("ConcurrentCache hash collisions" * doctest::test_suite("cache"))
+{
+  constexpr size_t max_size = 20;
+  ccf::ds::ConcurrentCache<size_t, std::string, CollidingHash> cache(max_size);
+
+  for (size_t i = 0; i < max_size; ++i)
+  {
+    cache.insert(i, std::to_string(i));
+  }
+  for (size_t i = 0; i < max_size; ++i)
+  {
+    REQUIRE(cache.find(i) == std::to_string(i));
+  }
+
+  cache.erase(3);
+  REQUIRE_FALSE(cache.contains(3));
+  REQUIRE(cache.contains(0));
+  REQUIRE(cache.contains(6));
+
+  for (size_t i = max_size; i < 5 * max_size; ++i)
+  {
+    REQUIRE(cache.insert(i, std::to_string(i)) == std::to_string(i));
+    REQUIRE(cache.find(i) == std::to_string(i));
+  }
+  REQUIRE(cache.size() == max_size);
+}
+
+TEST_CASE("ConcurrentCache is bounded" * doctest::test_suite("cache"))
+{
+  constexpr size_t max_size = 100;
+  Cache cache(max_size);
+
+  for (size_t i = 0; i < 10 * max_size; ++i)
+  {
+    cache.insert(i, std::to_string(i));
+    REQUIRE(cache.size() <= max_size);
+  }
+  REQUIRE(cache.size() == max_size);
+
+  const auto stats = cache.get_stats();
+  REQUIRE(stats.insertions == 10 * max_size);
+  REQUIRE(stats.evictions == stats.insertions - cache.size());
+
+  {
+    INFO("Shrinking the cache evicts entries");
+    cache.set_max_size(10);
+    REQUIRE(cache.get_max_size() == 10);
+    REQUIRE(cache.size() <= 10);
+  }
+
+  {
+    INFO("A cache with no capacity stores nothing");
+    cache.set_max_size(0);
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.insert(1, "a") == "a");
+    REQUIRE_FALSE(cache.contains(1));
+  }
+}
+
+TEST_CASE("ConcurrentCache is scan resistant" * doctest::test_suite("cache"))
+{
+  constexpr size_t max_size = 100;
+  constexpr size_t hot_keys = max_size / 2;
+  Cache cache(max_size);
+
+  // Frequently read keys
+  for (size_t i = 0; i < hot_keys; ++i)
+  {
+    cache.insert(i, std::to_string(i));
+  }
+
+  for (size_t round = 0; round < 3; ++round)
+  {
+    for (size_t i = 0; i < hot_keys; ++i)
+    {
+      REQUIRE(cache.find(i).has_value());
+    }
+
+    // A scan of many keys, each read once, does not displace them
+    for (size_t i = 0; i < 10 * max_size; ++i)
+    {
+      const auto key = (round + 1) * 1000000 + i;
+      cache.get_or_insert(key, [key]() { return std::to_string(key); });
+    }
+
+    for (size_t i = 0; i < hot_keys; ++i)
+    {
+      REQUIRE(cache.contains(i));
+    }
+  }
+}
+
+TEST_CASE(
+  "ConcurrentCache round-robin over more keys than fit" *
+  doctest::test_suite("cache"))
+{
+  // Under strict LRU, a round-robin over more keys than fit never hits. Here
+  // a key evicted soon after insertion is remembered, and is kept for longer
+  // when it is next inserted, so later rounds find it.
+  constexpr size_t max_size = 2;
+  constexpr size_t key_count = 3;
+  constexpr size_t rounds = 10;
+  Cache cache(max_size);
+
+  size_t hits = 0;
+  for (size_t round = 0; round < rounds; ++round)
+  {
+    for (size_t key = 0; key < key_count; ++key)
+    {
+      bool hit = true;
+      cache.get_or_insert(key, [&hit, key]() {
+        hit = false;
+        return std::to_string(key);
+      });
+      if (hit)
+      {
+        ++hits;
+      }
+      REQUIRE(cache.size() <= max_size);
+    }
+  }
+
+  const auto stats = cache.get_stats();
+  REQUIRE(stats.hits == hits);
+  REQUIRE(stats.misses == rounds * key_count - hits);
+  REQUIRE(hits > 0);
+
+  {
+    INFO("Whereas an LRU never hits");
+    LRU<size_t, std::string> lru(max_size);
+    for (size_t round = 0; round < rounds; ++round)
+    {
+      for (size_t key = 0; key < key_count; ++key)
+      {
+        REQUIRE_FALSE(lru.contains(key));
+        lru.insert(key, std::to_string(key));
+      }
+    }
+  }
+}
+
+TEST_CASE("ConcurrentCache concurrent access" * doctest::test_suite("cache"))
+{
+  constexpr size_t max_size = 256;
+  constexpr size_t key_space = 1024;
+  constexpr size_t thread_count = 8;
+  constexpr size_t lookups_per_thread = 20000;
+  Cache cache(max_size);
+
+  std::vector<std::thread> threads;
+  std::atomic<size_t> wrong_values = 0;
+  for (size_t t = 0; t < thread_count; ++t)
+  {
+    threads.emplace_back([&, t]() {
+      size_t key = t;
+      for (size_t i = 0; i < lookups_per_thread; ++i)
+      {
+        // Skewed towards low keys, so that some are hot
+        key = (key * 2654435761u + i) % key_space;
+        const auto k = (i % 2 == 0) ? key % (max_size / 4) : key;
+        const auto v =
+          cache.get_or_insert(k, [k]() { return std::to_string(k); });
+        if (v != std::to_string(k))
+        {
+          ++wrong_values;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  REQUIRE(wrong_values == 0);
+  REQUIRE(cache.size() <= max_size);
+
+  const auto stats = cache.get_stats();
+  REQUIRE(stats.hits + stats.misses == thread_count * lookups_per_thread);
+  REQUIRE(stats.insertions <= stats.misses);
+  REQUIRE(stats.evictions == stats.insertions - cache.size());
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "../file_range.h"
+
+#include <doctest/doctest.h>
+#include <sstream>
+#include <string>
+
+TEST_CASE("FileRange" * doctest::test_suite("file_range"))
+{
+  std::string contents(100'000, '\0');
+  for (size_t i = 0; i < contents.size(); ++i)
+  {
+    contents[i] = static_cast<char>(i % 251);
+  }
+  const auto file = std::make_shared<std::stringstream>(contents);
+
+  const ccf::ds::FileRange range{file, 10, 70'000};
+  const std::vector<uint8_t> expected(
+    contents.begin() + range.offset,
+    contents.begin() + range.offset + range.size);
+
+  {
+    INFO("A range is read in bounded chunks");
+    constexpr size_t chunk_size = 32'768;
+    std::vector<uint8_t> read;
+    size_t chunks = 0;
+    REQUIRE(range.read_chunks(chunk_size, [&](std::span<const uint8_t> chunk) {
+      REQUIRE(chunk.size() <= chunk_size);
+      read.insert(read.end(), chunk.begin(), chunk.end());
+      ++chunks;
+    }));
+    REQUIRE(chunks == 3);
+    REQUIRE(read == expected);
+  }
+
+  {
+    INFO("A range can be read repeatedly, or in full");
+    REQUIRE(range.read_all() == expected);
+    REQUIRE(range.read_all() == expected);
+  }
+
+  {
+    INFO("An empty range reads nothing");
+    const ccf::ds::FileRange empty{file, 10, 0};
+    REQUIRE(empty.read_all() == std::vector<uint8_t>{});
+  }
+
+  {
+    INFO("A range beyond the end of the file cannot be read");
+    const ccf::ds::FileRange past_end{file, 90'000, 20'000};
+    REQUIRE_FALSE(past_end.read_all().has_value());
+
+    INFO("The file is still readable afterwards");
+    REQUIRE(range.read_all() == expected);
+  }
+}
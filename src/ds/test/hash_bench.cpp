@@ -3,6 +3,7 @@
 
 #include "ccf/byte_vector.h"
 #include "ccf/ds/hash.h"
+#include "crypto/sha256_multibuffer.h"
 
 #define PICOBENCH_IMPLEMENT_WITH_MAIN
 #include <picobench/picobench.hpp>
@@ -36,3 +37,57 @@ auto hash_small_vec_16 = hash<llvm_vecsmall::SmallVector<uint8_t, 16>>;
 PICOBENCH(hash_small_vec_16).iterations(hash_sizes).baseline();
 auto hash_small_vec_128 = hash<llvm_vecsmall::SmallVector<uint8_t, 128>>;
 PICOBENCH(hash_small_vec_128).iterations(hash_sizes).baseline();
+
+// SHA-256 of many independent messages, as for the nodes of a Merkle tree
+// (64 bytes) or the entries of a batch of transactions
+template <size_t NBytes, ccf::crypto::Sha256Kernel Kernel>
+static void sha256_many(picobench::state& s)
+{
+  if (!ccf::crypto::is_sha256_kernel_supported(Kernel))
+  {
+    return;
+  }
+
+  std::vector<std::vector<uint8_t>> messages(s.iterations());
+  for (auto& m : messages)
+  {
+    m.resize(NBytes);
+    for (auto& b : m)
+    {
+      b = rand();
+    }
+  }
+  std::vector<std::span<const uint8_t>> spans(
+    messages.begin(), messages.end());
+  std::vector<ccf::crypto::Sha256Hash> digests(spans.size());
+
+  s.start_timer();
+  for (size_t i = 0; i < 10; ++i)
+  {
+    ccf::crypto::sha256_many(spans, digests, Kernel);
+  }
+  s.stop_timer();
+}
+
+using ccf::crypto::Sha256Kernel;
+const std::vector<int> message_counts = {16, 1024};
+
+PICOBENCH_SUITE("sha256_many 64 bytes");
+auto sha256_64_openssl = sha256_many<64, Sha256Kernel::OpenSSL>;
+PICOBENCH(sha256_64_openssl).iterations(message_counts).baseline();
+auto sha256_64_simd4 = sha256_many<64, Sha256Kernel::Simd4>;
+PICOBENCH(sha256_64_simd4).iterations(message_counts);
+auto sha256_64_avx2 = sha256_many<64, Sha256Kernel::Avx2>;
+PICOBENCH(sha256_64_avx2).iterations(message_counts);
+auto sha256_64_avx512 = sha256_many<64, Sha256Kernel::Avx512>;
+PICOBENCH(sha256_64_avx512).iterations(message_counts);
+
+PICOBENCH_SUITE("sha256_many 1024 bytes");
+auto sha256_1k_openssl = sha256_many<1024, Sha256Kernel::OpenSSL>;
+PICOBENCH(sha256_1k_openssl).iterations(message_counts).baseline();
+auto sha256_1k_simd4 = sha256_many<1024, Sha256Kernel::Simd4>;
+PICOBENCH(sha256_1k_simd4).iterations(message_counts);
+auto sha256_1k_avx2 = sha256_many<1024, Sha256Kernel::Avx2>;
+PICOBENCH(sha256_1k_avx2).iterations(message_counts);
+auto sha256_1k_avx512 = sha256_many<1024, Sha256Kernel::Avx512>;
+PICOBENCH(sha256_1k_avx512).iterations(message_counts);
@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define PICOBENCH_IMPLEMENT_WITH_MAIN
+#define PICOBENCH_DONT_BIND_TO_ONE_CORE
+#include "../concurrent_cache.h"
+#include "../lru.h"
+
+#include <mutex>
+#include <picobench/picobench.hpp>
+#include <thread>
+#include <vector>
+
+using K = std::vector<uint8_t>;
+using V = std::shared_ptr<std::string>;
+
+// Similar in size to the DER-encoded keys used by the authentication caches
+static constexpr size_t key_size = 300;
+static constexpr size_t cache_size = 1000;
+
+static K make_key(size_t i)
+{
+  K k(key_size, 0x30);
+  for (size_t j = 0; j < sizeof(i); ++j)
+  {
+    k[k.size() - 1 - j] = (i >> (8 * j)) & 0xff;
+  }
+  return k;
+}
+
+static std::vector<K> make_keys(size_t n, size_t offset = 0)
+{
+  std::vector<K> keys;
+  keys.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    keys.push_back(make_key(offset + i));
+  }
+  return keys;
+}
+
+// LRU, wrapped in a single mutex as it was by its users
+class LockedLRU
+{
+  std::mutex lock;
+  LRU<K, V> lru;
+
+public:
+  size_t created = 0;
+
+  LockedLRU(size_t max_size) : lru(max_size) {}
+
+  V get_or_insert(const K& k)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = lru.find(k);
+    if (it == lru.end())
+    {
+      ++created;
+      it = lru.insert(k, std::make_shared<std::string>("value"));
+    }
+    else
+    {
+      lru.promote(it);
+    }
+    return it->second;
+  }
+};
+
+class Concurrent
+{
+  ccf::ds::ConcurrentCache<K, V> cache;
+
+public:
+  std::atomic<size_t> created = 0;
+
+  Concurrent(size_t max_size) : cache(max_size) {}
+
+  V get_or_insert(const K& k)
+  {
+    return cache.get_or_insert(k, [this]() {
+      ++created;
+      return std::make_shared<std::string>("value");
+    });
+  }
+};
+
+// Each thread repeatedly reads keys which all fit in the cache
+template <typename Cache, size_t Threads>
+static void bench_hits(picobench::state& s)
+{
+  Cache cache(cache_size);
+  const auto keys = make_keys(cache_size / 2);
+  for (const auto& k : keys)
+  {
+    cache.get_or_insert(k);
+  }
+
+  const auto lookups_per_thread = s.iterations() / Threads;
+
+  s.start_timer();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < Threads; ++t)
+  {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < lookups_per_thread; ++i)
+      {
+        cache.get_or_insert(keys[(i * 7 + t) % keys.size()]);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  s.stop_timer();
+}
+
+// Hot keys are interleaved with a scan of keys which are each read once. The
+// result is the number of hot key lookups which missed.
+template <typename Cache>
+static void bench_scan(picobench::state& s)
+{
+  Cache cache(cache_size);
+  const auto hot = make_keys(cache_size / 2);
+  const auto scan = make_keys(s.iterations(), cache_size);
+
+  size_t hot_misses = 0;
+  for (const auto& k : hot)
+  {
+    cache.get_or_insert(k);
+  }
+
+  s.start_timer();
+  for (size_t i = 0; i < scan.size(); ++i)
+  {
+    cache.get_or_insert(scan[i]);
+    if (i % 4 == 0)
+    {
+      const size_t created = cache.created;
+      cache.get_or_insert(hot[(i / 4) % hot.size()]);
+      hot_misses += cache.created - created;
+    }
+  }
+  s.stop_timer();
+
+  s.set_result(hot_misses);
+}
+
+const std::vector<int> lookup_counts = {100000, 1000000};
+
+PICOBENCH_SUITE("hits (1 thread)");
+auto lru_hits_1 = bench_hits<LockedLRU, 1>;
+PICOBENCH(lru_hits_1).iterations(lookup_counts).baseline();
+auto concurrent_hits_1 = bench_hits<Concurrent, 1>;
+PICOBENCH(concurrent_hits_1).iterations(lookup_counts);
+
+PICOBENCH_SUITE("hits (8 threads)");
+auto lru_hits_8 = bench_hits<LockedLRU, 8>;
+PICOBENCH(lru_hits_8).iterations(lookup_counts).baseline();
+auto concurrent_hits_8 = bench_hits<Concurrent, 8>;
+PICOBENCH(concurrent_hits_8).iterations(lookup_counts);
+
+const std::vector<int> scan_counts = {10000, 100000};
+
+PICOBENCH_SUITE("scan");
+auto lru_scan = bench_scan<LockedLRU>;
+PICOBENCH(lru_scan).iterations(scan_counts).baseline();
+auto concurrent_scan = bench_scan<Concurrent>;
+PICOBENCH(concurrent_scan).iterations(scan_counts);
@@ -2,6 +2,7 @@
 // Licensed under the Apache 2.0 License.
 #include "../ring_buffer.h"
 
+#include "../buffer_handoff.h"
 #include "../serialized.h"
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
@@ -815,3 +816,77 @@ TEST_CASE("Malicious writer" * doctest::test_suite("ringbuffer"))
     }
   }
 }
+
+TEST_CASE("Buffer handoff" * doctest::test_suite("ringbuffer"))
+{
+  constexpr size_t size = 64;
+  auto buffer = std::make_unique<ringbuffer::TestBuffer>(size);
+  Reader r(buffer->bd);
+  Writer w(r);
+
+  BufferHandoff handoff(0);
+  auto make_parts = [](uint8_t n) {
+    return SharedBuffers{
+      std::make_shared<std::vector<uint8_t>>(1, n),
+      std::make_shared<std::vector<uint8_t>>(2, n)};
+  };
+  auto write_handle = [&w](BufferHandoff::Handle handle) {
+    return w.try_write(big_message, handle);
+  };
+
+  std::vector<BufferHandoff::Handle> handles;
+  auto read_handles = [&]() {
+    handles.clear();
+    // A read may stop at the end of the buffer, so read twice
+    for (size_t i = 0; i < 2; ++i)
+    {
+      r.read(-1, [&](Message m, const uint8_t* data, size_t size) {
+        REQUIRE(m == big_message);
+        handles.push_back(serialized::read<BufferHandoff::Handle>(data, size));
+      });
+    }
+  };
+
+  INFO("Parts are claimed in order, exactly once");
+  {
+    REQUIRE(handoff.send(make_parts(1), write_handle));
+    REQUIRE(handoff.pending() == 1);
+    read_handles();
+    REQUIRE(handles.size() == 1);
+    const auto parts = handoff.claim(handles[0]);
+    REQUIRE(parts.size() == 2);
+    REQUIRE(*parts[0] == std::vector<uint8_t>{1});
+    REQUIRE(*parts[1] == std::vector<uint8_t>{1, 1});
+    REQUIRE_THROWS_AS(handoff.claim(handles[0]), std::logic_error);
+    REQUIRE(handoff.pending() == 0);
+  }
+
+  INFO("Parts whose handle cannot be written are released");
+  {
+    size_t sent = 0;
+    while (handoff.send(make_parts(2), write_handle))
+    {
+      ++sent;
+    }
+    REQUIRE(sent > 0);
+    REQUIRE(handoff.pending() == sent);
+
+    REQUIRE_THROWS(handoff.send(make_parts(2), [](auto) -> bool {
+      throw std::runtime_error("Write failed");
+    }));
+    REQUIRE(handoff.pending() == sent);
+  }
+
+  INFO("Parts whose handle was dropped are reclaimed by a later claim");
+  {
+    read_handles();
+    REQUIRE(handles.size() == handoff.pending());
+
+    // Only the last handle reaches the reader
+    const auto parts = handoff.claim(handles.back());
+    REQUIRE(*parts[0] == std::vector<uint8_t>{2});
+    REQUIRE(handoff.pending() == 0);
+    REQUIRE(handoff.reclaimed_count() == handles.size() - 1);
+    REQUIRE_THROWS_AS(handoff.claim(handles.front()), std::logic_error);
+  }
+}
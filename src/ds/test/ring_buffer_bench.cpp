@@ -2,8 +2,12 @@
 // Licensed under the Apache 2.0 License.
 #define PICOBENCH_IMPLEMENT_WITH_MAIN
 #define PICOBENCH_DONT_BIND_TO_ONE_CORE
+#include "../buffer_handoff.h"
+#include "../messaging.h"
+#include "../oversized.h"
 #include "../ring_buffer.h"
 
+#include <numeric>
 #include <picobench/picobench.hpp>
 #include <thread>
 
@@ -30,6 +34,100 @@ void sleep_handler(ringbuffer::Message m, const uint8_t*, size_t)
   std::this_thread::sleep_for(t);
 }
 
+// Bulk payloads are either written through the ringbuffer (fragmented by an
+// oversized::Writer, and reassembled by the reader), or deposited in a
+// BufferHandoff with only their handle written to the ringbuffer
+enum : ringbuffer::Message
+{
+  DEFINE_RINGBUFFER_MSG_TYPE(bulk_payload),
+  DEFINE_RINGBUFFER_MSG_TYPE(bulk_payload_handle),
+};
+
+constexpr size_t BulkBufSize = 1 << 20;
+constexpr size_t BulkFragmentSize = 1 << 16;
+
+template <bool Handoff>
+static void bulk_impl(picobench::state& s, size_t message_size)
+{
+  const size_t total_messages = s.iterations();
+
+  auto buffer = std::make_unique<ringbuffer::TestBuffer>(BulkBufSize);
+  Reader r(buffer->bd);
+  auto handoff = std::make_shared<BufferHandoff>(0);
+
+  size_t reads = 0;
+
+  messaging::RingbufferDispatcher disp("bulk");
+  oversized::FragmentReconstructor fr(disp);
+  DISPATCHER_SET_MESSAGE_HANDLER(
+    disp, bulk_payload, [&reads, message_size](const uint8_t*, size_t size) {
+      if (size != message_size)
+        throw std::logic_error("Unexpected message size");
+      ++reads;
+    });
+  DISPATCHER_SET_MESSAGE_HANDLER(
+    disp, bulk_payload_handle, [&](const uint8_t* data, size_t size) {
+      auto handle = serialized::read<BufferHandoff::Handle>(data, size);
+      const auto claimed = handoff->claim(handle);
+      if (claimed.size() != 1 || claimed[0]->size() != message_size)
+        throw std::logic_error("Unexpected message size");
+      ++reads;
+    });
+
+  std::vector<uint8_t> payload(message_size);
+  std::iota(payload.begin(), payload.end(), 0);
+
+  s.start_timer();
+
+  std::thread writer_thread([&]() {
+    auto w = std::make_shared<Writer>(r);
+    oversized::Writer ow(w, BulkFragmentSize);
+    for (size_t m = 0; m < total_messages; ++m)
+    {
+      // In both cases the sender first serialises the payload into its own
+      // buffer (as ccf::Channel does), then either copies that buffer into the
+      // ringbuffer or passes ownership of it to the reader
+      auto serialised = std::make_shared<std::vector<uint8_t>>(payload);
+      if constexpr (Handoff)
+      {
+        while (!handoff->send({serialised}, [&w](auto handle) {
+          return w->try_write(bulk_payload_handle, handle);
+        }))
+        {
+          std::this_thread::yield();
+        }
+      }
+      else
+      {
+        ow.write(
+          bulk_payload,
+          serializer::ByteRange{serialised->data(), serialised->size()});
+      }
+    }
+  });
+
+  while (reads < total_messages)
+  {
+    r.read(-1, [&](ringbuffer::Message m, const uint8_t* data, size_t size) {
+      disp.dispatch(m, data, size);
+    });
+    std::this_thread::yield();
+  }
+
+  s.stop_timer();
+
+  writer_thread.join();
+
+  if (handoff->pending() != 0)
+    throw std::logic_error("Unclaimed buffers remain");
+}
+
+template <size_t MessageSize, bool Handoff>
+static void bulk(picobench::state& s)
+{
+  bulk_impl<Handoff>(s, MessageSize);
+}
+
 template <ReadHandler H>
 static void write_impl(
   picobench::state& s,
@@ -182,3 +280,30 @@ auto spin_200 = specialize<32, 1, 4, spin_pause_handler<200>>;
 FIXED_PICO(spin_200);
 auto spin_400 = specialize<32, 1, 4, spin_pause_handler<400>>;
 FIXED_PICO(spin_400);
+
+const std::vector<int> bulk_msg_counts = {16, 64, 256};
+#define BULK_PICO(NAME) PICOBENCH(NAME).iterations(bulk_msg_counts)
+
+PICOBENCH_SUITE("bulk messages through ringbuffer (1M buffer)");
+auto ring_1k = bulk<1024, false>;
+BULK_PICO(ring_1k);
+auto ring_16k = bulk<16 * 1024, false>;
+BULK_PICO(ring_16k);
+auto ring_64k = bulk<64 * 1024, false>;
+BULK_PICO(ring_64k);
+auto ring_256k = bulk<256 * 1024, false>;
+BULK_PICO(ring_256k);
+auto ring_1m = bulk<1024 * 1024, false>;
+BULK_PICO(ring_1m);
+
+PICOBENCH_SUITE("bulk messages through buffer handoff (1M buffer)");
+auto handoff_1k = bulk<1024, true>;
+BULK_PICO(handoff_1k);
+auto handoff_16k = bulk<16 * 1024, true>;
+BULK_PICO(handoff_16k);
+auto handoff_64k = bulk<64 * 1024, true>;
+BULK_PICO(handoff_64k);
+auto handoff_256k = bulk<256 * 1024, true>;
+BULK_PICO(handoff_256k);
+auto handoff_1m = bulk<1024 * 1024, true>;
+BULK_PICO(handoff_1m);
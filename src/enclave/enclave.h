@@ -35,6 +35,7 @@
 #include "node/signature_cache_subsystem.h"
 #include "rpc_map.h"
 #include "rpc_sessions.h"
+#include "tasks/task_system.h"
 #include "tasks/worker.h"
 
 namespace ccf
@@ -118,8 +119,10 @@ namespace ccf
 
       indexer = std::make_shared<ccf::indexing::Indexer>(
         std::make_shared<ccf::indexing::HistoricalTransactionFetcher>(
-          historical_state_cache));
+          historical_state_cache),
+        &ccf::tasks::get_main_job_board());
       context->install_subsystem(indexer);
+      network.tables->set_entry_observer(indexer);
 
       lfs_access = std::make_shared<ccf::indexing::EnclaveLFSAccess>(
         writer_factory->create_writer_to_outside());
@@ -149,8 +152,11 @@ namespace ccf
       context->install_subsystem(ledger_subsystem);
 
       static constexpr size_t max_interpreter_cache_size = 10;
-      auto interpreter_cache =
-        std::make_shared<ccf::js::InterpreterCache>(max_interpreter_cache_size);
+      static constexpr size_t max_prewarmed_interpreters = 4;
+      auto interpreter_cache = std::make_shared<ccf::js::InterpreterCache>(
+        max_interpreter_cache_size,
+        &ccf::tasks::get_main_job_board(),
+        max_prewarmed_interpreters);
       context->install_subsystem(interpreter_cache);
 
       context->install_subsystem(
@@ -205,6 +211,7 @@ namespace ccf
 
       historical_state_cache->set_soft_cache_limit(
         ccf_config_.historical_cache_soft_limit);
+      historical_state_cache->set_prefetch_enabled(true);
 
       auto network_identity_subsystem =
         context->get_subsystem<ccf::NetworkIdentitySubsystem>();
@@ -329,27 +336,15 @@ namespace ccf
           bp,
           ::consensus::ledger_entry_range,
           [this](const uint8_t* data, size_t size) {
-            const auto [from_seqno, to_seqno, purpose, body] =
+            auto [from_seqno, to_seqno, purpose, body] =
               ringbuffer::read_message<::consensus::ledger_entry_range>(
                 data, size);
             switch (purpose)
             {
               case ::consensus::LedgerRequestPurpose::Recovery:
               {
-                if (node->is_reading_public_ledger())
-                {
-                  node->recover_public_ledger_entries(body);
-                }
-                else if (node->is_reading_private_ledger())
-                {
-                  node->recover_private_ledger_entries(body);
-                }
-                else
-                {
-                  auto [s, _, __] = node->state();
-                  LOG_FAIL_FMT(
-                    "Cannot recover ledger entry: Unexpected node state {}", s);
-                }
+                node->recover_ledger_entries(
+                  from_seqno, to_seqno, std::move(body));
                 break;
               }
               case ::consensus::LedgerRequestPurpose::HistoricalQuery:
@@ -376,7 +371,7 @@ namespace ccf
             {
               case ::consensus::LedgerRequestPurpose::Recovery:
               {
-                node->recover_ledger_end();
+                node->recover_ledger_end(from_seqno);
                 break;
               }
               case ::consensus::LedgerRequestPurpose::HistoricalQuery:
@@ -392,6 +387,15 @@ namespace ccf
             }
           });
 
+        DISPATCHER_SET_MESSAGE_HANDLER(
+          bp,
+          ::consensus::ledger_durable,
+          [this](const uint8_t* data, size_t size) {
+            const auto [durable_idx, truncation_id] =
+              ringbuffer::read_message<::consensus::ledger_durable>(data, size);
+            node->ledger_durable(durable_idx, truncation_id);
+          });
+
         rpcsessions->register_message_handlers(bp.get_dispatcher());
 
         // Maximum number of inbound ringbuffer messages which will be
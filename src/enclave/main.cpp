@@ -57,7 +57,9 @@ namespace ccf
     auto basic_writer_factory =
       std::make_unique<ringbuffer::WriterFactory>(*circuit);
     auto writer_factory = std::make_unique<oversized::WriterFactory>(
-      *basic_writer_factory, enclave_config.writer_config);
+      *basic_writer_factory,
+      enclave_config.writer_config,
+      enclave_config.buffer_handoff);
 
     {
       num_pending_threads = (uint16_t)num_worker_threads + 1;
@@ -3,12 +3,15 @@
 #pragma once
 
 #include "ccf/node/session.h"
+#include "ds/buffer_pool.h"
+#include "ds/file_range.h"
 #include "enclave/tls_session.h"
 #include "tasks/ordered_tasks.h"
 #include "tasks/task.h"
 #include "tasks/task_system.h"
 #include "tcp/msg_types.h"
 
+#include <array>
 #include <span>
 
 namespace ccf
@@ -71,7 +74,67 @@ namespace ccf
       }
     };
 
+    struct SendVectoredDataTask : public ccf::tasks::ITaskAction
+    {
+      ccf::ds::PooledBuffer header;
+      std::vector<uint8_t> body;
+      std::shared_ptr<ThreadedSession> self;
+
+      SendVectoredDataTask(
+        ccf::ds::PooledBuffer&& h,
+        std::vector<uint8_t>&& b,
+        std::shared_ptr<ThreadedSession> s) :
+        header(std::move(h)),
+        body(std::move(b)),
+        self(std::move(s))
+      {}
+
+      void do_action() override
+      {
+        const std::array<std::span<const uint8_t>, 2> parts = {
+          header.span(), body};
+        self->send_vectored_data_thread(parts);
+      }
+
+      [[nodiscard]] const std::string& get_name() const override
+      {
+        static const std::string name =
+          "ThreadedSession::SendVectoredDataTask";
+        return name;
+      }
+    };
+
+    struct SendFileDataTask : public ccf::tasks::ITaskAction
+    {
+      ccf::ds::PooledBuffer header;
+      ccf::ds::FileRange body;
+      std::shared_ptr<ThreadedSession> self;
+
+      SendFileDataTask(
+        ccf::ds::PooledBuffer&& h,
+        ccf::ds::FileRange&& b,
+        std::shared_ptr<ThreadedSession> s) :
+        header(std::move(h)),
+        body(std::move(b)),
+        self(std::move(s))
+      {}
+
+      void do_action() override
+      {
+        self->send_file_data_thread(header.span(), body);
+      }
+
+      [[nodiscard]] const std::string& get_name() const override
+      {
+        static const std::string name = "ThreadedSession::SendFileDataTask";
+        return name;
+      }
+    };
+
   public:
+    // Maximum number of bytes of a file body which are read and sent at once
+    static constexpr size_t file_body_chunk_size = 64 * 1024;
+
     ThreadedSession(int64_t session_id)
     {
       task_scheduler = ccf::tasks::OrderedTasks::create(
@@ -106,6 +169,79 @@ namespace ccf
 
     virtual void send_data_thread(std::vector<uint8_t>&& data) = 0;
 
+    // Sends header followed by body, without first concatenating them. The
+    // header buffer is returned to its pool once it has been written.
+    void send_vectored_data(
+      ccf::ds::PooledBuffer&& header, std::vector<uint8_t>&& body)
+    {
+      task_scheduler->add_action(std::make_shared<SendVectoredDataTask>(
+        std::move(header), std::move(body), shared_from_this()));
+    }
+
+    // Default implementation concatenates parts into a single buffer. Session
+    // types which can write a sequence of buffers directly should override
+    // this.
+    virtual void send_vectored_data_thread(
+      std::span<const std::span<const uint8_t>> parts)
+    {
+      size_t total_size = 0;
+      for (const auto& part : parts)
+      {
+        total_size += part.size();
+      }
+
+      std::vector<uint8_t> data;
+      data.reserve(total_size);
+      for (const auto& part : parts)
+      {
+        data.insert(data.end(), part.begin(), part.end());
+      }
+
+      send_data_thread(std::move(data));
+    }
+
+    // Sends header followed by a range of a file. The file is read and sent
+    // in bounded chunks, so the body is never held in memory as a whole.
+    void send_file_data(
+      ccf::ds::PooledBuffer&& header, ccf::ds::FileRange&& body)
+    {
+      task_scheduler->add_action(std::make_shared<SendFileDataTask>(
+        std::move(header), std::move(body), shared_from_this()));
+    }
+
+    void send_file_data_thread(
+      std::span<const uint8_t> header, const ccf::ds::FileRange& body)
+    {
+      bool header_sent = false;
+      const auto read = body.read_chunks(
+        file_body_chunk_size, [&](std::span<const uint8_t> chunk) {
+          if (!header_sent)
+          {
+            const std::array<std::span<const uint8_t>, 2> parts = {
+              header, chunk};
+            send_vectored_data_thread(parts);
+            header_sent = true;
+          }
+          else
+          {
+            send_vectored_data_thread({&chunk, 1});
+          }
+        });
+
+      if (!header_sent)
+      {
+        send_vectored_data_thread({&header, 1});
+      }
+
+      if (!read)
+      {
+        // The headers have already been sent, so the client can only learn
+        // that the body is incomplete from the connection closing
+        LOG_FAIL_FMT("Unable to read response body from file, closing session");
+        close_session_thread();
+      }
+    }
+
     void close_session() override
     {
       is_closing.store(true);
@@ -142,6 +278,12 @@ namespace ccf
       tls_io->send_data(data.data(), data.size());
     }
 
+    void send_vectored_data_thread(
+      std::span<const std::span<const uint8_t>> parts) override
+    {
+      tls_io->send_data(parts);
+    }
+
     void handle_incoming_data_thread(std::vector<uint8_t>&& data) override
     {
       tls_io->recv_buffered(data.data(), data.size());
@@ -212,6 +354,24 @@ namespace ccf
         serializer::ByteRange{data.data(), data.size()});
     }
 
+    void send_vectored_data_thread(
+      std::span<const std::span<const uint8_t>> parts) override
+    {
+      // Messages on the ring buffer are delivered in order, so each part can
+      // be written as a separate message without reassembly
+      for (const auto& part : parts)
+      {
+        if (!part.empty())
+        {
+          RINGBUFFER_WRITE_MESSAGE(
+            ::tcp::tcp_outbound,
+            to_host,
+            session_id,
+            serializer::ByteRange{part.data(), part.size()});
+        }
+      }
+    }
+
     void close_session_thread() override
     {
       RINGBUFFER_WRITE_MESSAGE(
@@ -9,7 +9,9 @@
 #include "tls/context.h"
 #include "tls/tls.h"
 
+#include <algorithm>
 #include <exception>
+#include <span>
 
 namespace ccf
 {
@@ -28,6 +30,11 @@ namespace ccf
   public:
     using HandshakeErrorCB = std::function<void(std::string&&)>;
 
+    // Upper bound on the plaintext passed to a single TLS write, so that large
+    // payloads are encrypted and handed to the host as a stream of bounded
+    // chunks rather than in one allocation.
+    static constexpr size_t max_write_chunk_size = 64 * 1024;
+
   protected:
     ringbuffer::WriterPtr to_host;
     ::tcp::ConnID session_id;
@@ -311,6 +318,54 @@ namespace ccf
       flush();
     }
 
+    // Writes a sequence of buffers as if they were a single contiguous buffer,
+    // without first concatenating them. Data is passed to the TLS context
+    // directly from the caller's storage, and only the suffix which cannot be
+    // written immediately is copied to pending_write.
+    void send_data(std::span<const std::span<const uint8_t>> parts)
+    {
+      do_handshake();
+
+      if (status != handshake && !can_send())
+      {
+        return;
+      }
+
+      // Anything already pending must be written first, to preserve ordering
+      flush();
+
+      bool buffering = status == handshake || !pending_write.empty();
+
+      for (auto part : parts)
+      {
+        while (!buffering && !part.empty())
+        {
+          const auto chunk_size = std::min(part.size(), max_write_chunk_size);
+          auto r = write_some(part.data(), chunk_size);
+
+          if (r > 0)
+          {
+            part = part.subspan(r);
+          }
+          else if (r == 0)
+          {
+            buffering = true;
+          }
+          else
+          {
+            LOG_TRACE_FMT("TLS session {} error on send: {}", session_id, -r);
+            stop(error);
+            return;
+          }
+        }
+
+        if (!part.empty())
+        {
+          pending_write.insert(pending_write.end(), part.begin(), part.end());
+        }
+      }
+    }
+
   private:
     void send_buffered(const std::vector<uint8_t>& data)
     {
@@ -328,7 +383,7 @@ namespace ccf
 
       while (!pending_write.empty())
       {
-        auto r = write_some(pending_write);
+        auto r = write_some(pending_write.data(), pending_write.size());
 
         if (r > 0)
         {
@@ -414,9 +469,9 @@ namespace ccf
       }
     }
 
-    int write_some(const std::vector<uint8_t>& data)
+    int write_some(const uint8_t* data, size_t size)
     {
-      auto r = ctx->write(data.data(), data.size());
+      auto r = ctx->write(data, size);
 
       switch (r)
       {
@@ -4,13 +4,12 @@
 #include "ccf/endpoints/authentication/cert_auth.h"
 
 #include "ccf/ds/x509_time_fmt.h"
-#include "ccf/pal/locking.h"
 #include "ccf/rpc_context.h"
 #include "ccf/service/tables/members.h"
 #include "ccf/service/tables/nodes.h"
 #include "ccf/service/tables/users.h"
+#include "ds/concurrent_cache.h"
 #include "ds/internal_logger.h"
-#include "ds/lru.h"
 
 namespace ccf
 {
@@ -26,8 +25,7 @@ namespace ccf
 
     using DER = std::vector<uint8_t>;
 
-    ccf::pal::Mutex periods_lock;
-    LRU<DER, ValidityPeriod> periods;
+    ccf::ds::ConcurrentCache<DER, ValidityPeriod> periods;
 
     ValidityPeriodsCache(size_t max_periods = DEFAULT_MAX_PERIODS) :
       periods(max_periods)
@@ -35,11 +33,7 @@ namespace ccf
 
     ValidityPeriod get_validity_period(const DER& der)
     {
-      std::lock_guard<ccf::pal::Mutex> guard(periods_lock);
-
-      auto it = periods.find(der);
-      if (it == periods.end())
-      {
+      return periods.get_or_insert(der, [&der]() {
         auto verifier = ccf::crypto::make_unique_verifier(der);
 
         const auto [valid_from_timestring, valid_to_timestring] =
@@ -58,11 +52,8 @@ namespace ccf
               .time_since_epoch())
             .count();
 
-        it = periods.insert(
-          der, ValidityPeriod{valid_from_unix_time, valid_to_unix_time});
-      }
-
-      return it->second;
+        return ValidityPeriod{valid_from_unix_time, valid_to_unix_time};
+      });
     }
 
     bool is_cert_valid_now(
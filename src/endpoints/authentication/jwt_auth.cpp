@@ -7,10 +7,9 @@
 #include "ccf/crypto/ecdsa.h"
 #include "ccf/crypto/rsa_public_key.h"
 #include "ccf/ds/nonstd.h"
-#include "ccf/pal/locking.h"
 #include "ccf/rpc_context.h"
 #include "ccf/service/tables/jwt.h"
-#include "ds/lru.h"
+#include "ds/concurrent_cache.h"
 #include "http/http_jwt.h"
 
 namespace
@@ -89,11 +88,10 @@ namespace ccf
     static constexpr size_t DEFAULT_MAX_KEYS = 10;
 
     using DER = std::vector<uint8_t>;
-    ccf::pal::Mutex keys_lock;
 
     using PublicKey =
       std::variant<ccf::crypto::RSAPublicKeyPtr, ccf::crypto::ECPublicKeyPtr>;
-    LRU<DER, PublicKey> keys;
+    ccf::ds::ConcurrentCache<DER, PublicKey> keys;
 
     PublicKeysCache(size_t max_keys = DEFAULT_MAX_KEYS) : keys(max_keys) {}
 
@@ -104,22 +102,17 @@ namespace ccf
       size_t signature_size,
       const DER& der)
     {
-      std::lock_guard<ccf::pal::Mutex> guard(keys_lock);
-
-      auto it = keys.find(der);
-      if (it == keys.end())
-      {
+      const auto key = keys.get_or_insert(der, [&der]() -> PublicKey {
         try
         {
-          it = keys.insert(der, ccf::crypto::make_rsa_public_key(der));
+          return ccf::crypto::make_rsa_public_key(der);
         }
         catch (const std::exception&)
         {
-          it = keys.insert(der, ccf::crypto::make_ec_public_key(der));
+          return ccf::crypto::make_ec_public_key(der);
         }
-      }
+      });
 
-      const auto& key = it->second;
       if (std::holds_alternative<ccf::crypto::RSAPublicKeyPtr>(key))
       {
         LOG_DEBUG_FMT("Verify der: {} as RSA key", der);
@@ -13,9 +13,12 @@
 #include "ccf/receipt.h"
 #include "ccf/service/tables/code_id.h"
 #include "ccf/service/tables/host_data.h"
+#include "ccf/service/tables/service.h"
 #include "ccf/service/tables/snp_measurements.h"
 #include "node/rpc/call_types.h"
 #include "node/rpc/serialization.h"
+#include "node/signature_cache_interface.h"
+#include "node/tx_receipt_impl.h"
 
 namespace ccf
 {
@@ -60,6 +63,52 @@ namespace ccf
 
       return tx_id_opt;
     }
+
+    // Receipts for recent transactions of the current service are produced
+    // from the signatures and Merkle tree held in memory, without a
+    // historical query. Returns nullptr for any other request, which should
+    // then be served by the historical query adapter (including reporting
+    // errors).
+    TxReceiptImplPtr get_recent_receipt(
+      ccf::AbstractNodeContext& context,
+      ccf::endpoints::ReadOnlyEndpointContext& ctx)
+    {
+      const auto parsed_query =
+        http::parse_query(ctx.rpc_ctx->get_request_query());
+      const auto it = parsed_query.find(tx_id_param_key);
+      if (it == parsed_query.end())
+      {
+        return nullptr;
+      }
+
+      const auto tx_id = ccf::TxID::from_str(it->second);
+      if (!tx_id.has_value())
+      {
+        return nullptr;
+      }
+
+      // Transactions from before the current service was created may need
+      // endorsements of earlier service identities
+      auto* service = ctx.tx.template ro<ccf::Service>(Tables::SERVICE);
+      auto active_service = service->get();
+      if (
+        !active_service.has_value() ||
+        active_service->status != ServiceStatus::OPEN ||
+        !active_service->current_service_create_txid.has_value() ||
+        tx_id->seqno < active_service->current_service_create_txid->seqno)
+      {
+        return nullptr;
+      }
+
+      auto signature_cache =
+        context.get_subsystem<ccf::SignatureCacheInterface>();
+      if (signature_cache == nullptr)
+      {
+        return nullptr;
+      }
+
+      return signature_cache->get_recent_receipt(tx_id.value());
+    }
   }
 
   CommonEndpointRegistry::CommonEndpointRegistry(
@@ -261,24 +310,41 @@ namespace ccf
           current_consensus, view, seqno, error_reason);
       };
 
+    auto describe_receipt = [](auto& ctx, const TxReceiptImpl& receipt) {
+      auto out = ccf::describe_receipt_v1(receipt);
+      ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
+      ccf::jsonhandler::set_response(out, ctx.rpc_ctx);
+    };
+
     auto get_receipt =
-      [](
+      [describe_receipt](
         auto& ctx,
         ccf::historical::StatePtr
           historical_state) { // NOLINT(performance-unnecessary-value-param)
-        const auto params = ccf::jsonhandler::get_json_params(ctx.rpc_ctx);
-
         assert(historical_state->receipt);
-        auto out = ccf::describe_receipt_v1(*historical_state->receipt);
-        ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
-        ccf::jsonhandler::set_response(out, ctx.rpc_ctx);
+        describe_receipt(ctx, *historical_state->receipt);
+      };
+
+    auto get_historical_receipt = ccf::historical::read_only_adapter_v4(
+      get_receipt, context, is_tx_committed, txid_from_query_string);
+
+    auto get_receipt_from_memory_or_history =
+      [this, describe_receipt, get_historical_receipt](
+        ccf::endpoints::ReadOnlyEndpointContext& ctx) {
+        auto receipt = get_recent_receipt(context, ctx);
+        if (receipt != nullptr && receipt->signature.has_value())
+        {
+          describe_receipt(ctx, *receipt);
+          return;
+        }
+
+        get_historical_receipt(ctx);
       };
 
     make_read_only_endpoint(
       "/receipt",
       HTTP_GET,
-      ccf::historical::read_only_adapter_v4(
-        get_receipt, context, is_tx_committed, txid_from_query_string),
+      get_receipt_from_memory_or_history,
       no_auth_required)
       .set_auto_schema<void, nlohmann::json>()
       .add_openapi_response<std::string>(
@@ -292,8 +358,18 @@ namespace ccf
         "ledger")
       .install();
 
+    auto describe_cose_receipt = [](
+                                   auto& ctx,
+                                   const std::vector<uint8_t>& cose_receipt) {
+      ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
+      ctx.rpc_ctx->set_response_header(
+        ccf::http::headers::CONTENT_TYPE,
+        ccf::http::headervalues::contenttype::COSE);
+      ctx.rpc_ctx->set_response_body(cose_receipt);
+    };
+
     auto get_cose_receipt =
-      [](
+      [describe_cose_receipt](
         auto& ctx,
         ccf::historical::StatePtr
           historical_state) { // NOLINT(performance-unnecessary-value-param)
@@ -309,18 +385,33 @@ namespace ccf
           return;
         }
 
-        ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
-        ctx.rpc_ctx->set_response_header(
-          ccf::http::headers::CONTENT_TYPE,
-          ccf::http::headervalues::contenttype::COSE);
-        ctx.rpc_ctx->set_response_body(*cose_receipt);
+        describe_cose_receipt(ctx, *cose_receipt);
+      };
+
+    auto get_historical_cose_receipt = ccf::historical::read_only_adapter_v4(
+      get_cose_receipt, context, is_tx_committed, txid_from_query_string);
+
+    auto get_cose_receipt_from_memory_or_history =
+      [this, describe_cose_receipt, get_historical_cose_receipt](
+        ccf::endpoints::ReadOnlyEndpointContext& ctx) {
+        auto receipt = get_recent_receipt(context, ctx);
+        if (receipt != nullptr)
+        {
+          auto cose_receipt = ccf::describe_cose_receipt_v1(*receipt);
+          if (cose_receipt.has_value())
+          {
+            describe_cose_receipt(ctx, *cose_receipt);
+            return;
+          }
+        }
+
+        get_historical_cose_receipt(ctx);
       };
 
     make_read_only_endpoint(
       "/receipt/cose",
       HTTP_GET,
-      ccf::historical::read_only_adapter_v4(
-        get_cose_receipt, context, is_tx_committed, txid_from_query_string),
+      get_cose_receipt_from_memory_or_history,
       no_auth_required)
       .set_auto_schema<void, ds::openapi::Cose>()
       .add_openapi_response<std::string>(
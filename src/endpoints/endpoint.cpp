@@ -117,6 +117,20 @@ namespace ccf::endpoints
     return *this;
   }
 
+  Endpoint& Endpoint::set_read_only_batching(
+    const ReadOnlyBatchingPolicy& policy)
+  {
+    if (!is_read_only())
+    {
+      throw std::logic_error(fmt::format(
+        "Cannot batch requests to {}, as it is not read-only",
+        dispatch.to_str()));
+    }
+
+    read_only_batching = policy;
+    return *this;
+  }
+
   Endpoint& Endpoint::set_locally_committed_function(
     const LocallyCommittedEndpointFunction& lcf)
   {
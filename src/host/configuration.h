@@ -77,6 +77,7 @@ namespace host
       ccf::ds::SizeString circuit_size = {"16MB"};
       ccf::ds::SizeString max_msg_size = {"64MB"};
       ccf::ds::SizeString max_fragment_size = {"256KB"};
+      std::optional<ccf::ds::SizeString> min_shared_buffer_size = std::nullopt;
 
       bool operator==(const Memory&) const = default;
     };
@@ -143,7 +144,11 @@ namespace host
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(HostConfig::Memory);
   DECLARE_JSON_REQUIRED_FIELDS(HostConfig::Memory);
   DECLARE_JSON_OPTIONAL_FIELDS(
-    HostConfig::Memory, circuit_size, max_msg_size, max_fragment_size);
+    HostConfig::Memory,
+    circuit_size,
+    max_msg_size,
+    max_fragment_size,
+    min_shared_buffer_size);
 
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(HostConfig::Command::Start);
   DECLARE_JSON_REQUIRED_FIELDS(
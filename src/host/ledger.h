@@ -14,7 +14,9 @@
 #include "kv/kv_types.h"
 #include "kv/serialised_entry_format.h"
 #include "ledger_filenames.h"
+#include "ledger_writer.h"
 #include "time_bound_logger.h"
+#include "timer.h"
 
 #include <cstdint>
 #include <cstdio>
@@ -23,9 +25,13 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <tuple>
+#include <unistd.h>
 #include <uv.h>
 #include <vector>
 
@@ -79,6 +85,22 @@ namespace asynchost
     size_t end_idx{};
   };
 
+  // A contiguous run of serialised ledger entries, which is shared rather
+  // than copied. Entries from a mapped (committed) file are a view of the
+  // mapping, which owner keeps alive. Otherwise owner holds a single copy.
+  struct LedgerReadSegment
+  {
+    std::shared_ptr<const void> owner;
+    std::span<const uint8_t> data;
+  };
+
+  struct LedgerSharedReadResult
+  {
+    std::vector<LedgerReadSegment> segments;
+    size_t size = 0;
+    size_t end_idx{};
+  };
+
   class LedgerFile
   {
   private:
@@ -108,6 +130,67 @@ namespace asynchost
     // checked against the existing ones, until a divergence is found.
     bool from_existing_file = false;
 
+    // Committed files are immutable, so are mapped read-only when opened, and
+    // read from directly rather than by seeking (under lock) on file
+    uint8_t* mapped = nullptr;
+    size_t mapped_size = 0;
+
+    void map_committed_file(const fs::path& file_path, size_t total_file_size)
+    {
+      void* addr = nullptr;
+      {
+        TimeBoundLogger log_if_slow(
+          fmt::format("Mapping committed ledger file - mmap({})", file_path));
+        addr = mmap(
+          nullptr, total_file_size, PROT_READ, MAP_SHARED, fileno(file), 0);
+      }
+
+      if (addr == MAP_FAILED)
+      {
+        // Reads fall back to fread
+        LOG_FAIL_FMT(
+          "Unable to map committed ledger file {}: {}",
+          file_path,
+          ccf::nonstd::strerror(errno));
+        return;
+      }
+
+      mapped = static_cast<uint8_t*>(addr);
+      mapped_size = total_file_size;
+    }
+
+    void unmap()
+    {
+      if (mapped == nullptr)
+      {
+        return;
+      }
+
+      if (munmap(mapped, mapped_size) != 0)
+      {
+        LOG_FAIL_FMT(
+          "Unable to unmap ledger file {}: {}",
+          file_name,
+          ccf::nonstd::strerror(errno));
+      }
+      mapped = nullptr;
+      mapped_size = 0;
+    }
+
+    // Ask the kernel to page in the requested range, and as much again after
+    // it, so that sequential scans of committed files do not fault on every
+    // page
+    void advise_readahead(size_t offset, size_t size) const
+    {
+      static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+      const auto begin = offset - (offset % page_size);
+      const auto end = std::min(mapped_size, offset + (2 * size));
+      if (end > begin)
+      {
+        madvise(mapped + begin, end - begin, MADV_WILLNEED);
+      }
+    }
+
     int close()
     {
       if (file == nullptr)
@@ -270,6 +353,11 @@ namespace asynchost
           }
         }
         completed = true;
+
+        if (committed)
+        {
+          map_committed_file(file_path, total_file_size);
+        }
       }
       else
       {
@@ -332,6 +420,7 @@ namespace asynchost
 
     ~LedgerFile()
     {
+      unmap();
       std::ignore = close();
     }
 
@@ -365,10 +454,16 @@ namespace asynchost
       return recovery;
     }
 
+    [[nodiscard]] bool is_mapped() const
+    {
+      return mapped != nullptr;
+    }
+
     // Returns idx of new entry, and boolean to indicate that file was truncated
-    // before writing the entry
+    // before writing the entry. If flush is false, the caller is responsible
+    // for flushing committable entries.
     std::pair<size_t, bool> write_entry(
-      const uint8_t* data, size_t size, bool committable)
+      const uint8_t* data, size_t size, bool committable, bool flush = true)
     {
       fseeko(file, total_len, SEEK_SET);
 
@@ -414,7 +509,7 @@ namespace asynchost
         }
 
         // Committable entries get flushed straight away
-        if (committable)
+        if (committable && flush)
         {
           TimeBoundLogger log_if_slow(
             fmt::format("Flushing ledger entry - fflush({})", file_name));
@@ -433,6 +528,39 @@ namespace asynchost
       return std::make_pair(get_last_idx(), has_truncated);
     }
 
+    void flush()
+    {
+      TimeBoundLogger log_if_slow(
+        fmt::format("Flushing ledger entries - fflush({})", file_name));
+      if (fflush(file) != 0)
+      {
+        throw std::logic_error(fmt::format(
+          "Failed to flush entries to ledger: {}",
+          ccf::nonstd::strerror(errno)));
+      }
+    }
+
+    // Returns a new descriptor for this file, so that it can be synced without
+    // holding any lock, even if this file is concurrently closed or reopened.
+    // Returns std::nullopt if this file is already closed.
+    [[nodiscard]] std::optional<int> duplicate_fd() const
+    {
+      if (file == nullptr)
+      {
+        return std::nullopt;
+      }
+
+      auto fd = dup(fileno(file));
+      if (fd < 0)
+      {
+        throw std::logic_error(fmt::format(
+          "Failed to duplicate ledger file descriptor {}: {}",
+          file_name,
+          ccf::nonstd::strerror(errno)));
+      }
+      return fd;
+    }
+
     // Return pair containing entries size and index of last entry included
     [[nodiscard]] std::pair<size_t, size_t> entries_size(
       size_t from,
@@ -486,8 +614,42 @@ namespace asynchost
       return {size, to};
     }
 
-    std::optional<LedgerReadResult> read_entries(
+    // Returns a view of entries from to to (or fewer, so that they fit in
+    // max_size) in the mapping of this file, and the index of the last entry
+    // in it. The file must be mapped, and the view is only valid while this
+    // LedgerFile is alive.
+    std::pair<std::span<const uint8_t>, size_t> get_mapped_entries(
       size_t from, size_t to, std::optional<size_t> max_size = std::nullopt)
+    {
+      // Positions and contents of mapped (committed) files never change, so
+      // no lock is required
+      auto [size, to_] = entries_size(from, to, max_size);
+      if (size == 0)
+      {
+        return {};
+      }
+
+      const auto offset = positions.at(from - start_idx);
+      if (offset + size > mapped_size)
+      {
+        throw std::logic_error(fmt::format(
+          "Entry range {} - {} is beyond end of mapped file {}",
+          from,
+          to_,
+          file_name));
+      }
+
+      advise_readahead(offset, size);
+      return {{mapped + offset, size}, to_};
+    }
+
+    // Appends entries from to to (or fewer, so that they fit in max_size) to
+    // out, and returns the index of the last entry appended
+    std::optional<size_t> read_entries_into(
+      size_t from,
+      size_t to,
+      std::optional<size_t> max_size,
+      std::vector<uint8_t>& out)
     {
       if ((from < start_idx) || (to > get_last_idx()) || (to < from))
       {
@@ -506,13 +668,26 @@ namespace asynchost
         file_name,
         max_size.value_or(0));
 
+      if (mapped != nullptr)
+      {
+        auto [entries, to_] = get_mapped_entries(from, to, max_size);
+        if (entries.empty())
+        {
+          return std::nullopt;
+        }
+
+        out.insert(out.end(), entries.begin(), entries.end());
+        return to_;
+      }
+
       std::unique_lock<ccf::pal::Mutex> guard(file_lock);
       auto [size, to_] = entries_size(from, to, max_size);
       if (size == 0)
       {
         return std::nullopt;
       }
-      std::vector<uint8_t> entries(size);
+      const auto out_size = out.size();
+      out.resize(out_size + size);
       fseeko(file, positions.at(from - start_idx), SEEK_SET);
 
       {
@@ -522,8 +697,9 @@ namespace asynchost
           to_,
           size,
           file_name));
-        if (fread(entries.data(), size, 1, file) != 1)
+        if (fread(out.data() + out_size, size, 1, file) != 1)
         {
+          out.resize(out_size);
           throw std::logic_error(fmt::format(
             "Failed to read entry range {} - {} from file {}",
             from,
@@ -532,7 +708,21 @@ namespace asynchost
         }
       }
 
-      return LedgerReadResult{entries, to_};
+      return to_;
+    }
+
+    std::optional<LedgerReadResult> read_entries(
+      size_t from, size_t to, std::optional<size_t> max_size = std::nullopt)
+    {
+      LedgerReadResult rr;
+      const auto end_idx = read_entries_into(from, to, max_size, rr.data);
+      if (!end_idx.has_value())
+      {
+        return std::nullopt;
+      }
+
+      rr.end_idx = end_idx.value();
+      return rr;
     }
 
     bool truncate(size_t idx, bool remove_file_if_empty = true)
@@ -844,6 +1034,26 @@ namespace asynchost
     std::shared_ptr<ccf::ds::WorkerShutdownGate> shutdown_gate =
       std::make_shared<ccf::ds::WorkerShutdownGate>();
 
+    // Set when entries are synced to disk by the writer thread, see
+    // start_writer()
+    bool durable_writes = false;
+    // Files written to since they were last synced
+    std::vector<std::shared_ptr<LedgerFile>> unsynced_files;
+
+    // Protects the durability state below, which is reported to the enclave
+    ccf::pal::Mutex durable_lock;
+    size_t durable_idx = 0;
+    // Incremented whenever written entries may be replaced, so that a sync
+    // racing with it does not report the new entries as durable
+    size_t durable_generation = 0;
+    // Latest truncation issued by consensus which has been processed
+    ::consensus::TruncationId truncation_id = 0;
+    bool durable_idx_unreported = false;
+
+    // Declared last, so that the writer thread is stopped before anything it
+    // uses is destroyed
+    std::unique_ptr<LedgerWriter> writer = nullptr;
+
     [[nodiscard]] auto get_it_contains_idx(size_t idx) const
     {
       if (idx == 0)
@@ -1028,17 +1238,15 @@ namespace asynchost
         {
           max_size = max_entries_size.value() - rr.data.size();
         }
-        auto v = f_from->read_entries(idx, to_, max_size);
-        if (!v.has_value())
+        // Read directly into the result, rather than into an intermediate
+        // buffer per file
+        auto end_idx = f_from->read_entries_into(idx, to_, max_size, rr.data);
+        if (!end_idx.has_value())
         {
           break;
         }
-        rr.end_idx = v->end_idx;
-        rr.data.insert(
-          rr.data.end(),
-          std::make_move_iterator(v->data.begin()),
-          std::make_move_iterator(v->data.end()));
-        if (v->end_idx != to_)
+        rr.end_idx = end_idx.value();
+        if (end_idx.value() != to_)
         {
           // If all the entries requested from a file are not returned (i.e.
           // because the requested entries are larger than max_entries_size),
@@ -1322,10 +1530,73 @@ namespace asynchost
 
     ~Ledger()
     {
+      // Write any remaining entries
+      writer.reset();
+
       // Reject queued workers and wait for workers already using this Ledger.
       shutdown_gate->shutdown_and_wait();
     }
 
+    // From now on, entries appended by the enclave (and other ledger
+    // operations, in order with them) are written by a dedicated thread,
+    // coalescing entries appended in quick succession into a single write. If
+    // durable is true, written entries are also synced to disk (fdatasync) in
+    // batches, and report_durable_idx() tells the enclave how far the ledger is
+    // durable.
+    void start_writer(bool durable)
+    {
+      {
+        std::unique_lock<ccf::pal::Mutex> guard(state_lock);
+        durable_writes = durable;
+
+        std::unique_lock<ccf::pal::Mutex> durable_guard(durable_lock);
+        durable_idx = last_idx;
+        durable_idx_unreported = durable;
+      }
+
+      LedgerWriter::SyncFn sync = nullptr;
+      if (durable)
+      {
+        sync = [this]() { sync_written_entries(); };
+      }
+
+      writer = std::make_unique<LedgerWriter>(
+        [this](const LedgerWriter::Batch& batch) { write_entries(batch); },
+        std::move(sync));
+    }
+
+    // Runs op after all entries appended so far have been written
+    void write_in_order(LedgerWriter::Operation&& op)
+    {
+      if (writer != nullptr)
+      {
+        writer->append(std::move(op));
+      }
+      else
+      {
+        op();
+      }
+    }
+
+    void report_durable_idx()
+    {
+      size_t idx = 0;
+      ::consensus::TruncationId reported_truncation_id = 0;
+      {
+        std::unique_lock<ccf::pal::Mutex> guard(durable_lock);
+        if (!durable_idx_unreported)
+        {
+          return;
+        }
+        idx = durable_idx;
+        reported_truncation_id = truncation_id;
+        durable_idx_unreported = false;
+      }
+
+      RINGBUFFER_WRITE_MESSAGE(
+        ::consensus::ledger_durable, to_enclave, idx, reported_truncation_id);
+    }
+
     void init(size_t idx, size_t recovery_start_idx_ = 0)
     {
       TimeBoundLogger log_if_slow(
@@ -1453,6 +1724,11 @@ namespace asynchost
       TimeBoundLogger log_if_slow(
         fmt::format("Reading ledger entry at {}", idx));
 
+      if (writer != nullptr)
+      {
+        writer->wait_until_written();
+      }
+
       // Locking is done in read_entries_range
 
       return read_entries_range(idx, idx);
@@ -1466,11 +1742,91 @@ namespace asynchost
       TimeBoundLogger log_if_slow(
         fmt::format("Reading ledger entries from {} to {}", from, to));
 
+      // Entries appended by the enclave may not have been written yet
+      if (writer != nullptr)
+      {
+        writer->wait_until_written();
+      }
+
       // Locking is done in read_entries_range
 
       return read_entries_range(from, to, false, max_entries_size);
     }
 
+    // Reads entries from to to without copying them out of mapped
+    // (committed) files, so that they can be written to a socket directly.
+    // Entries in other files are read into one copy per file.
+    std::optional<LedgerSharedReadResult> read_entries_shared(
+      size_t from, size_t to)
+    {
+      TimeBoundLogger log_if_slow(
+        fmt::format("Reading shared ledger entries from {} to {}", from, to));
+
+      if (writer != nullptr)
+      {
+        writer->wait_until_written();
+      }
+
+      std::unique_lock<ccf::pal::Mutex> guard(state_lock);
+
+      if ((from <= 0) || (to < from))
+      {
+        return std::nullopt;
+      }
+
+      if (to > last_idx)
+      {
+        to = last_idx;
+      }
+
+      LedgerSharedReadResult rr;
+      size_t idx = from;
+      while (idx <= to)
+      {
+        auto f_from = get_file_from_idx(idx);
+        if (f_from == nullptr)
+        {
+          LOG_FAIL_FMT("Cannot find ledger file for seqno {}", idx);
+          return std::nullopt;
+        }
+        const auto to_ = std::min(f_from->get_last_idx(), to);
+
+        LedgerReadSegment segment;
+        if (f_from->is_mapped())
+        {
+          const auto entries = f_from->get_mapped_entries(idx, to_).first;
+          if (entries.empty())
+          {
+            break;
+          }
+          segment = {f_from, entries};
+        }
+        else
+        {
+          auto entries = std::make_shared<std::vector<uint8_t>>();
+          const auto end_idx =
+            f_from->read_entries_into(idx, to_, std::nullopt, *entries);
+          if (!end_idx.has_value())
+          {
+            break;
+          }
+          segment = {entries, *entries};
+        }
+
+        rr.size += segment.data.size();
+        rr.segments.push_back(std::move(segment));
+        rr.end_idx = to_;
+        idx = to_ + 1;
+      }
+
+      if (rr.segments.empty())
+      {
+        return std::nullopt;
+      }
+
+      return rr;
+    }
+
     size_t write_entry(const uint8_t* data, size_t size, bool committable)
     {
       TimeBoundLogger log_if_slow(fmt::format(
@@ -1478,6 +1834,132 @@ namespace asynchost
 
       std::unique_lock<ccf::pal::Mutex> guard(state_lock);
 
+      return write_entry_unsafe(data, size, committable);
+    }
+
+    // Writes a batch of entries, flushing them once at the end
+    size_t write_entries(const LedgerWriter::Batch& batch)
+    {
+      TimeBoundLogger log_if_slow(
+        fmt::format("Writing {} ledger entries", batch.size()));
+
+      std::unique_lock<ccf::pal::Mutex> guard(state_lock);
+
+      std::vector<std::shared_ptr<LedgerFile>> written_files;
+      for (const auto& entry : batch)
+      {
+        write_entry_unsafe(
+          entry.data.data(), entry.data.size(), entry.committable, false);
+
+        auto file = get_latest_file(false);
+        if (written_files.empty() || written_files.back() != file)
+        {
+          written_files.push_back(file);
+        }
+      }
+
+      for (const auto& file : written_files)
+      {
+        file->flush();
+        if (
+          durable_writes &&
+          (unsynced_files.empty() || unsynced_files.back() != file))
+        {
+          unsynced_files.push_back(file);
+        }
+      }
+
+      return last_idx;
+    }
+
+    // Syncs all entries written so far to disk, outside of state_lock so that
+    // entries can be written (and read) meanwhile
+    void sync_written_entries()
+    {
+      size_t generation = 0;
+      {
+        std::unique_lock<ccf::pal::Mutex> guard(durable_lock);
+        generation = durable_generation;
+      }
+
+      size_t idx = 0;
+      std::vector<int> fds;
+      {
+        std::unique_lock<ccf::pal::Mutex> guard(state_lock);
+        idx = last_idx;
+        for (const auto& file : unsynced_files)
+        {
+          auto fd = file->duplicate_fd();
+          if (fd.has_value())
+          {
+            fds.push_back(fd.value());
+          }
+        }
+        unsynced_files.clear();
+      }
+
+      int rc = 0;
+      {
+        TimeBoundLogger log_if_slow(
+          fmt::format("Syncing ledger entries up to {} - fdatasync", idx));
+        for (auto fd : fds)
+        {
+          if (rc == 0)
+          {
+            rc = fdatasync(fd);
+          }
+          close(fd);
+        }
+      }
+      if (rc != 0)
+      {
+        throw std::logic_error(fmt::format(
+          "Failed to sync ledger entries: {}", ccf::nonstd::strerror(errno)));
+      }
+
+      std::unique_lock<ccf::pal::Mutex> guard(durable_lock);
+      if (durable_generation == generation && idx > durable_idx)
+      {
+        durable_idx = idx;
+        durable_idx_unreported = true;
+      }
+    }
+
+  private:
+    // Called when entries may have been replaced (or removed), so that any
+    // concurrent sync is not reported as covering them. Reports carry the id
+    // of the latest truncation issued by consensus, so that the enclave can
+    // discard reports which precede its own truncations.
+    void reset_durable_idx(
+      size_t idx,
+      bool truncation,
+      ::consensus::TruncationId truncation_id_ = 0)
+    {
+      if (!durable_writes)
+      {
+        return;
+      }
+
+      std::unique_lock<ccf::pal::Mutex> guard(durable_lock);
+      ++durable_generation;
+      if (truncation)
+      {
+        durable_idx = std::min(durable_idx, idx);
+        if (truncation_id_ != 0)
+        {
+          truncation_id = truncation_id_;
+        }
+      }
+      else
+      {
+        durable_idx = idx;
+      }
+      durable_idx_unreported = true;
+    }
+
+    size_t write_entry_unsafe(
+      const uint8_t* data, size_t size, bool committable, bool flush = true)
+    {
       auto header =
         serialized::peek<ccf::kv::SerialisedEntryHeader>(data, size);
 
@@ -1530,7 +2012,7 @@ namespace asynchost
         files.emplace_back(file);
       }
       auto [last_idx_, has_truncated] =
-        file->write_entry(data, size, committable);
+        file->write_entry(data, size, committable, flush);
       last_idx = last_idx_;
 
       if (has_truncated)
@@ -1564,6 +2046,7 @@ namespace asynchost
       return last_idx;
     }
 
+  public:
     void truncate(size_t idx, bool recovery_mode = false)
     {
       TimeBoundLogger log_if_slow(fmt::format("Truncating ledger at {}", idx));
@@ -1839,7 +2322,10 @@ namespace asynchost
           auto idx = serialized::read<::consensus::Index>(data, size);
           auto recovery_start_index =
             serialized::read<::consensus::Index>(data, size);
-          init(idx, recovery_start_index);
+          write_in_order([this, idx, recovery_start_index]() {
+            init(idx, recovery_start_index);
+            reset_durable_idx(idx, false);
+          });
         });
 
       DISPATCHER_SET_MESSAGE_HANDLER(
@@ -1847,7 +2333,14 @@ namespace asynchost
         ::consensus::ledger_append,
         [this](const uint8_t* data, size_t size) {
           auto committable = serialized::read<bool>(data, size);
-          write_entry(data, size, committable);
+          if (writer != nullptr)
+          {
+            writer->append(data, size, committable);
+          }
+          else
+          {
+            write_entry(data, size, committable);
+          }
         });
 
       DISPATCHER_SET_MESSAGE_HANDLER(
@@ -1856,11 +2349,16 @@ namespace asynchost
         [this](const uint8_t* data, size_t size) {
           auto idx = serialized::read<::consensus::Index>(data, size);
           auto recovery_mode = serialized::read<bool>(data, size);
-          truncate(idx, recovery_mode);
-          if (recovery_mode)
-          {
-            set_recovery_start_idx(idx);
-          }
+          auto truncation_id =
+            serialized::read<::consensus::TruncationId>(data, size);
+          write_in_order([this, idx, recovery_mode, truncation_id]() {
+            truncate(idx, recovery_mode);
+            if (recovery_mode)
+            {
+              set_recovery_start_idx(idx);
+            }
+            reset_durable_idx(idx, true, truncation_id);
+          });
         });
 
       DISPATCHER_SET_MESSAGE_HANDLER(
@@ -1868,12 +2366,12 @@ namespace asynchost
         ::consensus::ledger_commit,
         [this](const uint8_t* data, size_t size) {
           auto idx = serialized::read<::consensus::Index>(data, size);
-          commit(idx);
+          write_in_order([this, idx]() { commit(idx); });
         });
 
       DISPATCHER_SET_MESSAGE_HANDLER(
         disp, ::consensus::ledger_open, [this](const uint8_t*, size_t) {
-          complete_recovery();
+          write_in_order([this]() { complete_recovery(); });
         });
 
       DISPATCHER_SET_MESSAGE_HANDLER(
@@ -1941,4 +2439,21 @@ namespace asynchost
         });
     }
   };
+
+  class LedgerDurabilityReporterImpl
+  {
+  private:
+    Ledger& ledger;
+
+  public:
+    LedgerDurabilityReporterImpl(Ledger& ledger_) : ledger(ledger_) {}
+
+    void on_timer()
+    {
+      ledger.report_durable_idx();
+    }
+  };
+
+  using LedgerDurabilityReporter =
+    proxy_ptr<Timer<LedgerDurabilityReporterImpl>>;
 }
@@ -0,0 +1,226 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace asynchost
+{
+  // Writes ledger entries appended by the enclave on a dedicated thread, so
+  // that the event loop does not wait on file I/O. Entries appended while a
+  // batch is being written are coalesced into the next batch, which is written
+  // (and flushed) at once. Other ledger operations (eg - truncation) are queued
+  // with the entries, and executed in order with them.
+  //
+  // If a sync function is given, the writer thread also calls it after each
+  // batch, to make what has been written durable. Writing the next batch does
+  // not wait for a sync to complete, so that entries appended while syncing
+  // are themselves synced together, by the next call.
+  class LedgerWriter
+  {
+  public:
+    struct Entry
+    {
+      std::vector<uint8_t> data;
+      bool committable;
+    };
+    using Batch = std::vector<Entry>;
+    using Operation = std::function<void()>;
+
+    using WriteBatchFn = std::function<void(const Batch&)>;
+    using SyncFn = std::function<void()>;
+
+  private:
+    using Item = std::variant<Entry, Operation>;
+
+    WriteBatchFn write_batch;
+    SyncFn sync;
+
+    std::mutex lock;
+    std::condition_variable work_available;
+    std::condition_variable batch_written;
+    std::vector<Item> queued;
+    bool writing = false;
+    bool sync_requested = false;
+    bool stopping = false;
+    std::exception_ptr error = nullptr;
+
+    std::thread thread;
+
+    void throw_if_failed()
+    {
+      if (error != nullptr)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+
+    void enqueue(Item&& item)
+    {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        throw_if_failed();
+        queued.push_back(std::move(item));
+      }
+      work_available.notify_one();
+    }
+
+    // Called with lock held, and returns with it held
+    void write_queued(std::unique_lock<std::mutex>& guard)
+    {
+      auto items = std::move(queued);
+      queued.clear();
+      writing = true;
+      guard.unlock();
+
+      std::exception_ptr write_error = nullptr;
+      try
+      {
+        Batch batch;
+        for (auto& item : items)
+        {
+          if (auto* entry = std::get_if<Entry>(&item))
+          {
+            batch.push_back(std::move(*entry));
+            continue;
+          }
+
+          if (!batch.empty())
+          {
+            write_batch(batch);
+            batch.clear();
+          }
+          std::get<Operation>(item)();
+        }
+
+        if (!batch.empty())
+        {
+          write_batch(batch);
+        }
+      }
+      catch (...)
+      {
+        write_error = std::current_exception();
+      }
+
+      guard.lock();
+      writing = false;
+      sync_requested = sync != nullptr;
+      if (write_error != nullptr && error == nullptr)
+      {
+        error = write_error;
+      }
+      if (error != nullptr)
+      {
+        // Nothing more can be written safely
+        queued.clear();
+      }
+      batch_written.notify_all();
+      work_available.notify_one();
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      while (true)
+      {
+        work_available.wait(guard, [this]() {
+          return sync_requested || (!writing && (stopping || !queued.empty()));
+        });
+
+        // Sync before writing anything else, so that entries keep becoming
+        // durable under a constant stream of appends
+        if (sync_requested)
+        {
+          sync_requested = false;
+          if (error == nullptr)
+          {
+            guard.unlock();
+            try
+            {
+              sync();
+              guard.lock();
+            }
+            catch (...)
+            {
+              guard.lock();
+              error = std::current_exception();
+            }
+          }
+          continue;
+        }
+
+        if (!queued.empty())
+        {
+          write_queued(guard);
+          continue;
+        }
+
+        if (stopping)
+        {
+          return;
+        }
+      }
+    }
+
+  public:
+    LedgerWriter(WriteBatchFn write_batch_, SyncFn sync_ = nullptr) :
+      write_batch(std::move(write_batch_)),
+      sync(std::move(sync_))
+    {
+      thread = std::thread([this]() { run(); });
+    }
+
+    ~LedgerWriter()
+    {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+      }
+      work_available.notify_one();
+      thread.join();
+    }
+
+    LedgerWriter(const LedgerWriter&) = delete;
+    LedgerWriter& operator=(const LedgerWriter&) = delete;
+
+    // Rethrows, on the caller's thread, any error from a previous write
+    void append(const uint8_t* data, size_t size, bool committable)
+    {
+      enqueue(Entry{{data, data + size}, committable});
+    }
+
+    void append(Operation&& operation)
+    {
+      enqueue(std::move(operation));
+    }
+
+    // Returns once everything appended so far has been written (but not
+    // necessarily synced). If the writer thread is busy syncing, the queued
+    // entries are written by the caller rather than waiting for it.
+    void wait_until_written()
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      while (writing || !queued.empty())
+      {
+        throw_if_failed();
+        if (writing)
+        {
+          batch_written.wait(guard);
+        }
+        else
+        {
+          write_queued(guard);
+        }
+      }
+      throw_if_failed();
+    }
+  };
+}
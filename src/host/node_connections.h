@@ -275,6 +275,7 @@ namespace asynchost
     size_t next_id = 1;
 
     ringbuffer::WriterPtr to_enclave;
+    ringbuffer::BufferHandoffPtr buffer_handoff;
 
     std::optional<std::string> client_interface = std::nullopt;
     std::optional<std::chrono::milliseconds> client_connection_timeout =
@@ -292,6 +293,7 @@ namespace asynchost
         std::nullopt) :
       ledger(ledger),
       to_enclave(writer_factory.create_writer_to_inside()),
+      buffer_handoff(writer_factory.get_buffer_handoff()),
       client_interface(client_interface),
       client_connection_timeout(client_connection_timeout_)
     {
@@ -330,122 +332,182 @@ namespace asynchost
         disp, ccf::node_outbound, [this](const uint8_t* data, size_t size) {
           // Read piece-by-piece rather than all at once
           ccf::NodeId to = serialized::read<ccf::NodeId::Value>(data, size);
+          send_to_node(to, data, size);
+        });
+
+      DISPATCHER_SET_MESSAGE_HANDLER(
+        disp,
+        ccf::node_outbound_shared,
+        [this](const uint8_t* data, size_t size) {
+          auto [to, handle] =
+            ringbuffer::read_message<ccf::node_outbound_shared>(data, size);
 
-          TCP outbound_connection = nullptr;
+          if (buffer_handoff == nullptr)
           {
-            const auto connection_it = connections.find(to);
-            if (connection_it == connections.end())
-            {
-              const auto address_it = node_addresses.find(to);
-              if (address_it == node_addresses.end())
-              {
-                LOG_TRACE_FMT("Ignoring node_outbound to unknown node {}", to);
-                return;
-              }
-
-              const auto& [host, port] = address_it->second;
-              outbound_connection = create_connection(to, host, port);
-              if (outbound_connection.is_null())
-              {
-                LOG_FAIL_FMT(
-                  "Unable to connect to {}, dropping outbound message message",
-                  to);
-                return;
-              }
-            }
-            else
-            {
-              outbound_connection = connection_it->second;
-            }
+            LOG_FAIL_FMT(
+              "Received node_outbound_shared, but no buffer handoff is "
+              "configured");
+            return;
           }
 
-          // Rather than reading and reserialising, use the msg_type and from_id
-          // that are already serialised on the ringbuffer
-          auto data_to_send = data;
-          auto size_to_send = size;
-
-          // If the message is a consensus append entries message, affix the
-          // corresponding ledger entries
-          auto msg_type = serialized::read<ccf::NodeMsgType>(data, size);
-          serialized::read<ccf::NodeId::Value>(data, size); // Ignore from_id
-          if (
-            msg_type == ccf::NodeMsgType::consensus_msg &&
-            (serialized::read<aft::RaftMsgType>(data, size) ==
-             aft::raft_append_entries))
+          // The first part holds the serialised message header, and the
+          // rest of the payload is written from the shared parts without
+          // being copied
+          const auto parts = buffer_handoff->claim(handle);
+          if (parts.empty())
           {
-            // Parse the indices to be sent to the recipient.
-            const auto& ae =
-              serialized::overlay<::consensus::AppendEntriesIndex>(data, size);
+            LOG_FAIL_FMT("Received empty node_outbound_shared payload");
+            return;
+          }
+          const auto& header = parts.front();
+          send_to_node(
+            to,
+            header->data(),
+            header->size(),
+            {std::next(parts.begin()), parts.end()});
+        });
+    }
 
-            // Find the total frame size, and write it along with the header.
-            auto frame = static_cast<uint32_t>(size_to_send);
+  private:
+    // data and size describe serialised (msg_type, from_id, payload), as
+    // written by the enclave in a node_outbound message. Any shared_tail is
+    // the remainder of the payload, which is kept alive (rather than copied)
+    // until it has been written.
+    void send_to_node(
+      const ccf::NodeId& to,
+      const uint8_t* data,
+      size_t size,
+      std::span<const ringbuffer::SharedBuffer> shared_tail = {})
+    {
+      TCP outbound_connection = nullptr;
+      {
+        const auto connection_it = connections.find(to);
+        if (connection_it == connections.end())
+        {
+          const auto address_it = node_addresses.find(to);
+          if (address_it == node_addresses.end())
+          {
+            LOG_TRACE_FMT("Ignoring node_outbound to unknown node {}", to);
+            return;
+          }
 
-            if (ae.idx > ae.prev_idx)
-            {
-              std::optional<asynchost::LedgerReadResult> read_result =
-                ledger.read_entries(ae.prev_idx + 1, ae.idx);
-
-              if (!read_result.has_value())
-              {
-                LOG_FAIL_FMT(
-                  "Unable to send AppendEntries ({}, {}]: Ledger read failed",
-                  ae.prev_idx,
-                  ae.idx);
-                return;
-              }
-
-              if (ae.idx != read_result->end_idx)
-              {
-                // NB: This should never happen since we do not pass a max_size
-                // to read_entries
-                LOG_FAIL_FMT(
-                  "Unable to send AppendEntries ({}, {}]: Ledger read returned "
-                  "entries to {}",
-                  ae.prev_idx,
-                  ae.idx,
-                  read_result->end_idx);
-                return;
-              }
-
-              const auto& framed_entries = read_result->data;
-              frame += static_cast<uint32_t>(framed_entries.size());
-              outbound_connection->write(
-                sizeof(uint32_t), reinterpret_cast<uint8_t*>(&frame));
-              outbound_connection->write(size_to_send, data_to_send);
-
-              outbound_connection->write(
-                framed_entries.size(), framed_entries.data());
-            }
-            else
-            {
-              // Header-only AE
-              outbound_connection->write(
-                sizeof(uint32_t), reinterpret_cast<uint8_t*>(&frame));
-              outbound_connection->write(size_to_send, data_to_send);
-            }
+          const auto& [host, port] = address_it->second;
+          outbound_connection = create_connection(to, host, port);
+          if (outbound_connection.is_null())
+          {
+            LOG_FAIL_FMT(
+              "Unable to connect to {}, dropping outbound message message",
+              to);
+            return;
+          }
+        }
+        else
+        {
+          outbound_connection = connection_it->second;
+        }
+      }
 
-            LOG_DEBUG_FMT(
-              "send AE to node {} [{}]: {}, {}",
-              to,
-              frame,
-              ae.idx,
-              ae.prev_idx);
+      // Rather than reading and reserialising, use the msg_type and from_id
+      // that are already serialised on the ringbuffer
+      auto data_to_send = data;
+      auto size_to_send = size;
+      size_t shared_tail_size = 0;
+      for (const auto& part : shared_tail)
+      {
+        shared_tail_size += part->size();
+      }
+
+      // Writes the message itself, following its frame size
+      auto write_message = [&]() {
+        outbound_connection->write(size_to_send, data_to_send);
+        for (const auto& part : shared_tail)
+        {
+          outbound_connection->write_shared(part, *part);
+        }
+      };
+
+      // If the message is a consensus append entries message, affix the
+      // corresponding ledger entries
+      auto msg_type = serialized::read<ccf::NodeMsgType>(data, size);
+      serialized::read<ccf::NodeId::Value>(data, size); // Ignore from_id
+      if (
+        msg_type == ccf::NodeMsgType::consensus_msg &&
+        (serialized::read<aft::RaftMsgType>(data, size) ==
+         aft::raft_append_entries))
+      {
+        // Parse the indices to be sent to the recipient.
+        const auto& ae =
+          serialized::overlay<::consensus::AppendEntriesIndex>(data, size);
+
+        // Find the total frame size, and write it along with the header.
+        auto frame = static_cast<uint32_t>(size_to_send + shared_tail_size);
+
+        if (ae.idx > ae.prev_idx)
+        {
+          // Entries in committed ledger files are written straight from the
+          // file mapping, and others from a single copy, rather than being
+          // copied again for the socket
+          auto read_result =
+            ledger.read_entries_shared(ae.prev_idx + 1, ae.idx);
+
+          if (!read_result.has_value())
+          {
+            LOG_FAIL_FMT(
+              "Unable to send AppendEntries ({}, {}]: Ledger read failed",
+              ae.prev_idx,
+              ae.idx);
+            return;
           }
-          else
+
+          if (ae.idx != read_result->end_idx)
           {
-            // Write as framed data to the recipient.
-            auto frame = static_cast<uint32_t>(size_to_send);
+            LOG_FAIL_FMT(
+              "Unable to send AppendEntries ({}, {}]: Ledger read returned "
+              "entries to {}",
+              ae.prev_idx,
+              ae.idx,
+              read_result->end_idx);
+            return;
+          }
 
-            LOG_DEBUG_FMT("node send to {} [{}]", to, frame);
+          frame += static_cast<uint32_t>(read_result->size);
+          outbound_connection->write(
+            sizeof(uint32_t), reinterpret_cast<uint8_t*>(&frame));
+          write_message();
 
-            outbound_connection->write(
-              sizeof(uint32_t), reinterpret_cast<uint8_t*>(&frame));
-            outbound_connection->write(size_to_send, data_to_send);
+          for (const auto& segment : read_result->segments)
+          {
+            outbound_connection->write_shared(segment.owner, segment.data);
           }
-        });
+        }
+        else
+        {
+          // Header-only AE
+          outbound_connection->write(
+            sizeof(uint32_t), reinterpret_cast<uint8_t*>(&frame));
+          write_message();
+        }
+
+        LOG_DEBUG_FMT(
+          "send AE to node {} [{}]: {}, {}",
+          to,
+          frame,
+          ae.idx,
+          ae.prev_idx);
+      }
+      else
+      {
+        // Write as framed data to the recipient.
+        auto frame = static_cast<uint32_t>(size_to_send + shared_tail_size);
+
+        LOG_DEBUG_FMT("node send to {} [{}]", to, frame);
+
+        outbound_connection->write(
+          sizeof(uint32_t), reinterpret_cast<uint8_t*>(&frame));
+        write_message();
+      }
     }
 
-  private:
     TCP create_connection(
       const ccf::NodeId& node_id,
       const std::string& host,
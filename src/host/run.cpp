@@ -182,11 +182,13 @@ namespace ccf
     oversized::WriterFactory writer_factory;
 
     WriterFactories(
-      ringbuffer::Circuit& circuit, const oversized::WriterConfig& config) :
+      ringbuffer::Circuit& circuit,
+      const oversized::WriterConfig& config,
+      ringbuffer::BufferHandoffPtr buffer_handoff) :
       base_factory(circuit),
       notifying_factory(base_factory),
       non_blocking_factory(notifying_factory),
-      writer_factory(non_blocking_factory, config)
+      writer_factory(non_blocking_factory, config, std::move(buffer_handoff))
     {}
   };
 
@@ -605,7 +607,8 @@ namespace ccf
     ccf::LoggerLevel log_level)
   {
     // Construct hierarchy of ringbuffer writer factories
-    WriterFactories factories(circuit, enclave_config.writer_config);
+    WriterFactories factories(
+      circuit, enclave_config.writer_config, enclave_config.buffer_handoff);
     auto& writer_factory = factories.writer_factory;
 
     // provide regular ticks to the enclave
@@ -635,6 +638,15 @@ namespace ccf
       asynchost::ledger_max_read_cache_files_default,
       config.ledger.read_only_directories);
     ledger.register_message_handlers(buffer_processor.get_dispatcher());
+    ledger.start_writer(config.consensus.durable_acks);
+
+    // In durable mode, regularly tell the enclave how much of the ledger has
+    // been synced to disk
+    std::optional<asynchost::LedgerDurabilityReporter> ledger_durability;
+    if (config.consensus.durable_acks)
+    {
+      ledger_durability.emplace(1ms, ledger);
+    }
 
     if (config.snapshots.read_only_directory.has_value())
     {
@@ -1095,6 +1107,13 @@ namespace ccf
         config.memory.max_fragment_size, config.memory.max_msg_size};
       enclave_config.writer_config = writer_config;
 
+      if (config.memory.min_shared_buffer_size.has_value())
+      {
+        enclave_config.buffer_handoff =
+          std::make_shared<ringbuffer::BufferHandoff>(
+            config.memory.min_shared_buffer_size->count_bytes());
+      }
+
       const auto inner_ret = run_main_loop(
         config, buffer_processor, circuit, enclave_config, log_level);
 
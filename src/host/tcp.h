@@ -11,8 +11,10 @@
 #include "proxy.h"
 #include "socket.h"
 
+#include <memory>
 #include <netinet/in.h>
 #include <optional>
+#include <span>
 #include <unistd.h>
 
 namespace asynchost
@@ -367,6 +369,41 @@ namespace asynchost
       }
       req->data = copy;
 
+      return queue_write(req, len);
+    }
+
+    // Writes data without copying it. owner is held until the write has
+    // completed or been dropped, and must keep data alive until then.
+    bool write_shared(
+      std::shared_ptr<const void> owner, std::span<const uint8_t> data)
+    {
+      auto* req = new SharedWrite; // NOLINT(cppcoreguidelines-owning-memory)
+      req->data = nullptr;
+      req->owner = std::move(owner);
+      req->bytes = data.data();
+      return queue_write(req, data.size());
+    }
+
+  private:
+    // A write whose data is borrowed rather than copied. These are
+    // distinguished from copying writes by a null req->data.
+    struct SharedWrite : public uv_write_t
+    {
+      std::shared_ptr<const void> owner;
+      const uint8_t* bytes = nullptr;
+    };
+
+    static const uint8_t* get_write_data(uv_write_t* req)
+    {
+      if (req->data == nullptr)
+      {
+        return static_cast<SharedWrite*>(req)->bytes;
+      }
+      return static_cast<uint8_t*>(req->data);
+    }
+
+    bool queue_write(uv_write_t* req, size_t len)
+    {
       switch (status)
       {
         case BINDING:
@@ -408,7 +445,6 @@ namespace asynchost
       return true;
     }
 
-  private:
     bool init()
     {
       assert_status(FRESH, FRESH);
@@ -442,10 +478,10 @@ namespace asynchost
 
     bool send_write(uv_write_t* req, size_t len)
     {
-      auto* copy = static_cast<char*>(req->data);
-
       uv_buf_t buf;
-      buf.base = copy;
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      buf.base =
+        reinterpret_cast<char*>(const_cast<uint8_t*>(get_write_data(req)));
       buf.len = len;
 
       int rc = 0;
@@ -1061,6 +1097,13 @@ namespace asynchost
         return;
       }
 
+      if (req->data == nullptr)
+      {
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        delete static_cast<SharedWrite*>(req);
+        return;
+      }
+
       auto* copy = static_cast<char*>(req->data);
       delete[] copy; // NOLINT(cppcoreguidelines-owning-memory)
       delete req; // NOLINT(cppcoreguidelines-owning-memory)
@@ -18,6 +18,7 @@
 #include <random>
 #include <string>
 #include <sys/file.h>
+#include <thread>
 #include <unistd.h>
 
 using namespace asynchost;
@@ -989,6 +990,114 @@ TEST_CASE("Commit")
   }
 }
 
+TEST_CASE("Committed files are mapped for reading")
+{
+  auto dir = AutoDeleteFolder(ledger_dir);
+
+  size_t chunk_threshold = 30;
+  size_t entries_per_chunk = get_entries_per_chunk(chunk_threshold);
+  size_t chunk_count = 3;
+  size_t last_idx = 0;
+
+  {
+    Ledger ledger(ledger_dir, wf);
+    TestEntrySubmitter entry_submitter(ledger, chunk_threshold);
+    initialise_ledger(entry_submitter, entries_per_chunk, chunk_count);
+    entry_submitter.write(true);
+    last_idx = entry_submitter.get_last_idx();
+    ledger.commit(last_idx - 1);
+    REQUIRE(number_of_committed_files_in_ledger_dir() == chunk_count);
+
+    INFO("Reads spanning committed and uncommitted files");
+    {
+      read_entries_range_from_ledger(ledger, 1, last_idx);
+      read_entries_range_from_ledger(ledger, entries_per_chunk, last_idx);
+    }
+  }
+
+  INFO("Shared reads match copied reads, with one segment per file");
+  {
+    Ledger ledger(ledger_dir, wf);
+    for (const auto from : {size_t(1), entries_per_chunk + 1})
+    {
+      const auto copied = ledger.read_entries(from, last_idx);
+      const auto shared = ledger.read_entries_shared(from, last_idx);
+      REQUIRE(copied.has_value());
+      REQUIRE(shared.has_value());
+      REQUIRE(shared->end_idx == copied->end_idx);
+
+      std::vector<uint8_t> joined;
+      for (const auto& segment : shared->segments)
+      {
+        REQUIRE(segment.owner != nullptr);
+        joined.insert(joined.end(), segment.data.begin(), segment.data.end());
+      }
+      REQUIRE(shared->size == joined.size());
+      REQUIRE(joined == copied->data);
+      REQUIRE(shared->segments.size() > 1);
+    }
+
+    REQUIRE_FALSE(ledger.read_entries_shared(0, last_idx).has_value());
+  }
+
+  for (auto const& f : fs::directory_iterator(ledger_dir))
+  {
+    const auto file_name = f.path().filename().string();
+    LedgerFile ledger_file(ledger_dir, file_name);
+
+    if (!is_ledger_file_name_committed(file_name))
+    {
+      REQUIRE_FALSE(ledger_file.is_mapped());
+      continue;
+    }
+
+    INFO("Committed file is mapped, and reads match the file contents");
+    {
+      REQUIRE(ledger_file.is_mapped());
+
+      const auto from = ledger_file.get_start_idx();
+      const auto to = ledger_file.get_last_idx();
+      auto read_result = ledger_file.read_entries(from, to);
+      REQUIRE(read_result.has_value());
+      verify_framed_entries_range(read_result.value(), from, to);
+      REQUIRE(read_result->end_idx == to);
+
+      const auto contents = files::slurp(f.path().string());
+      const auto [size, _] = ledger_file.entries_size(from, to);
+      REQUIRE(size == read_result->data.size());
+      REQUIRE(std::equal(
+        read_result->data.begin(),
+        read_result->data.end(),
+        contents.begin() + sizeof(size_t)));
+    }
+
+    INFO("Partial reads from a mapped file are capped by max size");
+    {
+      const auto from = ledger_file.get_start_idx();
+      const auto to = ledger_file.get_last_idx();
+      const auto [entry_size, _] = ledger_file.entries_size(from, from);
+      auto read_result = ledger_file.read_entries(from, to, entry_size);
+      REQUIRE(read_result.has_value());
+      REQUIRE(read_result->end_idx == from);
+      verify_framed_entries_range(read_result.value(), from, from);
+
+      REQUIRE_FALSE(ledger_file.read_entries(from, to + 1).has_value());
+    }
+
+    INFO("Reads append to an existing buffer");
+    {
+      const auto from = ledger_file.get_start_idx();
+      std::vector<uint8_t> out = {0x42};
+      const auto end_idx =
+        ledger_file.read_entries_into(from, from, std::nullopt, out);
+      REQUIRE(end_idx.has_value());
+      REQUIRE(end_idx.value() == from);
+      REQUIRE(out.size() == 1 + ledger_file.entries_size(from, from).first);
+      REQUIRE(out[0] == 0x42);
+    }
+  }
+}
+
 TEST_CASE("Restore existing ledger")
 {
   auto dir = AutoDeleteFolder(ledger_dir);
@@ -2359,6 +2468,110 @@ TEST_CASE("Async ledger reads survive concurrent destruction")
   uv_run(uv_default_loop(), UV_RUN_DEFAULT);
 }
 
+TEST_CASE("Writer thread")
+{
+  auto dir = AutoDeleteFolder(ledger_dir);
+
+  constexpr auto test_buffer_size = 64 * 1024;
+  auto test_in_buf = std::make_unique<ringbuffer::TestBuffer>(test_buffer_size);
+  auto test_out_buf =
+    std::make_unique<ringbuffer::TestBuffer>(test_buffer_size);
+  ringbuffer::Circuit test_circuit(test_in_buf->bd, test_out_buf->bd);
+  ringbuffer::WriterFactory test_wf(test_circuit);
+
+  // Durability reports, as received by the enclave
+  size_t durable_idx = 0;
+  ::consensus::TruncationId truncation_id = 0;
+  messaging::BufferProcessor enclave_bp("enclave");
+  DISPATCHER_SET_MESSAGE_HANDLER(
+    enclave_bp.get_dispatcher(),
+    ::consensus::ledger_durable,
+    [&](const uint8_t* data, size_t size) {
+      auto [idx, truncation_id_] =
+        ringbuffer::read_message<::consensus::ledger_durable>(data, size);
+      durable_idx = idx;
+      truncation_id = truncation_id_;
+    });
+
+  Ledger ledger(ledger_dir, test_wf);
+  messaging::BufferProcessor bp("host");
+  ledger.register_message_handlers(bp.get_dispatcher());
+  ledger.start_writer(true /* durable */);
+
+  auto to_host = test_wf.create_writer_to_outside();
+  auto append = [&](size_t from, size_t to) {
+    for (auto idx = from; idx <= to; ++idx)
+    {
+      auto entry = make_ledger_entry(idx);
+      RINGBUFFER_WRITE_MESSAGE(
+        ::consensus::ledger_append,
+        to_host,
+        idx % 10 == 0,
+        serializer::ByteRange{entry.data(), entry.size()});
+    }
+    bp.read_all(test_circuit.read_from_inside());
+  };
+
+  auto wait_until_durable = [&](size_t idx) {
+    for (size_t i = 0; i < 1000 && durable_idx != idx; ++i)
+    {
+      ledger.report_durable_idx();
+      enclave_bp.read_all(test_circuit.read_from_outside());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(durable_idx == idx);
+  };
+
+  INFO("Appended entries can be read as soon as they are appended");
+  {
+    append(1, 100);
+    read_entries_range_from_ledger(ledger, 1, 100);
+    wait_until_durable(100);
+    REQUIRE(truncation_id == 0);
+  }
+
+  INFO("Truncations are applied in order with appended entries");
+  {
+    RINGBUFFER_WRITE_MESSAGE(
+      ::consensus::ledger_truncate,
+      to_host,
+      ::consensus::Index(50),
+      false /* no recovery */,
+      ::consensus::TruncationId(1));
+    append(51, 60);
+    read_entries_range_from_ledger(ledger, 1, 60);
+    auto read_result = ledger.read_entries(1, 61);
+    REQUIRE(read_result.has_value());
+    REQUIRE(read_result->end_idx == 60);
+
+    wait_until_durable(60);
+    REQUIRE(truncation_id == 1);
+  }
+
+  INFO("Reports carry the latest truncation issued by consensus");
+  {
+    RINGBUFFER_WRITE_MESSAGE(
+      ::consensus::ledger_truncate,
+      to_host,
+      ::consensus::Index(55),
+      false /* no recovery */,
+      ::consensus::TruncationId(0));
+    append(56, 65);
+    wait_until_durable(65);
+    REQUIRE(truncation_id == 1);
+  }
+
+  INFO("Commits are applied in order with appended entries");
+  {
+    append(66, 80);
+    RINGBUFFER_WRITE_MESSAGE(
+      ::consensus::ledger_commit, to_host, ::consensus::Index(80));
+    bp.read_all(test_circuit.read_from_inside());
+    wait_until_durable(80);
+    read_entries_range_from_ledger(ledger, 1, 80);
+  }
+}
+
 int main(int argc, char** argv)
 {
   ccf::logger::config::default_init();
@@ -3,8 +3,12 @@
 
 #include "ds/serialized.h"
 #include "host/ledger.h"
+#include "host/ledger_writer.h"
 #include "kv/serialised_entry_format.h"
 
+#include <condition_variable>
+#include <mutex>
+
 #define PICOBENCH_IMPLEMENT
 #include <picobench/picobench.hpp>
 
@@ -145,6 +149,131 @@ namespace
   }
 
   const std::vector<int> rename_iterations = {20};
+
+  static constexpr size_t append_entry_body_size = 256;
+
+  void sync_file(const LedgerFile& file)
+  {
+    const auto fd = file.duplicate_fd();
+    if (!fd.has_value() || fdatasync(fd.value()) != 0)
+    {
+      throw std::runtime_error("Failed to sync ledger file");
+    }
+    close(fd.value());
+  }
+
+  // Each entry is written and synced before the next one is appended
+  static void append_sync_each_entry(picobench::state& state)
+  {
+    const auto directory = fs::path("ledger_append_bench_sync_each");
+    fs::remove_all(directory);
+    fs::create_directory(directory);
+    RemoveDirectory remove_directory{directory};
+
+    const auto entry = make_entry(append_entry_body_size);
+    LedgerFile file(directory, 1);
+
+    state.start_timer();
+    for ([[maybe_unused]] auto iteration : state)
+    {
+      file.write_entry(entry.data(), entry.size(), true);
+      sync_file(file);
+    }
+    state.stop_timer();
+  }
+
+  // Entries are written (and, if Sync, synced) in batches by a LedgerWriter.
+  // If WaitEach, each entry is durable before the next one is appended, which
+  // measures the latency of a single append. Otherwise, all entries are
+  // appended at once, and the time until the last one is durable measures
+  // throughput.
+  template <bool Sync, bool WaitEach>
+  static void append_group_commit(picobench::state& state)
+  {
+    const auto directory =
+      fs::path(fmt::format("ledger_append_bench_{}_{}", Sync, WaitEach));
+    fs::remove_all(directory);
+    fs::create_directory(directory);
+    RemoveDirectory remove_directory{directory};
+
+    const auto entry = make_entry(append_entry_body_size);
+    LedgerFile file(directory, 1);
+
+    std::mutex lock;
+    std::condition_variable durable_cv;
+    size_t written = 0;
+    size_t durable = 0;
+
+    LedgerWriter::SyncFn sync = nullptr;
+    if constexpr (Sync)
+    {
+      sync = [&]() {
+        size_t written_before_sync = 0;
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          written_before_sync = written;
+        }
+        sync_file(file);
+        std::lock_guard<std::mutex> guard(lock);
+        durable = written_before_sync;
+        durable_cv.notify_all();
+      };
+    }
+
+    LedgerWriter writer(
+      [&](const LedgerWriter::Batch& batch) {
+        for (const auto& e : batch)
+        {
+          file.write_entry(e.data.data(), e.data.size(), e.committable, false);
+        }
+        file.flush();
+
+        std::lock_guard<std::mutex> guard(lock);
+        written += batch.size();
+        if constexpr (!Sync)
+        {
+          durable = written;
+          durable_cv.notify_all();
+        }
+      },
+      std::move(sync));
+
+    auto wait_until_durable = [&](size_t count) {
+      std::unique_lock<std::mutex> guard(lock);
+      durable_cv.wait(guard, [&]() { return durable >= count; });
+    };
+
+    state.start_timer();
+    size_t appended = 0;
+    for ([[maybe_unused]] auto iteration : state)
+    {
+      writer.append(entry.data(), entry.size(), true);
+      ++appended;
+      if constexpr (WaitEach)
+      {
+        wait_until_durable(appended);
+      }
+    }
+    wait_until_durable(appended);
+    state.stop_timer();
+  }
+
+  static void append_group_commit_sync(picobench::state& state)
+  {
+    append_group_commit<true, false>(state);
+  }
+
+  static void append_group_commit_sync_latency(picobench::state& state)
+  {
+    append_group_commit<true, true>(state);
+  }
+
+  static void append_group_commit_no_sync(picobench::state& state)
+  {
+    append_group_commit<false, false>(state);
+  }
+
+  const std::vector<int> append_iterations = {100, 1000};
 }
 
 PICOBENCH_SUITE("rename empty ledger file");
@@ -167,6 +296,12 @@ PICOBENCH_SUITE("rename 100 MiB ledger file");
 PICOBENCH(rename_100_mib).iterations(rename_iterations).baseline();
 PICOBENCH(rename_100_mib_close_and_reopen).iterations(rename_iterations);
 
+PICOBENCH_SUITE("append durable ledger entries");
+PICOBENCH(append_sync_each_entry).iterations(append_iterations).baseline();
+PICOBENCH(append_group_commit_sync_latency).iterations(append_iterations);
+PICOBENCH(append_group_commit_sync).iterations(append_iterations);
+PICOBENCH(append_group_commit_no_sync).iterations(append_iterations);
+
 int main(int argc, char* argv[])
 {
   ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
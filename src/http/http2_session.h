@@ -364,8 +364,41 @@ namespace http
         std::shared_ptr<ccf::RpcHandler> search =
           http::fetch_rpc_handler(rpc_ctx, rpc_map);
 
+        rpc_ctx->can_defer_response = true;
         search->process(rpc_ctx);
 
+        if (rpc_ctx->deferred_response != nullptr)
+        {
+          // Block any future work from happening on this session until the
+          // response has been sent
+          ccf::tasks::Resumable paused_task = ccf::tasks::pause_current_task();
+          std::shared_ptr<ccf::ThreadedSession> self = shared_from_this();
+          rpc_ctx->deferred_response->on_complete(
+            [this, self, responder, rpc_ctx, paused_task]() {
+              try
+              {
+                // A request which was forwarded is responded to directly
+                if (!rpc_ctx->response_is_pending)
+                {
+                  responder->send_response(
+                    rpc_ctx->get_response_http_status(),
+                    rpc_ctx->get_response_headers(),
+                    rpc_ctx->get_response_trailers(),
+                    std::move(rpc_ctx->take_response_body()));
+                }
+              }
+              catch (const std::exception& e)
+              {
+                LOG_FAIL_FMT(
+                  "Exception while sending deferred response: {}", e.what());
+                close_session();
+              }
+
+              ccf::tasks::resume_task(paused_task);
+            });
+          return;
+        }
+
         if (rpc_ctx->response_is_pending)
         {
           // If the RPC is pending, hold the connection.
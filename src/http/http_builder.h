@@ -204,6 +204,23 @@ namespace http
   public:
     Response(ccf::http_status s = HTTP_STATUS_OK) : status(s) {}
 
+    // Appends the status line and headers (including the terminating empty
+    // line) to out, but not the body. This lets the caller send the body from
+    // its own storage, rather than copying it into a single response buffer.
+    void build_response_header(std::vector<uint8_t>& out) const
+    {
+      fmt::format_to(
+        std::back_inserter(out),
+        "HTTP/1.1 {} {}\r\n",
+        status,
+        ccf::http_status_str(status));
+      for (const auto& [k, v] : headers)
+      {
+        fmt::format_to(std::back_inserter(out), "{}: {}\r\n", k, v);
+      }
+      fmt::format_to(std::back_inserter(out), "\r\n");
+    }
+
     [[nodiscard]] std::vector<uint8_t> build_response(
       bool header_only = false) const
     {
@@ -53,6 +53,8 @@ namespace http
     ccf::http::HeaderMap response_headers;
     ccf::http::HeaderMap response_trailers;
     std::vector<uint8_t> response_body;
+    // Only set for HTTP/1 responses, which are streamed by the session
+    std::optional<ccf::ds::FileRange> response_file_body = std::nullopt;
     ccf::http_status response_status = HTTP_STATUS_OK;
 
     bool serialised = false;
@@ -207,6 +209,7 @@ namespace http
       // HEAD responses must not contain a body - clients will ignore it
       if (verb != HTTP_HEAD)
       {
+        response_file_body.reset();
         if constexpr (std::is_same_v<T, std::string>)
         {
           response_body = std::vector<uint8_t>(body.begin(), body.end());
@@ -243,6 +246,32 @@ namespace http
       return std::move(response_body);
     }
 
+    void set_response_body_from_file(ccf::ds::FileRange&& range) override
+    {
+      if (verb == HTTP_HEAD)
+      {
+        return;
+      }
+
+      if (http_version != ccf::HttpVersion::HTTP1)
+      {
+        RpcContextImpl::set_response_body_from_file(std::move(range));
+        return;
+      }
+
+      response_body.clear();
+      response_file_body = std::move(range);
+    }
+
+    // Returns the file range set as the response body, if any. In that case
+    // the body returned by take_response_body() is empty.
+    std::optional<ccf::ds::FileRange> take_response_file_body()
+    {
+      auto range = std::move(response_file_body);
+      response_file_body.reset();
+      return range;
+    }
+
     void set_response_status(int status) override
     {
       response_status = (ccf::http_status)status;
@@ -290,6 +319,7 @@ namespace http
     {
       response_headers.clear();
       response_body.clear();
+      response_file_body.reset();
       response_status = HTTP_STATUS_OK;
       explicit_apply_writes.reset();
       consensus_committed_func = nullptr;
@@ -304,6 +334,17 @@ namespace http
         http_response.set_header(k, v);
       }
 
+      if (response_file_body.has_value())
+      {
+        auto contents = response_file_body->read_all();
+        if (!contents.has_value())
+        {
+          throw std::runtime_error("Unable to read response body from file");
+        }
+        http_response.set_body(&contents.value());
+        return http_response.build_response();
+      }
+
       http_response.set_body(&response_body);
       return http_response.build_response();
     }
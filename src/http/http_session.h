@@ -2,6 +2,7 @@
 // Licensed under the Apache 2.0 License.
 #pragma once
 
+#include "ds/buffer_pool.h"
 #include "ds/internal_logger.h"
 #include "enclave/rpc_handler.h"
 #include "enclave/rpc_map.h"
@@ -14,6 +15,18 @@ namespace http
 {
   using HTTPSession = ccf::EncryptedSession;
 
+  // Response status lines and headers are serialised into small buffers
+  // drawn from this pool, shared by all HTTP/1 sessions, while response
+  // bodies are sent from their own storage
+  inline ccf::ds::BufferPoolPtr get_response_header_pool()
+  {
+    static constexpr size_t max_pooled_headers = 256;
+    static constexpr size_t max_header_capacity = 4096;
+    static auto pool = std::make_shared<ccf::ds::BufferPool>(
+      max_pooled_headers, max_header_capacity);
+    return pool;
+  }
+
   class HTTPServerSession : public HTTPSession,
                             public http::RequestProcessor,
                             public ccf::http::HTTPResponder
@@ -166,84 +179,46 @@ namespace http
         std::shared_ptr<ccf::RpcHandler> search =
           http::fetch_rpc_handler(rpc_ctx, rpc_map);
 
+        rpc_ctx->can_defer_response = true;
         search->process(rpc_ctx);
 
-        if (rpc_ctx->response_is_pending)
-        {
-          // If the RPC is pending, hold the connection.
-          LOG_TRACE_FMT("Pending");
-          return;
-        }
-
-        const auto& respond_on_commit = rpc_ctx->respond_on_commit;
-        if (respond_on_commit.has_value())
+        if (rpc_ctx->deferred_response != nullptr)
         {
-          const auto& info = respond_on_commit.value();
-          auto tx_id = info.tx_id;
-          auto committed_func = info.committed_func;
-          auto ws_digest = info.write_set_digest;
-          auto ce = info.commit_evidence;
-          auto claims = info.claims_digest;
-
-          // Block any future work from happening on this session, to
-          // maintain session consistency
+          // Block any future work from happening on this session until the
+          // response has been sent, to maintain session consistency
           ccf::tasks::Resumable paused_task = ccf::tasks::pause_current_task();
-
-          // shared_from_this returns a base session type
           std::shared_ptr<ccf::ThreadedSession> self = shared_from_this();
-
-          // Register for a callback when this TxID is committed (or
-          // invalidated)
-          commit_callbacks->add_callback(
-            tx_id,
-            [self, rpc_ctx, paused_task, committed_func, ws_digest, ce, claims](
-              ccf::TxID transaction_id, ccf::FinalTxStatus status) {
+          rpc_ctx->deferred_response->on_complete(
+            [this, self, rpc_ctx, paused_task]() {
               try
               {
-                // Build the context and let the handler modify the response
-                ccf::endpoints::CommittedTxInfo info{
-                  rpc_ctx, transaction_id, status, ws_digest, ce, claims};
-                committed_func(info);
-
-                // Write the response
-                send_response_impl(
-                  *self,
-                  rpc_ctx->get_response_http_status(),
-                  rpc_ctx->get_response_headers(),
-                  rpc_ctx->get_response_trailers(),
-                  std::move(rpc_ctx->take_response_body()));
+                // A request which was forwarded is responded to directly
+                if (!rpc_ctx->response_is_pending)
+                {
+                  send_rpc_response(rpc_ctx, paused_task);
+                  return;
+                }
               }
               catch (const std::exception& e)
               {
                 LOG_FAIL_FMT(
-                  "Exception thrown while executing commit callback for {}: {}",
-                  transaction_id.to_str(),
-                  e.what());
-                rpc_ctx->terminate_session = true;
+                  "Exception while sending deferred response: {}", e.what());
+                close_session();
               }
 
-              if (rpc_ctx->terminate_session)
-              {
-                self->close_session();
-              }
-
-              // Resume processing work for this session
               ccf::tasks::resume_task(paused_task);
             });
+          return;
         }
-        else
+
+        if (rpc_ctx->response_is_pending)
         {
-          send_response(
-            rpc_ctx->get_response_http_status(),
-            rpc_ctx->get_response_headers(),
-            rpc_ctx->get_response_trailers(),
-            std::move(rpc_ctx->take_response_body()));
-
-          if (rpc_ctx->terminate_session)
-          {
-            close_session();
-          }
+          // If the RPC is pending, hold the connection.
+          LOG_TRACE_FMT("Pending");
+          return;
         }
+
+        send_rpc_response(rpc_ctx, nullptr);
       }
       catch (const std::exception& e)
       {
@@ -260,12 +235,102 @@ namespace http
       }
     }
 
+    // Sends the response in rpc_ctx, or registers to send it once its
+    // transaction is committed. If paused_task is set, work on this session
+    // is held until the response is sent, and is then resumed.
+    void send_rpc_response(
+      const std::shared_ptr<http::HttpRpcContext>& rpc_ctx,
+      ccf::tasks::Resumable paused_task)
+    {
+      const auto& respond_on_commit = rpc_ctx->respond_on_commit;
+      if (respond_on_commit.has_value())
+      {
+        const auto& info = respond_on_commit.value();
+        auto tx_id = info.tx_id;
+        auto committed_func = info.committed_func;
+        auto ws_digest = info.write_set_digest;
+        auto ce = info.commit_evidence;
+        auto claims = info.claims_digest;
+
+        // Block any future work from happening on this session, to
+        // maintain session consistency
+        if (paused_task == nullptr)
+        {
+          paused_task = ccf::tasks::pause_current_task();
+        }
+
+        // shared_from_this returns a base session type
+        std::shared_ptr<ccf::ThreadedSession> self = shared_from_this();
+
+        // Register for a callback when this TxID is committed (or
+        // invalidated)
+        commit_callbacks->add_callback(
+          tx_id,
+          [self, rpc_ctx, paused_task, committed_func, ws_digest, ce, claims](
+            ccf::TxID transaction_id, ccf::FinalTxStatus status) {
+            try
+            {
+              // Build the context and let the handler modify the response
+              ccf::endpoints::CommittedTxInfo info{
+                rpc_ctx, transaction_id, status, ws_digest, ce, claims};
+              committed_func(info);
+
+              // Write the response
+              send_response_impl(
+                *self,
+                rpc_ctx->get_response_http_status(),
+                rpc_ctx->get_response_headers(),
+                rpc_ctx->get_response_trailers(),
+                std::move(rpc_ctx->take_response_body()),
+                rpc_ctx->take_response_file_body());
+            }
+            catch (const std::exception& e)
+            {
+              LOG_FAIL_FMT(
+                "Exception thrown while executing commit callback for {}: {}",
+                transaction_id.to_str(),
+                e.what());
+              rpc_ctx->terminate_session = true;
+            }
+
+            if (rpc_ctx->terminate_session)
+            {
+              self->close_session();
+            }
+
+            // Resume processing work for this session
+            ccf::tasks::resume_task(paused_task);
+          });
+      }
+      else
+      {
+        send_response_impl(
+          *this,
+          rpc_ctx->get_response_http_status(),
+          rpc_ctx->get_response_headers(),
+          rpc_ctx->get_response_trailers(),
+          std::move(rpc_ctx->take_response_body()),
+          rpc_ctx->take_response_file_body());
+
+        if (rpc_ctx->terminate_session)
+        {
+          close_session();
+        }
+
+        if (paused_task != nullptr)
+        {
+          ccf::tasks::resume_task(paused_task);
+        }
+      }
+    }
+
     static bool send_response_impl(
       ccf::ThreadedSession& session,
       ccf::http_status status_code,
       ccf::http::HeaderMap&& headers,
       ccf::http::HeaderMap&& trailers,
-      std::vector<uint8_t>&& body)
+      std::vector<uint8_t>&& body,
+      std::optional<ccf::ds::FileRange>&& file_body = std::nullopt)
     {
       if (!trailers.empty())
       {
@@ -278,13 +343,30 @@ namespace http
         response.set_header(k, v);
       }
 
+      if (file_body.has_value())
+      {
+        // The body is read from the file as it is sent
+        response.set_header(
+          ccf::http::headers::CONTENT_LENGTH,
+          std::to_string(file_body->size));
+
+        ccf::ds::PooledBuffer header(get_response_header_pool());
+        response.build_response_header(header.get());
+
+        session.send_file_data(std::move(header), std::move(*file_body));
+        return true;
+      }
+
       response.set_body(
         body.data(),
         body.size(),
         false /* Don't overwrite any existing content-length header */
       );
 
-      session.send_data(response.build_response());
+      ccf::ds::PooledBuffer header(get_response_header_pool());
+      response.build_response_header(header.get());
+
+      session.send_vectored_data(std::move(header), std::move(body));
       return true;
     }
 
@@ -102,6 +102,46 @@ DOCTEST_TEST_CASE("Complete response")
   }
 }
 
+DOCTEST_TEST_CASE("Response header built separately from body")
+{
+  std::vector<uint8_t> body(100'000);
+  for (size_t i = 0; i < body.size(); ++i)
+  {
+    body[i] = i % 256;
+  }
+
+  auto response = ::http::Response(HTTP_STATUS_PARTIAL_CONTENT);
+  response.set_header("x-ms-ccf-test", "value");
+  response.set_body(&body);
+
+  // Header can be appended to a reused buffer
+  std::vector<uint8_t> header = {'j', 'u', 'n', 'k'};
+  header.clear();
+  response.build_response_header(header);
+
+  {
+    DOCTEST_INFO("Header and body together match contiguous response");
+    std::vector<uint8_t> combined(header);
+    combined.insert(combined.end(), body.begin(), body.end());
+    DOCTEST_CHECK(combined == response.build_response());
+  }
+
+  {
+    DOCTEST_INFO("Header and body can be parsed when delivered separately");
+    ::http::SimpleResponseProcessor sp;
+    ::http::ResponseParser p(sp);
+    p.execute(header.data(), header.size());
+    DOCTEST_CHECK(sp.received.empty());
+    p.execute(body.data(), body.size());
+
+    DOCTEST_REQUIRE(sp.received.size() == 1);
+    const auto& m = sp.received.front();
+    DOCTEST_CHECK(m.status == HTTP_STATUS_PARTIAL_CONTENT);
+    DOCTEST_CHECK(m.headers.at("x-ms-ccf-test") == "value");
+    DOCTEST_CHECK(m.body == body);
+  }
+}
+
 DOCTEST_TEST_CASE("Parsing error")
 {
   std::vector<uint8_t> r;
@@ -2,31 +2,84 @@
 // Licensed under the Apache 2.0 License.
 #pragma once
 
+#include "ccf/ds/json.h"
 #include "ccf/indexing/indexer_interface.h"
 #include "ds/internal_logger.h"
 #include "indexing/transaction_fetcher_interface.h"
 #include "kv/kv_types.h"
 #include "kv/store.h"
+#include "tasks/basic_task.h"
+#include "tasks/job_board.h"
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
 
 namespace ccf::indexing
 {
+  struct IndexingMetrics
+  {
+    // Last committed seqno known to the indexer
+    ccf::SeqNo committed_seqno = 0;
+    // Number of committed transactions not yet given to every strategy which
+    // has requested them
+    size_t lag_tx_count = 0;
+    // Number of entries held from the local commit stream
+    size_t buffered_tx_count = 0;
+  };
+
+  DECLARE_JSON_TYPE(IndexingMetrics);
+  DECLARE_JSON_REQUIRED_FIELDS(
+    IndexingMetrics, committed_seqno, lag_tx_count, buffered_tx_count);
+
   // This is responsible for managing a collection of strategies, and ensuring
   // each has been given every transaction up to the commit point, in-order.
-  class Indexer : public IndexingStrategies
+  //
+  // When installed as the store's ledger entry observer, it holds on to the
+  // entries the store produces or applies. Strategies which have caught up are
+  // given committed transactions from these, and the transaction fetcher is
+  // only used to backfill strategies which are further behind.
+  //
+  // Each strategy advances from its own next_requested() cursor. If given a
+  // JobBoard, each strategy's batch of transactions is handled in a separate
+  // task, so strategies are updated concurrently and a strategy which is still
+  // handling its previous batch does not hold up the others.
+  class Indexer : public IndexingStrategies,
+                  public ccf::kv::ILedgerEntryObserver
   {
   public:
     static constexpr size_t MAX_REQUESTABLE = 500;
+    static constexpr size_t MAX_BUFFERED = 20 * MAX_REQUESTABLE;
 
   protected:
     std::shared_ptr<TransactionFetcher> transaction_fetcher;
+    ccf::tasks::JobBoard* job_board;
 
-    using PendingTx = std::pair<ccf::TxID, std::vector<uint8_t>>;
-    std::vector<PendingTx> uncommitted_entries;
+    using CommittedTx = std::pair<ccf::TxID, ccf::kv::ReadOnlyStorePtr>;
+
+    struct StrategyProgress
+    {
+      // Set while a batch is being handled, during which the strategy is not
+      // ticked or given further transactions
+      std::atomic<bool> busy = false;
+      std::atomic<size_t> indexed_tx_count = 0;
+      std::atomic<size_t> indexing_time_us = 0;
+    };
+    using StrategyProgressPtr = std::shared_ptr<StrategyProgress>;
+    std::map<StrategyPtr, StrategyProgressPtr> progress;
+
+    using PendingTx =
+      std::pair<ccf::TxID, std::shared_ptr<std::vector<uint8_t>>>;
+    // Contiguous run of entries from the local store, ordered by seqno
+    std::deque<PendingTx> uncommitted_entries;
+    ccf::pal::Mutex uncommitted_entries_lock;
 
     ccf::TxID committed = {};
+    size_t lag_tx_count = 0;
 
     static bool tx_id_less(const ccf::TxID& a, const ccf::TxID& b)
     {
@@ -37,11 +90,6 @@ namespace ccf::indexing
       return a.view < b.view || a.seqno < b.seqno;
     }
 
-    static bool uncommitted_entries_cmp(const ccf::TxID& a, const PendingTx& b)
-    {
-      return tx_id_less(a, b.first);
-    }
-
     void update_commit(const ccf::TxID& tx_id)
     {
       if (tx_id_less(tx_id, committed))
@@ -55,51 +103,280 @@ namespace ccf::indexing
       committed = tx_id;
     }
 
+    std::optional<ccf::SeqNo> min_next_requested()
+    {
+      std::optional<ccf::SeqNo> min_requested = std::nullopt;
+      for (const auto& strategy : strategies)
+      {
+        const auto next_requested = strategy->next_requested();
+        if (
+          next_requested.has_value() &&
+          (!min_requested.has_value() || *next_requested < *min_requested))
+        {
+          min_requested = next_requested;
+        }
+      }
+      return min_requested;
+    }
+
+    // Deserialises the committed entries from the local store in [from,
+    // committed], stopping at the first which cannot be deserialised
+    void deserialise_buffered_entries(
+      ccf::SeqNo from, std::map<ccf::SeqNo, CommittedTx>& available)
+    {
+      std::vector<PendingTx> committed_entries;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(uncommitted_entries_lock);
+        for (const auto& entry : uncommitted_entries)
+        {
+          if (entry.first.seqno > committed.seqno)
+          {
+            break;
+          }
+          if (entry.first.seqno >= from)
+          {
+            committed_entries.push_back(entry);
+          }
+        }
+      }
+
+      for (const auto& [tx_id, data] : committed_entries)
+      {
+        auto store = transaction_fetcher->deserialise_transaction(
+          tx_id.seqno, data->data(), data->size());
+        if (store == nullptr)
+        {
+          // Leave this and later entries to be fetched instead
+          return;
+        }
+
+        available.emplace(tx_id.seqno, CommittedTx{tx_id, store});
+      }
+    }
+
+    void handle_batch(
+      const StrategyPtr& strategy,
+      const StrategyProgressPtr& strategy_progress,
+      std::vector<CommittedTx>&& batch)
+    {
+      strategy_progress->busy.store(true);
+
+      auto fn = [strategy, strategy_progress, batch = std::move(batch)]() {
+        const auto start = std::chrono::steady_clock::now();
+        size_t handled = 0;
+        try
+        {
+          for (const auto& [tx_id, store] : batch)
+          {
+            const auto next_requested = strategy->next_requested();
+            if (next_requested.has_value() && *next_requested == tx_id.seqno)
+            {
+              strategy->handle_committed_transaction(tx_id, store);
+              ++handled;
+            }
+          }
+        }
+        catch (const std::exception& e)
+        {
+          LOG_FAIL_FMT(
+            "Indexing strategy {} failed to handle transaction: {}",
+            strategy->get_name(),
+            e.what());
+        }
+
+        const auto elapsed =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        strategy_progress->indexed_tx_count += handled;
+        strategy_progress->indexing_time_us += elapsed.count();
+        strategy_progress->busy.store(false);
+      };
+
+      if (job_board == nullptr)
+      {
+        fn();
+      }
+      else
+      {
+        job_board->add_task(ccf::tasks::make_basic_task(
+          std::move(fn), fmt::format("Indexing {}", strategy->get_name())));
+      }
+    }
+
+    // Drops committed entries which no strategy still needs
+    void release_buffered_entries(std::optional<ccf::SeqNo> min_requested)
+    {
+      const auto release_below = min_requested.has_value() ?
+        std::min(*min_requested, committed.seqno + 1) :
+        committed.seqno + 1;
+
+      std::lock_guard<ccf::pal::Mutex> guard(uncommitted_entries_lock);
+      while (!uncommitted_entries.empty() &&
+             uncommitted_entries.front().first.seqno < release_below)
+      {
+        uncommitted_entries.pop_front();
+      }
+    }
+
   public:
-    Indexer(const std::shared_ptr<TransactionFetcher>& tf) :
-      transaction_fetcher(tf)
+    Indexer(
+      const std::shared_ptr<TransactionFetcher>& tf,
+      ccf::tasks::JobBoard* job_board_ = nullptr) :
+      transaction_fetcher(tf),
+      job_board(job_board_)
     {}
 
-    // Returns true if it looks like there's still a gap to fill. Useful for
-    // testing
-    bool update_strategies(
-      std::chrono::milliseconds /*elapsed*/, const ccf::TxID& newly_committed)
+    void append_entry(
+      const ccf::TxID& tx_id,
+      const std::shared_ptr<std::vector<uint8_t>>& entry) override
     {
-      update_commit(newly_committed);
+      std::lock_guard<ccf::pal::Mutex> guard(uncommitted_entries_lock);
 
-      std::optional<ccf::SeqNo> min_requested = std::nullopt;
+      // Entries must form a contiguous run. Anything at or after this seqno
+      // has been rolled back, and a gap (eg - after joining from a snapshot)
+      // leaves earlier entries to be fetched instead
+      while (!uncommitted_entries.empty() &&
+             uncommitted_entries.back().first.seqno >= tx_id.seqno)
+      {
+        uncommitted_entries.pop_back();
+      }
+      if (
+        !uncommitted_entries.empty() &&
+        uncommitted_entries.back().first.seqno + 1 != tx_id.seqno)
+      {
+        uncommitted_entries.clear();
+      }
+
+      uncommitted_entries.emplace_back(tx_id, entry);
+
+      // Strategies which fall this far behind are backfilled by the fetcher
+      if (uncommitted_entries.size() > MAX_BUFFERED)
+      {
+        uncommitted_entries.pop_front();
+      }
+    }
+
+    void rolled_back_to(ccf::kv::Version v) override
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(uncommitted_entries_lock);
+      while (!uncommitted_entries.empty() &&
+             uncommitted_entries.back().first.seqno > v)
+      {
+        uncommitted_entries.pop_back();
+      }
+    }
 
+    IndexingMetrics get_metrics()
+    {
+      IndexingMetrics metrics;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        metrics.committed_seqno = committed.seqno;
+        metrics.lag_tx_count = lag_tx_count;
+      }
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(uncommitted_entries_lock);
+        metrics.buffered_tx_count = uncommitted_entries.size();
+      }
+      return metrics;
+    }
+
+    nlohmann::json describe() override
+    {
       std::lock_guard<ccf::pal::Mutex> guard(lock);
+      auto j = nlohmann::json::array();
 
       for (const auto& strategy : strategies)
       {
-        strategy->tick();
+        auto strategy_j = strategy->describe();
 
         const auto next_requested = strategy->next_requested();
-        if (!next_requested.has_value())
+        strategy_j["lag_tx_count"] =
+          next_requested.has_value() && *next_requested <= committed.seqno ?
+          committed.seqno - *next_requested + 1 :
+          0;
+
+        const auto it = progress.find(strategy);
+        if (it != progress.end())
+        {
+          const size_t indexed = it->second->indexed_tx_count;
+          const size_t time_us = it->second->indexing_time_us;
+          strategy_j["indexed_tx_count"] = indexed;
+          strategy_j["indexed_tx_per_second"] =
+            time_us == 0 ? 0 : indexed * 1'000'000 / time_us;
+          strategy_j["busy"] = it->second->busy.load();
+        }
+
+        j.push_back(strategy_j);
+      }
+
+      return j;
+    }
+
+    // Returns true if it looks like there's still a gap to fill, or a
+    // strategy is still handling transactions. Useful for testing
+    bool update_strategies(
+      std::chrono::milliseconds /*elapsed*/, const ccf::TxID& newly_committed)
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
+
+      update_commit(newly_committed);
+
+      // Strategies still handling a previous batch are left to finish it
+      bool any_busy = false;
+      std::vector<std::tuple<StrategyPtr, StrategyProgressPtr, ccf::SeqNo>>
+        idle;
+      for (const auto& strategy : strategies)
+      {
+        auto& strategy_progress = progress[strategy];
+        if (strategy_progress == nullptr)
+        {
+          strategy_progress = std::make_shared<StrategyProgress>();
+        }
+
+        if (strategy_progress->busy.load())
         {
-          // If this strategy has an upper-bound on Txs it cares about, and
-          // we've already provided that, don't consider advancing it any
-          // further
+          any_busy = true;
           continue;
         }
 
-        if (!min_requested.has_value() || *next_requested < *min_requested)
+        strategy->tick();
+
+        const auto next_requested = strategy->next_requested();
+        if (next_requested.has_value() && *next_requested <= committed.seqno)
         {
-          min_requested = next_requested;
+          idle.emplace_back(strategy, strategy_progress, *next_requested);
         }
       }
+      std::erase_if(progress, [this](const auto& entry) {
+        return !strategies.contains(entry.first);
+      });
+
+      const auto min_requested = min_next_requested();
+      lag_tx_count = min_requested.has_value() &&
+          *min_requested <= committed.seqno ?
+        committed.seqno - *min_requested + 1 :
+        0;
 
-      if (min_requested.has_value())
+      bool gap = false;
+      if (!idle.empty())
       {
-        if (*min_requested <= committed.seqno)
+        ccf::SeqNo first_requested = std::get<2>(idle.front());
+        for (const auto& [strategy, strategy_progress, next] : idle)
+        {
+          first_requested = std::min(first_requested, next);
+        }
+
+        std::map<ccf::SeqNo, CommittedTx> available;
+        deserialise_buffered_entries(first_requested, available);
+
+        if (
+          available.empty() || available.begin()->first > first_requested)
         {
           // Request a prefix of the missing entries. Cap the requested range,
           // so we don't overload the node with a huge historical request
-          const auto first_requested = *min_requested;
-          auto additional = std::min(
-            MAX_REQUESTABLE - uncommitted_entries.size(),
-            committed.seqno - first_requested);
+          auto additional =
+            std::min(MAX_REQUESTABLE, committed.seqno - first_requested);
 
           SeqNoCollection seqnos;
           for (auto i = first_requested; i <= first_requested + additional; ++i)
@@ -111,23 +388,35 @@ namespace ccf::indexing
           for (auto& store : stores)
           {
             const ccf::TxID tx_id = store->current_txid();
+            available.emplace(tx_id.seqno, CommittedTx{tx_id, store});
+          }
 
-            for (const auto& strategy : strategies)
-            {
-              const auto next_requested = strategy->next_requested();
-              if (
-                next_requested.has_value() && (tx_id.seqno == *next_requested))
-              {
-                strategy->handle_committed_transaction(tx_id, store);
-              }
-            }
+          gap = true;
+        }
+
+        // Give each strategy the run of available transactions from its
+        // cursor
+        for (const auto& [strategy, strategy_progress, next] : idle)
+        {
+          std::vector<CommittedTx> batch;
+          for (auto it = available.find(next);
+               it != available.end() && it->first == next + batch.size();
+               ++it)
+          {
+            batch.push_back(it->second);
           }
 
-          return true;
+          if (!batch.empty())
+          {
+            handle_batch(strategy, strategy_progress, std::move(batch));
+            any_busy |= job_board != nullptr;
+          }
         }
       }
 
-      return false;
+      release_buffered_entries(min_next_requested());
+
+      return gap || any_busy;
     }
   };
-}
\ No newline at end of file
+}
@@ -0,0 +1,678 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "ccf/indexing/strategies/keys_by_field.h"
+
+#include "ccf/pal/locking.h"
+#include "ds/internal_logger.h"
+#include "ds/serialized.h"
+#include "indexing/lfs_interface.h"
+#include "kv/store.h"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
+
+namespace ccf::indexing::strategies
+{
+  struct KeysByField_Untyped::Impl
+  {
+  public:
+    using Keys = std::set<ccf::ByteVector>;
+    using Entries = std::map<ccf::ByteVector, Keys>;
+
+    struct Change
+    {
+      bool insert;
+      ccf::ByteVector secondary_key;
+      ccf::ByteVector primary_key;
+    };
+
+    struct Page
+    {
+      size_t id;
+
+      // Nullopt while this page is spilled to disk
+      std::optional<Entries> entries = Entries();
+
+      // Number of (secondary key, primary key) pairs in this page, whether
+      // resident or spilled
+      size_t key_count = 0;
+
+      // Changes made while this page is spilled, applied in-order when it is
+      // reloaded. Once there are keys_per_page of these, the page is fetched
+      // so that they can be merged without waiting for a query.
+      std::vector<Change> pending;
+
+      FetchResultPtr fetch = nullptr;
+      size_t spill_count = 0;
+    };
+
+    // Pages partition the secondary key space, and are keyed by their
+    // inclusive lower bound. The first page's bound is empty, so every
+    // secondary key belongs to exactly one page.
+    using Pages = std::map<ccf::ByteVector, Page>;
+    Pages pages;
+    size_t next_page_id = 0;
+
+    // Bounds of resident pages, most recently used first
+    std::list<ccf::ByteVector> resident;
+
+    // Bounds of spilled pages with an outstanding fetch
+    std::set<ccf::ByteVector> fetching;
+
+    // Current secondary key of every indexed primary key
+    std::unordered_map<ccf::ByteVector, ccf::ByteVector> secondary_keys;
+
+    Extractor extractor;
+
+    const size_t keys_per_page;
+    const size_t max_resident_pages;
+
+    // Incremented whenever the index is rebuilt, so that blobs written by a
+    // previous build are never mistaken for those of the current build
+    size_t generation = 0;
+
+    // When index_access and current_txid_lock need to be
+    // taken at the same time, index_access should be first
+    ccf::pal::Mutex index_access;
+
+    std::string name;
+
+    // May be null, in which case the entire index is kept in memory
+    std::shared_ptr<AbstractLFSAccess> lfs_access;
+
+    ccf::pal::Mutex& current_txid_lock;
+    ccf::TxID& current_txid;
+
+    Impl(
+      std::string name_,
+      Extractor extractor_,
+      ccf::pal::Mutex& current_txid_lock_,
+      ccf::TxID& current_txid_,
+      std::shared_ptr<AbstractLFSAccess> lfs_access_,
+      size_t keys_per_page_,
+      size_t max_resident_pages_) :
+      extractor(std::move(extractor_)),
+      keys_per_page(keys_per_page_),
+      max_resident_pages(max_resident_pages_),
+      name(std::move(name_)),
+      lfs_access(std::move(lfs_access_)),
+      current_txid_lock(current_txid_lock_),
+      current_txid(current_txid_)
+    {
+      if (keys_per_page < 2 || max_resident_pages == 0)
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot create {} with pages of {} keys, of which {} may be resident",
+          name,
+          keys_per_page,
+          max_resident_pages));
+      }
+
+      reset();
+    }
+
+    void reset()
+    {
+      pages.clear();
+      resident.clear();
+      fetching.clear();
+      secondary_keys.clear();
+      ++generation;
+
+      pages.emplace(ccf::ByteVector(), Page{next_page_id++});
+      touch(ccf::ByteVector());
+    }
+
+    Pages::iterator page_for(const ccf::ByteVector& secondary_key)
+    {
+      return std::prev(pages.upper_bound(secondary_key));
+    }
+
+    void touch(const ccf::ByteVector& bound)
+    {
+      if (lfs_access == nullptr)
+      {
+        // Every page is always resident
+        return;
+      }
+
+      const auto it = std::find(resident.begin(), resident.end(), bound);
+      if (it != resident.end())
+      {
+        resident.splice(resident.begin(), resident, it);
+      }
+      else
+      {
+        resident.push_front(bound);
+      }
+    }
+
+    static bool apply_to_entries(Entries& entries, const Change& change)
+    {
+      if (change.insert)
+      {
+        return entries[change.secondary_key].insert(change.primary_key).second;
+      }
+
+      const auto it = entries.find(change.secondary_key);
+      if (it == entries.end() || it->second.erase(change.primary_key) == 0)
+      {
+        return false;
+      }
+      if (it->second.empty())
+      {
+        entries.erase(it);
+      }
+      return true;
+    }
+
+    void apply(Change&& change)
+    {
+      const auto page_it = page_for(change.secondary_key);
+      auto& page = page_it->second;
+      if (change.insert)
+      {
+        ++page.key_count;
+      }
+      else
+      {
+        --page.key_count;
+      }
+
+      if (!page.entries.has_value())
+      {
+        page.pending.push_back(std::move(change));
+        if (page.pending.size() >= keys_per_page)
+        {
+          start_fetch(page_it);
+        }
+        return;
+      }
+
+      apply_to_entries(*page.entries, change);
+      touch(page_it->first);
+      maybe_split(page_it);
+    }
+
+    void maybe_split(Pages::iterator page_it)
+    {
+      auto& page = page_it->second;
+      if (
+        page.key_count <= keys_per_page || !page.entries.has_value() ||
+        page.entries->size() < 2)
+      {
+        return;
+      }
+
+      // Split at the first secondary key past the midpoint, leaving at least
+      // one secondary key in the lower page
+      auto split_it = std::next(page.entries->begin());
+      size_t lower_count = page.entries->begin()->second.size();
+      while (std::next(split_it) != page.entries->end() &&
+             lower_count + split_it->second.size() <= page.key_count / 2)
+      {
+        lower_count += split_it->second.size();
+        ++split_it;
+      }
+
+      Page upper{next_page_id++};
+      upper.entries = Entries(split_it, page.entries->end());
+      upper.key_count = page.key_count - lower_count;
+      page.entries->erase(split_it, page.entries->end());
+      page.key_count = lower_count;
+
+      const auto bound = upper.entries->begin()->first;
+      pages.emplace(bound, std::move(upper));
+      touch(bound);
+    }
+
+    LFSKey get_blob_name(const Page& page)
+    {
+      return fmt::format(
+        "{}: page {}.{} v{}", name, generation, page.id, page.spill_count);
+    }
+
+    static LFSContents serialise(const Entries& entries)
+    {
+      size_t size = sizeof(size_t);
+      for (const auto& [sk, pks] : entries)
+      {
+        size += 2 * sizeof(size_t) + sk.size();
+        for (const auto& pk : pks)
+        {
+          size += sizeof(size_t) + pk.size();
+        }
+      }
+
+      LFSContents blob(size);
+      auto* data = blob.data();
+      serialized::write(data, size, entries.size());
+      for (const auto& [sk, pks] : entries)
+      {
+        serialized::write(data, size, sk.size());
+        serialized::write(data, size, sk.data(), sk.size());
+        serialized::write(data, size, pks.size());
+        for (const auto& pk : pks)
+        {
+          serialized::write(data, size, pk.size());
+          serialized::write(data, size, pk.data(), pk.size());
+        }
+      }
+      return blob;
+    }
+
+    static std::optional<Entries> deserialise(const LFSContents& raw)
+    {
+      try
+      {
+        const auto* data = raw.data();
+        auto size = raw.size();
+
+        Entries entries;
+        const auto sk_count = serialized::read<size_t>(data, size);
+        for (size_t i = 0; i < sk_count; ++i)
+        {
+          const auto sk_size = serialized::read<size_t>(data, size);
+          const auto sk = serialized::read(data, size, sk_size);
+          auto& pks = entries[ccf::ByteVector(sk.begin(), sk.end())];
+          const auto pk_count = serialized::read<size_t>(data, size);
+          for (size_t j = 0; j < pk_count; ++j)
+          {
+            const auto pk_size = serialized::read<size_t>(data, size);
+            const auto pk = serialized::read(data, size, pk_size);
+            pks.emplace(pk.begin(), pk.end());
+          }
+        }
+
+        if (size != 0)
+        {
+          LOG_TRACE_FMT("{} bytes remaining after deserialisation", size);
+          return std::nullopt;
+        }
+
+        return entries;
+      }
+      // Catch errors thrown by serialized::read
+      catch (const serialized::InsufficientSpaceException& e)
+      {
+        return std::nullopt;
+      }
+    }
+
+    // Spills the least recently used pages, beyond the resident limit. The
+    // first pinned pages in the resident list are kept regardless.
+    void spill_excess_pages(size_t pinned = 0)
+    {
+      if (lfs_access == nullptr)
+      {
+        return;
+      }
+
+      while (resident.size() > std::max(max_resident_pages, pinned))
+      {
+        auto& page = pages.at(resident.back());
+        ++page.spill_count;
+        lfs_access->store(get_blob_name(page), serialise(*page.entries));
+        page.entries.reset();
+        resident.pop_back();
+      }
+    }
+
+    void start_fetch(Pages::iterator page_it)
+    {
+      auto& page = page_it->second;
+      if (page.fetch == nullptr)
+      {
+        page.fetch = lfs_access->fetch(get_blob_name(page));
+        fetching.insert(page_it->first);
+      }
+    }
+
+    enum class LoadResult
+    {
+      Loaded,
+      Fetching,
+      Unavailable
+    };
+
+    // Makes the given page resident, if its fetch has completed, applying
+    // any changes made while it was spilled. Otherwise starts fetching it.
+    LoadResult load(Pages::iterator page_it)
+    {
+      auto& page = page_it->second;
+      if (page.entries.has_value())
+      {
+        touch(page_it->first);
+        return LoadResult::Loaded;
+      }
+
+      if (page.fetch == nullptr)
+      {
+        start_fetch(page_it);
+        return LoadResult::Fetching;
+      }
+
+      const auto fetch_result = page.fetch->fetch_result.load();
+      if (fetch_result == FetchResult::FetchResultType::Fetching)
+      {
+        return LoadResult::Fetching;
+      }
+
+      std::optional<Entries> entries = std::nullopt;
+      if (fetch_result == FetchResult::FetchResultType::Loaded)
+      {
+        entries = deserialise(page.fetch->contents);
+      }
+
+      if (!entries.has_value())
+      {
+        LOG_FAIL_FMT(
+          "A file that {} requires is unavailable. Re-indexing.", name);
+        LOG_DEBUG_FMT("The unavailable file is {}", page.fetch->key);
+        return LoadResult::Unavailable;
+      }
+
+      for (const auto& change : page.pending)
+      {
+        apply_to_entries(*entries, change);
+      }
+      page.pending.clear();
+      page.entries = std::move(entries);
+      page.fetch = nullptr;
+      fetching.erase(page_it->first);
+      touch(page_it->first);
+      return LoadResult::Loaded;
+    }
+
+    // Merges the pending changes of every page whose fetch has completed.
+    // Returns false if any of those pages is unavailable, in which case the
+    // index must be rebuilt.
+    bool load_fetched_pages()
+    {
+      const auto bounds = fetching;
+      for (const auto& bound : bounds)
+      {
+        const auto page_it = pages.find(bound);
+        if (load(page_it) == LoadResult::Unavailable)
+        {
+          return false;
+        }
+        maybe_split(page_it);
+      }
+      return true;
+    }
+
+    // This class previously wrote a page to disk which is no longer available
+    // or is corrupted. Re-index from the start of time to rebuild it.
+    void reindex()
+    {
+      {
+        std::lock_guard<ccf::pal::Mutex> current_txid_guard(current_txid_lock);
+        current_txid = {};
+      }
+      reset();
+    }
+
+    // Runs after every query, so that pages split when they grow too large
+    // and the resident set is kept within its limit. If the query is still
+    // waiting for some of its pages, those which are already resident (and
+    // so were most recently used) are kept, so that it can eventually
+    // complete.
+    void maintain(const std::vector<Pages::iterator>& needed, bool complete)
+    {
+      if (!complete)
+      {
+        const auto pinned = std::count_if(
+          needed.begin(), needed.end(), [](const auto& page_it) {
+            return page_it->second.entries.has_value();
+          });
+        spill_excess_pages(static_cast<size_t>(pinned));
+        return;
+      }
+
+      for (auto page_it : needed)
+      {
+        maybe_split(page_it);
+      }
+      spill_excess_pages();
+    }
+
+    void handle_write(
+      const ccf::ByteVector& k, const std::optional<ccf::ByteVector>& v)
+    {
+      std::optional<ccf::ByteVector> secondary_key = std::nullopt;
+      if (v.has_value())
+      {
+        secondary_key = extractor(k, *v);
+      }
+
+      const auto it = secondary_keys.find(k);
+      if (it != secondary_keys.end())
+      {
+        if (secondary_key == it->second)
+        {
+          return;
+        }
+
+        apply({false, it->second, k});
+        secondary_keys.erase(it);
+      }
+
+      if (secondary_key.has_value())
+      {
+        apply({true, *secondary_key, k});
+        secondary_keys.emplace(k, std::move(*secondary_key));
+      }
+    }
+
+    // Visits the resident entries with secondary keys from lower onwards,
+    // until the visitor returns false. Returns nullopt if any page which may
+    // be visited is spilled, after starting to fetch it.
+    std::optional<std::vector<ccf::ByteVector>> get_keys(
+      const ccf::ByteVector& lower,
+      const std::function<bool(const ccf::ByteVector&)>& past_end,
+      std::optional<size_t> max_keys)
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(index_access);
+
+      std::vector<Pages::iterator> needed;
+      for (auto it = page_for(lower);
+           it != pages.end() && (needed.empty() || !past_end(it->first));
+           ++it)
+      {
+        needed.push_back(it);
+      }
+
+      bool complete = true;
+      for (auto page_it : needed)
+      {
+        const auto result = load(page_it);
+        if (result == LoadResult::Unavailable)
+        {
+          reindex();
+          return std::nullopt;
+        }
+        complete &= result == LoadResult::Loaded;
+      }
+
+      std::optional<std::vector<ccf::ByteVector>> keys = std::nullopt;
+      if (complete)
+      {
+        keys = collect_keys(needed, lower, past_end, max_keys);
+      }
+
+      // Pages split after reloading, or loaded for this query, may take the
+      // resident set over its limit
+      maintain(needed, complete);
+
+      return keys;
+    }
+
+    static std::vector<ccf::ByteVector> collect_keys(
+      const std::vector<Pages::iterator>& needed,
+      const ccf::ByteVector& lower,
+      const std::function<bool(const ccf::ByteVector&)>& past_end,
+      std::optional<size_t> max_keys)
+    {
+      std::vector<ccf::ByteVector> keys;
+      for (auto page_it : needed)
+      {
+        const auto& entries = *page_it->second.entries;
+        for (auto it = entries.lower_bound(lower);
+             it != entries.end() && !past_end(it->first);
+             ++it)
+        {
+          for (const auto& pk : it->second)
+          {
+            if (max_keys.has_value() && keys.size() >= *max_keys)
+            {
+              return keys;
+            }
+            keys.push_back(pk);
+          }
+        }
+      }
+      return keys;
+    }
+  };
+
+  KeysByField_Untyped::KeysByField_Untyped(
+    const std::string& map_name_,
+    const std::string& field_name,
+    Extractor extractor) :
+    Strategy(fmt::format("KeysByField {} {}", map_name_, field_name)),
+    map_name(map_name_)
+  {
+    impl = std::make_shared<Impl>(
+      get_name(),
+      std::move(extractor),
+      current_txid_lock,
+      current_txid,
+      nullptr,
+      1000,
+      1);
+  }
+
+  KeysByField_Untyped::KeysByField_Untyped(
+    const std::string& map_name_,
+    const std::string& field_name,
+    Extractor extractor,
+    ccf::AbstractNodeContext& node_context,
+    size_t keys_per_page_,
+    size_t max_resident_pages_) :
+    Strategy(fmt::format("KeysByField {} {}", map_name_, field_name)),
+    map_name(map_name_)
+  {
+    auto lfs_access = node_context.get_subsystem<AbstractLFSAccess>();
+    if (lfs_access == nullptr)
+    {
+      throw std::logic_error(fmt::format(
+        "Cannot create {} without access to the LFS subsystem", get_name()));
+    }
+
+    impl = std::make_shared<Impl>(
+      get_name(),
+      std::move(extractor),
+      current_txid_lock,
+      current_txid,
+      lfs_access,
+      keys_per_page_,
+      max_resident_pages_);
+  }
+
+  void KeysByField_Untyped::handle_committed_transaction(
+    const ccf::TxID& tx_id, const ccf::kv::ReadOnlyStorePtr& store)
+  {
+    // NB: Get an untyped diff over the map with the same name, so that
+    // removals are visible as well as writes
+    auto tx_diff = store->create_tx_diff();
+    auto* diff = tx_diff.diff<ccf::kv::untyped::Map>(map_name);
+
+    std::lock_guard<ccf::pal::Mutex> guard(impl->index_access);
+    diff->foreach([this](const auto& k, const auto& v) {
+      impl->handle_write(k, v);
+      return true;
+    });
+
+    // Merge the changes buffered for spilled pages as soon as they have been
+    // fetched, rather than waiting for a query to need them
+    if (!impl->load_fetched_pages())
+    {
+      impl->reindex();
+      return;
+    }
+    impl->spill_excess_pages();
+
+    std::lock_guard<ccf::pal::Mutex> current_txid_guard(current_txid_lock);
+    current_txid = tx_id;
+  }
+
+  std::optional<ccf::SeqNo> KeysByField_Untyped::next_requested()
+  {
+    std::lock_guard<ccf::pal::Mutex> guard(current_txid_lock);
+    return current_txid.seqno + 1;
+  }
+
+  nlohmann::json KeysByField_Untyped::describe()
+  {
+    auto j = Strategy::describe();
+    j["target_map"] = map_name;
+    j["indexed_watermark"] = get_indexed_watermark();
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(impl->index_access);
+      j["indexed_key_count"] = impl->secondary_keys.size();
+      j["page_count"] = impl->pages.size();
+      j["resident_page_count"] = impl->lfs_access == nullptr ?
+        impl->pages.size() :
+        impl->resident.size();
+      j["keys_per_page"] = impl->keys_per_page;
+      size_t pending_change_count = 0;
+      for (const auto& [_, page] : impl->pages)
+      {
+        pending_change_count += page.pending.size();
+      }
+      j["pending_change_count"] = pending_change_count;
+    }
+    return j;
+  }
+
+  ccf::TxID KeysByField_Untyped::get_indexed_watermark()
+  {
+    std::lock_guard<ccf::pal::Mutex> guard(current_txid_lock);
+    return current_txid;
+  }
+
+  std::optional<std::vector<ccf::ByteVector>> KeysByField_Untyped::
+    get_keys_in_range_impl(
+      const ccf::ByteVector& from,
+      const ccf::ByteVector& to,
+      std::optional<size_t> max_keys)
+  {
+    if (to < from)
+    {
+      throw std::logic_error("Range of secondary keys goes backwards");
+    }
+
+    return impl->get_keys(
+      from,
+      [&to](const ccf::ByteVector& sk) { return to < sk; },
+      max_keys);
+  }
+
+  std::optional<std::vector<ccf::ByteVector>> KeysByField_Untyped::
+    get_keys_with_prefix_impl(
+      const ccf::ByteVector& prefix, std::optional<size_t> max_keys)
+  {
+    return impl->get_keys(
+      prefix,
+      [&prefix](const ccf::ByteVector& sk) {
+        return !(
+          sk.size() >= prefix.size() &&
+          std::equal(prefix.begin(), prefix.end(), sk.begin()));
+      },
+      max_keys);
+  }
+}
@@ -3,35 +3,134 @@
 
 #include "ccf/indexing/strategies/seqnos_by_key_bucketed.h"
 
-#include "ccf/ds/hex.h"
+#include "ccf/ds/hash.h"
 #include "ccf/pal/locking.h"
 #include "ds/internal_logger.h"
 #include "ds/lru.h"
-#include "ds/serialized.h"
 #include "indexing/lfs_interface.h"
 #include "kv/kv_types.h"
 
+#include <algorithm>
+#include <list>
+#include <map>
+
 namespace ccf::indexing::strategies
 {
   struct SeqnosByKey_Bucketed_Untyped::Impl
   {
   public:
     const size_t seqnos_per_bucket;
+    const size_t max_buckets;
 
     // Inclusive begin, exclusive end
     using Range = std::pair<ccf::SeqNo, ccf::SeqNo>;
 
-    // Store a single bucket of current results for each key
-    using CurrentResult = std::pair<Range, SeqNoCollection>;
-    std::unordered_map<ccf::ByteVector, CurrentResult> current_results;
+    // The index is an append-only log of sorted runs. Writes for the current
+    // bucket are accumulated in memory, and when a write for a later bucket
+    // arrives they are flushed as an immutable run of (key, seqno) entries,
+    // sorted by key then seqno. Each run is split into blocks of at most
+    // seqnos_per_bucket entries, and each block is a separately encrypted blob
+    // in the LFS. Adjacent runs of the same size are periodically compacted
+    // into a single larger run, so a key with a long history is held in a few
+    // contiguous blocks rather than spread across many small ones.
+    using Entries = std::map<ccf::ByteVector, SeqNoCollection>;
+    Entries memtable;
+    std::optional<Range> memtable_range = std::nullopt;
+
+    // Number of adjacent runs of a level which are merged into a single run of
+    // the next level, and the level at which runs are no longer compacted
+    static constexpr size_t compaction_fanout = 4;
+    static constexpr size_t max_compaction_level = 3;
+
+    // Bloom filter over the keys written in a run, so that queries can skip
+    // runs which do not contain the requested key without fetching anything
+    class KeyFilter
+    {
+      static constexpr size_t bits_per_key = 10;
+      static constexpr size_t hash_count = 7;
+
+      std::vector<uint64_t> bits;
+
+      template <typename F>
+      void for_each_bit(const ccf::ByteVector& k, F&& f) const
+      {
+        const auto h1 = std::hash<ccf::ByteVector>{}(k);
+        const std::string_view sv(
+          reinterpret_cast<const char*>(k.data()), k.size());
+        const auto h2 = ccf::ds::fnv_1a<uint64_t>(sv) | 1;
+        const auto bit_count = bits.size() * 64;
+        for (size_t i = 0; i < hash_count; ++i)
+        {
+          f((h1 + i * h2) % bit_count);
+        }
+      }
+
+    public:
+      KeyFilter(size_t key_count) :
+        bits(std::max<size_t>(1, (key_count * bits_per_key + 63) / 64))
+      {}
+
+      void insert(const ccf::ByteVector& k)
+      {
+        for_each_bit(k, [this](size_t n) { bits[n / 64] |= 1ull << (n % 64); });
+      }
+
+      [[nodiscard]] bool may_contain(const ccf::ByteVector& k) const
+      {
+        bool found = true;
+        for_each_bit(k, [&](size_t n) {
+          found &= (bits[n / 64] & (1ull << (n % 64))) != 0;
+        });
+        return found;
+      }
+    };
+
+    // Sparse index entry, describing the first entry in each block of a run
+    struct BlockStart
+    {
+      ccf::ByteVector key;
+      ccf::SeqNo seqno;
+    };
+
+    struct Run
+    {
+      size_t id;
+      size_t level;
+
+      // Inclusive range of seqnos covered by this run
+      ccf::SeqNo first_seqno;
+      ccf::SeqNo last_seqno;
+
+      KeyFilter keys;
+      std::vector<BlockStart> blocks;
+
+      bool compacting = false;
+    };
+
+    // Ordered by seqno range, with no overlaps between runs
+    std::vector<Run> runs;
+    size_t next_run_id = 0;
+
+    // Incremented whenever the index is rebuilt, so that blobs written by a
+    // previous build are never mistaken for those of the current build
+    size_t generation = 0;
 
-    // Maintain an LRU of old, requested buckets, which are asynchronously
+    struct Compaction
+    {
+      std::vector<size_t> run_ids;
+      size_t level;
+      std::vector<FetchResultPtr> blocks;
+    };
+    std::list<Compaction> compactions;
+
+    // Maintain an LRU of old, requested blocks, which are asynchronously
     // fetched from disk
-    using BucketKey = std::pair<ccf::ByteVector, Range>;
+    using Block =
+      std::vector<std::pair<ccf::ByteVector, std::vector<ccf::SeqNo>>>;
     // First element is a handle while result is being fetched. Second is parsed
     // result, after fetch completes, at which point the first is set to nullptr
-    using BucketValue = std::pair<FetchResultPtr, SeqNoCollection>;
-    LRU<BucketKey, BucketValue> old_results;
+    using BlockValue = std::pair<FetchResultPtr, Block>;
+    LRU<LFSKey, BlockValue> old_results;
 
     // When results_access and current_txid_lock need to be
     // taken at the same time, results_access should be first
@@ -52,7 +151,11 @@ namespace ccf::indexing::strategies
       size_t seqnos_per_bucket_,
       size_t max_buckets_) :
       seqnos_per_bucket(seqnos_per_bucket_),
-      old_results(max_buckets_),
+      max_buckets(max_buckets_),
+      // A range spanning max_buckets buckets touches at most max_buckets
+      // runs. In each of those, the requested key's entries fill at most one
+      // block per bucket, plus a partial block at either end
+      old_results(3 * max_buckets_),
       name(std::move(name_)),
       lfs_access(lfs_access_),
       current_txid_lock(current_txid_lock_),
@@ -65,33 +168,59 @@ namespace ccf::indexing::strategies
       }
     }
 
-    static LFSContents serialise(SeqNoCollection&& seqnos)
+    static void write_varint(LFSContents& blob, uint64_t n)
     {
-      LFSContents blob;
-
+      while (n >= 0x80)
       {
-        // Write number of seqnos
-        const auto orig_size = blob.size();
-        blob.resize(orig_size + sizeof(seqnos.size()));
-        auto* data = blob.data() + orig_size;
-        auto size = blob.size() - orig_size;
-        serialized::write(data, size, seqnos.size());
+        blob.push_back(static_cast<uint8_t>(n | 0x80));
+        n >>= 7;
       }
+      blob.push_back(static_cast<uint8_t>(n));
+    }
 
-      // Write each seqno
-      for (const auto& seqno : seqnos)
+    static uint64_t read_varint(const uint8_t*& data, size_t& size)
+    {
+      uint64_t n = 0;
+      for (size_t shift = 0; shift < 64; shift += 7)
       {
-        const auto orig_size = blob.size();
-        blob.resize(orig_size + sizeof(seqno));
-        auto* data = blob.data() + orig_size;
-        auto size = blob.size() - orig_size;
-        serialized::write(data, size, seqno);
+        if (size == 0)
+        {
+          throw std::logic_error("Insufficient space to read varint");
+        }
+        const auto byte = *data++;
+        --size;
+        n |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+          return n;
+        }
       }
+      throw std::logic_error("Varint is too long");
+    }
 
+    // Each block is a sequence of keys, each followed by its sorted seqnos in
+    // the block. Seqnos are delta-encoded, so dense histories cost roughly a
+    // byte per entry
+    static LFSContents serialise(const Block& block)
+    {
+      LFSContents blob;
+      write_varint(blob, block.size());
+      for (const auto& [k, seqnos] : block)
+      {
+        write_varint(blob, k.size());
+        blob.insert(blob.end(), k.begin(), k.end());
+        write_varint(blob, seqnos.size());
+        ccf::SeqNo prev = 0;
+        for (const auto seqno : seqnos)
+        {
+          write_varint(blob, seqno - prev);
+          prev = seqno;
+        }
+      }
       return blob;
     }
 
-    SeqNoCollection deserialise(const LFSContents& raw, bool& corrupt)
+    static Block deserialise(const LFSContents& raw, bool& corrupt)
     {
       corrupt = false;
       try
@@ -99,13 +228,36 @@ namespace ccf::indexing::strategies
         const auto* data = raw.data();
         auto size = raw.size();
 
-        // Read number of seqnos
-        const auto seqno_count = serialized::read<size_t>(data, size);
-        SeqNoCollection seqnos;
-
-        for (auto j = 0U; j < seqno_count; ++j)
+        Block block;
+        const auto key_count = read_varint(data, size);
+        for (auto i = 0U; i < key_count; ++i)
         {
-          seqnos.insert(serialized::read<ccf::SeqNo>(data, size));
+          const auto key_size = read_varint(data, size);
+          if (key_size > size)
+          {
+            corrupt = true;
+            return {};
+          }
+          ccf::ByteVector k(data, data + key_size);
+          data += key_size;
+          size -= key_size;
+
+          if (!block.empty() && !(block.back().first < k))
+          {
+            LOG_TRACE_FMT("Keys in block are not sorted");
+            corrupt = true;
+            return {};
+          }
+
+          std::vector<ccf::SeqNo> seqnos;
+          const auto seqno_count = read_varint(data, size);
+          ccf::SeqNo seqno = 0;
+          for (auto j = 0U; j < seqno_count; ++j)
+          {
+            seqno += read_varint(data, size);
+            seqnos.push_back(seqno);
+          }
+          block.emplace_back(std::move(k), std::move(seqnos));
         }
 
         if (size != 0)
@@ -115,9 +267,9 @@ namespace ccf::indexing::strategies
           return {};
         }
 
-        return seqnos;
+        return block;
       }
-      // Catch errors thrown by serialized::read
+      // Catch errors thrown by read_varint
       catch (const std::logic_error& e)
       {
         corrupt = true;
@@ -125,35 +277,204 @@ namespace ccf::indexing::strategies
       }
     }
 
-    LFSKey get_blob_name(const BucketKey& bk)
+    LFSKey get_blob_name(const Run& run, size_t block_idx)
     {
-      const auto hex_key = ds::to_hex(bk.first.begin(), bk.first.end());
-      const auto& range = bk.second;
       return fmt::format(
-        "{}: {} -> {} for {}", name, range.first, range.second, hex_key);
+        "{}: run {}.{} [{}, {}] block {}",
+        name,
+        generation,
+        run.id,
+        run.first_seqno,
+        run.last_seqno,
+        block_idx);
+    }
+
+    Run write_run(
+      size_t level,
+      ccf::SeqNo first_seqno,
+      ccf::SeqNo last_seqno,
+      const Entries& entries)
+    {
+      Run run{
+        next_run_id++,
+        level,
+        first_seqno,
+        last_seqno,
+        KeyFilter(entries.size())};
+
+      Block block;
+      size_t block_entries = 0;
+      auto store_block = [&]() {
+        if (block.empty())
+        {
+          return;
+        }
+        const auto& [first_key, first_seqnos] = block.front();
+        run.blocks.push_back({first_key, first_seqnos.front()});
+        lfs_access->store(
+          get_blob_name(run, run.blocks.size() - 1), serialise(block));
+        block.clear();
+        block_entries = 0;
+      };
+
+      for (const auto& [k, seqnos] : entries)
+      {
+        run.keys.insert(k);
+        for (const auto seqno : seqnos)
+        {
+          if (block.empty() || block.back().first != k)
+          {
+            block.emplace_back(k, std::vector<ccf::SeqNo>{});
+          }
+          block.back().second.push_back(seqno);
+          if (++block_entries >= seqnos_per_bucket)
+          {
+            store_block();
+          }
+        }
+      }
+      store_block();
+
+      LOG_TRACE_FMT(
+        "Stored level {} run covering [{}, {}] for {} keys in {} blocks",
+        level,
+        first_seqno,
+        last_seqno,
+        entries.size(),
+        run.blocks.size());
+
+      return run;
+    }
+
+    void flush_memtable()
+    {
+      if (!memtable_range.has_value())
+      {
+        return;
+      }
+
+      runs.push_back(write_run(
+        0, memtable_range->first, memtable_range->second - 1, memtable));
+      memtable.clear();
+      memtable_range.reset();
+
+      progress_compaction();
     }
 
-    void store_empty_buckets(
-      const ccf::ByteVector& k, Range begin, const Range& end)
+    // Compaction needs the contents of the runs being merged, which must be
+    // fetched asynchronously. This is driven from flushes: each flush merges
+    // any groups of runs whose fetches have completed, and begins fetching
+    // the next groups of runs to compact
+    void progress_compaction()
     {
-      while (begin != end)
+      for (auto it = compactions.begin(); it != compactions.end();)
+      {
+        const auto fetched = std::none_of(
+          it->blocks.begin(), it->blocks.end(), [](const auto& fetch) {
+            return fetch->fetch_result ==
+              ccf::indexing::FetchResult::FetchResultType::Fetching;
+          });
+        if (fetched)
+        {
+          complete_compaction(*it);
+          it = compactions.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+
+      // Find groups of adjacent runs at the same level, which are not already
+      // being compacted
+      size_t group_begin = 0;
+      for (size_t i = 0; i < runs.size(); ++i)
       {
-        LOG_TRACE_FMT(
-          "Storing empty bucket for range [{}, {}) for key {:02x}",
-          begin.first,
-          begin.second,
-          fmt::join(k, ""));
-        store_to_disk(k, begin, {});
-        begin = get_range_for(begin.second);
+        if (runs[i].compacting || runs[i].level >= max_compaction_level)
+        {
+          group_begin = i + 1;
+          continue;
+        }
+
+        if (runs[i].level != runs[group_begin].level)
+        {
+          group_begin = i;
+        }
+
+        if (i + 1 - group_begin == compaction_fanout)
+        {
+          Compaction c;
+          c.level = runs[i].level + 1;
+          for (auto j = group_begin; j <= i; ++j)
+          {
+            runs[j].compacting = true;
+            c.run_ids.push_back(runs[j].id);
+            for (size_t b = 0; b < runs[j].blocks.size(); ++b)
+            {
+              c.blocks.push_back(
+                lfs_access->fetch(get_blob_name(runs[j], b)));
+            }
+          }
+          compactions.push_back(std::move(c));
+          group_begin = i + 1;
+        }
       }
     }
 
-    void store_to_disk(
-      const ccf::ByteVector& k, const Range& range, SeqNoCollection&& seqnos)
+    void complete_compaction(const Compaction& compaction)
     {
-      const BucketKey bucket_key{k, range};
-      const auto blob_key = get_blob_name(bucket_key);
-      lfs_access->store(blob_key, serialise(std::move(seqnos)));
+      const auto first_it = std::find_if(
+        runs.begin(), runs.end(), [&compaction](const Run& run) {
+          return run.id == compaction.run_ids.front();
+        });
+      const auto run_count = compaction.run_ids.size();
+      if (
+        first_it == runs.end() ||
+        static_cast<size_t>(std::distance(first_it, runs.end())) < run_count)
+      {
+        return;
+      }
+
+      Entries merged;
+      for (const auto& fetch : compaction.blocks)
+      {
+        bool corrupt =
+          fetch->fetch_result !=
+          ccf::indexing::FetchResult::FetchResultType::Loaded;
+        Block block;
+        if (!corrupt)
+        {
+          block = deserialise(fetch->contents, corrupt);
+        }
+
+        if (corrupt)
+        {
+          // Leave the runs uncompacted. If a query needs this file, it will
+          // trigger a re-index
+          LOG_FAIL_FMT(
+            "Unable to compact runs of {}, as a file is unavailable", name);
+          LOG_DEBUG_FMT("The unavailable file is {}", fetch->key);
+          return;
+        }
+
+        for (auto& [k, seqnos] : block)
+        {
+          auto& merged_seqnos = merged[k];
+          for (const auto seqno : seqnos)
+          {
+            merged_seqnos.insert(seqno);
+          }
+        }
+      }
+
+      const auto last_it = first_it + run_count;
+      auto run = write_run(
+        compaction.level,
+        first_it->first_seqno,
+        (last_it - 1)->last_seqno,
+        merged);
+      const auto pos = runs.erase(first_it, last_it);
+      runs.insert(pos, std::move(run));
     }
 
     Range get_range_for(ccf::SeqNo seqno) const
@@ -163,6 +484,21 @@ namespace ccf::indexing::strategies
       return {begin, end};
     }
 
+    void visit_entry(const ccf::TxID& tx_id, const ccf::ByteVector& k)
+    {
+      const auto range = get_range_for(tx_id.seqno);
+
+      std::lock_guard<ccf::pal::Mutex> guard(results_access);
+
+      if (memtable_range.has_value() && memtable_range.value() != range)
+      {
+        flush_memtable();
+      }
+
+      memtable_range = range;
+      memtable[k].insert(tx_id.seqno);
+    }
+
     std::optional<SeqNoCollection> get_write_txs_impl(
       const ccf::ByteVector& serialised_key, ccf::SeqNo from, ccf::SeqNo to)
     {
@@ -180,14 +516,13 @@ namespace ccf::indexing::strategies
         return std::nullopt;
       }
 
-      auto from_range = get_range_for(from);
-      const auto to_range = get_range_for(to);
-
       // Check that once the entire requested range is fetched, it will fit
       // into the LRU at the same time
       const auto range_len = to - from;
       if (range_len > max_requestable_range())
       {
+        const auto from_range = get_range_for(from);
+        const auto to_range = get_range_for(to);
         throw std::logic_error(fmt::format(
           "Requesting transactions from {} to {} requires buckets covering "
           "[{}, {}). These {} transactions are larger than the maximum "
@@ -200,149 +535,181 @@ namespace ccf::indexing::strategies
           max_requestable_range()));
       }
 
-      SeqNoCollection result;
+      std::lock_guard<ccf::pal::Mutex> guard(results_access);
 
-      auto append_bucket_result = [&](const SeqNoCollection& seqnos) {
-        for (auto n : seqnos)
+      // Find the blocks which may contain the requested entries, using each
+      // run's seqno range, key filter, and sparse block index
+      std::vector<LFSKey> blob_names;
+      const auto block_before = [](const BlockStart& a, const BlockStart& b) {
+        return std::tie(a.key, a.seqno) < std::tie(b.key, b.seqno);
+      };
+      const BlockStart range_begin{serialised_key, from};
+      const BlockStart range_end{serialised_key, to};
+      for (const auto& run : runs)
+      {
+        if (
+          run.last_seqno < from || run.first_seqno > to ||
+          !run.keys.may_contain(serialised_key))
         {
-          if (n >= from && n <= to)
-          {
-            result.insert(n);
-          }
+          continue;
         }
-      };
 
+        auto begin = std::upper_bound(
+          run.blocks.begin(),
+          run.blocks.end(),
+          range_begin,
+          block_before);
+        if (begin != run.blocks.begin())
+        {
+          --begin;
+        }
+        const auto end = std::upper_bound(
+          run.blocks.begin(),
+          run.blocks.end(),
+          range_end,
+          block_before);
+
+        for (auto it = begin; it < end; ++it)
+        {
+          blob_names.push_back(
+            get_blob_name(run, std::distance(run.blocks.begin(), it)));
+        }
+      }
+
+      SeqNoCollection result;
       bool complete = true;
 
-      while (true)
+      for (const auto& blob_name : blob_names)
       {
-        std::lock_guard<ccf::pal::Mutex> guard(results_access);
-
-        const auto bucket_key = std::make_pair(serialised_key, from_range);
-        const auto old_it = old_results.find(bucket_key);
-        if (old_it != old_results.end())
+        auto old_it = old_results.find(blob_name);
+        if (old_it == old_results.end())
         {
-          auto& bucket_value = old_it->second;
+          // Begin fetching this block from disk
+          old_results.insert(
+            blob_name, std::make_pair(lfs_access->fetch(blob_name), Block()));
+          complete = false;
+          continue;
+        }
+
+        // Keep every block needed by this query in the LRU, so that they are
+        // all present once the outstanding fetches complete
+        old_results.promote(old_it);
+        auto& block_value = old_it->second;
 
-          // We were already trying to fetch this. If it's finished fetching,
-          // parse and store the result
-          if (bucket_value.first != nullptr)
+        // We were already trying to fetch this. If it's finished fetching,
+        // parse and store the result
+        if (block_value.first != nullptr)
+        {
+          const auto fetch_result = block_value.first->fetch_result.load();
+          switch (fetch_result)
           {
-            const auto fetch_result = bucket_value.first->fetch_result.load();
-            switch (fetch_result)
+            case (ccf::indexing::FetchResult::FetchResultType::Fetching):
             {
-              case (ccf::indexing::FetchResult::FetchResultType::Fetching):
+              complete = false;
+              break;
+            }
+            case (ccf::indexing::FetchResult::FetchResultType::Loaded):
+            {
+              bool corrupt = false;
+              block_value.second =
+                deserialise(block_value.first->contents, corrupt);
+              if (!corrupt)
               {
-                complete = false;
+                block_value.first = nullptr;
                 break;
               }
-              case (ccf::indexing::FetchResult::FetchResultType::Loaded):
-              {
-                bool corrupt = false;
-                bucket_value.second =
-                  deserialise(bucket_value.first->contents, corrupt);
-                if (!corrupt)
-                {
-                  bucket_value.first = nullptr;
-                  break;
-                }
-                // Deliberately fall through to the case below. If this can't
-                // deserialise the value, consider the file corrupted
-                LOG_FAIL_FMT("Deserialisation failed");
-              }
-              case (ccf::indexing::FetchResult::FetchResultType::NotFound):
-              case (ccf::indexing::FetchResult::FetchResultType::Corrupt):
+              // Deliberately fall through to the case below. If this can't
+              // deserialise the value, consider the file corrupted
+              LOG_FAIL_FMT("Deserialisation failed");
+            }
+            case (ccf::indexing::FetchResult::FetchResultType::NotFound):
+            case (ccf::indexing::FetchResult::FetchResultType::Corrupt):
+            {
+              // This class previously wrote a block to disk which is no
+              // longer available or corrupted. Reset the watermark of what
+              // has been indexed, to re-index and rewrite those files.
+              const auto* problem = fetch_result ==
+                  ccf::indexing::FetchResult::FetchResultType::NotFound ?
+                "missing" :
+                "corrupt";
+              LOG_FAIL_FMT(
+                "A file that {} requires is {}. Re-indexing.", name, problem);
+              LOG_DEBUG_FMT(
+                "The {} file is {}", problem, block_value.first->key);
+
+              // NB: This could probably be more precise about what is
+              // re-indexed. Technically only need to build an index to build
+              // the current query, and that applies to re-indexing too. But
+              // for safety, and consistency with the simple indexing
+              // strategies currently used, this re-indexes everything from
+              // the start of time.
               {
-                // This class previously wrote a bucket to disk which is no
-                // longer available or corrupted. Reset the watermark of what
-                // has been indexed, to re-index and rewrite those files.
-                const auto* problem = fetch_result ==
-                    ccf::indexing::FetchResult::FetchResultType::NotFound ?
-                  "missing" :
-                  "corrupt";
-                LOG_FAIL_FMT(
-                  "A file that {} requires is {}. Re-indexing.", name, problem);
-                LOG_DEBUG_FMT(
-                  "The {} file is {}", problem, bucket_value.first->key);
-
-                // NB: This could probably be more precise about what is
-                // re-indexed. Technically only need to build an index to build
-                // the current query, and that applies to re-indexing too. But
-                // for safety, and consistency with the simple indexing
-                // strategies currently used, this re-indexes everything from
-                // the start of time.
-                {
-                  std::lock_guard<ccf::pal::Mutex> current_txid_guard(
-                    current_txid_lock);
-                  current_txid = {};
-                }
-                old_results.clear();
-                current_results.clear();
-
-                return std::nullopt;
+                std::lock_guard<ccf::pal::Mutex> current_txid_guard(
+                  current_txid_lock);
+                current_txid = {};
               }
-            }
-          }
+              reset();
 
-          if (bucket_value.first == nullptr && complete)
-          {
-            // Still building a contiguous result, and have a parsed result for
-            // this bucket - insert it
-            append_bucket_result(bucket_value.second);
+              return std::nullopt;
+            }
           }
         }
-        else
+
+        if (block_value.first == nullptr && complete)
         {
-          // We're not currently fetching this. First check if it's in our
-          // current results
-          const auto current_it = current_results.find(serialised_key);
+          // Still building a complete result, and have a parsed result for
+          // this block - insert its matching entries
+          const auto key_it = std::lower_bound(
+            block_value.second.begin(),
+            block_value.second.end(),
+            serialised_key,
+            [](const auto& entry, const ccf::ByteVector& k) {
+              return entry.first < k;
+            });
           if (
-            current_it != current_results.end() &&
-            current_it->second.first == from_range)
+            key_it != block_value.second.end() &&
+            key_it->first == serialised_key)
           {
-            if (complete)
+            for (const auto n : key_it->second)
             {
-              append_bucket_result(current_it->second.second);
+              if (n >= from && n <= to)
+              {
+                result.insert(n);
+              }
             }
           }
-          // Another possibility is that the requested range is _after_ the
-          // current_results for this key. That means, assuming we have
-          // constructed a complete index up to to_range, that there are no
-          // later buckets to fetch - we have constructed a complete result.
-          // Similarly, if we have _no_ current_results for this key, then
-          // (assuming we have a complete index), there are no writes to this
-          // key, and we have constructed a complete result.
-          else if (
-            (current_it != current_results.end() &&
-             current_it->second.first.first < from_range.first) ||
-            current_it == current_results.end())
-          {
-            break;
-          }
-          else
-          {
-            // Begin fetching this bucket from disk
-            auto fetch_handle = lfs_access->fetch(get_blob_name(bucket_key));
-            old_results.insert(
-              bucket_key, std::make_pair(fetch_handle, SeqNoCollection()));
-            complete = false;
-          }
         }
+      }
 
-        if (from_range == to_range)
-        {
-          break;
-        }
-        from_range.first += seqnos_per_bucket;
-        from_range.second += seqnos_per_bucket;
+      if (!complete)
+      {
+        return std::nullopt;
       }
 
-      if (complete)
+      // Finally, add any matching entries which have not yet been flushed
+      const auto current_it = memtable.find(serialised_key);
+      if (current_it != memtable.end())
       {
-        return result;
+        for (const auto n : current_it->second)
+        {
+          if (n >= from && n <= to)
+          {
+            result.insert(n);
+          }
+        }
       }
 
-      return std::nullopt;
+      return result;
+    }
+
+    void reset()
+    {
+      old_results.clear();
+      memtable.clear();
+      memtable_range.reset();
+      runs.clear();
+      compactions.clear();
+      ++generation;
     }
 
     // This returns the max range which may be requested. This accounts for the
@@ -351,7 +718,7 @@ namespace ccf::indexing::strategies
     // at the beginning and end, essentially wasting some space.
     size_t max_requestable_range() const
     {
-      return ((old_results.get_max_size() - 1) * seqnos_per_bucket);
+      return ((max_buckets - 1) * seqnos_per_bucket);
     }
   };
 
@@ -359,49 +726,7 @@ namespace ccf::indexing::strategies
     const ccf::TxID& tx_id, const ccf::ByteVector& k, const ccf::ByteVector& v)
   {
     (void)v;
-    const auto range = impl->get_range_for(tx_id.seqno);
-
-    std::lock_guard<ccf::pal::Mutex> guard(impl->results_access);
-
-    auto it = impl->current_results.find(k);
-    if (it != impl->current_results.end())
-    {
-      // Have existing results. If they're from an old range, they must be
-      // flushed, and the bucket updated to contain the new entry
-      auto& current_result = it->second;
-      const auto current_range = current_result.first;
-      if (range != current_range)
-      {
-        LOG_TRACE_FMT(
-          "Storing {} entries from real range [{}, {}) for key {:02x}",
-          current_result.second.size(),
-          current_range.first,
-          current_range.second,
-          fmt::join(k, ""));
-        impl->store_to_disk(k, current_range, std::move(current_result.second));
-
-        const auto next_range = impl->get_range_for(current_range.second);
-        if (next_range != range)
-        {
-          impl->store_empty_buckets(k, next_range, range);
-        }
-
-        current_result.first = range;
-        current_result.second.clear();
-      }
-    }
-    else
-    {
-      // This key has never been seen before. Insert a new bucket for it
-      impl->store_empty_buckets(k, impl->get_range_for(0), range);
-      it = impl->current_results
-             .emplace(k, std::make_pair(range, SeqNoCollection()))
-             .first;
-    }
-
-    auto& current_result = it->second;
-    auto& current_seqnos = current_result.second;
-    current_seqnos.insert(tx_id.seqno);
+    impl->visit_entry(tx_id, k);
   }
 
   nlohmann::json SeqnosByKey_Bucketed_Untyped::describe()
@@ -412,7 +737,19 @@ namespace ccf::indexing::strategies
       j["seqnos_per_bucket"] = impl->seqnos_per_bucket;
       j["old_results_max_size"] = impl->old_results.get_max_size();
       j["old_results_current_size"] = impl->old_results.size();
-      j["current_results_size"] = impl->current_results.size();
+      j["memtable_size"] = impl->memtable.size();
+
+      std::map<size_t, size_t> runs_per_level;
+      size_t block_count = 0;
+      for (const auto& run : impl->runs)
+      {
+        ++runs_per_level[run.level];
+        block_count += run.blocks.size();
+      }
+      j["run_count"] = impl->runs.size();
+      j["runs_per_level"] = runs_per_level;
+      j["block_count"] = block_count;
+      j["pending_compactions"] = impl->compactions.size();
     }
     return j;
   }
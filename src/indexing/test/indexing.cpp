@@ -2,6 +2,7 @@
 // Licensed under the Apache 2.0 License.
 
 #include "ccf/ds/x509_time_fmt.h"
+#include "ccf/indexing/strategies/keys_by_field.h"
 #include "ccf/indexing/strategies/seqnos_by_key_bucketed.h"
 #include "ccf/indexing/strategies/seqnos_by_key_in_memory.h"
 #include "consensus/aft/raft.h"
@@ -246,6 +247,353 @@ TEST_CASE("basic indexing" * doctest::test_suite("indexing"))
     index_b);
 }
 
+// Uses stub classes to test that strategies which have caught up are given
+// committed entries from the local store, without fetching them
+TEST_CASE("indexing from the commit stream" * doctest::test_suite("indexing"))
+{
+  auto kv_store_p = std::make_shared<ccf::kv::Store>();
+  auto& kv_store = *kv_store_p;
+
+  auto consensus = std::make_shared<AllCommittableConsensus>();
+  kv_store.set_consensus(consensus);
+
+  auto fetcher = std::make_shared<TestTransactionFetcher>();
+  auto indexer = std::make_shared<ccf::indexing::Indexer>(fetcher);
+  kv_store.set_entry_observer(indexer);
+
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+
+  auto index_a = std::make_shared<IndexA>(map_a);
+  REQUIRE(indexer->install_strategy(index_a));
+
+  ExpectedSeqNos seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2;
+  REQUIRE(create_transactions(
+    kv_store,
+    create_actions(seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2)));
+
+  {
+    INFO("Caught up strategies do not fetch committed entries");
+    REQUIRE_FALSE(
+      indexer->update_strategies(step_time, kv_store.current_txid()));
+    REQUIRE(fetcher->requested.empty());
+
+    REQUIRE(check_seqnos(seqnos_hello, index_a->get_all_write_txs("hello")));
+    REQUIRE(
+      check_seqnos(seqnos_saluton, index_a->get_all_write_txs("saluton")));
+
+    const auto metrics = indexer->get_metrics();
+    REQUIRE(metrics.committed_seqno == kv_store.current_version());
+    REQUIRE(metrics.lag_tx_count == 0);
+    REQUIRE(metrics.buffered_tx_count == 0);
+  }
+
+  {
+    INFO("Strategies installed later are backfilled by the fetcher");
+    auto index_b = std::make_shared<IndexB>(map_b);
+    REQUIRE(indexer->install_strategy(index_b));
+
+    REQUIRE(create_transactions(
+      kv_store,
+      create_actions(seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2),
+      100));
+
+    size_t fetched = 0;
+    while (indexer->update_strategies(step_time, kv_store.current_txid()) ||
+           !fetcher->requested.empty())
+    {
+      REQUIRE(indexer->get_metrics().lag_tx_count > 0);
+      for (auto seqno : fetcher->requested)
+      {
+        const auto& entry = std::get<1>(consensus->replica[seqno - 1]);
+        fetcher->fetched_stores[seqno] =
+          fetcher->deserialise_transaction(seqno, entry->data(), entry->size());
+        ++fetched;
+      }
+      fetcher->requested.clear();
+    }
+
+    // Only the transactions before index_b was installed, which were no
+    // longer held by the indexer, were fetched
+    REQUIRE(fetched > 0);
+    REQUIRE(fetched < kv_store.current_version());
+
+    REQUIRE(check_seqnos(seqnos_hello, index_a->get_all_write_txs("hello")));
+    REQUIRE(check_seqnos(seqnos_1, index_b->get_all_write_txs(1)));
+    REQUIRE(check_seqnos(seqnos_2, index_b->get_all_write_txs(2)));
+    REQUIRE(indexer->get_metrics().lag_tx_count == 0);
+  }
+
+  {
+    INFO("Rolled back entries are not indexed");
+    const auto rollback_point = kv_store.current_txid();
+
+    // These are replicated to a separate consensus, which is then discarded
+    kv_store.set_consensus(std::make_shared<AllCommittableConsensus>());
+
+    ExpectedSeqNos rolled_back;
+    REQUIRE(create_transactions(
+      kv_store,
+      {{rolled_back,
+        [](size_t, ccf::kv::Tx& tx) {
+          tx.wo(map_a)->put("rolled back", "value doesn't matter");
+          return true;
+        }}},
+      10));
+
+    kv_store.rollback(rollback_point, rollback_point.view + 1);
+    kv_store.set_consensus(consensus);
+
+    REQUIRE(create_transactions(
+      kv_store,
+      create_actions(seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2),
+      20));
+
+    REQUIRE_FALSE(
+      indexer->update_strategies(step_time, kv_store.current_txid()));
+    REQUIRE(fetcher->requested.empty());
+
+    REQUIRE(check_seqnos(seqnos_hello, index_a->get_all_write_txs("hello")));
+    REQUIRE(check_seqnos({}, index_a->get_all_write_txs("rolled back")));
+  }
+}
+
+TEST_CASE("keys by field" * doctest::test_suite("indexing"))
+{
+  ccf::kv::Store kv_store;
+
+  auto consensus = std::make_shared<AllCommittableConsensus>();
+  kv_store.set_consensus(consensus);
+
+  auto fetcher = std::make_shared<TestTransactionFetcher>();
+  ccf::indexing::Indexer indexer(fetcher);
+
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+
+  // Index map_b by value, ignoring values above 1000
+  using KeysByValueB =
+    ccf::indexing::strategies::KeysByField<decltype(map_b), size_t>;
+  auto index_b = std::make_shared<KeysByValueB>(
+    map_b, "value", [](const size_t& k, const size_t& v) {
+      return v <= 1000 ? std::optional<size_t>(v) : std::nullopt;
+    });
+  REQUIRE(indexer.install_strategy(index_b));
+
+  // Index map_a by value, to look up keys by prefix of value
+  using KeysByValueA =
+    ccf::indexing::strategies::KeysByField<decltype(map_a), std::string>;
+  auto index_a = std::make_shared<KeysByValueA>(
+    map_a, "value", [](const std::string& k, const std::string& v) {
+      return std::optional<std::string>(v);
+    });
+  REQUIRE(indexer.install_strategy(index_a));
+
+  auto tick_until_caught_up = [&]() {
+    while (indexer.update_strategies(step_time, kv_store.current_txid()) ||
+           !fetcher->requested.empty())
+    {
+      for (auto seqno : fetcher->requested)
+      {
+        const auto& entry = std::get<1>(consensus->replica[seqno - 1]);
+        fetcher->fetched_stores[seqno] =
+          fetcher->deserialise_transaction(seqno, entry->data(), entry->size());
+      }
+      fetcher->requested.clear();
+    }
+  };
+
+  std::map<size_t, size_t> state_b;
+  std::map<std::string, std::string> state_a;
+  for (size_t i = 0; i < 500; ++i)
+  {
+    auto tx = kv_store.create_tx();
+    auto handle_b = tx.wo(map_b);
+    auto handle_a = tx.wo(map_a);
+    for (size_t j = 0; j < 3; ++j)
+    {
+      const size_t k = rand() % 100;
+      if (rand() % 4 == 0)
+      {
+        handle_b->remove(k);
+        state_b.erase(k);
+      }
+      else
+      {
+        const size_t v = rand() % 1100;
+        handle_b->put(k, v);
+        state_b[k] = v;
+      }
+    }
+    const auto k = std::to_string(rand() % 50);
+    const auto v = fmt::format("{}-{}", rand() % 3 == 0 ? "red" : "blue", i);
+    handle_a->put(k, v);
+    state_a[k] = v;
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+
+  tick_until_caught_up();
+  REQUIRE(index_b->get_indexed_watermark() == kv_store.current_txid());
+
+  auto expected_in_range = [&](size_t from, size_t to) {
+    std::vector<std::pair<size_t, size_t>> matches;
+    for (const auto& [k, v] : state_b)
+    {
+      if (v >= from && v <= to && v <= 1000)
+      {
+        matches.emplace_back(v, k);
+      }
+    }
+    std::sort(matches.begin(), matches.end());
+    std::vector<size_t> keys;
+    for (const auto& [v, k] : matches)
+    {
+      keys.push_back(k);
+    }
+    return keys;
+  };
+
+  {
+    INFO("Range lookups return current keys, ordered by field");
+    for (const auto& [from, to] : std::vector<std::pair<size_t, size_t>>{
+           {0, 1100}, {0, 0}, {100, 200}, {500, 500}, {999, 1100}})
+    {
+      const auto keys = index_b->get_keys_in_range(from, to);
+      REQUIRE(keys.has_value());
+      REQUIRE(*keys == expected_in_range(from, to));
+    }
+
+    const auto some = index_b->get_keys_in_range(0, 1100, 5);
+    REQUIRE(some.has_value());
+    const auto all = expected_in_range(0, 1100);
+    REQUIRE(*some == std::vector<size_t>(all.begin(), all.begin() + 5));
+
+    REQUIRE_THROWS(index_b->get_keys_in_range(10, 5));
+  }
+
+  {
+    INFO("Exact and prefix lookups");
+    const auto [k, v] = *state_a.begin();
+    const auto exact = index_a->get_keys(v);
+    REQUIRE(exact.has_value());
+    REQUIRE(*exact == std::vector<std::string>{k});
+
+    std::set<std::string> expected_red;
+    for (const auto& [k, v] : state_a)
+    {
+      if (v.starts_with("red-"))
+      {
+        expected_red.insert(k);
+      }
+    }
+    const auto red = index_a->get_keys_with_prefix("red-");
+    REQUIRE(red.has_value());
+    REQUIRE(std::set<std::string>(red->begin(), red->end()) == expected_red);
+    REQUIRE(red->size() == expected_red.size());
+  }
+
+  {
+    INFO("Removals and updates are reflected in later lookups");
+    auto tx = kv_store.create_tx();
+    auto handle_b = tx.wo(map_b);
+    for (const auto& [k, v] : state_b)
+    {
+      handle_b->put(k, 2000);
+    }
+    handle_b->put(1000, 7);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+
+    tick_until_caught_up();
+
+    const auto keys = index_b->get_keys_in_range(0, 1100);
+    REQUIRE(keys.has_value());
+    REQUIRE(*keys == std::vector<size_t>{1000});
+  }
+}
+
+// Uses stub classes to test that each strategy is updated by its own task
+TEST_CASE(
+  "strategies are updated concurrently" * doctest::test_suite("indexing"))
+{
+  auto kv_store_p = std::make_shared<ccf::kv::Store>();
+  auto& kv_store = *kv_store_p;
+
+  auto consensus = std::make_shared<AllCommittableConsensus>();
+  kv_store.set_consensus(consensus);
+
+  ccf::tasks::JobBoard job_board;
+  auto fetcher = std::make_shared<TestTransactionFetcher>();
+  auto indexer = std::make_shared<ccf::indexing::Indexer>(fetcher, &job_board);
+  kv_store.set_entry_observer(indexer);
+
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+
+  auto index_a = std::make_shared<IndexA>(map_a);
+  REQUIRE(indexer->install_strategy(index_a));
+  auto index_b = std::make_shared<IndexB>(map_b);
+  REQUIRE(indexer->install_strategy(index_b));
+
+  ExpectedSeqNos seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2;
+  REQUIRE(create_transactions(
+    kv_store,
+    create_actions(seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2),
+    100));
+
+  REQUIRE(indexer->update_strategies(step_time, kv_store.current_txid()));
+  REQUIRE(job_board.get_summary().pending_tasks == 2);
+  REQUIRE(index_a->get_indexed_watermark() == ccf::TxID());
+  REQUIRE(index_b->get_indexed_watermark() == ccf::TxID());
+
+  {
+    INFO("A strategy still handling its batch does not hold up the others");
+    auto task = job_board.get_task();
+    REQUIRE(task != nullptr);
+    task->do_task();
+
+    REQUIRE(create_transactions(
+      kv_store,
+      create_actions(seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2),
+      50));
+
+    REQUIRE(indexer->update_strategies(step_time, kv_store.current_txid()));
+    REQUIRE(job_board.get_summary().pending_tasks == 2);
+    REQUIRE(fetcher->requested.empty());
+  }
+
+  auto run_tasks = [&]() {
+    for (auto task = job_board.get_task(); task != nullptr;
+         task = job_board.get_task())
+    {
+      task->do_task();
+    }
+  };
+
+  while (indexer->update_strategies(step_time, kv_store.current_txid()))
+  {
+    run_tasks();
+  }
+
+  REQUIRE(fetcher->requested.empty());
+  REQUIRE(check_seqnos(seqnos_hello, index_a->get_all_write_txs("hello")));
+  REQUIRE(check_seqnos(seqnos_saluton, index_a->get_all_write_txs("saluton")));
+  REQUIRE(check_seqnos(seqnos_1, index_b->get_all_write_txs(1)));
+  REQUIRE(check_seqnos(seqnos_2, index_b->get_all_write_txs(2)));
+
+  {
+    INFO("Each strategy's progress is described");
+    const auto j = indexer->describe();
+    REQUIRE(j.size() == 2);
+    for (const auto& strategy_j : j)
+    {
+      REQUIRE(strategy_j["lag_tx_count"] == 0);
+      REQUIRE(strategy_j["indexed_tx_count"] == kv_store.current_version());
+      REQUIRE(strategy_j.contains("indexed_tx_per_second"));
+      REQUIRE(strategy_j["busy"] == false);
+    }
+  }
+}
+
 ccf::kv::Version rekey(
   ccf::kv::Store& kv_store,
   const std::shared_ptr<ccf::LedgerSecrets>& ledger_secrets)
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the Apache 2.0 License.
 
+#include "ccf/indexing/strategies/keys_by_field.h"
 #include "ccf/indexing/strategies/seqnos_by_key_bucketed.h"
 #include "host/lfs_file_handler.h"
 #include "indexing/enclave_lfs_access.h"
@@ -712,4 +713,334 @@ TEST_CASE("Sparse index" * doctest::test_suite("lfs"))
                                    << bucket_size);
     run_sparse_index_test(bucket_size, num_buckets);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Spilled secondary index" * doctest::test_suite("lfs"))
+{
+  ccf::kv::Store kv_store;
+
+  auto consensus = std::make_shared<AllCommittableConsensus>();
+  kv_store.set_consensus(consensus);
+
+  auto fetcher = std::make_shared<TestTransactionFetcher>();
+  ccf::indexing::Indexer indexer(fetcher);
+
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+
+  messaging::BufferProcessor host_bp("lfs_host");
+  messaging::BufferProcessor enclave_bp("lfs_enclave");
+
+  constexpr size_t buf_size = 1 << 16;
+  auto inbound_buffer = std::make_unique<ringbuffer::TestBuffer>(buf_size);
+  ringbuffer::Reader inbound_reader(inbound_buffer->bd);
+  auto outbound_buffer = std::make_unique<ringbuffer::TestBuffer>(buf_size);
+
+  ringbuffer::Reader outbound_reader(outbound_buffer->bd);
+  asynchost::LFSFileHandler host_files(
+    std::make_shared<ringbuffer::Writer>(inbound_reader));
+  host_files.register_message_handlers(host_bp.get_dispatcher());
+
+  auto enclave_lfs = std::make_shared<ccf::indexing::EnclaveLFSAccess>(
+    std::make_shared<ringbuffer::Writer>(outbound_reader));
+  enclave_lfs->register_message_handlers(enclave_bp.get_dispatcher());
+
+  ccf::AbstractNodeContext node_context;
+  node_context.install_subsystem(enclave_lfs);
+
+  auto flush_ringbuffers = [&]() {
+    return host_bp.read_all(outbound_reader) +
+      enclave_bp.read_all(inbound_reader);
+  };
+
+  // Small pages, of which only a couple may be held in memory at once
+  using Strat =
+    ccf::indexing::strategies::KeysByField<decltype(map_b), size_t>;
+  auto index = std::make_shared<Strat>(
+    map_b,
+    "value",
+    [](const size_t& k, const size_t& v) { return v; },
+    node_context,
+    10,
+    2);
+  REQUIRE(indexer.install_strategy(index));
+
+  auto tick_until_caught_up = [&]() {
+    while (indexer.update_strategies(step_time, kv_store.current_txid()) ||
+           !fetcher->requested.empty())
+    {
+      for (auto seqno : fetcher->requested)
+      {
+        const auto& entry = std::get<1>(consensus->replica[seqno - 1]);
+        fetcher->fetched_stores[seqno] =
+          fetcher->deserialise_transaction(seqno, entry->data(), entry->size());
+      }
+      fetcher->requested.clear();
+
+      flush_ringbuffers();
+    }
+  };
+
+  std::map<size_t, size_t> state;
+  auto write_entries = [&](size_t tx_count) {
+    for (size_t i = 0; i < tx_count; ++i)
+    {
+      auto tx = kv_store.create_tx();
+      auto handle = tx.wo(map_b);
+      const size_t k = rand() % 200;
+      if (rand() % 5 == 0)
+      {
+        handle->remove(k);
+        state.erase(k);
+      }
+      else
+      {
+        const size_t v = rand() % 1000;
+        handle->put(k, v);
+        state[k] = v;
+      }
+      REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+    }
+  };
+
+  auto check_range = [&](size_t from, size_t to) {
+    auto keys = index->get_keys_in_range(from, to);
+    if (!keys.has_value())
+    {
+      // This required an async load from disk
+      REQUIRE(flush_ringbuffers() > 0);
+      keys = index->get_keys_in_range(from, to);
+      REQUIRE(keys.has_value());
+    }
+
+    std::vector<std::pair<size_t, size_t>> matches;
+    for (const auto& [k, v] : state)
+    {
+      if (v >= from && v <= to)
+      {
+        matches.emplace_back(v, k);
+      }
+    }
+    std::sort(matches.begin(), matches.end());
+    std::vector<size_t> expected;
+    for (const auto& [v, k] : matches)
+    {
+      expected.push_back(k);
+    }
+    REQUIRE(*keys == expected);
+  };
+
+  for (size_t round = 0; round < 5; ++round)
+  {
+    write_entries(300);
+    tick_until_caught_up();
+    REQUIRE(index->get_indexed_watermark() == kv_store.current_txid());
+
+    check_range(0, 1000);
+    for (size_t i = 0; i < 20; ++i)
+    {
+      const size_t from = rand() % 1000;
+      check_range(from, from + rand() % 200);
+    }
+  }
+
+  {
+    INFO("Changes to spilled pages are merged without any query");
+    write_entries(1000);
+    tick_until_caught_up();
+    const auto description = index->describe();
+    REQUIRE(description["resident_page_count"].get<size_t>() <= 2);
+    REQUIRE(description["pending_change_count"].get<size_t>() < 100);
+  }
+
+  {
+    INFO("Queries which stop early still spill excess pages");
+    auto keys = index->get_keys_in_range(0, 1000, 1);
+    while (!keys.has_value())
+    {
+      REQUIRE(flush_ringbuffers() > 0);
+      keys = index->get_keys_in_range(0, 1000, 1);
+    }
+    REQUIRE(keys->size() == 1);
+    REQUIRE(index->describe()["resident_page_count"].get<size_t>() <= 2);
+  }
+
+  {
+    INFO("Missing files cause the index to be rebuilt");
+    for (auto const& f :
+         std::filesystem::directory_iterator(host_files.root_dir))
+    {
+      std::filesystem::remove(f);
+    }
+
+    auto keys = index->get_keys_in_range(0, 1000);
+    REQUIRE_FALSE(keys.has_value());
+    REQUIRE(flush_ringbuffers() > 0);
+    keys = index->get_keys_in_range(0, 1000);
+    REQUIRE_FALSE(keys.has_value());
+    REQUIRE(index->get_indexed_watermark() != kv_store.current_txid());
+
+    tick_until_caught_up();
+    REQUIRE(index->get_indexed_watermark() == kv_store.current_txid());
+    check_range(0, 1000);
+  }
+}
+
+TEST_CASE("Sorted run index at scale" * doctest::test_suite("lfs"))
+{
+  ccf::kv::Store kv_store;
+
+  auto consensus = std::make_shared<AllCommittableConsensus>();
+  kv_store.set_consensus(consensus);
+
+  auto fetcher = std::make_shared<TestTransactionFetcher>();
+  ccf::indexing::Indexer indexer(fetcher);
+
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+
+  messaging::BufferProcessor host_bp("lfs_host");
+  messaging::BufferProcessor enclave_bp("lfs_enclave");
+
+  // Large enough to hold the blocks written by a compaction
+  constexpr size_t buf_size = 1 << 22;
+  auto inbound_buffer = std::make_unique<ringbuffer::TestBuffer>(buf_size);
+  ringbuffer::Reader inbound_reader(inbound_buffer->bd);
+  auto outbound_buffer = std::make_unique<ringbuffer::TestBuffer>(buf_size);
+
+  ringbuffer::Reader outbound_reader(outbound_buffer->bd);
+  asynchost::LFSFileHandler host_files(
+    std::make_shared<ringbuffer::Writer>(inbound_reader));
+  host_files.register_message_handlers(host_bp.get_dispatcher());
+
+  auto enclave_lfs = std::make_shared<ccf::indexing::EnclaveLFSAccess>(
+    std::make_shared<ringbuffer::Writer>(outbound_reader));
+  enclave_lfs->register_message_handlers(enclave_bp.get_dispatcher());
+
+  ccf::AbstractNodeContext node_context;
+  node_context.install_subsystem(enclave_lfs);
+
+  size_t host_messages = 0;
+  auto flush_ringbuffers = [&]() {
+    const auto to_host = host_bp.read_all(outbound_reader);
+    host_messages += to_host;
+    return to_host + enclave_bp.read_all(inbound_reader);
+  };
+
+  constexpr size_t bucket_size = 1'000;
+  constexpr size_t num_buckets = 10;
+  using Strat =
+    ccf::indexing::strategies::SeqnosByKey_Bucketed<decltype(map_b)>;
+  auto index =
+    std::make_shared<Strat>(map_b, node_context, bucket_size, num_buckets);
+  REQUIRE(indexer.install_strategy(index));
+
+  constexpr size_t tx_count =
+#ifdef NDEBUG
+    100'000;
+#else
+    20'000;
+#endif
+  constexpr size_t key_count = 1'000;
+  constexpr size_t keys_per_tx = 3;
+
+  // A few hot keys are written in most transactions, the remainder are
+  // spread thinly over the whole history
+  std::map<size_t, std::vector<ccf::SeqNo>> all_writes;
+  for (size_t i = 0; i < tx_count; ++i)
+  {
+    auto tx = kv_store.create_tx();
+    auto handle = tx.wo(map_b);
+    std::set<size_t> keys{i % 2};
+    for (size_t j = 0; j < keys_per_tx; ++j)
+    {
+      keys.insert(rand() % key_count);
+    }
+    for (const auto k : keys)
+    {
+      handle->put(k, i);
+    }
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+    const auto seqno = tx.get_txid()->seqno;
+    for (const auto k : keys)
+    {
+      all_writes[k].push_back(seqno);
+    }
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  while (indexer.update_strategies(step_time, kv_store.current_txid()) ||
+         !fetcher->requested.empty())
+  {
+    for (auto seqno : fetcher->requested)
+    {
+      const auto& entry = std::get<1>(consensus->replica[seqno - 1]);
+      fetcher->fetched_stores[seqno] =
+        fetcher->deserialise_transaction(seqno, entry->data(), entry->size());
+    }
+    fetcher->requested.clear();
+
+    flush_ringbuffers();
+  }
+  const auto indexing_time = Clock::now() - start;
+  const auto indexing_host_messages = host_messages;
+  REQUIRE(index->get_indexed_watermark() == kv_store.current_txid());
+
+  const auto description =
+    static_cast<ccf::indexing::Strategy&>(*index).describe();
+  LOG_INFO_FMT("Index after {} transactions: {}", tx_count, description.dump());
+
+  // Query every key across the whole history, in the widest ranges that the
+  // index allows
+  const auto end_seqno = kv_store.current_txid().seqno;
+  const auto max_range = index->max_requestable_range();
+  size_t query_count = 0;
+  size_t async_query_count = 0;
+  host_messages = 0;
+  start = Clock::now();
+  for (size_t k = 0; k < key_count; ++k)
+  {
+    std::vector<ccf::SeqNo> writes;
+    ccf::SeqNo range_start = 0;
+    while (true)
+    {
+      const auto range_end = std::min(end_seqno, range_start + max_range);
+      auto results = index->get_write_txs_in_range(k, range_start, range_end);
+      ++query_count;
+      if (!results.has_value())
+      {
+        ++async_query_count;
+        REQUIRE(flush_ringbuffers() > 0);
+        results = index->get_write_txs_in_range(k, range_start, range_end);
+        REQUIRE(results.has_value());
+      }
+
+      writes.insert(writes.end(), results->begin(), results->end());
+
+      if (range_end == end_seqno)
+      {
+        break;
+      }
+      range_start = range_end + 1;
+    }
+    REQUIRE(writes == all_writes[k]);
+  }
+  const auto query_time = Clock::now() - start;
+
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+  LOG_INFO_FMT(
+    "Indexed {} transactions in {}ms, with {} LFS requests",
+    tx_count,
+    duration_cast<milliseconds>(indexing_time).count(),
+    indexing_host_messages);
+  LOG_INFO_FMT(
+    "Ran {} queries ({} requiring fetches) in {}ms, fetching {} files",
+    query_count,
+    async_query_count,
+    duration_cast<milliseconds>(query_time).count(),
+    host_messages);
+
+  // Compaction leaves far fewer runs than buckets
+  REQUIRE(description["run_count"].get<size_t>() < tx_count / bucket_size);
+}
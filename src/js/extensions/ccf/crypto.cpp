@@ -11,14 +11,18 @@
 #include "ccf/crypto/key_wrap.h"
 #include "ccf/crypto/rsa_key_pair.h"
 #include "ccf/crypto/sha256.h"
+#include "ccf/crypto/sha256_hash.h"
 #include "ccf/crypto/verifier.h"
 #include "ccf/ds/json.h"
 #include "ccf/js/core/context.h"
+#include "ds/concurrent_cache.h"
 #include "ds/internal_logger.h"
 #include "js/checks.h"
+#include "js/global_class_ids.h"
 #include "tls/ca.h"
 
 #include <climits>
+#include <variant>
 
 namespace ccf::js::extensions
 {
@@ -1028,16 +1032,158 @@ namespace ccf::js::extensions
       }
     }
 
-    bool verify_eddsa_signature(
-      uint8_t* contents,
-      size_t contents_size,
-      uint8_t* signature,
-      size_t signature_size,
-      const std::string& pub_key)
+    // A public key parsed for use with one signing algorithm. Certificates are
+    // held as verifiers, since they may contain an EC or an RSA key.
+    using ParsedPublicKey = std::variant<
+      ccf::crypto::VerifierPtr,
+      ccf::crypto::ECPublicKeyPtr,
+      ccf::crypto::RSAPublicKeyPtr,
+      ccf::crypto::EdDSAPublicKeyPtr>;
+
+    ParsedPublicKey parse_public_key(
+      const std::string& algo_name, const std::string& key, bool is_jwk)
+    {
+      if (is_jwk)
+      {
+        if (algo_name == "ECDSA")
+        {
+          ccf::crypto::JsonWebKeyECPublic jwk = ccf::parse_json_safe(key);
+          return ccf::crypto::make_ec_public_key(jwk);
+        }
+        if (algo_name == "RSA-PSS")
+        {
+          ccf::crypto::JsonWebKeyRSAPublic jwk = ccf::parse_json_safe(key);
+          return ccf::crypto::make_rsa_public_key(jwk);
+        }
+        if (algo_name == "EdDSA")
+        {
+          ccf::crypto::JsonWebKeyEdDSAPublic jwk = ccf::parse_json_safe(key);
+          return ccf::crypto::make_eddsa_public_key(jwk);
+        }
+      }
+      else
+      {
+        if (algo_name == "EdDSA")
+        {
+          return ccf::crypto::make_eddsa_public_key(key);
+        }
+        if (key.starts_with("-----BEGIN CERTIFICATE"))
+        {
+          return ccf::crypto::make_verifier(key);
+        }
+        if (algo_name == "ECDSA")
+        {
+          return ccf::crypto::make_ec_public_key(key);
+        }
+        if (algo_name == "RSA-PSS")
+        {
+          return ccf::crypto::make_rsa_public_key(key);
+        }
+      }
+
+      throw std::logic_error(fmt::format(
+        "Unsupported signing algorithm {}, supported: RSA-PSS, ECDSA, EdDSA",
+        algo_name));
+    }
+
+    // Parsed public keys, shared by all interpreters on this node. Apps
+    // usually verify signatures against a handful of known keys, so most
+    // verifications can skip parsing the key. Only the pointer to a cached
+    // key is copied out: the key itself is shared, and only read, and each
+    // verification creates its own OpenSSL context, so concurrent
+    // verifications against the same key do not contend.
+    struct PublicKeysCache
+    {
+      static constexpr size_t DEFAULT_MAX_KEYS = 256;
+
+      using Digest = ccf::crypto::Sha256Hash::Representation;
+      ccf::ds::ConcurrentCache<Digest, ParsedPublicKey> keys;
+
+      PublicKeysCache(size_t max_keys = DEFAULT_MAX_KEYS) : keys(max_keys) {}
+
+      ParsedPublicKey get(
+        const std::string& algo_name, const std::string& key, bool is_jwk)
+      {
+        const auto digest =
+          ccf::crypto::Sha256Hash(
+            fmt::format("{}\n{}\n{}", algo_name, is_jwk ? "jwk" : "pem", key))
+            .h;
+
+        // Concurrent misses for the same key may each parse it, and the cache
+        // keeps one of the results
+        return keys.get_or_insert(digest, [&]() {
+          return parse_public_key(algo_name, key, is_jwk);
+        });
+      }
+    };
+
+    PublicKeysCache& get_public_keys_cache()
     {
-      auto public_key = ccf::crypto::make_eddsa_public_key(pub_key);
-      return public_key->verify(
-        contents, contents_size, signature, signature_size);
+      static PublicKeysCache cache;
+      return cache;
+    }
+
+    // Opaque value of a CryptoPublicKey object, returned by importPublicKey
+    struct ImportedPublicKey
+    {
+      std::string algo_name;
+      ParsedPublicKey key;
+    };
+
+    void js_public_key_finalizer(JSRuntime*, JSValue val)
+    {
+      delete static_cast<ImportedPublicKey*>(
+        JS_GetOpaque(val, public_key_class_id));
+    }
+
+    JSValue js_import_public_key(
+      JSContext* ctx, JSValueConst, int argc, JSValueConst* argv)
+    {
+      js::core::Context& jsctx =
+        *reinterpret_cast<js::core::Context*>(JS_GetContextOpaque(ctx));
+
+      if (argc != 2)
+      {
+        return JS_ThrowTypeError(
+          ctx, "Passed %d arguments, but expected 2", argc);
+      }
+
+      auto algo_name_val = jsctx.get_property(argv[0], "name");
+      JS_CHECK_EXC(algo_name_val);
+
+      auto algo_name_str = jsctx.to_str(algo_name_val);
+      if (!algo_name_str)
+      {
+        return ccf::js::core::constants::Exception;
+      }
+
+      // A JWK is passed as an object, and a PEM as a string
+      const bool is_jwk = JS_IsObject(argv[1]);
+      auto key_str = is_jwk ?
+        jsctx.to_str(jsctx.json_stringify(jsctx.wrap(argv[1]))) :
+        jsctx.to_str(argv[1]);
+      if (!key_str)
+      {
+        return ccf::js::core::constants::Exception;
+      }
+
+      std::unique_ptr<ImportedPublicKey> imported = nullptr;
+      try
+      {
+        imported = std::make_unique<ImportedPublicKey>(ImportedPublicKey{
+          *algo_name_str,
+          get_public_keys_cache().get(*algo_name_str, *key_str, is_jwk)});
+      }
+      catch (const std::exception& ex)
+      {
+        return JS_ThrowRangeError(
+          ctx, "Failed to import public key: %s", ex.what());
+      }
+
+      auto handle = jsctx.new_obj_class(public_key_class_id);
+      JS_CHECK_EXC(handle);
+      JS_SetOpaque(handle.val, imported.release());
+      return handle.take();
     }
 
     JSValue js_verify_signature(
@@ -1083,21 +1229,48 @@ namespace ccf::js::extensions
         return ccf::js::core::constants::Exception;
       }
 
-      auto key_str = jsctx.to_str(argv[1]);
-      if (!key_str)
+      // The key is either a handle returned by importPublicKey, or a PEM
+      // public key or certificate, which is parsed via the node's key cache
+      const auto* imported = static_cast<const ImportedPublicKey*>(
+        JS_GetOpaque(argv[1], public_key_class_id));
+      std::optional<std::string> key_str = std::nullopt;
+      if (imported == nullptr)
       {
-        return ccf::js::core::constants::Exception;
+        key_str = jsctx.to_str(argv[1]);
+        if (!key_str)
+        {
+          return ccf::js::core::constants::Exception;
+        }
       }
+      else if (imported->algo_name != *algo_name_str)
+      {
+        return JS_ThrowRangeError(
+          ctx,
+          "Key was imported for %s, not %s",
+          imported->algo_name.c_str(),
+          algo_name_str->c_str());
+      }
+
+      auto get_key = [&]() {
+        if (imported != nullptr)
+        {
+          return imported->key;
+        }
+        return get_public_keys_cache().get(*algo_name_str, *key_str, false);
+      };
 
       // Handle algorithms that don't use algo_hash here
       if (*algo_name_str == "EdDSA")
       {
         try
         {
+          const auto key = get_key();
+          const auto& public_key =
+            std::get<ccf::crypto::EdDSAPublicKeyPtr>(key);
           return JS_NewBool(
             ctx,
-            static_cast<int>(verify_eddsa_signature(
-              data, data_size, signature, signature_size, *key_str)));
+            static_cast<int>(public_key->verify(
+              data, data_size, signature, signature_size)));
         }
         catch (const std::exception& ex)
         {
@@ -1116,7 +1289,6 @@ namespace ccf::js::extensions
       {
         auto algo_name = *algo_name_str;
         auto algo_hash = *algo_hash_str;
-        auto key = *key_str;
 
         ccf::crypto::MDType mdtype = {};
         if (algo_hash == "SHA-256")
@@ -1144,23 +1316,23 @@ namespace ccf::js::extensions
             ccf::crypto::ecdsa_sig_p1363_to_der({signature, signature_size});
         }
 
-        auto is_cert = key.starts_with("-----BEGIN CERTIFICATE");
+        const auto key = get_key();
 
         bool valid = false;
 
-        if (is_cert)
+        if (const auto* verifier = std::get_if<ccf::crypto::VerifierPtr>(&key))
         {
-          auto verifier = ccf::crypto::make_unique_verifier(key);
-          valid =
-            verifier->verify(data, data_size, sig.data(), sig.size(), mdtype);
+          valid = (*verifier)->verify(
+            data, data_size, sig.data(), sig.size(), mdtype);
         }
-        else if (algo_name == "ECDSA")
+        else if (
+          const auto* ec_key = std::get_if<ccf::crypto::ECPublicKeyPtr>(&key))
         {
-          auto public_key = ccf::crypto::make_ec_public_key(key);
-          valid =
-            public_key->verify(data, data_size, sig.data(), sig.size(), mdtype);
+          valid = (*ec_key)->verify(
+            data, data_size, sig.data(), sig.size(), mdtype);
         }
-        else
+        else if (
+          const auto* rsa_key = std::get_if<ccf::crypto::RSAPublicKeyPtr>(&key))
         {
           int64_t salt_length{};
           std::ignore = JS_ToInt64(
@@ -1168,9 +1340,8 @@ namespace ccf::js::extensions
             &salt_length,
             jsctx.get_property(algorithm, "saltLength").val);
 
-          auto public_key = ccf::crypto::make_rsa_public_key(key);
           // Only supporting PSS (with salt), PKCS1v15 has been deprecated.
-          valid = public_key->verify(
+          valid = (*rsa_key)->verify(
             data,
             data_size,
             sig.data(),
@@ -1179,6 +1350,10 @@ namespace ccf::js::extensions
             ccf::crypto::RSAPadding::PKCS_PSS,
             static_cast<size_t>(salt_length));
         }
+        else
+        {
+          throw std::logic_error("Key does not match signing algorithm");
+        }
         return JS_NewBool(ctx, static_cast<int>(valid));
       }
       catch (const std::exception& ex)
@@ -1198,6 +1373,9 @@ namespace ccf::js::extensions
     JS_CHECK_OR_THROW(crypto.set(
       "verifySignature",
       ctx.new_c_function(js_verify_signature, "verifySignature", 4)));
+    JS_CHECK_OR_THROW(crypto.set(
+      "importPublicKey",
+      ctx.new_c_function(js_import_public_key, "importPublicKey", 2)));
     JS_CHECK_OR_THROW(crypto.set(
       "pubPemToJwk",
       ctx.new_c_function(
@@ -1290,4 +1468,14 @@ namespace ccf::js::extensions
     auto ccf = ctx.get_or_create_global_property("ccf", ctx.new_obj());
     JS_CHECK_OR_THROW(ccf.set("crypto", std::move(crypto)));
   }
-}
\ No newline at end of file
+}
+
+namespace ccf::js
+{
+  JSClassDef public_key_class_def = {
+    .class_name = "CryptoPublicKey",
+    .finalizer = extensions::js_public_key_finalizer,
+    .gc_mark = {},
+    .call = {},
+    .exotic = {}};
+}
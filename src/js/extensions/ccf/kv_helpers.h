@@ -9,6 +9,8 @@
 namespace ccf::js::extensions::kvhelpers
 {
   using KVMap = ::ccf::kv::untyped::Map;
+  using KVKey = KVMap::Handle::KeyType;
+  using KVValue = KVMap::Handle::ValueType;
 
   using ROHandleGetter = KVMap::ReadOnlyHandle* (*)(js::core::Context& jsctx,
                                                     JSValueConst this_val);
@@ -51,8 +53,62 @@ namespace ccf::js::extensions::kvhelpers
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_foreach_denied, "forEach")
   JS_KV_PERMISSION_ERROR_HELPER(
     js_kv_get_version_of_previous_write_denied, "getVersionOfPreviousWrite")
+  JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_get_many_denied, "getMany")
+  JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_set_many_denied, "setMany")
+  JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_delete_many_denied, "deleteMany")
+  JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_range_denied, "range")
 #undef JS_KV_PERMISSION_ERROR_HELPER
 
+  static JSValue get_array_length(
+    JSContext* ctx, const js::core::JSWrappedValue& arr, uint32_t& len)
+  {
+    if (JS_IsArray(ctx, arr.val) == 0)
+    {
+      return JS_ThrowTypeError(ctx, "Argument must be an array");
+    }
+
+    auto len_val = arr["length"];
+    if (JS_ToUint32(ctx, &len, len_val.val) != 0)
+    {
+      return ccf::js::core::constants::Exception;
+    }
+
+    return ccf::js::core::constants::Undefined;
+  }
+
+  // Copies the contents of each ArrayBuffer in arr to out. This is the only
+  // copy made of each key, so batched calls cost no more per key than single
+  // calls, and all arguments are validated before the map is accessed.
+  static JSValue extract_array_buffers(
+    JSContext* ctx, JSValueConst arr, std::vector<KVKey>& out)
+  {
+    js::core::JSWrappedValue args(ctx, arr);
+    uint32_t len = 0;
+    auto ret = get_array_length(ctx, args, len);
+    if (JS_IsException(ret) != 0)
+    {
+      return ret;
+    }
+
+    out.reserve(len);
+    for (uint32_t i = 0; i < len; ++i)
+    {
+      auto element = args[i];
+      JS_CHECK_EXC(element);
+
+      size_t size = 0;
+      uint8_t* buf = JS_GetArrayBuffer(ctx, &size, element.val);
+      if (!buf)
+      {
+        return JS_ThrowTypeError(
+          ctx, "Array element %u must be an ArrayBuffer", i);
+      }
+      out.emplace_back(buf, buf + size);
+    }
+
+    return ccf::js::core::constants::Undefined;
+  }
+
 #define JS_CHECK_HANDLE(h) \
   do \
   { \
@@ -326,6 +382,260 @@ namespace ccf::js::extensions::kvhelpers
 
     return ccf::js::core::constants::Undefined;
   }
+  template <ROHandleGetter GetReadOnlyHandle>
+  static JSValue js_kv_map_get_many(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    js::core::Context& jsctx =
+      *static_cast<js::core::Context*>(JS_GetContextOpaque(ctx));
+
+    if (argc != 1)
+    {
+      return JS_ThrowTypeError(
+        ctx, "Passed %d arguments, but expected 1", argc);
+    }
+
+    std::vector<KVKey> keys;
+    auto ret = extract_array_buffers(ctx, argv[0], keys);
+    if (JS_IsException(ret) != 0)
+    {
+      return ret;
+    }
+
+    auto* handle = GetReadOnlyHandle(jsctx, this_val);
+    JS_CHECK_HANDLE(handle);
+
+    auto values = jsctx.new_array();
+    JS_CHECK_EXC(values);
+
+    for (uint32_t i = 0; i < keys.size(); ++i)
+    {
+      auto val = handle->get(keys[i]);
+      if (!val.has_value())
+      {
+        JS_CHECK_SET(values.set_at_index(
+          i, jsctx.wrap(ccf::js::core::constants::Undefined)));
+        continue;
+      }
+
+      auto buf = jsctx.new_array_buffer_copy(val->data(), val->size());
+      JS_CHECK_EXC(buf);
+      JS_CHECK_SET(values.set_at_index(i, std::move(buf)));
+    }
+
+    return values.take();
+  }
+
+  template <RWHandleGetter GetWriteHandle>
+  static JSValue js_kv_map_set_many(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    js::core::Context& jsctx =
+      *static_cast<js::core::Context*>(JS_GetContextOpaque(ctx));
+
+    if (argc != 1)
+    {
+      return JS_ThrowTypeError(
+        ctx, "Passed %d arguments, but expected 1", argc);
+    }
+
+    auto entries = jsctx.duplicate_value(argv[0]);
+    uint32_t len = 0;
+    auto ret = get_array_length(ctx, entries, len);
+    if (JS_IsException(ret) != 0)
+    {
+      return ret;
+    }
+
+    std::vector<std::pair<KVKey, KVValue>> writes;
+    writes.reserve(len);
+    for (uint32_t i = 0; i < len; ++i)
+    {
+      auto entry = entries[i];
+      JS_CHECK_EXC(entry);
+      if (JS_IsArray(ctx, entry.val) == 0)
+      {
+        return JS_ThrowTypeError(
+          ctx, "Array element %u must be a [key, value] array", i);
+      }
+
+      auto key_val = entry[0u];
+      JS_CHECK_EXC(key_val);
+      auto value_val = entry[1u];
+      JS_CHECK_EXC(value_val);
+
+      size_t key_size = 0;
+      uint8_t* key = JS_GetArrayBuffer(ctx, &key_size, key_val.val);
+
+      size_t val_size = 0;
+      uint8_t* val = JS_GetArrayBuffer(ctx, &val_size, value_val.val);
+
+      if (!key || !val)
+      {
+        return JS_ThrowTypeError(
+          ctx, "Key and value of array element %u must be ArrayBuffers", i);
+      }
+
+      writes.emplace_back(
+        KVKey(key, key + key_size),
+        KVValue(val, val + val_size));
+    }
+
+    auto* handle = GetWriteHandle(jsctx, this_val);
+    JS_CHECK_HANDLE(handle);
+
+    for (const auto& [key, value] : writes)
+    {
+      handle->put(key, value);
+    }
+
+    return JS_DupValue(ctx, this_val);
+  }
+
+  template <RWHandleGetter GetWriteHandle>
+  static JSValue js_kv_map_delete_many(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    js::core::Context& jsctx =
+      *static_cast<js::core::Context*>(JS_GetContextOpaque(ctx));
+
+    if (argc != 1)
+    {
+      return JS_ThrowTypeError(
+        ctx, "Passed %d arguments, but expected 1", argc);
+    }
+
+    std::vector<KVKey> keys;
+    auto ret = extract_array_buffers(ctx, argv[0], keys);
+    if (JS_IsException(ret) != 0)
+    {
+      return ret;
+    }
+
+    auto* handle = GetWriteHandle(jsctx, this_val);
+    JS_CHECK_HANDLE(handle);
+
+    for (const auto& key : keys)
+    {
+      handle->remove(key);
+    }
+
+    return ccf::js::core::constants::Undefined;
+  }
+
+  template <ROHandleGetter GetReadOnlyHandle>
+  static JSValue js_kv_map_range(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    js::core::Context& jsctx =
+      *static_cast<js::core::Context*>(JS_GetContextOpaque(ctx));
+
+    if (argc > 3)
+    {
+      return JS_ThrowTypeError(
+        ctx, "Passed %d arguments, but expected at most 3", argc);
+    }
+
+    // Both bounds are optional. from is inclusive, to is exclusive
+    std::optional<KVKey> bounds[2];
+    for (int i = 0; i < 2 && i < argc; ++i)
+    {
+      if (JS_IsUndefined(argv[i]))
+      {
+        continue;
+      }
+
+      size_t bound_size = 0;
+      uint8_t* bound = JS_GetArrayBuffer(ctx, &bound_size, argv[i]);
+      if (!bound)
+      {
+        return JS_ThrowTypeError(
+          ctx, "Range bounds must be ArrayBuffers or undefined");
+      }
+      bounds[i].emplace(bound, bound + bound_size);
+    }
+
+    std::optional<uint32_t> limit = std::nullopt;
+    if (argc == 3 && !JS_IsUndefined(argv[2]))
+    {
+      int64_t n = 0;
+      if (JS_ToInt64(ctx, &n, argv[2]) != 0)
+      {
+        return ccf::js::core::constants::Exception;
+      }
+      if (n <= 0)
+      {
+        return JS_ThrowRangeError(ctx, "Limit must be a positive integer");
+      }
+      limit = static_cast<uint32_t>(std::min<int64_t>(n, UINT32_MAX));
+    }
+
+    auto* handle = GetReadOnlyHandle(jsctx, this_val);
+    JS_CHECK_HANDLE(handle);
+
+    auto entries = jsctx.new_array();
+    JS_CHECK_EXC(entries);
+
+    // Keys are visited in order. Once limit entries have been collected, the
+    // next key is returned as a cursor from which the caller can resume, so
+    // at most limit + 1 keys are needed from the map
+    const auto max_count = limit.has_value() ?
+      static_cast<size_t>(limit.value()) + 1 :
+      std::numeric_limits<size_t>::max();
+    uint32_t count = 0;
+    std::optional<KVKey> next = std::nullopt;
+    bool failed = false;
+    handle->range(
+      [&](const auto& k, const auto& v) {
+        if (failed || next.has_value())
+        {
+          return;
+        }
+
+        if (limit.has_value() && count == limit.value())
+        {
+          next = k;
+          return;
+        }
+
+        auto key = jsctx.new_array_buffer_copy(k.data(), k.size());
+        auto value = jsctx.new_array_buffer_copy(v.data(), v.size());
+        auto entry = jsctx.new_array();
+        if (
+          key.is_exception() || value.is_exception() ||
+          entry.is_exception() ||
+          entry.set_at_index(0, std::move(key)) != 1 ||
+          entry.set_at_index(1, std::move(value)) != 1 ||
+          entries.set_at_index(count, std::move(entry)) != 1)
+        {
+          failed = true;
+          return;
+        }
+        ++count;
+      },
+      bounds[0],
+      bounds[1],
+      max_count);
+
+    if (failed)
+    {
+      return ccf::js::core::constants::Exception;
+    }
+
+    auto result = jsctx.new_obj();
+    JS_CHECK_EXC(result);
+    JS_CHECK_SET(result.set("entries", std::move(entries)));
+
+    if (next.has_value())
+    {
+      auto next_val =
+        jsctx.new_array_buffer_copy(next->data(), next->size());
+      JS_CHECK_EXC(next_val);
+      JS_CHECK_SET(result.set("next", std::move(next_val)));
+    }
+
+    return result.take();
+  }
 #undef JS_CHECK_HANDLE
 
   template <ROHandleGetter GetReadOnlyHandle, RWHandleGetter GetWriteHandle>
@@ -410,6 +720,12 @@ namespace ccf::js::extensions::kvhelpers
     MAKE_WRITE_FUNCTION(js_kv_map_delete, "delete", 1);
     MAKE_WRITE_FUNCTION(js_kv_map_clear, "clear", 0);
 
+    // Batched variants, which cross into C++ once for many keys
+    MAKE_READ_FUNCTION(js_kv_map_get_many, "getMany", 1);
+    MAKE_READ_FUNCTION(js_kv_map_range, "range", 3);
+    MAKE_WRITE_FUNCTION(js_kv_map_set_many, "setMany", 1);
+    MAKE_WRITE_FUNCTION(js_kv_map_delete_many, "deleteMany", 1);
+
     // This is a _getter_, subtly different from a read-only function
     MAKE_FUNCTION(
       js_kv_map_size_getter,
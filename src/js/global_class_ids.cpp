@@ -11,6 +11,7 @@ namespace ccf::js
   JSClassID kv_historical_class_id = 0;
   JSClassID kv_map_handle_class_id = 0;
   JSClassID historical_state_class_id = 0;
+  JSClassID public_key_class_id = 0;
 
   JSClassDef kv_map_handle_class_def = {};
 
@@ -22,5 +23,7 @@ namespace ccf::js
 
     JS_NewClassID(&kv_map_handle_class_id);
     kv_map_handle_class_def.class_name = "KV Map Handle";
+
+    JS_NewClassID(&public_key_class_id);
   }
 }
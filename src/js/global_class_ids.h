@@ -10,11 +10,13 @@ namespace ccf::js
   extern JSClassID kv_historical_class_id;
   extern JSClassID kv_map_handle_class_id;
   extern JSClassID historical_state_class_id;
+  extern JSClassID public_key_class_id;
 
   extern JSClassDef kv_class_def;
   extern JSClassDef kv_historical_class_def;
   extern JSClassDef kv_map_handle_class_def;
   extern JSClassDef historical_state_class_def;
+  extern JSClassDef public_key_class_def;
 
   // Not thread-safe, must happen exactly once
   void register_class_ids();
@@ -2,13 +2,23 @@
 // Licensed under the Apache 2.0 License.
 #pragma once
 
+#include "ccf/js/core/context.h"
 #include "ccf/js/interpreter_cache_interface.h"
 #include "ccf/pal/locking.h"
 #include "ds/lru.h"
+#include "js/modules/preloaded_bytecode_module_loader.h"
+#include "tasks/basic_task.h"
+#include "tasks/job_board.h"
+
+#include <deque>
+#include <map>
+#include <set>
 
 namespace ccf::js
 {
-  class InterpreterCache : public AbstractInterpreterCache
+  class InterpreterCache
+    : public AbstractInterpreterCache,
+      public std::enable_shared_from_this<InterpreterCache>
   {
   protected:
     // Locks access to all internal fields
@@ -18,18 +28,151 @@ namespace ccf::js
 
     InterpreterFactory interpreter_factory = nullptr;
 
-    std::shared_ptr<js::core::Context> make_interpreter(js::TxAccess access)
+    // Fresh interpreters for endpoints without a reuse policy, constructed by
+    // tasks on job_board. Each is handed out at most once. If job_board is
+    // null, fresh interpreters are only constructed on demand.
+    ccf::tasks::JobBoard* job_board;
+    size_t max_prewarmed_interpreters;
+    std::map<js::TxAccess, std::deque<std::shared_ptr<js::core::Context>>>
+      prewarmed;
+    std::set<js::TxAccess> refilling;
+
+    // Module bytecode seen at cache_build_marker, which is loaded into
+    // prewarmed interpreters. Replaced rather than modified, so that it can be
+    // read by a refill task without holding the lock.
+    js::modules::PreloadedModulesPtr preloaded_modules =
+      std::make_shared<js::modules::PreloadedModules>();
+
+    std::shared_ptr<js::core::Context> make_interpreter(
+      js::TxAccess access, const InterpreterFactory& factory)
     {
-      if (interpreter_factory != nullptr)
+      if (factory != nullptr)
       {
-        return interpreter_factory(access);
+        return factory(access);
       }
 
       return std::make_shared<js::core::Context>(access);
     }
 
+    std::shared_ptr<js::core::Context> make_interpreter(js::TxAccess access)
+    {
+      return make_interpreter(access, interpreter_factory);
+    }
+
+    std::shared_ptr<js::core::Context> make_prewarmed_interpreter(
+      js::TxAccess access,
+      const InterpreterFactory& factory,
+      const js::modules::PreloadedModulesPtr& modules)
+    {
+      auto interpreter = make_interpreter(access, factory);
+      if (modules->empty())
+      {
+        return interpreter;
+      }
+
+      try
+      {
+        auto& ctx = *interpreter;
+        std::lock_guard<ccf::pal::Mutex> guard(ctx.lock);
+        JS_UpdateStackTop(ctx.runtime());
+        ctx.runtime().reset_runtime_options();
+        ctx.set_module_loader(
+          std::make_shared<js::modules::PreloadedBytecodeModuleLoader>(
+            modules));
+        for (const auto& [module_name, _] : *modules)
+        {
+          ctx.get_module(module_name);
+        }
+        ctx.set_module_loader(nullptr);
+        return interpreter;
+      }
+      catch (const std::exception& e)
+      {
+        // Loading will be retried, and report its error, during execution
+        LOG_INFO_FMT("Unable to preload JS modules: {}", e.what());
+        return make_interpreter(access, factory);
+      }
+    }
+
+    // Must be called with lock held
+    void schedule_refill(js::TxAccess access)
+    {
+      if (
+        job_board == nullptr || max_prewarmed_interpreters == 0 ||
+        refilling.contains(access))
+      {
+        return;
+      }
+
+      refilling.insert(access);
+      job_board->add_task(ccf::tasks::make_basic_task(
+        [weak_self = weak_from_this(), access]() {
+          auto self = weak_self.lock();
+          if (self != nullptr)
+          {
+            self->refill(access);
+          }
+        },
+        "InterpreterCache::refill"));
+    }
+
+    void refill(js::TxAccess access)
+    {
+      while (true)
+      {
+        size_t marker = 0;
+        InterpreterFactory factory = nullptr;
+        js::modules::PreloadedModulesPtr modules = nullptr;
+        {
+          std::lock_guard<ccf::pal::Mutex> guard(lock);
+          if (prewarmed[access].size() >= max_prewarmed_interpreters)
+          {
+            refilling.erase(access);
+            return;
+          }
+          marker = cache_build_marker;
+          factory = interpreter_factory;
+          modules = preloaded_modules;
+        }
+
+        std::shared_ptr<js::core::Context> interpreter = nullptr;
+        try
+        {
+          interpreter = make_prewarmed_interpreter(access, factory, modules);
+        }
+        catch (const std::exception& e)
+        {
+          LOG_FAIL_FMT("Unable to prewarm JS interpreter: {}", e.what());
+          std::lock_guard<ccf::pal::Mutex> guard(lock);
+          refilling.erase(access);
+          return;
+        }
+
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        // Discard any interpreter built for a previous app
+        if (marker == cache_build_marker && modules == preloaded_modules)
+        {
+          prewarmed[access].push_back(std::move(interpreter));
+        }
+      }
+    }
+
+    // Must be called with lock held
+    void clear_prewarmed()
+    {
+      prewarmed.clear();
+      preloaded_modules = std::make_shared<js::modules::PreloadedModules>();
+    }
+
   public:
-    InterpreterCache(size_t max_cache_size) : lru(max_cache_size) {}
+    InterpreterCache(
+      size_t max_cache_size,
+      ccf::tasks::JobBoard* job_board_ = nullptr,
+      size_t max_prewarmed_interpreters_ = 0) :
+      lru(max_cache_size),
+      job_board(job_board_),
+      max_prewarmed_interpreters(max_prewarmed_interpreters_)
+    {}
 
     std::shared_ptr<js::core::Context> get_interpreter(
       js::TxAccess access,
@@ -44,7 +187,7 @@ namespace ccf::js
           "interpreters");
       }
 
-      std::lock_guard<ccf::pal::Mutex> guard(lock);
+      std::unique_lock<ccf::pal::Mutex> guard(lock);
 
       if (cache_build_marker != freshness_marker)
       {
@@ -53,6 +196,7 @@ namespace ccf::js
           cache_build_marker,
           freshness_marker);
         lru.clear();
+        clear_prewarmed();
         cache_build_marker = freshness_marker;
       }
 
@@ -72,30 +216,56 @@ namespace ccf::js
               key += " (ro)";
             }
             auto it = lru.find(key);
-            if (it == lru.end())
-            {
-              it = lru.insert(key, make_interpreter(access));
-              LOG_INFO_FMT(
-                "Constructed cached JS interpreter at key {}. Cache now "
-                "contains {} interpreters",
-                key,
-                lru.size());
-            }
-            else
+            if (it != lru.end())
             {
               LOG_TRACE_FMT(
                 "Returning interpreter previously in cache, with key {}", key);
               lru.promote(it);
+              return it->second;
             }
 
+            // Construct without holding the lock, so that other requests
+            // are not blocked meanwhile
+            auto factory = interpreter_factory;
+            guard.unlock();
+            auto interpreter = make_interpreter(access, factory);
+            guard.lock();
+
+            if (cache_build_marker != freshness_marker)
+            {
+              // The app changed meanwhile, so this interpreter is used once
+              // but not cached
+              return interpreter;
+            }
+
+            // If another request cached an interpreter at this key meanwhile,
+            // that one is kept and returned
+            it = lru.insert(key, std::move(interpreter));
+            LOG_INFO_FMT(
+              "Constructed cached JS interpreter at key {}. Cache now "
+              "contains {} interpreters",
+              key,
+              lru.size());
             return it->second;
           }
         }
       }
 
       // Return a fresh interpreter, not stored in the cache
+      schedule_refill(access);
+      auto& pool = prewarmed[access];
+      if (!pool.empty())
+      {
+        LOG_TRACE_FMT("Returning prewarmed interpreter");
+        auto interpreter = std::move(pool.front());
+        pool.pop_front();
+        return interpreter;
+      }
+
       LOG_TRACE_FMT("Returning freshly constructed interpreter");
-      return make_interpreter(access);
+      auto factory = interpreter_factory;
+      guard.unlock();
+      return make_interpreter(access, factory);
     }
 
     void set_max_cached_interpreters(size_t max) override
@@ -104,9 +274,39 @@ namespace ccf::js
       lru.set_max_size(max);
     }
 
+    void record_module_bytecode(
+      size_t freshness_marker,
+      std::string_view module_name,
+      const std::vector<uint8_t>& bytecode) override
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
+      if (
+        job_board == nullptr || max_prewarmed_interpreters == 0 ||
+        freshness_marker != cache_build_marker ||
+        preloaded_modules->contains(module_name))
+      {
+        return;
+      }
+
+      auto modules =
+        std::make_shared<js::modules::PreloadedModules>(*preloaded_modules);
+      modules->emplace(module_name, bytecode);
+      preloaded_modules = std::move(modules);
+
+      // Interpreters which do not yet have this module are still usable, but
+      // are replaced so that later requests benefit from it
+      for (auto& [access, pool] : prewarmed)
+      {
+        pool.clear();
+        schedule_refill(access);
+      }
+    }
+
     void set_interpreter_factory(const InterpreterFactory& ip) override
     {
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
       interpreter_factory = ip;
+      prewarmed.clear();
     }
   };
 }
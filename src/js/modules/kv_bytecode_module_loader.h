@@ -8,22 +8,33 @@
 #include "ccf/version.h"
 #include "ds/internal_logger.h"
 
+#include <functional>
 #include <string>
 
 namespace ccf::js::modules
 {
   class KvBytecodeModuleLoader : public ModuleLoaderInterface
   {
+  public:
+    // Called with the name and bytecode of each module successfully loaded
+    // from the KV
+    using BytecodeObserver = std::function<void(
+      std::string_view module_name, const std::vector<uint8_t>& bytecode)>;
+
   protected:
     ccf::ModulesQuickJsBytecode::ReadOnlyHandle* modules_bytecode_handle;
 
     bool version_ok;
 
+    BytecodeObserver observer;
+
   public:
     KvBytecodeModuleLoader(
       ccf::ModulesQuickJsBytecode::ReadOnlyHandle* mbh,
-      ccf::ModulesQuickJsVersion::ReadOnlyHandle* modules_version_handle) :
-      modules_bytecode_handle(mbh)
+      ccf::ModulesQuickJsVersion::ReadOnlyHandle* modules_version_handle,
+      BytecodeObserver observer_ = nullptr) :
+      modules_bytecode_handle(mbh),
+      observer(std::move(observer_))
     {
       const auto version_in_kv = modules_version_handle->get();
       const auto version_in_binary = std::string(ccf::quickjs_version);
@@ -90,6 +101,12 @@ namespace ccf::js::modules
         "Module '{}' bytecode found in KV (table: {})",
         module_name_kv,
         modules_bytecode_handle->get_name_of_map());
+
+      if (observer != nullptr)
+      {
+        observer(module_name, *module_bytecode);
+      }
+
       return module_val;
     }
   };
@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/js/core/context.h"
+#include "ccf/js/modules/module_loader_interface.h"
+#include "ds/internal_logger.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ccf::js::modules
+{
+  // Module bytecode, keyed by the module name it was loaded under
+  using PreloadedModules =
+    std::map<std::string, std::vector<uint8_t>, std::less<>>;
+  using PreloadedModulesPtr = std::shared_ptr<const PreloadedModules>;
+
+  // Loads modules from bytecode which was previously read from the KV, so that
+  // modules can be loaded into an interpreter outside of any transaction
+  class PreloadedBytecodeModuleLoader : public ModuleLoaderInterface
+  {
+  protected:
+    PreloadedModulesPtr modules;
+
+  public:
+    PreloadedBytecodeModuleLoader(PreloadedModulesPtr modules_) :
+      modules(std::move(modules_))
+    {}
+
+    std::optional<js::core::JSWrappedValue> get_module(
+      std::string_view module_name, js::core::Context& ctx) override
+    {
+      auto it = modules->find(module_name);
+      if (it == modules->end())
+      {
+        CCF_APP_TRACE("Module '{}' not preloaded", module_name);
+        return std::nullopt;
+      }
+
+      const auto& module_bytecode = it->second;
+      auto module_val = ctx.read_object(
+        module_bytecode.data(), module_bytecode.size(), JS_READ_OBJ_BYTECODE);
+
+      if (module_val.is_exception())
+      {
+        auto [reason, trace] = ctx.error_message();
+        throw std::runtime_error(fmt::format(
+          "Failed to deserialize preloaded bytecode for module '{}': {}",
+          module_name,
+          reason));
+      }
+
+      return module_val;
+    }
+  };
+}
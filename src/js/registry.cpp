@@ -111,7 +111,14 @@ namespace ccf::js
         endpoint_ctx.tx.ro<ccf::ModulesQuickJsBytecode>(
           modules_quickjs_bytecode_map),
         endpoint_ctx.tx.ro<ccf::ModulesQuickJsVersion>(
-          modules_quickjs_version_map)),
+          modules_quickjs_version_map),
+        // Allow fresh interpreters to be constructed with these modules
+        // already loaded, for later requests against the same app
+        [this, flush_marker](
+          std::string_view module_name, const std::vector<uint8_t>& bytecode) {
+          interpreter_cache->record_module_bytecode(
+            flush_marker, module_name, bytecode);
+        }),
       std::make_shared<ccf::js::modules::KvModuleLoader>(
         endpoint_ctx.tx.ro<ccf::Modules>(modules_map))};
     auto module_loader =
@@ -1,13 +1,19 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the Apache 2.0 License.
 #include "ccf/js/core/wrapped_value.h"
+#include "ccf/js/extensions/ccf/crypto.h"
 #include "ccf/js/extensions/ccf/gov.h"
+#include "ccf/js/extensions/ccf/kv.h"
 #include "js/global_class_ids.h"
+#include "js/interpreter_cache.h"
 #include "js/permissions_checks.h"
+#include "kv/store.h"
+#include "tasks/job_board.h"
 
 #define DOCTEST_CONFIG_IMPLEMENT
 #include <doctest/doctest.h>
 #include <random>
+#include <set>
 
 using namespace ccf::js;
 
@@ -635,6 +641,205 @@ TEST_CASE("Context::to_str preserves embedded NUL bytes")
   }
 }
 
+TEST_CASE("Prewarmed interpreters")
+{
+  static constexpr size_t max_prewarmed = 2;
+  ccf::tasks::JobBoard job_board;
+  auto cache =
+    std::make_shared<InterpreterCache>(10, &job_board, max_prewarmed);
+
+  auto run_tasks = [&]() {
+    while (auto task = job_board.get_task())
+    {
+      task->do_task();
+    }
+  };
+
+  const std::string module_name = "/module.js";
+  std::vector<uint8_t> bytecode;
+  {
+    ccf::js::core::Context ctx(TxAccess::APP_RO);
+    const std::string src = "export function f() { return 42; }";
+    auto module_val = ctx.eval(
+      src.c_str(),
+      src.size(),
+      module_name.c_str(),
+      JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    REQUIRE(!module_val.is_exception());
+    size_t len = 0;
+    uint8_t* buf =
+      JS_WriteObject(ctx, &len, module_val.val, JS_WRITE_OBJ_BYTECODE);
+    REQUIRE(buf != nullptr);
+    bytecode.assign(buf, buf + len);
+    js_free(ctx, buf);
+  }
+
+  const std::optional<ccf::endpoints::InterpreterReusePolicy> no_reuse =
+    std::nullopt;
+  size_t marker = 1;
+  std::set<std::shared_ptr<ccf::js::core::Context>> seen;
+
+  {
+    INFO("With an empty pool, interpreters are constructed on demand");
+    auto interpreter =
+      cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+    REQUIRE(interpreter != nullptr);
+    seen.insert(interpreter);
+    REQUIRE(job_board.get_summary().pending_tasks == 1);
+  }
+
+  {
+    INFO("Refill constructs interpreters which are each returned once");
+    run_tasks();
+    for (size_t i = 0; i < max_prewarmed; ++i)
+    {
+      auto interpreter =
+        cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+      REQUIRE(seen.insert(interpreter).second);
+      // Prewarmed interpreters are constructed without any modules
+      REQUIRE_FALSE(interpreter->get_module(module_name).has_value());
+    }
+  }
+
+  {
+    INFO("Recorded modules are loaded into prewarmed interpreters");
+    cache->record_module_bytecode(marker, module_name, bytecode);
+    run_tasks();
+    auto interpreter =
+      cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+    REQUIRE(seen.insert(interpreter).second);
+    // No module loader is installed, so this must be preloaded
+    auto module_val = interpreter->get_module(module_name);
+    REQUIRE(module_val.has_value());
+    auto f = interpreter->get_exported_function(*module_val, "f", module_name);
+    auto val = interpreter->call_with_rt_options(
+      f, {}, std::nullopt, ccf::js::core::RuntimeLimitsPolicy::NONE);
+    REQUIRE(interpreter->to_str(val) == "42");
+  }
+
+  {
+    INFO("Only the requested kind of interpreter is prewarmed");
+    run_tasks();
+    auto interpreter =
+      cache->get_interpreter(TxAccess::APP_RW, no_reuse, marker);
+    REQUIRE(interpreter->access == TxAccess::APP_RW);
+    REQUIRE_FALSE(interpreter->get_module(module_name).has_value());
+  }
+
+  {
+    INFO("A new marker discards prewarmed interpreters and modules");
+    run_tasks();
+    ++marker;
+    auto interpreter =
+      cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+    REQUIRE_FALSE(interpreter->get_module(module_name).has_value());
+
+    // Bytecode from a previous app is ignored
+    cache->record_module_bytecode(marker - 1, module_name, bytecode);
+    run_tasks();
+    interpreter = cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+    REQUIRE_FALSE(interpreter->get_module(module_name).has_value());
+  }
+}
+
+TEST_CASE("Imported public keys")
+{
+  ccf::js::core::Context ctx(TxAccess::APP_RO);
+  ctx.add_extension(
+    std::make_shared<ccf::js::extensions::CryptoExtension>());
+
+  const std::string script = R"(
+    const algorithm = { name: "ECDSA", hash: "SHA-256" };
+    const { privateKey, publicKey } =
+      ccf.crypto.generateEcdsaKeyPair("secp256r1");
+    const data = new ArrayBuffer(8);
+    const signature = ccf.crypto.sign(algorithm, privateKey, data);
+
+    const fromPem = ccf.crypto.importPublicKey(algorithm, publicKey);
+    const fromJwk = ccf.crypto.importPublicKey(
+      algorithm, ccf.crypto.pubPemToJwk(publicKey));
+
+    let wrongAlgorithm = false;
+    try {
+      ccf.crypto.verifySignature(
+        { name: "RSA-PSS", hash: "SHA-256" }, fromPem, signature, data);
+    } catch (e) {
+      wrongAlgorithm = true;
+    }
+
+    let badKey = false;
+    try {
+      ccf.crypto.importPublicKey(algorithm, "not a key");
+    } catch (e) {
+      badKey = true;
+    }
+
+    [
+      ccf.crypto.verifySignature(algorithm, publicKey, signature, data),
+      ccf.crypto.verifySignature(algorithm, publicKey, signature, data),
+      ccf.crypto.verifySignature(algorithm, fromPem, signature, data),
+      ccf.crypto.verifySignature(algorithm, fromJwk, signature, data),
+      !ccf.crypto.verifySignature(
+        algorithm, fromPem, signature, new ArrayBuffer(9)),
+      wrongAlgorithm,
+      badKey,
+    ].join(",")
+  )";
+
+  auto result =
+    ctx.eval(script.c_str(), script.size(), "<test>", JS_EVAL_TYPE_GLOBAL);
+  REQUIRE_FALSE(result.is_exception());
+  REQUIRE(ctx.to_str(result) == "true,true,true,true,true,true,true");
+}
+
+TEST_CASE("Batched KV access")
+{
+  ccf::kv::Store kv_store;
+  auto tx = kv_store.create_tx();
+
+  ccf::js::core::Context ctx(TxAccess::APP_RW);
+  ctx.add_extension(std::make_shared<ccf::js::extensions::KvExtension>(&tx));
+
+  const std::string script = R"(
+    const m = ccf.kv["data"];
+    const b = (n) => new Uint8Array([n]).buffer;
+    const n = (v) => (v === undefined ? "u" : new Uint8Array(v)[0]);
+
+    m.setMany([[b(3), b(30)], [b(1), b(10)], [b(2), b(20)], [b(4), b(40)]]);
+    const got = m.getMany([b(2), b(5), b(1)]).map(n).join(" ");
+
+    const first = m.range(undefined, b(4), 2);
+    const second = m.range(first.next, b(4), 2);
+    const pages = [first, second].map(
+      (p) =>
+        p.entries.map(([k, v]) => `${n(k)}:${n(v)}`).join(" ") + "|" +
+        n(p.next));
+
+    m.deleteMany([b(1), b(2)]);
+    const after = m.getMany([b(1), b(2), b(3), b(4)]).map(n).join(" ");
+
+    let invalid = false;
+    try {
+      m.setMany([[b(9), b(90)], [b(8), "not a buffer"]]);
+    } catch (e) {
+      invalid = true;
+    }
+
+    [got, ...pages, after, invalid, m.has(b(9))].join(";")
+  )";
+
+  auto result =
+    ctx.eval(script.c_str(), script.size(), "<test>", JS_EVAL_TYPE_GLOBAL);
+  REQUIRE_FALSE(result.is_exception());
+  REQUIRE(
+    ctx.to_str(result) == "20 u 10;1:10 2:20|3;3:30|u;u u 30 40;true;false");
+
+  // Values written by the batched calls are visible to the transaction
+  auto handle = tx.ro<ccf::kv::untyped::Map>("data");
+  REQUIRE(handle->size() == 2);
+  REQUIRE(handle->get({3}) == ccf::kv::untyped::Map::Handle::ValueType{30});
+}
+
 int main(int argc, char** argv)
 {
   ccf::js::register_class_ids();
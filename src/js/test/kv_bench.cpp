@@ -0,0 +1,355 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define PICOBENCH_IMPLEMENT
+
+#include "ccf/js/core/context.h"
+#include "ccf/js/extensions/ccf/crypto.h"
+#include "ccf/js/extensions/ccf/kv.h"
+#include "js/global_class_ids.h"
+#include "js/interpreter_cache.h"
+#include "kv/store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <picobench/picobench.hpp>
+#include <string>
+#include <vector>
+
+// Defines functions which access the same keys, either with one call per key
+// (or per callback) or with a single batched call
+static constexpr auto setup_script = R"(
+  const m = ccf.kv["data"];
+  const keys = [];
+  const entries = [];
+
+  function init(n) {
+    for (let i = 0; i < n; ++i) {
+      const key = new Uint32Array([i]).buffer;
+      keys.push(key);
+      entries.push([key, new Uint32Array([i, i, i, i]).buffer]);
+    }
+    setBatched();
+  }
+
+  function getPerKey() {
+    return keys.map((k) => m.get(k));
+  }
+
+  function getBatched() {
+    return m.getMany(keys);
+  }
+
+  function setPerKey() {
+    for (const [k, v] of entries) {
+      m.set(k, v);
+    }
+  }
+
+  function setBatched() {
+    m.setMany(entries);
+  }
+
+  function iterateForEach() {
+    const res = [];
+    m.forEach((v, k) => res.push([k, v]));
+    return res;
+  }
+
+  function iterateRange() {
+    return m.range().entries;
+  }
+)";
+
+// Verifies a signature from each of a set of keys, passing each key either as
+// PEM (parsed, or found in the node's key cache) or as an imported handle
+static constexpr auto verify_script = R"(
+  const algorithm = { name: "ECDSA", hash: "SHA-256" };
+  const data = new ArrayBuffer(64);
+  const publicKeys = [];
+  const signatures = [];
+  let importedKeys = [];
+
+  function init(n) {
+    for (let i = 0; i < n; ++i) {
+      const { privateKey, publicKey } =
+        ccf.crypto.generateEcdsaKeyPair("secp256r1");
+      publicKeys.push(publicKey);
+      signatures.push(ccf.crypto.sign(algorithm, privateKey, data));
+    }
+  }
+
+  function importKeys() {
+    importedKeys = publicKeys.map((k) =>
+      ccf.crypto.importPublicKey(algorithm, k));
+  }
+
+  function verifyAll(keys) {
+    keys.forEach((k, i) => {
+      if (!ccf.crypto.verifySignature(algorithm, k, signatures[i], data)) {
+        throw new Error("Invalid signature");
+      }
+    });
+  }
+)";
+
+static void eval(ccf::js::core::Context& ctx, const std::string& script)
+{
+  auto val =
+    ctx.eval(script.c_str(), script.size(), "<bench>", JS_EVAL_TYPE_GLOBAL);
+  if (val.is_exception())
+  {
+    auto [reason, trace] = ctx.error_message();
+    throw std::runtime_error(reason);
+  }
+}
+
+static void run(picobench::state& s, const std::string& call)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  ccf::kv::Store kv_store;
+  auto tx = kv_store.create_tx();
+
+  ccf::js::core::Context ctx(ccf::js::TxAccess::APP_RW);
+  ctx.add_extension(std::make_shared<ccf::js::extensions::KvExtension>(&tx));
+  eval(ctx, setup_script);
+  eval(ctx, fmt::format("init({})", s.iterations()));
+
+  s.start_timer();
+  eval(ctx, call);
+  s.stop_timer();
+}
+
+// Keys are generated afresh for each run, so are not in the node's key cache
+// until they have been used or imported by setup
+static void run_verify(
+  picobench::state& s, const std::string& setup, const std::string& call)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  ccf::js::core::Context ctx(ccf::js::TxAccess::APP_RO);
+  ctx.add_extension(
+    std::make_shared<ccf::js::extensions::CryptoExtension>());
+  eval(ctx, verify_script);
+  eval(ctx, fmt::format("init({})", s.iterations()));
+  eval(ctx, setup);
+
+  s.start_timer();
+  eval(ctx, call);
+  s.stop_timer();
+}
+
+static void get_per_key(picobench::state& s)
+{
+  run(s, "getPerKey()");
+}
+
+static void get_batched(picobench::state& s)
+{
+  run(s, "getBatched()");
+}
+
+static void set_per_key(picobench::state& s)
+{
+  run(s, "setPerKey()");
+}
+
+static void set_batched(picobench::state& s)
+{
+  run(s, "setBatched()");
+}
+
+static void iterate_foreach(picobench::state& s)
+{
+  run(s, "iterateForEach()");
+}
+
+static void iterate_range(picobench::state& s)
+{
+  run(s, "iterateRange()");
+}
+
+static void verify_new_keys(picobench::state& s)
+{
+  run_verify(s, "", "verifyAll(publicKeys)");
+}
+
+static void verify_cached_keys(picobench::state& s)
+{
+  run_verify(s, "verifyAll(publicKeys)", "verifyAll(publicKeys)");
+}
+
+static void verify_imported_keys(picobench::state& s)
+{
+  run_verify(s, "importKeys()", "verifyAll(importedKeys)");
+}
+
+// A module set standing in for an app bundle, each module exporting a
+// handful of functions
+static std::vector<std::pair<std::string, std::vector<uint8_t>>>
+compile_modules(size_t n)
+{
+  ccf::js::core::Context ctx(ccf::js::TxAccess::APP_RO);
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> modules;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const auto name = fmt::format("/module_{}.js", i);
+    std::string src;
+    for (size_t j = 0; j < 20; ++j)
+    {
+      src += fmt::format(
+        "export function f{0}(a) {{ return a.map((x) => x * {0} + {1}); }}\n",
+        j,
+        i);
+    }
+    auto module_val = ctx.eval(
+      src.c_str(),
+      src.size(),
+      name.c_str(),
+      JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    if (module_val.is_exception())
+    {
+      auto [reason, trace] = ctx.error_message();
+      throw std::runtime_error(reason);
+    }
+    size_t len = 0;
+    uint8_t* buf =
+      JS_WriteObject(ctx, &len, module_val.val, JS_WRITE_OBJ_BYTECODE);
+    modules.emplace_back(name, std::vector<uint8_t>(buf, buf + len));
+    js_free(ctx, buf);
+  }
+  return modules;
+}
+
+// Measures the latency, for requests to an endpoint without a reuse policy,
+// of getting an interpreter with the app's modules loaded. Without a job
+// board each interpreter is constructed, and its modules deserialised, on
+// the request path. With one, interpreters are taken from the prewarmed
+// pool, which is refilled between requests as a worker thread would.
+template <bool Prewarmed>
+static void cold_start(picobench::state& s)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  constexpr size_t module_count = 20;
+  const auto modules = compile_modules(module_count);
+  auto preloaded = std::make_shared<ccf::js::modules::PreloadedModules>();
+  for (const auto& [name, bytecode] : modules)
+  {
+    preloaded->emplace(name, bytecode);
+  }
+
+  ccf::tasks::JobBoard job_board;
+  auto cache = std::make_shared<ccf::js::InterpreterCache>(
+    10, Prewarmed ? &job_board : nullptr, 4);
+  auto run_tasks = [&]() {
+    while (auto task = job_board.get_task())
+    {
+      task->do_task();
+    }
+  };
+
+  const std::optional<ccf::endpoints::InterpreterReusePolicy> no_reuse =
+    std::nullopt;
+  constexpr size_t marker = 1;
+  cache->get_interpreter(ccf::js::TxAccess::APP_RO, no_reuse, marker);
+  for (const auto& [name, bytecode] : modules)
+  {
+    cache->record_module_bytecode(marker, name, bytecode);
+  }
+  run_tasks();
+
+  std::vector<std::chrono::nanoseconds> latencies;
+  latencies.reserve(s.iterations());
+
+  s.start_timer();
+  for (auto _ : s)
+  {
+    (void)_;
+    const auto start = std::chrono::steady_clock::now();
+    auto interpreter =
+      cache->get_interpreter(ccf::js::TxAccess::APP_RO, no_reuse, marker);
+    interpreter->set_module_loader(
+      std::make_shared<ccf::js::modules::PreloadedBytecodeModuleLoader>(
+        preloaded));
+    for (const auto& [name, bytecode] : modules)
+    {
+      interpreter->get_module(name);
+    }
+    latencies.push_back(std::chrono::steady_clock::now() - start);
+    run_tasks();
+  }
+  s.stop_timer();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](size_t p) {
+    return latencies[(latencies.size() - 1) * p / 100].count();
+  };
+  std::cout << fmt::format(
+                 "cold start latency ({}) n={}: p50 {}ns, p99 {}ns, max {}ns",
+                 Prewarmed ? "prewarmed" : "on demand",
+                 latencies.size(),
+                 percentile(50),
+                 percentile(99),
+                 latencies.back().count())
+            << std::endl;
+}
+
+static void cold_start_on_demand(picobench::state& s)
+{
+  cold_start<false>(s);
+}
+
+static void cold_start_prewarmed(picobench::state& s)
+{
+  cold_start<true>(s);
+}
+
+const std::vector<int> key_counts = {10, 100, 1000};
+const auto sample_size = 10;
+
+PICOBENCH_SUITE("get");
+PICOBENCH(get_per_key).iterations(key_counts).samples(sample_size).baseline();
+PICOBENCH(get_batched).iterations(key_counts).samples(sample_size);
+
+PICOBENCH_SUITE("set");
+PICOBENCH(set_per_key).iterations(key_counts).samples(sample_size).baseline();
+PICOBENCH(set_batched).iterations(key_counts).samples(sample_size);
+
+// range() returns entries in key order, so also pays to sort them
+PICOBENCH_SUITE("iterate");
+PICOBENCH(iterate_foreach)
+  .iterations(key_counts)
+  .samples(sample_size)
+  .baseline();
+PICOBENCH(iterate_range).iterations(key_counts).samples(sample_size);
+
+// Fewer keys than the node's key cache holds
+const std::vector<int> verify_counts = {10, 100};
+PICOBENCH_SUITE("verify");
+PICOBENCH(verify_new_keys)
+  .iterations(verify_counts)
+  .samples(sample_size)
+  .baseline();
+PICOBENCH(verify_cached_keys).iterations(verify_counts).samples(sample_size);
+PICOBENCH(verify_imported_keys).iterations(verify_counts).samples(sample_size);
+
+// Timings include refilling the pool, which is off the request path, so
+// compare the printed per-request latencies instead
+const std::vector<int> request_counts = {100, 1000};
+PICOBENCH_SUITE("cold start");
+PICOBENCH(cold_start_on_demand)
+  .iterations(request_counts)
+  .samples(1)
+  .baseline();
+PICOBENCH(cold_start_prewarmed).iterations(request_counts).samples(1);
+
+int main(int argc, char** argv)
+{
+  ccf::js::register_class_ids();
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  return runner.run();
+}
@@ -75,13 +75,26 @@ namespace ccf::kv
 
     if (ok && has_writes)
     {
-      for (auto& [view_name, view_ptr] : views)
+      try
+      {
+        for (auto& [view_name, view_ptr] : views)
+        {
+          if (!view_ptr->prepare())
+          {
+            ok = false;
+            break;
+          }
+        }
+      }
+      catch (...)
       {
-        if (!view_ptr->prepare())
+        // Preparing may run merge functions. If one throws, no version has
+        // been assigned yet, so release the maps and fail the transaction
+        for (auto& [map_name, mc] : changes)
         {
-          ok = false;
-          break;
+          mc.map->unlock();
         }
+        throw;
       }
     }
 
@@ -58,12 +58,7 @@ namespace ccf::kv
       }
 
       // If no transactions made changes, return a zero length vector.
-      const bool any_changes =
-        std::any_of(all_changes.begin(), all_changes.end(), [](const auto& it) {
-          return it.second.changeset->has_writes();
-        });
-
-      if (!any_changes)
+      if (!has_writes())
       {
         return {};
       }
@@ -115,6 +110,15 @@ namespace ccf::kv
   public:
     CommittableTx(AbstractStore* _store) : Tx(_store) {}
 
+    // Whether any map has been written to in this transaction
+    [[nodiscard]] bool has_writes() const
+    {
+      return std::any_of(
+        all_changes.begin(), all_changes.end(), [](const auto& it) {
+          return it.second.changeset->has_writes();
+        });
+    }
+
     using WriteSetObserver = std::function<void(
       const ccf::crypto::Sha256Hash& write_set_digest,
       const std::string& commit_evidence)>;
@@ -150,6 +154,20 @@ namespace ccf::kv
         return CommitResult::SUCCESS;
       }
 
+      if (!pimpl->track_reads)
+      {
+        // Without a read set, writes cannot be checked for conflicts
+        if (has_writes())
+        {
+          throw std::logic_error(
+            "Cannot commit writes from a read-only transaction");
+        }
+
+        committed = true;
+        success = true;
+        return CommitResult::SUCCESS;
+      }
+
       // If this transaction creates any maps, ensure that commit gets a
       // consistent snapshot of the existing map set
       const bool maps_created = !pimpl->created_maps.empty();
@@ -163,17 +181,29 @@ namespace ccf::kv
       std::optional<Version> new_maps_conflict_version = std::nullopt;
 
       bool track_deletes_on_missing_keys = false;
-      auto c = apply_changes(
-        all_changes,
-        version_resolver == nullptr ?
-          [&](bool has_new_map) {
-            return pimpl->store->next_version(has_new_map);
-          } :
-          version_resolver,
-        hooks,
-        pimpl->created_maps,
-        new_maps_conflict_version,
-        track_deletes_on_missing_keys);
+      std::optional<Version> c = std::nullopt;
+      try
+      {
+        c = apply_changes(
+          all_changes,
+          version_resolver == nullptr ?
+            [&](bool has_new_map) {
+              return pimpl->store->next_version(has_new_map);
+            } :
+            version_resolver,
+          hooks,
+          pimpl->created_maps,
+          new_maps_conflict_version,
+          track_deletes_on_missing_keys);
+      }
+      catch (...)
+      {
+        if (maps_created)
+        {
+          this->pimpl->store->unlock_map_set();
+        }
+        throw;
+      }
 
       if (maps_created)
       {
@@ -359,6 +389,21 @@ namespace ccf::kv
     }
   };
 
+  // Used by frontend for read-only endpoints. These read the state at the
+  // version they are created at, and can never conflict, so do not record
+  // their reads and apply nothing on commit. Committing writes throws.
+  class ReadOnlyCommittableTx : public CommittableTx
+  {
+  public:
+    ReadOnlyCommittableTx(AbstractStore* _store) : CommittableTx(_store)
+    {
+      auto [read_txid, commit_view] = _store->current_txid_and_commit_term();
+      pimpl->read_txid = read_txid;
+      pimpl->commit_view = commit_view;
+      pimpl->track_reads = false;
+    }
+  };
+
   // Used by frontend for reserved transactions. These are constructed with a
   // pre-reserved Version, and _must succeed_ to fulfil this version. Otherwise
   // they create a hole in the transaction order, and no future transactions can
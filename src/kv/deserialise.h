@@ -6,30 +6,45 @@
 #include "ds/internal_logger.h"
 #include "kv/committable_tx.h"
 #include "kv/ledger_chunker_interface.h"
+#include "kv/untyped_change_set.h"
 #include "kv_types.h"
 #include "service/tables/shares.h"
 #include "service/tables/signatures.h"
 #include "service/tables/snapshot_evidence.h"
 
+#include <memory>
 #include <vector>
 
 namespace ccf::kv
 {
+  // A serialised entry which has been decrypted and parsed, but not yet
+  // applied to a store
+  struct DeserialisedEntry
+  {
+    ccf::kv::Version version{0};
+    ccf::kv::Term term{0};
+    ccf::kv::EntryFlags entry_flags{0};
+    ccf::ClaimsDigest claims_digest;
+    std::optional<ccf::crypto::Sha256Hash> commit_evidence_digest;
+    std::vector<std::pair<std::string, ccf::kv::untyped::DeserialisedChanges>>
+      maps;
+  };
+
   class ExecutionWrapperStore
   {
   public:
     virtual ~ExecutionWrapperStore() = default;
 
+    // Decrypts and parses data. This does not depend on the state of the
+    // store, so may be called concurrently for distinct entries. Returns
+    // nullptr (or throws) if the entry cannot be deserialised.
+    virtual std::unique_ptr<DeserialisedEntry> deserialise_entry(
+      const std::vector<uint8_t>& data, bool public_only) = 0;
+
     virtual bool fill_maps(
-      const std::vector<uint8_t>& data,
-      bool public_only,
-      ccf::kv::Version& v,
-      ccf::kv::Term& view,
-      ccf::kv::EntryFlags& entry_flags,
+      DeserialisedEntry& entry,
       ccf::kv::OrderedChanges& changes,
       ccf::kv::MapCollection& new_maps,
-      ccf::ClaimsDigest& claims_digest,
-      std::optional<ccf::crypto::Sha256Hash>& commit_evidence_digest,
       bool ignore_strict_versions = false) = 0;
 
     virtual bool commit_deserialised(
@@ -47,6 +62,7 @@ namespace ccf::kv
     ExecutionWrapperStore* store;
     std::shared_ptr<TxHistory> history;
     std::shared_ptr<ILedgerChunker> chunker;
+    std::shared_ptr<ILedgerEntryObserver> entry_observer;
     const std::vector<uint8_t> data;
     bool public_only;
     ccf::kv::Version version{0};
@@ -60,17 +76,22 @@ namespace ccf::kv
 
     const std::optional<TxID> expected_txid;
 
+    // Set by deserialise_ahead(), and consumed by apply()
+    std::unique_ptr<DeserialisedEntry> deserialised;
+
   public:
     CFTExecutionWrapper(
       ExecutionWrapperStore* store_,
       std::shared_ptr<TxHistory> history_,
       std::shared_ptr<ILedgerChunker> chunker_,
+      std::shared_ptr<ILedgerEntryObserver> entry_observer_,
       const std::vector<uint8_t>& data_,
       bool public_only_,
       const std::optional<TxID>& expected_txid_) :
       store(store_),
       history(std::move(history_)),
       chunker(std::move(chunker_)),
+      entry_observer(std::move(entry_observer_)),
       data(data_),
       public_only(public_only_),
       expected_txid(expected_txid_)
@@ -87,19 +108,41 @@ namespace ccf::kv
       return std::move(commit_evidence_digest);
     }
 
+    void deserialise_ahead() override
+    {
+      try
+      {
+        deserialised = store->deserialise_entry(data, public_only);
+      }
+      catch (const std::exception& e)
+      {
+        // The entry is deserialised again by apply(), which reports the error
+        LOG_DEBUG_FMT("Unable to deserialise entry ahead: {}", e.what());
+        deserialised = nullptr;
+      }
+    }
+
     ApplyResult apply(bool track_deletes_on_missing_keys) override
     {
-      if (!store->fill_maps(
-            data,
-            public_only,
-            version,
-            term,
-            entry_flags,
-            changes,
-            new_maps,
-            claims_digest,
-            commit_evidence_digest,
-            true))
+      if (deserialised == nullptr)
+      {
+        deserialised = store->deserialise_entry(data, public_only);
+        if (deserialised == nullptr)
+        {
+          return ApplyResult::FAIL;
+        }
+      }
+
+      version = deserialised->version;
+      term = deserialised->term;
+      entry_flags = deserialised->entry_flags;
+      claims_digest = std::move(deserialised->claims_digest);
+      commit_evidence_digest = std::move(deserialised->commit_evidence_digest);
+
+      const auto filled =
+        store->fill_maps(*deserialised, changes, new_maps, true);
+      deserialised = nullptr;
+      if (!filled)
       {
         return ApplyResult::FAIL;
       }
@@ -179,7 +222,9 @@ namespace ccf::kv
       if (history)
       {
         history->append_entry(
-          ccf::entry_leaf(data, commit_evidence_digest, claims_digest));
+          {ccf::crypto::Sha256Hash(data),
+           commit_evidence_digest,
+           claims_digest});
       }
 
       if (chunker)
@@ -197,6 +242,12 @@ namespace ccf::kv
         }
       }
 
+      if (entry_observer)
+      {
+        entry_observer->append_entry(
+          {term, version}, std::make_shared<std::vector<uint8_t>>(data));
+      }
+
       return success;
     }
 
@@ -20,6 +20,8 @@
 #include "ccf/tx_status.h"
 #include "crypto/openssl/ec_key_pair.h"
 #include "kv/ledger_chunker_interface.h"
+#include "kv/ledger_entry_observer_interface.h"
+#include "node/rpc/claims.h"
 #include "serialised_entry_format.h"
 
 #include <array>
@@ -30,6 +32,7 @@
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <tuple>
 #include <unordered_set>
@@ -403,8 +406,19 @@ namespace ccf::kv
     virtual std::vector<uint8_t> get_raw_leaf(uint64_t index) = 0;
     virtual void append(const std::vector<uint8_t>& data) = 0;
     virtual void append_entry(
-      const ccf::crypto::Sha256Hash& digest,
+      const ccf::EntryLeafComponents& leaf,
       std::optional<ccf::kv::Term> expected_term = std::nullopt) = 0;
+    // Equivalent to calling append_entry() on each of leaves in turn, but
+    // implementations may hash the leaves together
+    virtual void append_entries(
+      std::span<const ccf::EntryLeafComponents> leaves,
+      std::optional<ccf::kv::Term> expected_term = std::nullopt)
+    {
+      for (const auto& leaf : leaves)
+      {
+        append_entry(leaf, expected_term);
+      }
+    }
     virtual void rollback(
       const ccf::TxID& tx_id, ccf::kv::Term term_of_next_version_) = 0;
     virtual void compact(Version v) = 0;
@@ -464,6 +478,12 @@ namespace ccf::kv
 
     virtual void enable_all_domains() {}
 
+    // Called when the host reports that the ledger is durable up to seqno,
+    // having processed every truncation up to the given one
+    virtual void set_ledger_durable_seqno(
+      ccf::SeqNo /*seqno*/, uint64_t /*truncation_id*/)
+    {}
+
     virtual void set_retired_committed(
       ccf::SeqNo /*seqno*/, const std::vector<NodeId>& node_ids)
     {}
@@ -506,6 +526,22 @@ namespace ccf::kv
   class PendingTx
   {
   public:
+    // Called before call(). If this returns false, this transaction's
+    // content is being prepared asynchronously, and it (and all later
+    // transactions) are held until Store::resume_commit() is called.
+    virtual bool prepare()
+    {
+      return true;
+    }
+
+    // If true, all preceding transactions are appended to the history before
+    // prepare() is called. Otherwise, the history leaves of consecutive
+    // transactions may be appended together, after they have all been called.
+    [[nodiscard]] virtual bool prepare_reads_history() const
+    {
+      return false;
+    }
+
     virtual PendingTxInfo call() = 0;
     virtual ~PendingTx() = default;
   };
@@ -655,6 +691,11 @@ namespace ccf::kv
   {
   public:
     virtual ~AbstractExecutionWrapper() = default;
+    // Does the work of apply() which does not depend on the state of the
+    // store (decrypting and parsing the entry), so that it can be done ahead
+    // of time, concurrently for distinct entries. Entries must still be
+    // applied in order. If this fails, apply() retries and reports the error.
+    virtual void deserialise_ahead() {}
     virtual ccf::kv::ApplyResult apply(
       bool track_deletes_on_missing_keys = false) = 0;
     virtual ccf::kv::ConsensusHookPtrs& get_hooks() = 0;
@@ -721,6 +762,7 @@ namespace ccf::kv
     virtual std::shared_ptr<Consensus> get_consensus() = 0;
     virtual std::shared_ptr<TxHistory> get_history() = 0;
     virtual std::shared_ptr<ILedgerChunker> get_chunker() = 0;
+    virtual std::shared_ptr<ILedgerEntryObserver> get_entry_observer() = 0;
     virtual EncryptorPtr get_encryptor() = 0;
     virtual std::unique_ptr<AbstractExecutionWrapper> deserialize(
       const std::vector<uint8_t>& data,
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/kv/version.h"
+#include "ccf/tx_id.h"
+
+#include <memory>
+#include <vector>
+
+namespace ccf::kv
+{
+  // Given each serialised ledger entry as the local store produces (primary)
+  // or applies (backup) it, before it is committed
+  struct ILedgerEntryObserver
+  {
+    virtual ~ILedgerEntryObserver() = default;
+
+    virtual void append_entry(
+      const TxID& tx_id,
+      const std::shared_ptr<std::vector<uint8_t>>& entry) = 0;
+
+    virtual void rolled_back_to(Version) = 0;
+  };
+}
@@ -5,6 +5,7 @@
 #include "apply_changes.h"
 #include "ccf/kv/read_only_store.h"
 #include "ccf/pal/locking.h"
+#include "crypto/sha256_multibuffer.h"
 #include "deserialise.h"
 #include "ds/internal_logger.h"
 #include "kv/committable_tx.h"
@@ -16,6 +17,7 @@
 
 #define FMT_HEADER_ONLY
 #include <atomic>
+#include <condition_variable>
 #include <fmt/format.h>
 #include <memory>
 
@@ -46,8 +48,19 @@ namespace ccf::kv
     Version last_new_map = ccf::kv::NoVersion;
     std::atomic<Version> compacted = 0;
 
-    // Calls to Store::commit are made atomic by taking this lock.
-    ccf::pal::Mutex commit_lock;
+    // Set while a thread is replicating pending_txs. Committing threads which
+    // find it set wait for that thread to replicate their txs, rather than
+    // replicating them themselves. Protected by version_lock.
+    bool replicating = false;
+    // Each round of replication collects the contiguous pending_txs, and
+    // replicates them as one batch. Protected by version_lock.
+    size_t replication_rounds_started = 0;
+    size_t replication_rounds_finished = 0;
+    // Results of pending txs whose committing threads are waiting for another
+    // thread to replicate them. Protected by version_lock.
+    std::unordered_map<Version, std::optional<CommitResult>> awaited_results;
+    // Notified when a round of replication finishes
+    std::condition_variable replication_round_finished;
 
     // Term at which write future transactions should be committed.
     std::atomic<Term> term_of_next_version = 0;
@@ -67,6 +80,10 @@ namespace ccf::kv
 
     std::unordered_map<Version, std::tuple<std::unique_ptr<PendingTx>, bool>>
       pending_txs;
+    // Set when a tx is added to pending_txs, or a held tx is prepared, and
+    // cleared when pending_txs are collected for replication. Protected by
+    // version_lock.
+    bool pending_txs_changed = false;
 
   public:
     void clear()
@@ -103,6 +120,7 @@ namespace ccf::kv
     std::shared_ptr<Consensus> consensus = nullptr;
     std::shared_ptr<TxHistory> history = nullptr;
     std::shared_ptr<ILedgerChunker> chunker = nullptr;
+    std::shared_ptr<ILedgerEntryObserver> entry_observer = nullptr;
     EncryptorPtr encryptor = nullptr;
     SnapshotterPtr snapshotter = nullptr;
 
@@ -244,6 +262,17 @@ namespace ccf::kv
       chunker = chunker_;
     }
 
+    std::shared_ptr<ILedgerEntryObserver> get_entry_observer() override
+    {
+      return entry_observer;
+    }
+
+    void set_entry_observer(
+      const std::shared_ptr<ILedgerEntryObserver>& entry_observer_)
+    {
+      entry_observer = entry_observer_;
+    }
+
     void set_encryptor(const EncryptorPtr& encryptor_)
     {
       encryptor = encryptor_;
@@ -643,6 +672,11 @@ namespace ccf::kv
         chunker->rolled_back_to(tx_id.seqno);
       }
 
+      if (entry_observer)
+      {
+        entry_observer->rolled_back_to(tx_id.seqno);
+      }
+
       std::lock_guard<ccf::pal::Mutex> mguard(maps_lock);
 
       {
@@ -680,6 +714,15 @@ namespace ccf::kv
         last_committable = std::min(last_committable, tx_id.seqno);
         unset_flag_unsafe(StoreFlag::SNAPSHOT_AT_NEXT_SIGNATURE);
         rollback_count++;
+        // Pending txs which were waiting to be replicated never will be
+        for (const auto& [pending_version, pending_tx] : pending_txs)
+        {
+          auto it = awaited_results.find(pending_version);
+          if (it != awaited_results.end() && !it->second.has_value())
+          {
+            it->second = CommitResult::FAIL_NO_REPLICATE;
+          }
+        }
         pending_txs.clear();
         auto e = get_encryptor();
         if (e)
@@ -739,23 +782,9 @@ namespace ccf::kv
       }
     }
 
-    bool fill_maps(
-      const std::vector<uint8_t>& data,
-      bool public_only,
-      ccf::kv::Version& v,
-      ccf::kv::Term& view,
-      ccf::kv::EntryFlags& entry_flags,
-      OrderedChanges& changes,
-      MapCollection& new_maps,
-      ccf::ClaimsDigest& claims_digest,
-      std::optional<ccf::crypto::Sha256Hash>& commit_evidence_digest,
-      bool ignore_strict_versions = false) override
+    std::unique_ptr<DeserialisedEntry> deserialise_entry(
+      const std::vector<uint8_t>& data, bool public_only) override
     {
-      // This will return FAILED if the serialised transaction is being
-      // applied out of order.
-      // Processing transactions locally and also deserialising to the
-      // same store will result in a store version mismatch and
-      // deserialisation will then fail.
       auto e = get_encryptor();
 
       auto d = RawKvStoreDeserialiser(
@@ -763,29 +792,64 @@ namespace ccf::kv
         public_only ? ccf::kv::SecurityDomain::PUBLIC :
                       std::optional<ccf::kv::SecurityDomain>());
 
-      auto v_ =
-        d.init(data.data(), data.size(), view, entry_flags, is_historical);
+      auto entry = std::make_unique<DeserialisedEntry>();
+      auto v_ = d.init(
+        data.data(),
+        data.size(),
+        entry->term,
+        entry->entry_flags,
+        is_historical);
       if (!v_.has_value())
       {
         LOG_FAIL_FMT("Initialisation of deserialise object failed");
-        return false;
+        return nullptr;
       }
-      v = v_.value();
+      entry->version = v_.value();
 
-      claims_digest = std::move(d.consume_claims_digest());
+      entry->claims_digest = std::move(d.consume_claims_digest());
       LOG_TRACE_FMT(
         "Deserialised claim digest {} {}",
-        claims_digest.value(),
-        claims_digest.empty());
+        entry->claims_digest.value(),
+        entry->claims_digest.empty());
 
-      commit_evidence_digest = std::move(d.consume_commit_evidence_digest());
-      if (commit_evidence_digest.has_value())
+      entry->commit_evidence_digest =
+        std::move(d.consume_commit_evidence_digest());
+      if (entry->commit_evidence_digest.has_value())
       {
         LOG_TRACE_FMT(
           "Deserialised commit evidence digest {}",
-          commit_evidence_digest.value());
+          entry->commit_evidence_digest.value());
+      }
+
+      for (auto r = d.start_map(); r.has_value(); r = d.start_map())
+      {
+        entry->maps.emplace_back(
+          r.value(), ccf::kv::untyped::Map::parse_changes(d));
       }
 
+      if (!d.end())
+      {
+        LOG_FAIL_FMT(
+          "Unexpected content in transaction at version {}", entry->version);
+        return nullptr;
+      }
+
+      return entry;
+    }
+
+    bool fill_maps(
+      DeserialisedEntry& entry,
+      OrderedChanges& changes,
+      MapCollection& new_maps,
+      bool ignore_strict_versions = false) override
+    {
+      // This will return FAILED if the serialised transaction is being
+      // applied out of order.
+      // Processing transactions locally and also deserialising to the
+      // same store will result in a store version mismatch and
+      // deserialisation will then fail.
+      const auto v = entry.version;
+
       // Throw away any local commits that have not propagated via the
       // consensus.
       rollback({term_of_last_version, v - 1}, term_of_next_version);
@@ -808,10 +872,8 @@ namespace ccf::kv
       // lock each of the maps before creating the transaction.
       std::lock_guard<ccf::pal::Mutex> mguard(maps_lock);
 
-      for (auto r = d.start_map(); r.has_value(); r = d.start_map())
+      for (auto& [map_name, parsed] : entry.maps)
       {
-        const auto map_name = r.value();
-
         auto map = get_map_internal(v, map_name);
         if (map == nullptr)
         {
@@ -833,7 +895,8 @@ namespace ccf::kv
           return false;
         }
 
-        auto deserialised_changes = map->deserialise_changes(d, v);
+        auto deserialised_changes =
+          map->deserialise_changes(std::move(parsed), v);
 
         // Take ownership of the produced change set, store it to be applied
         // later
@@ -844,12 +907,6 @@ namespace ccf::kv
           std::forward_as_tuple(map, std::move(deserialised_changes)));
       }
 
-      if (!d.end())
-      {
-        LOG_FAIL_FMT("Unexpected content in transaction at version {}", v);
-        return false;
-      }
-
       return true;
     }
 
@@ -859,7 +916,13 @@ namespace ccf::kv
       const std::optional<TxID>& expected_txid = std::nullopt) override
     {
       auto exec = std::make_unique<CFTExecutionWrapper>(
-        this, get_history(), get_chunker(), data, public_only, expected_txid);
+        this,
+        get_history(),
+        get_chunker(),
+        get_entry_observer(),
+        data,
+        public_only,
+        expected_txid);
       return exec;
     }
 
@@ -942,48 +1005,171 @@ namespace ccf::kv
         return CommitResult::SUCCESS;
       }
 
-      std::lock_guard<ccf::pal::Mutex> cguard(commit_lock);
-
       LOG_DEBUG_FMT(
         "Store::commit {}{}",
         txid.seqno,
         (globally_committable ? " globally_committable" : ""));
 
-      BatchVector batch;
-      Version previous_last_replicated = 0;
-      Version next_last_replicated = 0;
-      Version previous_rollback_count = 0;
-      ccf::View replication_view = 0;
+      std::unique_lock<ccf::pal::Mutex> vguard(version_lock);
+      if (txid.view != term_of_next_version && get_consensus()->is_primary())
+      {
+        // This can happen when a transaction started before a view change,
+        // but tries to commit after the view change is complete.
+        LOG_DEBUG_FMT(
+          "Want to commit for term {} but term is {}",
+          txid.view,
+          term_of_next_version);
 
-      std::vector<std::tuple<std::unique_ptr<PendingTx>, bool>>
-        contiguous_pending_txs;
-      auto h = get_history();
+        return CommitResult::FAIL_NO_REPLICATE;
+      }
 
+      if (globally_committable && txid.seqno > last_committable)
       {
-        std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
-        if (txid.view != term_of_next_version && get_consensus()->is_primary())
+        last_committable = txid.seqno;
+      }
+
+      pending_txs.insert(
+        {txid.seqno,
+         std::make_tuple(std::move(pending_tx), globally_committable)});
+      pending_txs_changed = true;
+
+      LOG_TRACE_FMT("Inserting pending tx at {}", txid.seqno);
+
+      return try_replicate_pending_txs(c, txid, vguard, txid.seqno);
+    }
+
+    // Replicates the transactions which were held behind a pending tx whose
+    // content was being prepared asynchronously (see PendingTx::prepare())
+    CommitResult resume_commit()
+    {
+      auto c = get_consensus();
+      if (!c)
+      {
+        return CommitResult::SUCCESS;
+      }
+
+      const auto txid = current_txid();
+
+      std::unique_lock<ccf::pal::Mutex> vguard(version_lock);
+      LOG_DEBUG_FMT("Store::resume_commit after {}", last_replicated);
+      pending_txs_changed = true;
+
+      return try_replicate_pending_txs(c, txid, vguard);
+    }
+
+  private:
+    // A thread which is replicating runs further rounds while other threads
+    // add pending txs, up to this many, before handing over to one of them
+    static constexpr size_t max_replication_rounds = 16;
+
+    // Must be called with vguard holding version_lock, after adding a pending
+    // tx at awaited_version, or after preparing a held tx. Replicates pending
+    // txs, unless another thread is already doing so, in which case this
+    // waits for the round which collects them. Returns the result for the tx
+    // at awaited_version. If that tx is held behind one which is not yet
+    // prepared, it is replicated later, and SUCCESS is returned.
+    CommitResult try_replicate_pending_txs(
+      const std::shared_ptr<Consensus>& c,
+      const TxID& txid,
+      std::unique_lock<ccf::pal::Mutex>& vguard,
+      std::optional<Version> awaited_version = std::nullopt)
+    {
+      // The next round to start will collect this tx
+      const auto awaited_round = replication_rounds_started + 1;
+
+      auto take_result = [&]() {
+        if (!awaited_version.has_value())
         {
-          // This can happen when a transaction started before a view change,
-          // but tries to commit after the view change is complete.
-          LOG_DEBUG_FMT(
-            "Want to commit for term {} but term is {}",
-            txid.view,
-            term_of_next_version);
+          return CommitResult::SUCCESS;
+        }
+
+        auto it = awaited_results.find(awaited_version.value());
+        const auto result = it->second.value_or(CommitResult::SUCCESS);
+        awaited_results.erase(it);
+        return result;
+      };
 
-          return CommitResult::FAIL_NO_REPLICATE;
+      if (awaited_version.has_value())
+      {
+        awaited_results[awaited_version.value()] = std::nullopt;
+      }
+
+      while (replicating)
+      {
+        replication_round_finished.wait(vguard);
+        if (replication_rounds_finished >= awaited_round)
+        {
+          return take_result();
         }
+      }
 
-        if (globally_committable && txid.seqno > last_committable)
+      replicating = true;
+      vguard.unlock();
+
+      std::optional<CommitResult> first_result = std::nullopt;
+      try
+      {
+        for (size_t round = 0; round < max_replication_rounds; ++round)
         {
-          last_committable = txid.seqno;
+          const auto result = replicate_pending_txs(c, txid);
+          if (!first_result.has_value())
+          {
+            first_result = result;
+          }
+
+          std::lock_guard<ccf::pal::Mutex> round_guard(version_lock);
+          ++replication_rounds_finished;
+          replication_round_finished.notify_all();
+          if (!pending_txs_changed)
+          {
+            break;
+          }
         }
+      }
+      catch (...)
+      {
+        vguard.lock();
+        replicating = false;
+        replication_round_finished.notify_all();
+        if (awaited_version.has_value())
+        {
+          awaited_results.erase(awaited_version.value());
+        }
+        throw;
+      }
+
+      vguard.lock();
+      replicating = false;
+      // Any waiting thread whose round has not run takes over
+      replication_round_finished.notify_all();
 
-        pending_txs.insert(
-          {txid.seqno,
-           std::make_tuple(std::move(pending_tx), globally_committable)});
+      if (awaited_version.has_value())
+      {
+        return take_result();
+      }
 
-        LOG_TRACE_FMT("Inserting pending tx at {}", txid.seqno);
+      return first_result.value_or(CommitResult::SUCCESS);
+    }
 
+    // Must only be called by the replicating thread. txid is only used for
+    // logging
+    CommitResult replicate_pending_txs(
+      const std::shared_ptr<Consensus>& c, const TxID& txid)
+    {
+      BatchVector batch;
+      Version previous_last_replicated = 0;
+      Version next_last_replicated = 0;
+      Version previous_rollback_count = 0;
+      ccf::View replication_view = 0;
+
+      std::vector<std::tuple<std::unique_ptr<PendingTx>, bool>>
+        contiguous_pending_txs;
+      auto h = get_history();
+
+      {
+        std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
+        pending_txs_changed = false;
+        ++replication_rounds_started;
         for (Version offset = 1; true; ++offset)
         {
           auto search = pending_txs.find(last_replicated + offset);
@@ -1017,9 +1203,68 @@ namespace ccf::kv
         return CommitResult::SUCCESS;
       }
 
+      // Records the result of the first count collected txs, for any threads
+      // waiting on them
+      auto resolve = [&](size_t count, CommitResult result) {
+        std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
+        for (size_t i = 1; i <= count; ++i)
+        {
+          auto it = awaited_results.find(previous_last_replicated + i);
+          if (it != awaited_results.end() && !it->second.has_value())
+          {
+            it->second = result;
+          }
+        }
+        return result;
+      };
+
+      // History leaves are appended in runs, so that the write sets of the
+      // entries in each run are hashed together
+      std::vector<std::shared_ptr<std::vector<uint8_t>>> unappended_entries;
+      std::vector<ccf::EntryLeafComponents> unappended_leaves;
+      auto append_leaves = [&]() {
+        if (unappended_leaves.empty())
+        {
+          return;
+        }
+
+        std::vector<std::span<const uint8_t>> write_sets(
+          unappended_entries.size());
+        for (size_t i = 0; i < unappended_entries.size(); ++i)
+        {
+          write_sets[i] = *unappended_entries[i];
+        }
+        std::vector<ccf::crypto::Sha256Hash> write_set_digests(
+          write_sets.size());
+        ccf::crypto::sha256_many(write_sets, write_set_digests);
+        for (size_t i = 0; i < unappended_leaves.size(); ++i)
+        {
+          unappended_leaves[i].write_set_digest = write_set_digests[i];
+        }
+
+        h->append_entries(unappended_leaves, replication_view);
+        unappended_entries.clear();
+        unappended_leaves.clear();
+      };
+
       size_t offset = 1;
-      for (auto& [pending_tx_, committable_] : contiguous_pending_txs)
+      auto next_pending = contiguous_pending_txs.begin();
+      for (; next_pending != contiguous_pending_txs.end(); ++next_pending)
       {
+        auto& [pending_tx_, committable_] = *next_pending;
+        if (pending_tx_->prepare_reads_history())
+        {
+          append_leaves();
+        }
+
+        if (!pending_tx_->prepare())
+        {
+          LOG_DEBUG_FMT(
+            "Holding {} and later pending txs until prepared",
+            previous_last_replicated + offset);
+          break;
+        }
+
         auto
           [success_, data_, claims_digest_, commit_evidence_digest_, hooks_] =
             pending_tx_->call();
@@ -1034,7 +1279,8 @@ namespace ccf::kv
         {
           LOG_DEBUG_FMT(
             "Failed Tx commit {}", previous_last_replicated + offset);
-          return success_;
+          append_leaves();
+          return resolve(contiguous_pending_txs.size(), success_);
         }
         // We should never fail from here, as normal txs have already succeeded
         // and reserved txs only fail with FAIL_NO_REPLICATE
@@ -1049,10 +1295,9 @@ namespace ccf::kv
 
         if (h)
         {
-          h->append_entry(
-            ccf::entry_leaf(
-              *data_shared, commit_evidence_digest_, claims_digest_),
-            replication_view);
+          unappended_entries.push_back(data_shared);
+          unappended_leaves.push_back(
+            {{}, commit_evidence_digest_, claims_digest_});
         }
 
         if (chunker)
@@ -1060,6 +1305,12 @@ namespace ccf::kv
           chunker->append_entry_size(data_shared->size());
         }
 
+        if (entry_observer)
+        {
+          entry_observer->append_entry(
+            {replication_view, previous_last_replicated + offset}, data_shared);
+        }
+
         LOG_DEBUG_FMT(
           "Batching {} ({}) during commit of {}.{}",
           previous_last_replicated + offset,
@@ -1075,8 +1326,35 @@ namespace ccf::kv
 
         offset++;
       }
+      append_leaves();
+
+      if (next_pending != contiguous_pending_txs.end())
+      {
+        // Return the held txs to pending_txs, unless they have since been
+        // invalidated by a rollback
+        std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
+        if (previous_rollback_count == rollback_count)
+        {
+          auto held_version = previous_last_replicated + offset;
+          for (; next_pending != contiguous_pending_txs.end(); ++next_pending)
+          {
+            pending_txs.insert({held_version++, std::move(*next_pending)});
+          }
+        }
+        next_last_replicated = previous_last_replicated + batch.size();
+
+        if (batch.empty())
+        {
+          return CommitResult::SUCCESS;
+        }
+      }
+
+      if (!c->replicate(batch, replication_view))
+      {
+        LOG_DEBUG_FMT("Failed to replicate");
+        return resolve(batch.size(), CommitResult::FAIL_NO_REPLICATE);
+      }
 
-      if (c->replicate(batch, replication_view))
       {
         std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
         if (
@@ -1085,13 +1363,12 @@ namespace ccf::kv
         {
           last_replicated = next_last_replicated;
         }
-        return CommitResult::SUCCESS;
       }
 
-      LOG_DEBUG_FMT("Failed to replicate");
-      return CommitResult::FAIL_NO_REPLICATE;
+      return resolve(batch.size(), CommitResult::SUCCESS);
     }
 
+  public:
     bool should_schedule_snapshot()
     {
       std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
@@ -1349,6 +1626,11 @@ namespace ccf::kv
       return std::make_unique<CommittableTx>(this);
     }
 
+    std::unique_ptr<CommittableTx> create_read_only_committable_tx_ptr()
+    {
+      return std::make_unique<ReadOnlyCommittableTx>(this);
+    }
+
     ReservedTx create_reserved_tx(const TxID& tx_id)
     {
       std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
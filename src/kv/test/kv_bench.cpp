@@ -1,14 +1,18 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the Apache 2.0 License.
 #define PICOBENCH_IMPLEMENT
+#define PICOBENCH_DONT_BIND_TO_ONE_CORE
 
 #include "crypto/openssl/hash.h"
 #include "kv/store.h"
 #include "kv/test/stub_consensus.h"
 #include "node/encryptor.h"
 
+#include <atomic>
 #include <picobench/picobench.hpp>
 #include <string>
+#include <thread>
+#include <vector>
 
 using KeyType = ccf::kv::serialisers::SerialisedEntry;
 using ValueType = ccf::kv::serialisers::SerialisedEntry;
@@ -83,7 +87,9 @@ static void serialise(picobench::state& s)
   s.stop_timer();
 }
 
-template <ccf::kv::SecurityDomain SD>
+// If DESERIALISE_AHEAD, only the in-order apply() is timed, as is the case
+// for entries deserialised concurrently during recovery
+template <ccf::kv::SecurityDomain SD, bool DESERIALISE_AHEAD = false>
 static void deserialise(picobench::state& s)
 {
   ccf::logger::config::level() = ccf::LoggerLevel::INFO;
@@ -115,9 +121,14 @@ static void deserialise(picobench::state& s)
   }
   tx.commit();
 
+  auto wrapper = kv_store2.deserialize(consensus->get_latest_data().value());
+  if constexpr (DESERIALISE_AHEAD)
+  {
+    wrapper->deserialise_ahead();
+  }
+
   s.start_timer();
-  auto rc =
-    kv_store2.deserialize(consensus->get_latest_data().value())->apply();
+  auto rc = wrapper->apply();
   if (rc != ccf::kv::ApplyResult::PASS)
     throw std::logic_error(
       "Transaction deserialisation failed: " + std::to_string(rc));
@@ -243,6 +254,126 @@ static void des_snap(picobench::state& s)
   s.stop_timer();
 }
 
+// Each iteration is a transaction which reads KEY_COUNT keys, and commits
+template <bool READ_ONLY_TX, size_t KEY_COUNT>
+static void read_only_tx(picobench::state& s)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  ccf::kv::Store kv_store;
+  auto secrets = create_ledger_secrets();
+  auto encryptor = std::make_shared<ccf::NodeEncryptor>(secrets);
+  kv_store.set_encryptor(encryptor);
+
+  const auto map_name = "map0";
+  {
+    auto tx = kv_store.create_tx();
+    auto handle = tx.rw<MapType>(map_name);
+    for (size_t i = 0; i < KEY_COUNT; i++)
+    {
+      handle->put(gen_key(i), gen_value(i));
+    }
+    auto rc = tx.commit();
+    if (rc != ccf::kv::CommitResult::SUCCESS)
+      throw std::logic_error(
+        "Transaction commit failed: " + std::to_string(rc));
+  }
+
+  std::vector<KeyType> keys;
+  for (size_t i = 0; i < KEY_COUNT; i++)
+  {
+    keys.push_back(gen_key(i));
+  }
+
+  s.start_timer();
+  for (int i = 0; i < s.iterations(); i++)
+  {
+    auto tx = READ_ONLY_TX ? kv_store.create_read_only_committable_tx_ptr() :
+                             kv_store.create_tx_ptr();
+    auto handle = tx->ro<MapType>(map_name);
+    for (const auto& key : keys)
+    {
+      handle->get(key);
+    }
+
+    auto rc = tx->commit();
+    if (rc != ccf::kv::CommitResult::SUCCESS)
+      throw std::logic_error(
+        "Transaction commit failed: " + std::to_string(rc));
+    clobber_memory();
+  }
+  s.stop_timer();
+}
+
+// Transactions are committed from THREADS threads, each writing either to its
+// own map or to a single shared map
+template <bool DISJOINT_MAPS, size_t THREADS>
+static void concurrent_commit(picobench::state& s)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  ccf::kv::Store kv_store;
+  auto secrets = create_ledger_secrets();
+  auto encryptor = std::make_shared<ccf::NodeEncryptor>(secrets);
+  kv_store.set_encryptor(encryptor);
+
+  auto map_name = [](size_t t) {
+    return fmt::format("map{}", DISJOINT_MAPS ? t : 0);
+  };
+
+  {
+    // Create all maps up-front, so that creation does not conflict
+    auto tx = kv_store.create_tx();
+    for (size_t t = 0; t < THREADS; t++)
+    {
+      tx.rw<MapType>(map_name(t))->put(gen_key(0), gen_value(0));
+    }
+    auto rc = tx.commit();
+    if (rc != ccf::kv::CommitResult::SUCCESS)
+      throw std::logic_error(
+        "Transaction commit failed: " + std::to_string(rc));
+  }
+
+  const auto txs_per_thread = s.iterations() / THREADS;
+  std::atomic<size_t> failures = 0;
+
+  s.start_timer();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREADS; t++)
+  {
+    threads.emplace_back([&, t]() {
+      const auto suffix = std::to_string(t);
+      for (size_t i = 0; i < txs_per_thread; i++)
+      {
+        auto rc = ccf::kv::CommitResult::FAIL_CONFLICT;
+        while (rc == ccf::kv::CommitResult::FAIL_CONFLICT)
+        {
+          auto tx = kv_store.create_tx();
+          auto handle = tx.rw<MapType>(map_name(t));
+          for (size_t k = 0; k < 10; k++)
+          {
+            handle->put(gen_key(k, suffix), gen_value(i));
+          }
+          rc = tx.commit();
+        }
+        if (rc != ccf::kv::CommitResult::SUCCESS)
+        {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  s.stop_timer();
+
+  if (failures != 0)
+    throw std::logic_error(
+      "Transaction commit failed: " + std::to_string(failures));
+}
+
 const std::vector<int> tx_count = {10, 100, 1000};
 const uint32_t sample_size = 100;
 
@@ -265,6 +396,38 @@ PICOBENCH(deserialise<SD::PUBLIC>)
   .samples(sample_size)
   .baseline();
 PICOBENCH(deserialise<SD::PRIVATE>).iterations(tx_count).samples(sample_size);
+auto apply_deserialised_ahead_public = deserialise<SD::PUBLIC, true>;
+PICOBENCH(apply_deserialised_ahead_public)
+  .iterations(tx_count)
+  .samples(sample_size);
+auto apply_deserialised_ahead_private = deserialise<SD::PRIVATE, true>;
+PICOBENCH(apply_deserialised_ahead_private)
+  .iterations(tx_count)
+  .samples(sample_size);
+
+PICOBENCH_SUITE("read_only_tx");
+auto tracked_reads_10 = read_only_tx<false, 10>;
+PICOBENCH(tracked_reads_10).iterations(tx_count).baseline();
+auto untracked_reads_10 = read_only_tx<true, 10>;
+PICOBENCH(untracked_reads_10).iterations(tx_count);
+auto tracked_reads_100 = read_only_tx<false, 100>;
+PICOBENCH(tracked_reads_100).iterations(tx_count);
+auto untracked_reads_100 = read_only_tx<true, 100>;
+PICOBENCH(untracked_reads_100).iterations(tx_count);
+
+const std::vector<int> concurrent_tx_count = {1000, 10000};
+
+PICOBENCH_SUITE("concurrent_commit");
+auto shared_map_1 = concurrent_commit<false, 1>;
+PICOBENCH(shared_map_1).iterations(concurrent_tx_count).baseline();
+auto shared_map_4 = concurrent_commit<false, 4>;
+PICOBENCH(shared_map_4).iterations(concurrent_tx_count);
+auto disjoint_maps_4 = concurrent_commit<true, 4>;
+PICOBENCH(disjoint_maps_4).iterations(concurrent_tx_count);
+auto shared_map_8 = concurrent_commit<false, 8>;
+PICOBENCH(shared_map_8).iterations(concurrent_tx_count);
+auto disjoint_maps_8 = concurrent_commit<true, 8>;
+PICOBENCH(disjoint_maps_8).iterations(concurrent_tx_count);
 
 const std::vector<int> map_count = {20, 100};
 
@@ -10,6 +10,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <limits>
 #define DOCTEST_CONFIG_NO_SHORT_MACRO_NAMES
 
 #include <doctest/doctest.h>
@@ -34,6 +35,34 @@ public:
   }
 };
 
+// Holds every call to replicate until the gate is opened, and fails calls
+// from fail_from_call onwards
+class GatedStubConsensus : public ccf::kv::test::StubConsensus
+{
+public:
+  using ccf::kv::test::StubConsensus::StubConsensus;
+
+  std::atomic<bool> gate_open = false;
+  std::atomic<size_t> calls = 0;
+  size_t fail_from_call = std::numeric_limits<size_t>::max();
+
+  bool replicate(const ccf::kv::BatchVector& entries, ccf::View view) override
+  {
+    const auto call = ++calls;
+    while (!gate_open)
+    {
+      std::this_thread::yield();
+    }
+
+    if (call >= fail_from_call)
+    {
+      return false;
+    }
+
+    return ccf::kv::test::StubConsensus::replicate(entries, view);
+  }
+};
+
 DOCTEST_TEST_CASE("Concurrent kv access" * doctest::test_suite("concurrency"))
 {
   ccf::logger::config::level() = ccf::LoggerLevel::INFO;
@@ -376,3 +405,164 @@ DOCTEST_TEST_CASE(
     }
   }
 }
+
+DOCTEST_TEST_CASE("Hot key goodput" * doctest::test_suite("concurrency"))
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  // Many threads increment a single counter, either by reading and writing it
+  // or by merging an addition into it. Goodput is the fraction of commit
+  // attempts which succeed.
+  using MapType = ccf::kv::Map<size_t, size_t>;
+  MapType map("public:counter");
+  constexpr size_t k = 0;
+
+  constexpr size_t thread_count = 8;
+  constexpr size_t increments_per_thread = 1000;
+
+  auto run = [&](bool use_add) {
+    ccf::kv::Store kv_store;
+    auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+    kv_store.set_encryptor(encryptor);
+
+    {
+      // Ensure the map already exists, so that it is not created concurrently
+      auto tx = kv_store.create_tx();
+      tx.rw(map)->put(k, 0);
+      DOCTEST_REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+    }
+
+    std::atomic<size_t> attempts = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+      threads.emplace_back([&]() {
+        for (size_t i = 0; i < increments_per_thread; ++i)
+        {
+          while (true)
+          {
+            ++attempts;
+            auto tx = kv_store.create_tx();
+            auto h = tx.rw(map);
+            if (use_add)
+            {
+              h->add(k, 1);
+            }
+            else
+            {
+              h->put(k, h->get(k).value_or(0) + 1);
+            }
+
+            // Yield now, to increase the chance of conflicts
+            std::this_thread::yield();
+
+            if (tx.commit() == ccf::kv::CommitResult::SUCCESS)
+            {
+              break;
+            }
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    constexpr auto expected = thread_count * increments_per_thread;
+    auto tx = kv_store.create_read_only_tx();
+    DOCTEST_REQUIRE(tx.ro(map)->get(k) == expected);
+
+    const auto ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    LOG_INFO_FMT(
+      "{}: {} increments from {} attempts ({:.1f}% goodput) in {}ms",
+      use_add ? "add" : "get+put",
+      expected,
+      attempts.load(),
+      100.0 * expected / attempts.load(),
+      ms);
+
+    return attempts.load();
+  };
+
+  run(false);
+  const auto add_attempts = run(true);
+
+  // Additions never conflict with each other
+  DOCTEST_REQUIRE(add_attempts == thread_count * increments_per_thread);
+}
+
+DOCTEST_TEST_CASE(
+  "Commits wait for their txs to be replicated" *
+  doctest::test_suite("concurrency"))
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  using MapType = ccf::kv::Map<size_t, size_t>;
+  MapType map_a("public:a");
+  MapType map_b("public:b");
+
+  // Commits to disjoint maps, while the first is still being replicated
+  auto run = [&](size_t fail_from_call) {
+    ccf::kv::Store kv_store;
+    auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+    kv_store.set_encryptor(encryptor);
+    auto consensus = std::make_shared<GatedStubConsensus>();
+    consensus->fail_from_call = fail_from_call;
+    kv_store.set_consensus(consensus);
+
+    auto commit_to = [&](MapType& map) {
+      auto tx = kv_store.create_tx();
+      tx.rw(map)->put(0, 0);
+      return tx.commit();
+    };
+
+    std::atomic<bool> second_done = false;
+    ccf::kv::CommitResult first_result{};
+    ccf::kv::CommitResult second_result{};
+
+    std::thread first([&]() { first_result = commit_to(map_a); });
+    while (consensus->calls == 0)
+    {
+      std::this_thread::yield();
+    }
+
+    std::thread second([&]() {
+      second_result = commit_to(map_b);
+      second_done = true;
+    });
+
+    // The second tx cannot be replicated until the first has been
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    DOCTEST_REQUIRE_FALSE(second_done);
+
+    consensus->gate_open = true;
+    first.join();
+    second.join();
+
+    return std::make_tuple(
+      first_result, second_result, consensus->number_of_replicas());
+  };
+
+  {
+    DOCTEST_INFO("A waiting commit returns once its tx is replicated");
+    const auto [first, second, replicated] =
+      run(std::numeric_limits<size_t>::max());
+    DOCTEST_REQUIRE(first == ccf::kv::CommitResult::SUCCESS);
+    DOCTEST_REQUIRE(second == ccf::kv::CommitResult::SUCCESS);
+    DOCTEST_REQUIRE(replicated == 2);
+  }
+
+  {
+    DOCTEST_INFO("A waiting commit gets the result of replicating its tx");
+    const auto [first, second, replicated] = run(2);
+    DOCTEST_REQUIRE(first == ccf::kv::CommitResult::SUCCESS);
+    DOCTEST_REQUIRE(second == ccf::kv::CommitResult::FAIL_NO_REPLICATE);
+    DOCTEST_REQUIRE(replicated == 1);
+  }
+}
@@ -1921,6 +1921,53 @@ TEST_CASE("Read-only tx")
   }
 }
 
+TEST_CASE("Read-only committable tx")
+{
+  ccf::kv::Store kv_store;
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+  MapTypes::StringString map("public:map");
+
+  constexpr auto k = "key";
+  constexpr auto v1 = "value1";
+  constexpr auto v2 = "value2";
+
+  {
+    auto tx = kv_store.create_tx();
+    tx.rw(map)->put(k, v1);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+  const auto txid_before_write = kv_store.current_txid();
+
+  INFO("Reads at the version it was created at");
+  {
+    auto ro_tx = kv_store.create_read_only_committable_tx_ptr();
+
+    auto tx = kv_store.create_tx();
+    tx.rw(map)->put(k, v2);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+
+    auto handle = ro_tx->ro(map);
+    REQUIRE(handle->get(k) == v1);
+    REQUIRE(handle->size() == 1);
+    REQUIRE(handle->get_version_of_previous_write(k).has_value());
+
+    INFO("Does not conflict with the concurrent write");
+    REQUIRE(ro_tx->commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(ro_tx->get_txid() == txid_before_write);
+  }
+
+  INFO("Cannot commit writes");
+  {
+    auto ro_tx = kv_store.create_read_only_committable_tx_ptr();
+    ro_tx->rw(map)->put(k, v1);
+    REQUIRE_THROWS_AS(ro_tx->commit(), std::logic_error);
+
+    auto tx = kv_store.create_read_only_tx();
+    REQUIRE(tx.ro(map)->get(k) == v2);
+  }
+}
+
 TEST_CASE("Rollback and compact")
 {
   ccf::kv::Store kv_store;
@@ -2739,6 +2786,137 @@ TEST_CASE("Conflict resolution - removals")
   }
 }
 
+TEST_CASE("Merges")
+{
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  ccf::kv::Store kv_store;
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+  kv_store.set_consensus(consensus);
+  MapTypes::NumNum map("public:map");
+
+  constexpr size_t k = 42;
+
+  {
+    // Ensure this map already exists, by making a prior write to it
+    auto tx = kv_store.create_tx();
+    tx.rw(map)->put(k, 0);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+
+  auto get = [&](size_t key) {
+    auto tx = kv_store.create_read_only_tx();
+    return tx.ro(map)->get(key);
+  };
+
+  INFO("Concurrent merges into the same key do not conflict");
+  {
+    auto tx1 = kv_store.create_tx();
+    auto tx2 = kv_store.create_tx();
+    tx1.rw(map)->add(k, 1);
+    tx2.rw(map)->add(k, 10);
+    tx2.rw(map)->add(k, 100);
+
+    REQUIRE(tx2.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(tx1.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(get(k) == 111);
+  }
+
+  INFO("Merges are replicated as the values they resolve to");
+  {
+    ccf::kv::Store clone;
+    clone.set_encryptor(encryptor);
+    for (const size_t expected : {0, 110, 111})
+    {
+      const auto entry = consensus->pop_oldest_entry();
+      REQUIRE(entry.has_value());
+      const auto& data = *std::get<1>(entry.value());
+      REQUIRE(clone.deserialize(data)->apply() == ccf::kv::ApplyResult::PASS);
+
+      auto tx = clone.create_read_only_tx();
+      REQUIRE(tx.ro(map)->get(k) == expected);
+    }
+  }
+
+  INFO("A merge applies to the transaction's own writes");
+  {
+    auto tx = kv_store.create_tx();
+    auto handle = tx.rw(map);
+    handle->put(k, 5);
+    handle->add(k, 1);
+    REQUIRE(handle->get(k) == 6);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(get(k) == 6);
+  }
+
+  INFO("A write replaces an earlier merge");
+  {
+    auto tx = kv_store.create_tx();
+    auto handle = tx.rw(map);
+    handle->add(k, 1);
+    handle->put(k, 20);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(get(k) == 20);
+  }
+
+  INFO("A merge can remove a key");
+  {
+    auto tx = kv_store.create_tx();
+    tx.rw(map)->merge(
+      k, [](const std::optional<size_t>&) { return std::nullopt; });
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE_FALSE(get(k).has_value());
+  }
+
+  INFO("Reading a merged key introduces a read dependency");
+  {
+    auto tx1 = kv_store.create_tx();
+    auto handle1 = tx1.rw(map);
+    handle1->add(k, 1);
+    REQUIRE(handle1->get(k) == 1);
+    REQUIRE(handle1->size() == 1);
+
+    auto tx2 = kv_store.create_tx();
+    tx2.rw(map)->add(k, 2);
+    REQUIRE(tx2.commit() == ccf::kv::CommitResult::SUCCESS);
+
+    REQUIRE(tx1.commit() == ccf::kv::CommitResult::FAIL_CONFLICT);
+    REQUIRE(get(k) == 2);
+  }
+
+  auto failing_merge =
+    [](const std::optional<size_t>&) -> std::optional<size_t> {
+    throw std::runtime_error("Merge failed");
+  };
+
+  INFO("A merge which throws fails its transaction before it is versioned");
+  {
+    const auto version_before = kv_store.current_version();
+    auto tx = kv_store.create_tx();
+    tx.rw(map)->merge(k, failing_merge);
+    REQUIRE_THROWS_AS(tx.commit(), std::runtime_error);
+    REQUIRE(kv_store.current_version() == version_before);
+
+    INFO("The map is released for later transactions");
+    auto tx2 = kv_store.create_tx();
+    tx2.rw(map)->add(k, 3);
+    REQUIRE(tx2.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(get(k) == 5);
+  }
+
+  INFO("A merge which throws into a new map releases the map set");
+  {
+    MapTypes::NumNum new_map("public:new_map");
+    auto tx = kv_store.create_tx();
+    tx.rw(new_map)->merge(k, failing_merge);
+    REQUIRE_THROWS_AS(tx.commit(), std::runtime_error);
+
+    auto tx2 = kv_store.create_tx();
+    tx2.rw(new_map)->add(k, 1);
+    REQUIRE(tx2.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+}
+
 TEST_CASE("Cross-map conflicts")
 {
   ccf::kv::Store kv_store;
@@ -3288,6 +3466,25 @@ TEST_CASE("Range")
       auto std_range = std_map_range(ref, range.first, range.second);
       auto kv_range = kv_map_range(h, range.first, range.second);
       REQUIRE(std_range == kv_range);
+
+      INFO("Bounded ranges return the first keys of the range");
+      for (size_t max_count : {0ul, 1ul, 7ul, size, size * 2})
+      {
+        std::map<KeyType, ValueType> bounded;
+        h->range(
+          [&bounded](const KeyType& k, const ValueType& v) {
+            bounded.emplace(k, v);
+          },
+          range.first,
+          range.second,
+          max_count);
+        auto expected = std_range;
+        while (expected.size() > max_count)
+        {
+          expected.erase(std::prev(expected.end()));
+        }
+        REQUIRE(expected == bounded);
+      }
     }
   }
 
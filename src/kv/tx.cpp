@@ -92,10 +92,14 @@ namespace ccf::kv
         fmt::format("Map {} has unexpected type", map_name));
     }
 
-    return {
-      abstract_map,
-      untyped_map->create_change_set(
-        read_txid->seqno, track_deletes_on_missing_keys)};
+    auto change_set = untyped_map->create_change_set(
+      read_txid->seqno, track_deletes_on_missing_keys);
+    if (change_set != nullptr)
+    {
+      change_set->track_reads = pimpl->track_reads;
+    }
+
+    return {abstract_map, std::move(change_set)};
   }
 
   std::list<AbstractHandle*> BaseTx::get_possible_handles(
@@ -23,6 +23,10 @@ namespace ccf::kv
     std::optional<TxID> read_txid = std::nullopt;
     ccf::View commit_view = ccf::VIEW_UNKNOWN;
 
+    // False for transactions which can never conflict, so need not record
+    // what they read
+    bool track_reads = true;
+
     std::map<std::string, std::shared_ptr<AbstractMap>> created_maps;
   };
 }
\ No newline at end of file
@@ -41,9 +41,13 @@ namespace ccf::kv::untyped
     const ccf::kv::untyped::State committed;
     const Version start_version = {};
 
+    // Reads are only recorded by transactions which may conflict on commit
+    bool track_reads = true;
     Version read_version = NoVersion;
     ccf::kv::untyped::Read reads;
     ccf::kv::untyped::Write writes;
+    // Resolved into writes when the transaction commits
+    ccf::kv::untyped::Merges merges;
 
     ChangeSet(
       size_t rollbacks,
@@ -62,12 +66,21 @@ namespace ccf::kv::untyped
 
     [[nodiscard]] bool has_writes() const override
     {
-      return !writes.empty();
+      return !writes.empty() || !merges.empty();
     }
   };
 
   using ChangeSetPtr = std::unique_ptr<ChangeSet>;
 
+  // The changes to a single map, parsed from a serialised entry but not yet
+  // bound to that map
+  struct DeserialisedChanges
+  {
+    Version read_version = NoVersion;
+    ccf::kv::untyped::Read reads;
+    ccf::kv::untyped::Write writes;
+  };
+
   // This is a container for a snapshot. It has no dependencies as the snapshot
   // obliterates the current state.
   struct SnapshotChangeSet : public ChangeSet
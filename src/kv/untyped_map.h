@@ -196,20 +196,38 @@ namespace ccf::kv::untyped
           }
         }
 
+        // Merges did not read their keys, so cannot conflict. Resolve them
+        // against the latest state, which cannot change while the map is
+        // locked, so that they are applied and serialised as ordinary writes.
+        // This is done before a version is assigned, so a merge which throws
+        // fails the transaction without leaving a gap in the versions.
+        ccf::kv::untyped::Write resolved;
+        for (const auto& [key, f] : change_set.merges)
+        {
+          const auto* entry = current->state.getp(key);
+          resolved[key] = f(
+            entry == nullptr ? std::nullopt : std::make_optional(entry->value));
+        }
+        change_set.merges.clear();
+        for (auto& [key, value] : resolved)
+        {
+          change_set.writes[key] = std::move(value);
+        }
+
         return true;
       }
 
       void commit(Version v, bool track_deletes_on_missing_keys) override
       {
+        auto& map_roll = map.get_roll();
+        auto state = map_roll.commits->get_tail()->state;
+
         if (change_set.writes.empty())
         {
           commit_version = change_set.start_version;
           return;
         }
 
-        auto& map_roll = map.get_roll();
-        auto state = map_roll.commits->get_tail()->state;
-
         // Record our commit time.
         commit_version = v;
         committed_writes = true;
@@ -459,39 +477,20 @@ namespace ccf::kv::untyped
         deserialize_map_snapshot(map_snapshot), v);
     }
 
-    ChangeSetPtr deserialise_changes(KvStoreDeserialiser& d, Version version)
-    {
-      return deserialise_internal(d, version);
-    }
-
-    ChangeSetPtr deserialise_internal(KvStoreDeserialiser& d, Version version)
+    // Parses the changes to a single map from d. This does not depend on the
+    // state of any map, so may be done before the changes are bound to one.
+    static DeserialisedChanges parse_changes(KvStoreDeserialiser& d)
     {
-      // Create a new change set, and deserialise d's contents into it.
-      auto change_set_ptr = create_change_set(version, false);
-      if (change_set_ptr == nullptr)
-      {
-        LOG_FAIL_FMT(
-          "Failed to create change set over '{}' at {} - too early",
-          name,
-          version);
-        throw std::logic_error("Can't create change set");
-      }
-
-      auto& change_set = *change_set_ptr;
-
+      DeserialisedChanges parsed;
       uint64_t ctr = 0;
 
-      auto rv = d.deserialise_entry_version();
-      if (rv != NoVersion)
-      {
-        change_set.read_version = rv;
-      }
+      parsed.read_version = d.deserialise_entry_version();
 
       ctr = d.deserialise_read_header();
       for (size_t i = 0; i < ctr; ++i)
       {
         auto r = d.deserialise_read();
-        change_set.reads[std::get<0>(r)] =
+        parsed.reads[std::get<0>(r)] =
           std::make_tuple(std::get<1>(r), NoVersion);
       }
 
@@ -499,15 +498,46 @@ namespace ccf::kv::untyped
       for (size_t i = 0; i < ctr; ++i)
       {
         auto w = d.deserialise_write();
-        change_set.writes[std::get<0>(w)] = std::get<1>(w);
+        parsed.writes[std::get<0>(w)] = std::get<1>(w);
       }
 
       ctr = d.deserialise_remove_header();
       for (size_t i = 0; i < ctr; ++i)
       {
         auto r = d.deserialise_remove();
-        change_set.writes[r] = std::nullopt;
+        parsed.writes[r] = std::nullopt;
+      }
+
+      return parsed;
+    }
+
+    ChangeSetPtr deserialise_changes(KvStoreDeserialiser& d, Version version)
+    {
+      return deserialise_changes(parse_changes(d), version);
+    }
+
+    ChangeSetPtr deserialise_changes(
+      DeserialisedChanges&& parsed, Version version)
+    {
+      // Create a new change set, and move the parsed changes into it
+      auto change_set_ptr = create_change_set(version, false);
+      if (change_set_ptr == nullptr)
+      {
+        LOG_FAIL_FMT(
+          "Failed to create change set over '{}' at {} - too early",
+          name,
+          version);
+        throw std::logic_error("Can't create change set");
+      }
+
+      auto& change_set = *change_set_ptr;
+
+      if (parsed.read_version != NoVersion)
+      {
+        change_set.read_version = parsed.read_version;
       }
+      change_set.reads = std::move(parsed.reads);
+      change_set.writes = std::move(parsed.writes);
 
       return change_set_ptr;
     }
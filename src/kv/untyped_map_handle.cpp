@@ -6,10 +6,27 @@
 #include "ds/internal_logger.h"
 #include "kv/untyped_change_set.h"
 
+#include <iterator>
+#include <limits>
+#include <map>
+
 namespace ccf::kv::untyped
 {
   const MapHandle::ValueType* MapHandle::read_key(const KeyType& key)
   {
+    // Reading a key with a pending merge depends on its current value, so
+    // resolve the merge now into a read followed by a write.
+    auto merge = tx_changes.merges.find(key);
+    if (merge != tx_changes.merges.end())
+    {
+      const auto f = std::move(merge->second);
+      tx_changes.merges.erase(merge);
+
+      const auto* current = read_key(key);
+      tx_changes.writes[key] = f(
+        current == nullptr ? std::nullopt : std::make_optional(*current));
+    }
+
     // A write followed by a read doesn't introduce a read dependency.
     // If we have written, return the value without updating the read set.
     auto write = tx_changes.writes.find(key);
@@ -29,14 +46,20 @@ namespace ccf::kv::untyped
     const auto* const search = tx_changes.state.getp(key);
     if (search == nullptr)
     {
-      tx_changes.reads.insert(
-        std::make_pair(key, std::make_tuple(NoVersion, NoVersion)));
+      if (tx_changes.track_reads)
+      {
+        tx_changes.reads.insert(
+          std::make_pair(key, std::make_tuple(NoVersion, NoVersion)));
+      }
       return nullptr;
     }
 
     // Record the version that we depend on.
-    tx_changes.reads.insert(std::make_pair(
-      key, std::make_tuple(search->version, search->read_version)));
+    if (tx_changes.track_reads)
+    {
+      tx_changes.reads.insert(std::make_pair(
+        key, std::make_tuple(search->version, search->read_version)));
+    }
 
     // Return the value.
     return &search->value;
@@ -45,8 +68,18 @@ namespace ccf::kv::untyped
   void MapHandle::foreach_state_and_writes(
     const MapHandle::ElementVisitorWithEarlyOut& f, bool always_consider_writes)
   {
+    // Pending merges depend on the values they are merged into
+    while (!tx_changes.merges.empty())
+    {
+      const auto key = tx_changes.merges.begin()->first;
+      read_key(key);
+    }
+
     // Record a global read dependency.
-    tx_changes.read_version = tx_changes.start_version;
+    if (tx_changes.track_reads)
+    {
+      tx_changes.read_version = tx_changes.start_version;
+    }
 
     // Take a snapshot copy of the writes. This is what we will iterate over,
     // while any additional modifications made by the functor will modify the
@@ -117,14 +150,20 @@ namespace ccf::kv::untyped
     const auto* const search = tx_changes.state.getp(key);
     if (search == nullptr)
     {
-      tx_changes.reads.insert(
-        std::make_pair(key, std::make_tuple(NoVersion, NoVersion)));
+      if (tx_changes.track_reads)
+      {
+        tx_changes.reads.insert(
+          std::make_pair(key, std::make_tuple(NoVersion, NoVersion)));
+      }
       return std::nullopt;
     }
 
     // Record the version that we depend on.
-    tx_changes.reads.insert(std::make_pair(
-      key, std::make_tuple(search->version, search->read_version)));
+    if (tx_changes.track_reads)
+    {
+      tx_changes.reads.insert(std::make_pair(
+        key, std::make_tuple(search->version, search->read_version)));
+    }
 
     return search->version;
   }
@@ -162,19 +201,49 @@ namespace ccf::kv::untyped
     const MapHandle::KeyType& key, const MapHandle::ValueType& value)
   {
     LOG_TRACE_FMT("KV[{}]::put({}, {})", map_name, key, value);
-    // Record in the write set.
+    // Record in the write set, replacing any pending merge.
+    tx_changes.merges.erase(key);
     tx_changes.writes[key] = value;
   }
 
   void MapHandle::remove(const MapHandle::KeyType& key)
   {
     LOG_TRACE_FMT("KV[{}]::remove({})", map_name, key);
-    // Record in the write set
+    // Record in the write set, replacing any pending merge.
+    tx_changes.merges.erase(key);
     tx_changes.writes[key] = std::nullopt;
   }
 
+  void MapHandle::merge(
+    const MapHandle::KeyType& key, const MergeFunction& f)
+  {
+    LOG_TRACE_FMT("KV[{}]::merge({})", map_name, key);
+
+    // If this transaction has already written the key, its value is known
+    auto write = tx_changes.writes.find(key);
+    if (write != tx_changes.writes.end())
+    {
+      write->second = f(write->second);
+      return;
+    }
+
+    // Otherwise apply after any earlier merge, when the transaction commits
+    auto& pending = tx_changes.merges[key];
+    if (pending == nullptr)
+    {
+      pending = f;
+    }
+    else
+    {
+      pending = [prev = std::move(pending), f](const auto& v) {
+        return f(prev(v));
+      };
+    }
+  }
+
   void MapHandle::clear()
   {
+    tx_changes.merges.clear();
     foreach([this](const auto& k, const auto&) {
       remove(k);
       return true;
@@ -202,6 +271,15 @@ namespace ccf::kv::untyped
     const MapHandle::ElementVisitor& f,
     const std::optional<MapHandle::KeyType>& from,
     const std::optional<MapHandle::KeyType>& to)
+  {
+    range(f, from, to, std::numeric_limits<size_t>::max());
+  }
+
+  void MapHandle::range(
+    const MapHandle::ElementVisitor& f,
+    const std::optional<MapHandle::KeyType>& from,
+    const std::optional<MapHandle::KeyType>& to,
+    size_t max_count)
   {
     // Current limitations/ineficiencies:
     // - The state and writes are wastefully looped over until `from` is
@@ -217,8 +295,9 @@ namespace ccf::kv::untyped
     // with the local writes.
 
     if (
-      from.has_value() && to.has_value() &&
-      (from.value() == to.value() || to.value() < from.value()))
+      max_count == 0 ||
+      (from.has_value() && to.has_value() &&
+       (from.value() == to.value() || to.value() < from.value())))
     {
       return;
     }
@@ -229,8 +308,10 @@ namespace ccf::kv::untyped
     // this could be set to false to stop iteration once `to` is exceeded.
     bool continue_past_range_to = true;
 
+    // Only the max_count smallest keys seen so far are kept. Once res is
+    // full, later keys past its largest are skipped without being copied.
     std::map<KeyType, ValueType> res;
-    auto g = [&res, &from, &to, continue_past_range_to](
+    auto g = [&res, &from, &to, continue_past_range_to, max_count](
                const KeyType& k, const ValueType& v) {
       if (from.has_value() && k < from.value())
       {
@@ -244,6 +325,16 @@ namespace ccf::kv::untyped
         return continue_past_range_to;
       }
 
+      if (res.size() == max_count)
+      {
+        auto last = std::prev(res.end());
+        if (!(k < last->first))
+        {
+          return true;
+        }
+        res.erase(last);
+      }
+
       res[k] = v;
       return true;
     };
@@ -188,6 +188,7 @@ namespace ccf
     ccf::crypto::Pem peer_cert;
 
     ringbuffer::WriterPtr to_host;
+    ringbuffer::BufferHandoffPtr buffer_handoff;
     NodeId peer_id;
 
     // Used for key exchange
@@ -931,12 +932,24 @@ namespace ccf
       gcm_hdr.set_iv(
         reinterpret_cast<const uint8_t*>(&wire_nonce), sizeof(wire_nonce));
 
-      std::vector<uint8_t> cipher;
+      // Held by shared pointer, so that a large ciphertext can be passed to
+      // the host without being copied
+      auto cipher = std::make_shared<std::vector<uint8_t>>();
       assert(send_key);
-      send_key->encrypt(gcm_hdr.get_iv(), plain, aad, cipher, gcm_hdr.tag);
+      send_key->encrypt(gcm_hdr.get_iv(), plain, aad, *cipher, gcm_hdr.tag);
 
       const auto gcm_hdr_serialised = gcm_hdr.serialise();
 
+      if (
+        buffer_handoff != nullptr &&
+        buffer_handoff->should_handoff(
+          aad.size() + gcm_hdr_serialised.size() + cipher->size()) &&
+        send_shared(type, aad, gcm_hdr_serialised, cipher))
+      {
+        check_message_limit();
+        return true;
+      }
+
       // Payload is concatenation of 3 things:
       // 1) aad
       // 2) gcm header
@@ -947,7 +960,7 @@ namespace ccf
         {aad.data(), static_cast<size_t>(aad.size())},
         {gcm_hdr_serialised.data(),
          static_cast<size_t>(gcm_hdr_serialised.size())},
-        {cipher.data(), static_cast<size_t>(cipher.size())}};
+        {cipher->data(), static_cast<size_t>(cipher->size())}};
 
       RINGBUFFER_WRITE_MESSAGE(
         node_outbound, to_host, peer_id.value(), type, self.value(), payload);
@@ -957,6 +970,38 @@ namespace ccf
       return true;
     }
 
+    // Passes the same (msg_type, from_id, payload) that node_outbound would
+    // carry to the host through the buffer handoff, so that it need not be
+    // copied through (and fragmented on) the ringbuffer. Only the small
+    // header is serialised here. The ciphertext is shared with the host as a
+    // separate part. Returns false if the handle could not be written, in
+    // which case the caller should write the message to the ringbuffer.
+    bool send_shared(
+      NodeMsgType type,
+      std::span<const uint8_t> aad,
+      std::span<const uint8_t> gcm_hdr_serialised,
+      const std::shared_ptr<std::vector<uint8_t>>& cipher)
+    {
+      const auto& from = self.value();
+      auto header = std::make_shared<std::vector<uint8_t>>();
+      header->reserve(
+        sizeof(type) + sizeof(from.size()) + from.size() + aad.size() +
+        gcm_hdr_serialised.size());
+      append_value(*header, type);
+      append_buffer(
+        *header,
+        {reinterpret_cast<const uint8_t*>(from.data()), from.size()});
+      header->insert(header->end(), aad.begin(), aad.end());
+      header->insert(
+        header->end(), gcm_hdr_serialised.begin(), gcm_hdr_serialised.end());
+
+      return buffer_handoff->send(
+        {std::move(header), cipher}, [this](auto handle) {
+          return RINGBUFFER_TRY_WRITE_MESSAGE(
+            node_outbound_shared, to_host, peer_id.value(), handle);
+        });
+    }
+
   public:
     static constexpr size_t protocol_version = 1;
 
@@ -973,6 +1018,7 @@ namespace ccf
       node_kp(std::move(node_kp_)),
       node_cert(node_cert_),
       to_host(writer_factory.create_writer_to_outside()),
+      buffer_handoff(writer_factory.get_buffer_handoff()),
       peer_id(std::move(peer_id_)),
       status(fmt::format("Channel to {}", peer_id), INACTIVE),
       message_limit(message_limit_)
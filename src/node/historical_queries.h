@@ -6,6 +6,7 @@
 #include "ccf/pal/locking.h"
 #include "consensus/ledger_enclave_types.h"
 #include "ds/ccf_assert.h"
+#include "ds/lru.h"
 #include "kv/store.h"
 #include "node/cose_common.h"
 #include "node/encryptor.h"
@@ -14,7 +15,10 @@
 #include "node/rpc/node_interface.h"
 #include "node/tx_receipt_impl.h"
 #include "service/tables/node_signature.h"
+#include "tasks/parallel_for.h"
+#include "tasks/task_system.h"
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <memory>
@@ -66,6 +70,14 @@ namespace ccf::historical
 {
   static constexpr auto slow_fetch_threshold = std::chrono::milliseconds(1000);
 
+  // Upper bound on the number of seqnos speculatively fetched ahead of a
+  // request which is paging forward through the ledger
+  static constexpr size_t max_prefetch_window = 1000;
+
+  // Ledger entries received in a single range are decrypted, deserialised and
+  // hashed across the task system in chunks of this many entries
+  static constexpr size_t deserialise_chunk_size = 64;
+
   static std::optional<ccf::PrimarySignature> get_signature(
     const ccf::kv::StorePtr& sig_store)
   {
@@ -188,9 +200,21 @@ namespace ccf::historical
     VersionedSecret earliest_secret_;
     StoreDetailsPtr next_secret_fetch_handle = nullptr;
 
+    // Merkle trees deserialised from recently used signatures, shared by all
+    // requests. A tree is only reused while the signature's serialised tree
+    // is unchanged, ie - the signature store at that seqno was not replaced.
+    struct SignatureTree
+    {
+      std::vector<uint8_t> serialised;
+      std::shared_ptr<ccf::MerkleTreeHistory> tree;
+    };
+    using SignatureTrees = LRU<ccf::SeqNo, SignatureTree>;
+    static constexpr size_t max_cached_signature_trees = 16;
+
     struct Request
     {
       AllRequestedStores& all_stores;
+      SignatureTrees& signature_trees;
 
       RequestedStores my_stores;
       std::chrono::milliseconds time_to_expiry{};
@@ -205,7 +229,20 @@ namespace ccf::historical
       // Only set when recovering ledger secrets
       std::optional<ccf::SeqNo> awaiting_ledger_secrets = std::nullopt;
 
-      Request(AllRequestedStores& all_stores_) : all_stores(all_stores_) {}
+      // Most recent request, if it was for a single contiguous range. Used to
+      // detect requests which page forward through the ledger.
+      std::optional<std::pair<ccf::SeqNo, ccf::SeqNo>> last_range =
+        std::nullopt;
+
+      // Stores speculatively fetched after the requested range, in
+      // anticipation of the next request. Disjoint from my_stores.
+      RequestedStores prefetched_stores;
+
+      Request(
+        AllRequestedStores& all_stores_, SignatureTrees& signature_trees_) :
+        all_stores(all_stores_),
+        signature_trees(signature_trees_)
+      {}
 
       [[nodiscard]] StoreDetailsPtr get_store_details(ccf::SeqNo seqno) const
       {
@@ -490,6 +527,39 @@ namespace ccf::historical
       }
 
     private:
+      std::shared_ptr<ccf::MerkleTreeHistory> get_signature_tree(
+        const std::shared_ptr<StoreDetails>& sig_details)
+      {
+        auto serialised_tree = get_tree(sig_details->store);
+        if (!serialised_tree.has_value())
+        {
+          return nullptr;
+        }
+
+        const auto sig_seqno = sig_details->transaction_id.seqno;
+        auto it = signature_trees.find(sig_seqno);
+        if (it != signature_trees.end())
+        {
+          if (it->second.serialised == serialised_tree.value())
+          {
+            signature_trees.promote(it);
+            return it->second.tree;
+          }
+
+          it->second.tree =
+            std::make_shared<ccf::MerkleTreeHistory>(serialised_tree.value());
+          it->second.serialised = std::move(serialised_tree.value());
+          signature_trees.promote(it);
+          return it->second.tree;
+        }
+
+        auto tree =
+          std::make_shared<ccf::MerkleTreeHistory>(serialised_tree.value());
+        signature_trees.insert(
+          sig_seqno, SignatureTree{std::move(serialised_tree.value()), tree});
+        return tree;
+      }
+
       bool fill_receipts_from_signature(
         const std::shared_ptr<StoreDetails>& sig_details,
         std::optional<ccf::SeqNo> should_fill = std::nullopt)
@@ -502,90 +572,108 @@ namespace ccf::historical
         {
           return false;
         }
-        const auto serialised_tree = get_tree(sig_details->store);
-        if (!serialised_tree.has_value())
+        const auto tree = get_signature_tree(sig_details);
+        if (tree == nullptr)
         {
           return false;
         }
-        ccf::MerkleTreeHistory tree(serialised_tree.value());
 
-        // This is either pointing at the sig itself, or the closest larger
-        // seqno we're holding
-        auto sig_lower_bound_it =
-          my_stores.lower_bound(sig_details->transaction_id.seqno);
-
-        if (sig_lower_bound_it != my_stores.begin()) // Skip empty map edge case
+        // Collect the contiguous run of seqnos covered by this signature,
+        // searching backwards from the signature (or the closest larger seqno
+        // we're holding)
+        std::vector<uint64_t> seqnos;
+        std::vector<StoreDetailsPtr> covered;
+        auto search_rit = std::reverse_iterator(
+          my_stores.lower_bound(sig_details->transaction_id.seqno));
+        for (; search_rit != my_stores.rend(); ++search_rit)
         {
-          // Construct reverse iterator to search backwards from here
-          auto search_rit = std::reverse_iterator(sig_lower_bound_it);
-          while (search_rit != my_stores.rend())
+          const auto seqno = search_rit->first;
+          if (!tree->in_range(seqno))
           {
-            auto seqno = search_rit->first;
-            if (tree.in_range(seqno))
-            {
-              auto details = search_rit->second;
-              if (details != nullptr && details->store != nullptr)
-              {
-                auto proof = tree.get_proof(seqno);
+            // Found a seqno which this signature doesn't cover. It can't
+            // cover anything else, so stop here
+            break;
+          }
 
-                if (sig.has_value())
-                {
-                  details->transaction_id = {sig->view, seqno};
-                  details->receipt = std::make_shared<TxReceiptImpl>(
-                    sig->sig,
-                    cose_sig,
-                    proof.get_root(),
-                    proof.get_path(),
-                    sig->node,
-                    sig->cert,
-                    details->entry_digest,
-                    details->get_commit_evidence(),
-                    details->claims_digest);
-                }
-                else
-                {
-                  auto cose_receipt =
-                    ccf::cose::decode_ccf_receipt(cose_sig.value(), false);
-                  auto parsed_txid =
-                    ccf::TxID::from_str(cose_receipt.phdr.ccf.txid);
-                  if (!parsed_txid.has_value())
-                  {
-                    throw std::logic_error(fmt::format(
-                      "Cannot parse CCF TxID: {}", cose_receipt.phdr.ccf.txid));
-                  }
+          const auto& details = search_rit->second;
+          if (details != nullptr && details->store != nullptr)
+          {
+            seqnos.push_back(seqno);
+            covered.push_back(details);
+          }
+        }
 
-                  details->transaction_id = {parsed_txid->view, seqno};
-                  details->receipt = std::make_shared<TxReceiptImpl>(
-                    std::nullopt,
-                    cose_sig,
-                    proof.get_root(),
-                    proof.get_path(),
-                    ccf::NodeId{},
-                    std::nullopt,
-                    details->entry_digest,
-                    details->get_commit_evidence(),
-                    details->claims_digest);
-                }
+        if (seqnos.empty())
+        {
+          return !should_fill.has_value();
+        }
 
-                HISTORICAL_LOG(
-                  "Assigned a receipt for {} after given signature at {}",
-                  seqno,
-                  sig_details->transaction_id.to_str());
+        // Extract all of the paths in a single walk of the tree
+        std::reverse(seqnos.begin(), seqnos.end());
+        std::reverse(covered.begin(), covered.end());
+        const auto paths = tree->get_paths(seqnos);
+        const HistoryTree::Hash root(tree->get_root().h);
 
-                if (should_fill.has_value() && seqno == *should_fill)
-                {
-                  should_fill.reset();
-                }
-              }
+        // The view of every receipt is that of the signature
+        ccf::View view = 0;
+        if (sig.has_value())
+        {
+          view = sig->view;
+        }
+        else
+        {
+          auto cose_receipt =
+            ccf::cose::decode_ccf_receipt(cose_sig.value(), false);
+          auto parsed_txid = ccf::TxID::from_str(cose_receipt.phdr.ccf.txid);
+          if (!parsed_txid.has_value())
+          {
+            throw std::logic_error(fmt::format(
+              "Cannot parse CCF TxID: {}", cose_receipt.phdr.ccf.txid));
+          }
+          view = parsed_txid->view;
+        }
 
-              ++search_rit;
-            }
-            else
-            {
-              // Found a seqno which this signature doesn't cover. It can't
-              // cover anything else, so break here
-              break;
-            }
+        for (size_t i = 0; i < seqnos.size(); ++i)
+        {
+          const auto seqno = static_cast<ccf::SeqNo>(seqnos[i]);
+          auto& details = covered[i];
+
+          details->transaction_id = {view, seqno};
+          if (sig.has_value())
+          {
+            details->receipt = std::make_shared<TxReceiptImpl>(
+              sig->sig,
+              cose_sig,
+              root,
+              paths[i],
+              sig->node,
+              sig->cert,
+              details->entry_digest,
+              details->get_commit_evidence(),
+              details->claims_digest);
+          }
+          else
+          {
+            details->receipt = std::make_shared<TxReceiptImpl>(
+              std::nullopt,
+              cose_sig,
+              root,
+              paths[i],
+              ccf::NodeId{},
+              std::nullopt,
+              details->entry_digest,
+              details->get_commit_evidence(),
+              details->claims_digest);
+          }
+
+          HISTORICAL_LOG(
+            "Assigned a receipt for {} after given signature at {}",
+            seqno,
+            sig_details->transaction_id.to_str());
+
+          if (should_fill.has_value() && seqno == *should_fill)
+          {
+            should_fill.reset();
           }
         }
 
@@ -604,6 +692,8 @@ namespace ccf::historical
     // same underlying state (and benefit from faster lookup)
     AllRequestedStores all_stores;
 
+    SignatureTrees signature_trees{max_cached_signature_trees};
+
     ExpiryDuration default_expiry_duration = std::chrono::seconds(1800);
 
     // These two combine into an effective O(log(N)) lookup/add/remove by
@@ -619,6 +709,10 @@ namespace ccf::historical
     CacheSize soft_store_cache_limit{std::numeric_limits<size_t>::max()};
     CacheSize estimated_store_cache_size{0};
 
+    bool prefetch_enabled = false;
+    size_t prefetch_requested_count = 0;
+    size_t prefetch_hit_count = 0;
+
     void add_request_ref(SeqNo seq, CompoundHandle handle)
     {
       auto it = store_to_requests.find(seq);
@@ -640,7 +734,12 @@ namespace ccf::historical
 
     void add_request_refs(CompoundHandle handle)
     {
-      for (const auto& [seq, _] : requests.at(handle).my_stores)
+      const auto& request = requests.at(handle);
+      for (const auto& [seq, _] : request.my_stores)
+      {
+        add_request_ref(seq, handle);
+      }
+      for (const auto& [seq, _] : request.prefetched_stores)
       {
         add_request_ref(seq, handle);
       }
@@ -666,7 +765,12 @@ namespace ccf::historical
 
     void remove_request_refs(CompoundHandle handle)
     {
-      for (const auto& [seq, _] : requests.at(handle).my_stores)
+      const auto& request = requests.at(handle);
+      for (const auto& [seq, _] : request.my_stores)
+      {
+        remove_request_ref(seq, handle);
+      }
+      for (const auto& [seq, _] : request.prefetched_stores)
       {
         remove_request_ref(seq, handle);
       }
@@ -751,6 +855,173 @@ namespace ccf::historical
         ::consensus::LedgerRequestPurpose::HistoricalQuery);
     }
 
+    void drop_prefetched_before(
+      const CompoundHandle& handle, Request& request, ccf::SeqNo seqno)
+    {
+      auto& prefetched = request.prefetched_stores;
+      auto it = prefetched.begin();
+      while (it != prefetched.end() && it->first < seqno)
+      {
+        remove_request_ref(it->first, handle);
+        it = prefetched.erase(it);
+      }
+    }
+
+    // If this request continues directly from the previous range requested on
+    // the same handle, begin fetching the following window of the same length,
+    // so that it may already be available when it is requested. Prefetching
+    // stops at the end of the committed ledger, and is skipped if the
+    // estimated size of the window would take the cache beyond half of its
+    // soft limit.
+    void update_prefetch(
+      const CompoundHandle& handle,
+      Request& request,
+      const SeqNoCollection& seqnos)
+    {
+      auto& prefetched = request.prefetched_stores;
+
+      // Prefetched seqnos which have now been requested are tracked (and
+      // referenced) by my_stores instead
+      auto it = prefetched.begin();
+      while (it != prefetched.end())
+      {
+        if (request.my_stores.contains(it->first))
+        {
+          ++prefetch_hit_count;
+          it = prefetched.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+
+      std::optional<std::pair<ccf::SeqNo, ccf::SeqNo>> range = std::nullopt;
+      if (seqnos.get_ranges().size() == 1)
+      {
+        range = std::make_pair(seqnos.front(), seqnos.back());
+      }
+      const auto previous_range = request.last_range;
+      if (range.has_value() && range == previous_range)
+      {
+        // Repeated request for the same range (eg - polling until it is
+        // available) leaves any prefetched window in place
+        return;
+      }
+      request.last_range = range;
+
+      const auto is_sequential = range.has_value() &&
+        previous_range.has_value() &&
+        range->first == previous_range->second + 1;
+      if (!is_sequential || request.awaiting_ledger_secrets.has_value())
+      {
+        drop_prefetched_before(
+          handle, request, std::numeric_limits<ccf::SeqNo>::max());
+        return;
+      }
+
+      drop_prefetched_before(handle, request, range->first);
+
+      auto consensus = source_store.get_consensus();
+      if (consensus == nullptr)
+      {
+        return;
+      }
+
+      const auto window_size = std::min<size_t>(
+        range->second - range->first + 1, max_prefetch_window);
+      const auto window_begin = range->second + 1;
+      const auto window_end = std::min(
+        range->second + static_cast<ccf::SeqNo>(window_size),
+        consensus->get_committed_seqno());
+      if (window_end < window_begin)
+      {
+        return;
+      }
+
+      // Estimate size of window from entries already received for this range
+      size_t known_size = 0;
+      size_t known_count = 0;
+      for (auto seqno = range->first; seqno <= range->second; ++seqno)
+      {
+        const auto size_it = raw_store_sizes.find(seqno);
+        if (size_it != raw_store_sizes.end())
+        {
+          known_size += size_it->second;
+          ++known_count;
+        }
+      }
+      if (known_count > 0)
+      {
+        const auto estimated_window_size =
+          (known_size / known_count) *
+          static_cast<size_t>(window_end - window_begin + 1);
+        if (
+          estimated_store_cache_size + estimated_window_size >
+          soft_store_cache_limit / 2)
+        {
+          HISTORICAL_LOG(
+            "Not prefetching {} to {} for {}: estimated {} bytes exceeds "
+            "budget",
+            window_begin,
+            window_end,
+            handle,
+            estimated_window_size);
+          return;
+        }
+      }
+
+      HISTORICAL_LOG(
+        "Prefetching {} to {} for {}", window_begin, window_end, handle);
+
+      // Newly tracked stores are fetched now, in contiguous ranges, rather
+      // than waiting for the next tick to find them
+      std::optional<std::pair<ccf::SeqNo, ccf::SeqNo>> range_to_fetch =
+        std::nullopt;
+      for (auto seqno = window_begin; seqno <= window_end; ++seqno)
+      {
+        if (
+          request.my_stores.contains(seqno) || prefetched.contains(seqno) ||
+          seqno < earliest_secret_.valid_from)
+        {
+          continue;
+        }
+
+        auto all_it = all_stores.find(seqno);
+        auto details =
+          all_it == all_stores.end() ? nullptr : all_it->second.lock();
+        if (details == nullptr)
+        {
+          details = std::make_shared<StoreDetails>();
+          details->time_until_fetch = slow_fetch_threshold;
+          all_stores.insert_or_assign(all_it, seqno, details);
+
+          if (
+            range_to_fetch.has_value() && range_to_fetch->second + 1 == seqno)
+          {
+            range_to_fetch->second = seqno;
+          }
+          else
+          {
+            if (range_to_fetch.has_value())
+            {
+              fetch_entries_range(
+                range_to_fetch->first, range_to_fetch->second);
+            }
+            range_to_fetch = std::make_pair(seqno, seqno);
+          }
+        }
+        prefetched.emplace(seqno, details);
+        add_request_ref(seqno, handle);
+        ++prefetch_requested_count;
+      }
+
+      if (range_to_fetch.has_value())
+      {
+        fetch_entries_range(range_to_fetch->first, range_to_fetch->second);
+      }
+    }
+
     std::optional<ccf::SeqNo> fetch_supporting_secret_if_needed(
       ccf::SeqNo seqno)
     {
@@ -807,6 +1078,168 @@ namespace ccf::historical
       return std::nullopt;
     }
 
+    struct DeserialisedEntry
+    {
+      ccf::kv::StorePtr store = nullptr;
+      ccf::kv::ApplyResult result = ccf::kv::ApplyResult::FAIL;
+      ccf::ClaimsDigest claims_digest;
+      bool has_commit_evidence = false;
+      bool public_only = false;
+      ccf::crypto::Sha256Hash entry_digest;
+    };
+
+    // Encrypted ledger secrets are deserialised in public-only mode. Their
+    // Merkle tree integrity is not verified: even if the recovered ledger
+    // secret was bogus, the deserialisation of subsequent ledger entries would
+    // fail.
+    bool is_awaited_ledger_secret(ccf::SeqNo seqno)
+    {
+      for (const auto& [_, request] : requests)
+      {
+        const auto& als = request.awaiting_ledger_secrets;
+        if (als.has_value() && als.value() == seqno)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    DeserialisedEntry deserialise_entry(
+      ccf::SeqNo seqno, const uint8_t* data, size_t size, bool public_only)
+    {
+      DeserialisedEntry entry;
+      entry.public_only = public_only;
+      entry.store = deserialise_ledger_entry(
+        seqno,
+        data,
+        size,
+        public_only,
+        entry.result,
+        entry.claims_digest,
+        entry.has_commit_evidence);
+      if (entry.result != ccf::kv::ApplyResult::FAIL)
+      {
+        entry.entry_digest = ccf::crypto::Sha256Hash({data, size});
+      }
+      return entry;
+    }
+
+    // Must be called with requests_lock held. An entry which was deserialised
+    // outside the lock is only used if it is still wanted in the same mode,
+    // and deserialised successfully. Otherwise (eg - it was encrypted with a
+    // past ledger secret recovered from an earlier entry in the same range),
+    // it is deserialised again here.
+    bool process_ledger_entry(
+      ccf::SeqNo seqno,
+      const uint8_t* data,
+      size_t size,
+      std::optional<DeserialisedEntry>&& deserialised)
+    {
+      const auto it = all_stores.find(seqno);
+      auto details = it == all_stores.end() ? nullptr : it->second.lock();
+      if (details == nullptr || details->current_stage != StoreStage::Fetching)
+      {
+        // Unexpected entry, we already have it or weren't asking for it -
+        // ignore this resubmission
+        return false;
+      }
+
+      const auto public_only = is_awaited_ledger_secret(seqno);
+      DeserialisedEntry entry;
+      if (
+        deserialised.has_value() &&
+        deserialised->result != ccf::kv::ApplyResult::FAIL &&
+        deserialised->public_only == public_only)
+      {
+        entry = std::move(deserialised.value());
+      }
+      else
+      {
+        entry = deserialise_entry(seqno, data, size, public_only);
+      }
+
+      if (entry.result == ccf::kv::ApplyResult::FAIL)
+      {
+        return false;
+      }
+
+      {
+        // Confirm this entry is from a precursor of the current state, and not
+        // a fork
+        const auto tx_id = entry.store->current_txid();
+        if (tx_id.seqno != seqno)
+        {
+          LOG_FAIL_FMT(
+            "Corrupt ledger entry received - claims to be {} but is actually "
+            "{}.{}",
+            seqno,
+            tx_id.view,
+            tx_id.seqno);
+          return false;
+        }
+
+        auto consensus = source_store.get_consensus();
+        if (consensus == nullptr)
+        {
+          LOG_FAIL_FMT("No consensus on source store");
+          return false;
+        }
+
+        const auto actual_view = consensus->get_view(seqno);
+        if (actual_view != tx_id.view)
+        {
+          LOG_FAIL_FMT(
+            "Ledger entry comes from fork - contains {}.{} but this service "
+            "expected {}.{}",
+            tx_id.view,
+            tx_id.seqno,
+            actual_view,
+            seqno);
+          return false;
+        }
+      }
+
+      const auto is_signature =
+        entry.result == ccf::kv::ApplyResult::PASS_SIGNATURE;
+
+      update_earliest_known_ledger_secret();
+
+      auto [valid_from, secret] = earliest_secret_;
+
+      if (secret != nullptr)
+      {
+        const auto& prev_version = secret->previous_secret_stored_version;
+        if (prev_version.has_value() && *prev_version == seqno)
+        {
+          HISTORICAL_LOG(
+            "Handling past ledger secret. Current earliest is valid from {}, "
+            "now "
+            "processing secret stored at {}",
+            valid_from,
+            seqno);
+          handle_encrypted_past_ledger_secret(entry.store, secret);
+          next_secret_fetch_handle = nullptr;
+        }
+      }
+
+      HISTORICAL_LOG(
+        "Processing historical store at {} ({})",
+        seqno,
+        (size_t)entry.result);
+      process_deserialised_store(
+        details,
+        entry.store,
+        entry.entry_digest,
+        seqno,
+        is_signature,
+        std::move(entry.claims_digest),
+        entry.has_commit_evidence);
+
+      update_store_raw_size(seqno, size);
+      return true;
+    }
+
     void process_deserialised_store(
       const StoreDetailsPtr& details,
       const ccf::kv::StorePtr& store,
@@ -1042,7 +1475,8 @@ namespace ccf::historical
       if (it == requests.end())
       {
         // This is a new handle - insert a newly created Request for it
-        it = requests.emplace_hint(it, handle, Request(all_stores));
+        it = requests.emplace_hint(
+          it, handle, Request(all_stores, signature_trees));
         HISTORICAL_LOG("First time I've seen handle {}", handle);
       }
 
@@ -1078,6 +1512,11 @@ namespace ccf::historical
       request.awaiting_ledger_secrets =
         fetch_supporting_secret_if_needed(request.first_requested_seqno());
 
+      if (prefetch_enabled)
+      {
+        update_prefetch(handle, request, seqnos);
+      }
+
       // Reset the expiry timer as this has just been requested
       request.time_to_expiry = ms_until_expiry;
 
@@ -1280,6 +1719,11 @@ namespace ccf::historical
       soft_store_cache_limit = cache_limit;
     }
 
+    void set_prefetch_enabled(bool enabled)
+    {
+      prefetch_enabled = enabled;
+    }
+
     void track_deletes_on_missing_keys(bool track)
     {
       track_deletes_on_missing_keys_v = track;
@@ -1301,106 +1745,7 @@ namespace ccf::historical
     bool handle_ledger_entry(ccf::SeqNo seqno, const uint8_t* data, size_t size)
     {
       std::lock_guard<ccf::pal::Mutex> guard(requests_lock);
-      const auto it = all_stores.find(seqno);
-      auto details = it == all_stores.end() ? nullptr : it->second.lock();
-      if (details == nullptr || details->current_stage != StoreStage::Fetching)
-      {
-        // Unexpected entry, we already have it or weren't asking for it -
-        // ignore this resubmission
-        return false;
-      }
-
-      ccf::kv::ApplyResult deserialise_result = ccf::kv::ApplyResult::FAIL;
-      ccf::ClaimsDigest claims_digest;
-      bool has_commit_evidence = false;
-      auto store = deserialise_ledger_entry(
-        seqno,
-        data,
-        size,
-        deserialise_result,
-        claims_digest,
-        has_commit_evidence);
-
-      if (deserialise_result == ccf::kv::ApplyResult::FAIL)
-      {
-        return false;
-      }
-
-      {
-        // Confirm this entry is from a precursor of the current state, and not
-        // a fork
-        const auto tx_id = store->current_txid();
-        if (tx_id.seqno != seqno)
-        {
-          LOG_FAIL_FMT(
-            "Corrupt ledger entry received - claims to be {} but is actually "
-            "{}.{}",
-            seqno,
-            tx_id.view,
-            tx_id.seqno);
-          return false;
-        }
-
-        auto consensus = source_store.get_consensus();
-        if (consensus == nullptr)
-        {
-          LOG_FAIL_FMT("No consensus on source store");
-          return false;
-        }
-
-        const auto actual_view = consensus->get_view(seqno);
-        if (actual_view != tx_id.view)
-        {
-          LOG_FAIL_FMT(
-            "Ledger entry comes from fork - contains {}.{} but this service "
-            "expected {}.{}",
-            tx_id.view,
-            tx_id.seqno,
-            actual_view,
-            seqno);
-          return false;
-        }
-      }
-
-      const auto is_signature =
-        deserialise_result == ccf::kv::ApplyResult::PASS_SIGNATURE;
-
-      update_earliest_known_ledger_secret();
-
-      auto [valid_from, secret] = earliest_secret_;
-
-      if (secret != nullptr)
-      {
-        const auto& prev_version = secret->previous_secret_stored_version;
-        if (prev_version.has_value() && *prev_version == seqno)
-        {
-          HISTORICAL_LOG(
-            "Handling past ledger secret. Current earliest is valid from {}, "
-            "now "
-            "processing secret stored at {}",
-            valid_from,
-            seqno);
-          handle_encrypted_past_ledger_secret(store, secret);
-          next_secret_fetch_handle = nullptr;
-        }
-      }
-
-      HISTORICAL_LOG(
-        "Processing historical store at {} ({})",
-        seqno,
-        (size_t)deserialise_result);
-      const auto entry_digest = ccf::crypto::Sha256Hash({data, size});
-      process_deserialised_store(
-        details,
-        store,
-        entry_digest,
-        seqno,
-        is_signature,
-        std::move(claims_digest),
-        has_commit_evidence);
-
-      update_store_raw_size(seqno, size);
-      return true;
+      return process_ledger_entry(seqno, data, size, std::nullopt);
     }
 
     bool handle_ledger_entries(
@@ -1418,15 +1763,24 @@ namespace ccf::historical
     {
       LOG_TRACE_FMT("handle_ledger_entries({}, {})", from_seqno, to_seqno);
 
+      struct ReceivedEntry
+      {
+        ccf::SeqNo seqno;
+        const uint8_t* data;
+        size_t size;
+        bool public_only = false;
+        std::optional<DeserialisedEntry> deserialised = std::nullopt;
+      };
+
+      std::vector<ReceivedEntry> received;
       auto seqno = from_seqno;
-      bool all_accepted = true;
       while (size > 0)
       {
         const auto header =
           serialized::peek<ccf::kv::SerialisedEntryHeader>(data, size);
         const auto whole_size =
           header.size + ccf::kv::serialised_entry_header_size;
-        all_accepted &= handle_ledger_entry(seqno, data, whole_size);
+        received.push_back({seqno, data, whole_size, false, std::nullopt});
         data += whole_size;
         size -= whole_size;
         ++seqno;
@@ -1442,6 +1796,48 @@ namespace ccf::historical
           seqno);
       }
 
+      // Decrypt, deserialise and hash the entries which are currently being
+      // fetched across the task system, outside of requests_lock
+      std::vector<size_t> to_deserialise;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(requests_lock);
+        for (size_t i = 0; i < received.size(); ++i)
+        {
+          auto& entry = received[i];
+          const auto it = all_stores.find(entry.seqno);
+          auto details = it == all_stores.end() ? nullptr : it->second.lock();
+          if (
+            details != nullptr &&
+            details->current_stage == StoreStage::Fetching)
+          {
+            entry.public_only = is_awaited_ledger_secret(entry.seqno);
+            to_deserialise.push_back(i);
+          }
+        }
+      }
+
+      ccf::tasks::parallel_for(
+        ccf::tasks::get_main_job_board(),
+        to_deserialise.size(),
+        deserialise_chunk_size,
+        [&](size_t begin, size_t end) {
+          for (auto i = begin; i < end; ++i)
+          {
+            auto& entry = received[to_deserialise[i]];
+            entry.deserialised = deserialise_entry(
+              entry.seqno, entry.data, entry.size, entry.public_only);
+          }
+        });
+
+      // Then process them in order, taking the lock for each entry
+      bool all_accepted = true;
+      for (auto& entry : received)
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(requests_lock);
+        all_accepted &= process_ledger_entry(
+          entry.seqno, entry.data, entry.size, std::move(entry.deserialised));
+      }
+
       return all_accepted;
     }
 
@@ -1479,6 +1875,27 @@ namespace ccf::historical
       ccf::kv::ApplyResult& result,
       ccf::ClaimsDigest& claims_digest,
       bool& has_commit_evidence)
+    {
+      return deserialise_ledger_entry(
+        seqno,
+        data,
+        size,
+        is_awaited_ledger_secret(seqno),
+        result,
+        claims_digest,
+        has_commit_evidence);
+    }
+
+    // Does not access any state guarded by requests_lock, so may be called
+    // concurrently for distinct entries
+    ccf::kv::StorePtr deserialise_ledger_entry(
+      ccf::SeqNo seqno,
+      const uint8_t* data,
+      size_t size,
+      bool public_only,
+      ccf::kv::ApplyResult& result,
+      ccf::ClaimsDigest& claims_digest,
+      bool& has_commit_evidence)
     {
       // Create a new store and try to deserialise this entry into it
       ccf::kv::StorePtr store = std::make_shared<ccf::kv::Store>(
@@ -1498,21 +1915,6 @@ namespace ccf::historical
 
       try
       {
-        // Encrypted ledger secrets are deserialised in public-only mode. Their
-        // Merkle tree integrity is not verified: even if the recovered ledger
-        // secret was bogus, the deserialisation of subsequent ledger entries
-        // would fail.
-        bool public_only = false;
-        for (const auto& [_, request] : requests)
-        {
-          const auto& als = request.awaiting_ledger_secrets;
-          if (als.has_value() && als.value() == seqno)
-          {
-            public_only = true;
-            break;
-          }
-        }
-
         auto exec = store->deserialize({data, data + size}, public_only);
         if (exec == nullptr)
         {
@@ -1545,6 +1947,20 @@ namespace ccf::historical
       return estimated_store_cache_size;
     }
 
+    // Number of seqnos fetched speculatively, ahead of being requested
+    size_t get_prefetch_requested_count()
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(requests_lock);
+      return prefetch_requested_count;
+    }
+
+    // Number of speculatively fetched seqnos which were subsequently requested
+    size_t get_prefetch_hit_count()
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(requests_lock);
+      return prefetch_hit_count;
+    }
+
     void tick(const std::chrono::milliseconds& elapsed_ms)
     {
       std::lock_guard<ccf::pal::Mutex> guard(requests_lock);
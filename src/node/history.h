@@ -14,6 +14,7 @@
 #include "crypto/openssl/ec_key_pair.h"
 #include "crypto/openssl/hash.h"
 #include "crypto/public_key.h"
+#include "crypto/sha256_multibuffer.h"
 #include "ds/internal_logger.h"
 #include "endian.h"
 #include "kv/kv_types.h"
@@ -25,8 +26,13 @@
 #include "tasks/basic_task.h"
 #include "tasks/task_system.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <deque>
+#include <exception>
+#include <list>
+#include <numeric>
 #include <string.h>
 
 #define HAVE_OPENSSL
@@ -134,7 +140,7 @@ namespace ccf
     }
 
     void append_entry(
-      const ccf::crypto::Sha256Hash& /*digest*/,
+      const ccf::EntryLeafComponents& /*leaf*/,
       std::optional<ccf::kv::Term> /*term_of_next_version_*/ =
         std::nullopt) override
     {
@@ -246,6 +252,164 @@ namespace ccf
 
   using HistoryTree = merkle::TreeT<sha256_byte_size, ccf::sha256_history>;
 
+  // Extends HistoryTree with the extraction of paths for many leaves at once.
+  // Rather than walking from the root to each leaf in turn, the tree is walked
+  // once, and the path elements above consecutive leaves are shared.
+  // Similarly, pending node hashes are computed a level at a time, so that
+  // the independent nodes on each level are hashed together.
+  class BatchedHistoryTree : public HistoryTree
+  {
+  private:
+    using Indices = std::vector<uint64_t>;
+
+    void collect_paths(
+      const Node* node,
+      uint64_t first_index,
+      std::vector<Path::Element>& elements,
+      Indices::const_iterator& next,
+      const Indices::const_iterator& end,
+      std::vector<std::shared_ptr<Path>>& paths)
+    {
+      if (node->height == 1)
+      {
+        // Path elements are ordered from the leaf up to the root
+        paths.push_back(std::make_shared<Path>(
+          node->hash,
+          first_index,
+          std::list<Path::Element>(elements.rbegin(), elements.rend()),
+          max_index()));
+        ++next;
+        return;
+      }
+
+      // This node covers [first_index, first_index + 2^(height - 1)). The left
+      // subtree is always complete, while the right subtree may be shallower
+      // than this node's height would suggest.
+      const uint64_t split = first_index + (uint64_t(1) << (node->height - 2));
+      const uint64_t limit = first_index + (uint64_t(1) << (node->height - 1));
+      if (*next < split)
+      {
+        elements.push_back({node->right->hash, Path::PATH_RIGHT});
+        collect_paths(node->left, first_index, elements, next, end, paths);
+        elements.pop_back();
+      }
+      if (next != end && *next >= split && *next < limit)
+      {
+        elements.push_back({node->left->hash, Path::PATH_LEFT});
+        collect_paths(node->right, split, elements, next, end, paths);
+        elements.pop_back();
+      }
+    }
+
+  public:
+    using HistoryTree::TreeT;
+
+    // Computes the hashes of all dirty nodes, from the lowest level up
+    void compute_hashes()
+    {
+      insert_leaves(true);
+      if (_root == nullptr || !_root->dirty)
+      {
+        return;
+      }
+
+      // Dirty nodes always have children, and only dirty nodes can have dirty
+      // children
+      std::vector<std::vector<Node*>> dirty_by_height(_root->height + 1);
+      std::vector<Node*> to_visit = {_root};
+      while (!to_visit.empty())
+      {
+        Node* n = to_visit.back();
+        to_visit.pop_back();
+        dirty_by_height[n->height].push_back(n);
+        for (Node* child : {n->left, n->right})
+        {
+          if (child->dirty)
+          {
+            to_visit.push_back(child);
+          }
+        }
+      }
+
+      std::vector<std::array<uint8_t, 2 * sha256_byte_size>> contents;
+      std::vector<std::span<const uint8_t>> messages;
+      std::vector<ccf::crypto::Sha256Hash> digests;
+      for (const auto& nodes : dirty_by_height)
+      {
+        if (nodes.empty())
+        {
+          continue;
+        }
+
+        contents.resize(nodes.size());
+        messages.clear();
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+          auto* content = contents[i].data();
+          memcpy(content, nodes[i]->left->hash.bytes, sha256_byte_size);
+          memcpy(
+            content + sha256_byte_size,
+            nodes[i]->right->hash.bytes,
+            sha256_byte_size);
+          messages.emplace_back(contents[i]);
+        }
+
+        digests.resize(nodes.size());
+        ccf::crypto::sha256_many(messages, digests);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+          std::copy(
+            digests[i].h.begin(), digests[i].h.end(), nodes[i]->hash.bytes);
+          nodes[i]->dirty = false;
+        }
+        statistics.num_hash += nodes.size();
+      }
+    }
+
+    const Hash& root()
+    {
+      compute_hashes();
+      return HistoryTree::root();
+    }
+
+    void flush_to(size_t index)
+    {
+      compute_hashes();
+      HistoryTree::flush_to(index);
+    }
+
+    // Returns the paths of the given leaves, which must be distinct, in
+    // ascending order, and within [min_index(), max_index()]
+    std::vector<std::shared_ptr<Path>> paths(const Indices& indices)
+    {
+      std::vector<std::shared_ptr<Path>> result;
+      if (indices.empty())
+      {
+        return result;
+      }
+
+      if (
+        indices.front() < min_index() || indices.back() > max_index() ||
+        std::adjacent_find(
+          indices.begin(), indices.end(), std::greater_equal<>()) !=
+          indices.end())
+      {
+        throw std::logic_error(
+          "Leaf indices must be distinct, ascending, and within the tree");
+      }
+
+      // Computes any pending hashes
+      root();
+
+      result.reserve(indices.size());
+      std::vector<Path::Element> elements;
+      auto next = indices.cbegin();
+      collect_paths(_root, 0, elements, next, indices.cend(), result);
+      return result;
+    }
+  };
+
   class Proof
   {
   private:
@@ -277,6 +441,13 @@ namespace ccf
       path(tree->path(index))
     {}
 
+    // Proof against the root of the tree as it was when as_of was its last
+    // index
+    Proof(HistoryTree* tree, uint64_t index, uint64_t as_of) :
+      root(*tree->past_root(as_of)),
+      path(tree->past_path(index, as_of))
+    {}
+
     Proof(const Proof&) = delete;
 
     bool verify(HistoryTree* tree) const
@@ -304,75 +475,91 @@ namespace ccf
     }
   };
 
+  struct ServiceSigningIdentity
+  {
+    const std::shared_ptr<ccf::crypto::ECKeyPair_OpenSSL> service_kp;
+    const ccf::COSESignaturesConfig cose_signatures_config;
+    const ccf::LedgerSignMode ledger_sign_mode = ccf::LedgerSignMode::Dual;
+
+    // Derived once from service_kp, rather than for each signature
+    const std::string kid;
+    CoseKey cose_key;
+  };
+
+  // Content of a signature transaction, produced from a snapshot of the root
+  struct SignatureContent
+  {
+    std::optional<PrimarySignature> primary_signature = std::nullopt;
+    std::vector<uint8_t> cose_signature;
+    std::vector<uint8_t> serialised_tree;
+  };
+
+  // Shared by a history with the signing tasks it creates, which may still be
+  // queued when it is destroyed. Tasks only run while holding lock, and do
+  // nothing once the history has cancelled them, since they refer to the
+  // history, its store and its keys.
+  struct SigningTaskGuard
+  {
+    ccf::pal::Mutex lock;
+    bool cancelled = false;
+  };
+
   template <class T>
   class MerkleTreeHistoryPendingTx : public ccf::kv::PendingTx
   {
+    // Shared with the task preparing the content, which may outlive this
+    // pending tx if it is discarded by a rollback
+    struct Prepared
+    {
+      std::atomic<bool> ready = false;
+      SignatureContent content;
+      std::exception_ptr error = nullptr;
+    };
+
     ccf::TxID txid;
     ccf::kv::Store& store;
     ccf::kv::TxHistory& history;
     NodeId id;
     ccf::crypto::ECKeyPair& node_kp;
-    ccf::crypto::ECKeyPair_OpenSSL& service_kp;
-    ccf::crypto::Pem& endorsed_cert;
-    const ccf::COSESignaturesConfig& cose_signatures_config;
-    const ccf::LedgerSignMode ledger_sign_mode;
-    std::unordered_map<std::string, CoseKey>& cose_key_cache;
-
-  public:
-    MerkleTreeHistoryPendingTx(
-      ccf::TxID txid_,
-      ccf::kv::Store& store_,
-      ccf::kv::TxHistory& history_,
-      NodeId id_,
-      ccf::crypto::ECKeyPair& node_kp_,
-      ccf::crypto::ECKeyPair_OpenSSL& service_kp_,
-      ccf::crypto::Pem& endorsed_cert_,
-      const ccf::COSESignaturesConfig& cose_signatures_config_,
-      ccf::LedgerSignMode ledger_sign_mode_,
-      std::unordered_map<std::string, CoseKey>& cose_key_cache_) :
-      txid(txid_),
-      store(store_),
-      history(history_),
-      id(std::move(id_)),
-      node_kp(node_kp_),
-      service_kp(service_kp_),
-      endorsed_cert(endorsed_cert_),
-      cose_signatures_config(cose_signatures_config_),
-      ledger_sign_mode(ledger_sign_mode_),
-      cose_key_cache(cose_key_cache_)
-    {}
-
-    ccf::kv::PendingTxInfo call() override
+    const ServiceSigningIdentity& signing_identity;
+    ccf::crypto::Pem endorsed_cert;
+    ccf::tasks::JobBoard* job_board;
+    std::shared_ptr<SigningTaskGuard> task_guard;
+
+    std::shared_ptr<Prepared> prepared = nullptr;
+
+    static SignatureContent sign(
+      const ccf::TxID& txid,
+      const NodeId& id,
+      const ccf::crypto::Sha256Hash& root,
+      ccf::crypto::ECKeyPair& node_kp,
+      const ServiceSigningIdentity& signing_identity,
+      const ccf::crypto::Pem& endorsed_cert,
+      ccf::kv::TxHistory& history)
     {
-      auto sig = store.create_reserved_tx(txid);
-      ccf::crypto::Sha256Hash root = history.get_replicated_state_root();
+      SignatureContent content;
 
       std::vector<uint8_t> root_hash{
         root.h.data(), root.h.data() + root.h.size()};
 
-      if (ledger_sign_mode == ccf::LedgerSignMode::Dual)
+      if (signing_identity.ledger_sign_mode == ccf::LedgerSignMode::Dual)
       {
-        auto* signatures =
-          sig.template wo<ccf::Signatures>(ccf::Tables::SIGNATURES);
         auto primary_sig =
           node_kp.sign_hash(root_hash.data(), root_hash.size());
 
-        PrimarySignature sig_value(
+        content.primary_signature.emplace(
           id,
           txid.seqno,
           txid.view,
           root,
-          {}, // Nonce is currently empty
+          Nonce{}, // Nonce is currently empty
           primary_sig,
           endorsed_cert);
-
-        signatures->put(sig_value);
       }
 
-      auto* cose_signatures =
-        sig.template wo<ccf::CoseSignatures>(ccf::Tables::COSE_SIGNATURES);
-
-      auto kid = ccf::crypto::kid_from_key(service_kp.public_key_der());
+      const auto& kid = signing_identity.kid;
+      const auto& cose_signatures_config =
+        signing_identity.cose_signatures_config;
       const auto tx_id = txid.to_str();
 
       const auto time_since_epoch =
@@ -380,27 +567,10 @@ namespace ccf
           std::chrono::system_clock::now().time_since_epoch())
           .count();
 
-      auto it = cose_key_cache.find(kid);
-      if (it == cose_key_cache.end())
-      {
-        auto key_der = service_kp.private_key_der();
-        CoseBuffer key_err;
-        auto cose_key =
-          CoseKey::from_private(key_der.data(), key_der.size(), key_err);
-        if (!cose_key.is_set())
-        {
-          throw std::runtime_error(fmt::format(
-            "cose_key_from_der_private failed: {}",
-            key_err.is_set() ? key_err.to_string() : "unknown error"));
-        }
-        auto [inserted, _] = cose_key_cache.emplace(kid, std::move(cose_key));
-        it = inserted;
-      }
-
       CoseBuffer cose_buf;
       CoseBuffer cose_err;
       auto rc = cose_sign_ledger(
-        it->second,
+        signing_identity.cose_key,
         reinterpret_cast<const uint8_t*>(kid.data()),
         kid.size(),
         time_since_epoch,
@@ -420,13 +590,136 @@ namespace ccf
           "cose_sign_ledger failed: {}",
           cose_err.is_set() ? cose_err.to_string() : "unknown error"));
       }
-      std::vector<uint8_t> cose_sign(cose_buf.to_vector());
+      content.cose_signature = cose_buf.to_vector();
 
-      cose_signatures->put(cose_sign);
+      content.serialised_tree = history.serialise_tree(txid.seqno - 1);
+
+      return content;
+    }
+
+  public:
+    MerkleTreeHistoryPendingTx(
+      ccf::TxID txid_,
+      ccf::kv::Store& store_,
+      ccf::kv::TxHistory& history_,
+      NodeId id_,
+      ccf::crypto::ECKeyPair& node_kp_,
+      const ServiceSigningIdentity& signing_identity_,
+      ccf::crypto::Pem endorsed_cert_,
+      ccf::tasks::JobBoard* job_board_ = nullptr,
+      std::shared_ptr<SigningTaskGuard> task_guard_ = nullptr) :
+      txid(txid_),
+      store(store_),
+      history(history_),
+      id(std::move(id_)),
+      node_kp(node_kp_),
+      signing_identity(signing_identity_),
+      endorsed_cert(std::move(endorsed_cert_)),
+      job_board(job_board_),
+      task_guard(std::move(task_guard_))
+    {
+      if (job_board != nullptr && task_guard == nullptr)
+      {
+        throw std::logic_error(
+          "Signatures signed by tasks require a signing task guard");
+      }
+    }
+
+    [[nodiscard]] bool prepare_reads_history() const override
+    {
+      return true;
+    }
+
+    bool prepare() override
+    {
+      if (prepared != nullptr)
+      {
+        return prepared->ready;
+      }
+
+      // All preceding transactions are now in the tree, and later ones are
+      // held until this is ready, so this is the root to be signed
+      prepared = std::make_shared<Prepared>();
+      const auto root = history.get_replicated_state_root();
+
+      if (job_board == nullptr)
+      {
+        prepared->content = sign(
+          txid, id, root, node_kp, signing_identity, endorsed_cert, history);
+        prepared->ready = true;
+        return true;
+      }
+
+      // Sign on a worker thread, so that other transactions can be committed
+      // (and held) in the meantime rather than waiting on the commit lock
+      job_board->add_task(ccf::tasks::make_basic_task(
+        [guard = task_guard,
+         p = prepared,
+         txid = txid,
+         id = id,
+         root,
+         &node_kp = node_kp,
+         &signing_identity = signing_identity,
+         endorsed_cert = endorsed_cert,
+         &history = history,
+         &store = store]() {
+          std::lock_guard<ccf::pal::Mutex> lock(guard->lock);
+          if (guard->cancelled)
+          {
+            return;
+          }
+
+          try
+          {
+            p->content = sign(
+              txid,
+              id,
+              root,
+              node_kp,
+              signing_identity,
+              endorsed_cert,
+              history);
+          }
+          catch (...)
+          {
+            p->error = std::current_exception();
+          }
+          p->ready = true;
+          store.resume_commit();
+        }));
+      return false;
+    }
+
+    ccf::kv::PendingTxInfo call() override
+    {
+      if (prepared == nullptr || !prepared->ready)
+      {
+        throw std::logic_error(fmt::format(
+          "Signature at {} committed before it was prepared", txid.to_str()));
+      }
+
+      if (prepared->error != nullptr)
+      {
+        std::rethrow_exception(prepared->error);
+      }
+
+      auto& content = prepared->content;
+      auto sig = store.create_reserved_tx(txid);
+
+      if (content.primary_signature.has_value())
+      {
+        auto* signatures =
+          sig.template wo<ccf::Signatures>(ccf::Tables::SIGNATURES);
+        signatures->put(content.primary_signature.value());
+      }
+
+      auto* cose_signatures =
+        sig.template wo<ccf::CoseSignatures>(ccf::Tables::COSE_SIGNATURES);
+      cose_signatures->put(content.cose_signature);
 
       auto* serialised_tree = sig.template wo<ccf::SerialisedMerkleTree>(
         ccf::Tables::SERIALISED_MERKLE_TREE);
-      serialised_tree->put(history.serialise_tree(txid.seqno - 1));
+      serialised_tree->put(content.serialised_tree);
 
       return sig.commit_reserved();
     }
@@ -434,24 +727,24 @@ namespace ccf
 
   class MerkleTreeHistory
   {
-    std::unique_ptr<HistoryTree> tree;
+    std::unique_ptr<BatchedHistoryTree> tree;
 
   public:
     MerkleTreeHistory(MerkleTreeHistory const&) = delete;
 
     MerkleTreeHistory(const std::vector<uint8_t>& serialised) :
-      tree(std::make_unique<HistoryTree>(serialised))
+      tree(std::make_unique<BatchedHistoryTree>(serialised))
     {}
 
     MerkleTreeHistory(ccf::crypto::Sha256Hash first_hash = {}) :
-      tree(std::make_unique<HistoryTree>(merkle::Hash(first_hash.h)))
+      tree(std::make_unique<BatchedHistoryTree>(merkle::Hash(first_hash.h)))
     {}
 
     ~MerkleTreeHistory() = default;
 
     void deserialise(const std::vector<uint8_t>& serialised)
     {
-      tree = std::make_unique<HistoryTree>(serialised);
+      tree = std::make_unique<BatchedHistoryTree>(serialised);
     }
 
     void append(const ccf::crypto::Sha256Hash& hash)
@@ -472,7 +765,7 @@ namespace ccf
       if (this != &rhs)
       {
         ccf::crypto::Sha256Hash root(rhs.get_root());
-        tree = std::make_unique<HistoryTree>(merkle::Hash(root.h));
+        tree = std::make_unique<BatchedHistoryTree>(merkle::Hash(root.h));
       }
       return *this;
     }
@@ -506,9 +799,76 @@ namespace ccf
           index,
           end_index()));
       }
+      tree->compute_hashes();
       return {tree.get(), index};
     }
 
+    // Proof of index against the root of the tree as of (and including)
+    // as_of, which must not have been retracted or flushed
+    Proof get_past_proof(uint64_t index, uint64_t as_of)
+    {
+      if (index > as_of)
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot produce proof for {} as of earlier index {}", index, as_of));
+      }
+      if (index < begin_index())
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot produce proof for {}: index is older than first index {}, "
+          "and has been flushed from memory",
+          index,
+          begin_index()));
+      }
+      if (as_of > end_index())
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot produce proof as of {}: index is later than last index {}",
+          as_of,
+          end_index()));
+      }
+      return {tree.get(), index, as_of};
+    }
+
+    // Returns the paths of the given indices (distinct and in ascending order),
+    // which all prove against get_root(). Equivalent to calling get_proof() for
+    // each index, but with a single walk of the tree.
+    std::vector<std::shared_ptr<HistoryTree::Path>> get_paths(
+      const std::vector<uint64_t>& indices)
+    {
+      if (!indices.empty())
+      {
+        if (indices.front() < begin_index())
+        {
+          throw std::logic_error(fmt::format(
+            "Cannot produce proof for {}: index is older than first index {}, "
+            "and has been flushed from memory",
+            indices.front(),
+            begin_index()));
+        }
+        if (indices.back() > end_index())
+        {
+          throw std::logic_error(fmt::format(
+            "Cannot produce proof for {}: index is later than last index {}",
+            indices.back(),
+            end_index()));
+        }
+      }
+      return tree->paths(indices);
+    }
+
+    std::vector<std::shared_ptr<HistoryTree::Path>> get_paths(
+      uint64_t from, uint64_t to)
+    {
+      std::vector<uint64_t> indices;
+      if (to >= from)
+      {
+        indices.resize(to - from + 1);
+        std::iota(indices.begin(), indices.end(), from);
+      }
+      return get_paths(indices);
+    }
+
     bool verify(const Proof& r)
     {
       return r.verify(tree.get());
@@ -517,6 +877,7 @@ namespace ccf
     std::vector<uint8_t> serialise()
     {
       LOG_TRACE_FMT("mt_serialize_size {}", tree->serialised_size());
+      tree->compute_hashes();
       std::vector<uint8_t> output;
       tree->serialise(output);
       return output;
@@ -529,6 +890,7 @@ namespace ccf
         from,
         to,
         tree->serialised_size(from, to));
+      tree->compute_hashes();
       std::vector<uint8_t> output;
       tree->serialise(from, to, output);
       return output;
@@ -558,6 +920,15 @@ namespace ccf
     }
   };
 
+  // Proof of a recent entry, produced from the Merkle tree held in memory
+  struct RecentEntryProof
+  {
+    HistoryTree::Hash root;
+    std::shared_ptr<HistoryTree::Path> path;
+    EntryLeafComponents leaf;
+    std::optional<std::string> commit_evidence;
+  };
+
   template <class T>
   class HashedTxHistory : public ccf::kv::TxHistory
   {
@@ -565,6 +936,17 @@ namespace ccf
     NodeId id;
     T replicated_state_tree;
 
+    // Number of committed entries retained in the tree (beyond those kept
+    // for MAX_HISTORY_LEN), so that receipts for them can be produced from
+    // memory. Signatures only serialise the tree from serialise_from, as if
+    // these entries had been flushed.
+    size_t receipt_window = 0;
+    uint64_t serialise_from = 0;
+
+    // Leaf components of the last entries in the tree, ending with its last
+    // index. Empty for entries appended from a raw hash.
+    std::deque<std::optional<EntryLeafComponents>> recent_leaves;
+
     ccf::crypto::ECKeyPair& node_kp;
     ccf::crypto::COSEVerifierUniquePtr cose_verifier;
     ccf::crypto::Pem cose_cert_cached;
@@ -579,16 +961,13 @@ namespace ccf
 
     std::optional<ccf::crypto::Pem> endorsed_cert = std::nullopt;
 
-    struct ServiceSigningIdentity
-    {
-      const std::shared_ptr<ccf::crypto::ECKeyPair_OpenSSL> service_kp;
-      const ccf::COSESignaturesConfig cose_signatures_config;
-      const ccf::LedgerSignMode ledger_sign_mode = ccf::LedgerSignMode::Dual;
-    };
-
     std::optional<ServiceSigningIdentity> signing_identity = std::nullopt;
 
-    std::unordered_map<std::string, CoseKey> cose_key_cache;
+    // If set, signatures are produced by tasks on this job board, rather than
+    // while holding the store's commit lock
+    ccf::tasks::JobBoard* signing_job_board = nullptr;
+    std::shared_ptr<SigningTaskGuard> signing_task_guard =
+      std::make_shared<SigningTaskGuard>();
 
   public:
     HashedTxHistory(
@@ -622,8 +1001,25 @@ namespace ccf
 
       const auto ledger_sign_mode_ = ccf::get_ledger_sign_mode();
 
+      auto kid = ccf::crypto::kid_from_key(service_kp_->public_key_der());
+
+      auto key_der = service_kp_->private_key_der();
+      CoseBuffer key_err;
+      auto cose_key =
+        CoseKey::from_private(key_der.data(), key_der.size(), key_err);
+      if (!cose_key.is_set())
+      {
+        throw std::runtime_error(fmt::format(
+          "cose_key_from_der_private failed: {}",
+          key_err.is_set() ? key_err.to_string() : "unknown error"));
+      }
+
       signing_identity.emplace(ServiceSigningIdentity{
-        service_kp_, cose_signatures_config_, ledger_sign_mode_});
+        service_kp_,
+        cose_signatures_config_,
+        ledger_sign_mode_,
+        std::move(kid),
+        std::move(cose_key)});
 
       LOG_INFO_FMT(
         "Setting service signing identity to iss: {} sub: {}. Ledger "
@@ -709,6 +1105,10 @@ namespace ccf
       {
         emit_signature_periodic_task->cancel_task();
       }
+
+      // Waits for any signing task which is running to complete
+      std::lock_guard<ccf::pal::Mutex> guard(signing_task_guard->lock);
+      signing_task_guard->cancelled = true;
     }
 
     void set_node_id(const NodeId& id_)
@@ -741,6 +1141,7 @@ namespace ccf
         "Tree is not empty before initialising from snapshot");
 
       replicated_state_tree.deserialise(tree.value());
+      recent_leaves.clear();
 
       ccf::crypto::Sha256Hash hash;
       std::copy_n(
@@ -879,7 +1280,7 @@ namespace ccf
       if (to <= replicated_state_tree.end_index())
       {
         return replicated_state_tree.serialise(
-          replicated_state_tree.begin_index(), to);
+          std::max(replicated_state_tree.begin_index(), serialise_from), to);
       }
 
       return {};
@@ -901,6 +1302,13 @@ namespace ccf
       LOG_TRACE_FMT("Rollback to {}.{}", tx_id.view, tx_id.seqno);
       term_of_last_version = tx_id.view;
       term_of_next_version = term_of_next_version_;
+      const auto end = replicated_state_tree.end_index();
+      if (tx_id.seqno < end)
+      {
+        recent_leaves.resize(
+          recent_leaves.size() -
+          std::min<size_t>(recent_leaves.size(), end - tx_id.seqno));
+      }
       replicated_state_tree.retract(tx_id.seqno);
       log_hash(replicated_state_tree.get_root(), ROLLBACK);
     }
@@ -912,11 +1320,105 @@ namespace ccf
       // history so that a range of receipts are available.
       if (v > MAX_HISTORY_LEN)
       {
-        replicated_state_tree.flush(v - MAX_HISTORY_LEN);
+        serialise_from = v - MAX_HISTORY_LEN;
+        if (serialise_from > receipt_window)
+        {
+          replicated_state_tree.flush(serialise_from - receipt_window);
+          const auto retained = replicated_state_tree.end_index() -
+            replicated_state_tree.begin_index() + 1;
+          while (recent_leaves.size() > retained)
+          {
+            recent_leaves.pop_front();
+          }
+        }
       }
       log_hash(replicated_state_tree.get_root(), COMPACT);
     }
 
+    // Retains the given number of committed entries in memory, in addition to
+    // those otherwise retained, so that get_recent_proof() can produce
+    // receipts for them
+    void set_receipt_window(size_t entries)
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(state_lock);
+      receipt_window = entries;
+    }
+
+    // Signatures are then signed by a task on the given job board, and only
+    // inserted while holding the store's commit lock. Transactions committed
+    // after a signature are held until it has been signed
+    void set_signing_job_board(ccf::tasks::JobBoard* job_board)
+    {
+      signing_job_board = job_board;
+    }
+
+    // Returns a proof of tx_id against the root signed by the signature at
+    // sig_seqno, if the tree covering both is still held in memory. Returns
+    // nullopt if it is not, or if tx_id does not match the entry at its seqno.
+    std::optional<RecentEntryProof> get_recent_proof(
+      const ccf::TxID& tx_id, ccf::SeqNo sig_seqno)
+    {
+      if (tx_id.seqno == 0 || tx_id.seqno >= sig_seqno)
+      {
+        return std::nullopt;
+      }
+
+      // The signature at sig_seqno signs the tree up to the entry before it
+      const auto index = tx_id.seqno;
+      const auto as_of = sig_seqno - 1;
+
+      std::optional<RecentEntryProof> proof = std::nullopt;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(state_lock);
+        const auto end = replicated_state_tree.end_index();
+        if (
+          index < replicated_state_tree.begin_index() || as_of > end ||
+          end - index >= recent_leaves.size())
+        {
+          return std::nullopt;
+        }
+
+        const auto& leaf =
+          recent_leaves[recent_leaves.size() - 1 - (end - index)];
+        if (!leaf.has_value())
+        {
+          return std::nullopt;
+        }
+
+        auto past_proof = replicated_state_tree.get_past_proof(index, as_of);
+        proof = RecentEntryProof{
+          past_proof.get_root(),
+          past_proof.get_path(),
+          leaf.value(),
+          std::nullopt};
+      }
+
+      // Without commit evidence, the view of the entry cannot be checked
+      if (!proof->leaf.commit_evidence_digest.has_value())
+      {
+        return std::nullopt;
+      }
+
+      auto encryptor = store.get_encryptor();
+      if (encryptor == nullptr)
+      {
+        return std::nullopt;
+      }
+
+      // The commit evidence is derived from the TxID, so only matches the
+      // digest in the leaf if tx_id names the entry at this seqno
+      auto commit_evidence = encryptor->get_commit_evidence(tx_id);
+      if (
+        ccf::crypto::Sha256Hash(commit_evidence) !=
+        proof->leaf.commit_evidence_digest.value())
+      {
+        return std::nullopt;
+      }
+      proof->commit_evidence = std::move(commit_evidence);
+
+      return proof;
+    }
+
     ccf::pal::Mutex signature_lock;
 
     void try_emit_signature() override
@@ -967,11 +1469,10 @@ namespace ccf
           *this,
           id,
           node_kp,
-          *signing_identity->service_kp,
+          signing_identity.value(),
           endorsed_cert.value(),
-          signing_identity->cose_signatures_config,
-          signing_identity->ledger_sign_mode,
-          cose_key_cache),
+          signing_job_board,
+          signing_task_guard),
         true);
     }
 
@@ -1001,13 +1502,15 @@ namespace ccf
       log_hash(rh, APPEND);
       std::lock_guard<ccf::pal::Mutex> guard(state_lock);
       replicated_state_tree.append(rh);
+      recent_leaves.emplace_back(std::nullopt);
     }
 
     void append_entry(
-      const ccf::crypto::Sha256Hash& digest,
+      const ccf::EntryLeafComponents& leaf,
       std::optional<ccf::kv::Term> expected_term_of_next_version =
         std::nullopt) override
     {
+      const auto digest = ccf::entry_leaf(leaf);
       log_hash(digest, APPEND);
       std::lock_guard<ccf::pal::Mutex> guard(state_lock);
       if (expected_term_of_next_version.has_value())
@@ -1018,6 +1521,32 @@ namespace ccf
         }
       }
       replicated_state_tree.append(digest);
+      recent_leaves.emplace_back(leaf);
+    }
+
+    void append_entries(
+      std::span<const ccf::EntryLeafComponents> leaves,
+      std::optional<ccf::kv::Term> expected_term_of_next_version =
+        std::nullopt) override
+    {
+      const auto digests = ccf::entry_leaves(leaves);
+      for (const auto& digest : digests)
+      {
+        log_hash(digest, APPEND);
+      }
+      std::lock_guard<ccf::pal::Mutex> guard(state_lock);
+      if (expected_term_of_next_version.has_value())
+      {
+        if (expected_term_of_next_version.value() != term_of_next_version)
+        {
+          return;
+        }
+      }
+      for (size_t i = 0; i < leaves.size(); ++i)
+      {
+        replicated_state_tree.append(digests[i]);
+        recent_leaves.emplace_back(leaves[i]);
+      }
     }
 
     void set_endorsed_certificate(const ccf::crypto::Pem& cert) override
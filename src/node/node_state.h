@@ -45,6 +45,7 @@
 #include "node/node_inbound_message.h"
 #include "node/node_to_node_channel_manager.h"
 #include "node/recovery_decision_protocol.h"
+#include "node/recovery_ledger_reader.h"
 #include "node/recovery_snapshot_ledger.h"
 #include "node/signature_cache_subsystem.h"
 #include "node/snapshotter.h"
@@ -60,6 +61,8 @@
 #include "share_manager.h"
 #include "snapshots/fetch.h"
 #include "snapshots/filenames.h"
+#include "tasks/parallel_for.h"
+#include "tasks/task_system.h"
 #include "uvm_endorsements.h"
 
 #include <arpa/inet.h>
@@ -480,6 +483,18 @@ namespace ccf
 
     ::consensus::Index last_recovered_idx = 0;
     static const size_t recovery_batch_size = 100;
+    static const size_t max_recovery_batch_size = 10'000;
+    static const size_t max_recovery_reads_in_flight = 4;
+    // Number of ledger entries deserialised by each task, ahead of the
+    // entries being applied in order during recovery
+    static const size_t recovery_deserialise_chunk_size = 16;
+    RecoveryLedgerReader recovery_reader{
+      [this](::consensus::Index from, ::consensus::Index to) {
+        read_ledger_entries(from, to);
+      },
+      max_recovery_reads_in_flight,
+      recovery_batch_size,
+      max_recovery_batch_size};
 
     //
     // JWT key auto-refresh
@@ -1879,40 +1894,58 @@ namespace ccf
 
       LOG_INFO_FMT("Starting to read public ledger");
 
-      read_ledger_entries(
-        last_recovered_idx + 1, last_recovered_idx + recovery_batch_size);
+      recovery_reader.start(last_recovered_idx + 1);
     }
 
-    void recover_public_ledger_entries(const std::vector<uint8_t>& entries)
+    // Splits a batch of ledger entries and deserialises them ahead of time,
+    // across the task threads, since decrypting and parsing an entry does not
+    // depend on the entries before it. The returned entries must still be
+    // applied in order.
+    std::vector<std::unique_ptr<ccf::kv::AbstractExecutionWrapper>>
+    deserialise_recovery_entries(
+      ccf::kv::Store& store,
+      const std::vector<uint8_t>& entries,
+      bool public_only = false)
     {
-      std::lock_guard<pal::Mutex> guard(lock);
-
-      sm.expect(NodeStartupState::readingPublicLedger);
-
+      std::vector<std::unique_ptr<ccf::kv::AbstractExecutionWrapper>> wrappers;
       const auto* data = entries.data();
       auto size = entries.size();
-
-      if (size == 0)
+      while (size > 0)
       {
-        recover_public_ledger_end_unsafe();
-        return;
+        wrappers.push_back(store.deserialize(
+          ::consensus::LedgerEnclave::get_entry(data, size), public_only));
       }
 
-      while (size > 0)
-      {
-        auto entry = ::consensus::LedgerEnclave::get_entry(data, size);
+      ccf::tasks::parallel_for(
+        ccf::tasks::get_main_job_board(),
+        wrappers.size(),
+        recovery_deserialise_chunk_size,
+        [&wrappers](size_t begin, size_t end) {
+          for (auto i = begin; i < end; ++i)
+          {
+            wrappers[i]->deserialise_ahead();
+          }
+        });
 
-        LOG_INFO_FMT(
-          "Deserialising public ledger entry #{} [{} bytes]",
-          last_recovered_idx,
-          entry.size());
+      return wrappers;
+    }
+
+    void recover_public_ledger_entries_unsafe(
+      const std::vector<uint8_t>& entries)
+    {
+      sm.expect(NodeStartupState::readingPublicLedger);
 
-        // When reading the private ledger, deserialise in the recovery store
+      auto wrappers = deserialise_recovery_entries(
+        *network.tables, entries, true /* public only */);
+
+      for (auto& r : wrappers)
+      {
+        LOG_INFO_FMT(
+          "Deserialising public ledger entry #{}", last_recovered_idx);
 
         ccf::kv::ApplyResult result = ccf::kv::ApplyResult::FAIL;
         try
         {
-          auto r = network.tables->deserialize(entry, true);
           result = r->apply();
           if (result == ccf::kv::ApplyResult::FAIL)
           {
@@ -1966,9 +1999,6 @@ namespace ccf
           last_recovered_signed_idx = last_recovered_idx;
         }
       }
-
-      read_ledger_entries(
-        last_recovered_idx + 1, last_recovered_idx + recovery_batch_size);
     }
 
     void advance_part_of_public_network()
@@ -1994,6 +2024,8 @@ namespace ccf
     {
       sm.expect(NodeStartupState::readingPublicLedger);
 
+      recovery_reader.stop();
+
       // When reaching the end of the public ledger, truncate to last signed
       // index
       const auto last_recovered_term = view_history.size();
@@ -2176,39 +2208,23 @@ namespace ccf
     //
     // funcs in state "readingPrivateLedger"
     //
-    void recover_private_ledger_entries(const std::vector<uint8_t>& entries)
+    void recover_private_ledger_entries_unsafe(
+      const std::vector<uint8_t>& entries)
     {
-      std::lock_guard<pal::Mutex> guard(lock);
-      if (!sm.check(NodeStartupState::readingPrivateLedger))
-      {
-        LOG_FAIL_FMT(
-          "Node in state {} cannot recover private ledger entries", sm.value());
-        return;
-      }
-
-      const auto* data = entries.data();
-      auto size = entries.size();
+      sm.expect(NodeStartupState::readingPrivateLedger);
 
-      if (size == 0)
-      {
-        recover_private_ledger_end_unsafe();
-        return;
-      }
+      // When reading the private ledger, deserialise in the recovery store
+      auto wrappers = deserialise_recovery_entries(*recovery_store, entries);
 
-      while (size > 0)
+      for (auto& r : wrappers)
       {
-        auto entry = ::consensus::LedgerEnclave::get_entry(data, size);
-
         LOG_INFO_FMT(
-          "Deserialising private ledger entry {} [{}]",
-          last_recovered_idx + 1,
-          entry.size());
+          "Deserialising private ledger entry {}", last_recovered_idx + 1);
 
-        // When reading the private ledger, deserialise in the recovery store
         ccf::kv::ApplyResult result = ccf::kv::ApplyResult::FAIL;
         try
         {
-          result = recovery_store->deserialize(entry)->apply();
+          result = r->apply();
           if (result == ccf::kv::ApplyResult::FAIL)
           {
             LOG_FAIL_FMT(
@@ -2240,12 +2256,6 @@ namespace ccf
         LOG_INFO_FMT("Reached recovery final version at {}", recovery_v);
         recover_private_ledger_end_unsafe();
       }
-      else
-      {
-        read_ledger_entries(
-          last_recovered_idx + 1,
-          std::min(last_recovered_idx + recovery_batch_size, recovery_v));
-      }
     }
 
     void recover_private_ledger_end_unsafe()
@@ -2255,6 +2265,8 @@ namespace ccf
 
       sm.expect(NodeStartupState::readingPrivateLedger);
 
+      recovery_reader.stop();
+
       LOG_INFO_FMT(
         "Try end private recovery at {}. Is primary: {}",
         recovery_v,
@@ -2387,23 +2399,69 @@ namespace ccf
     //
     // funcs in state "readingPublicLedger" or "readingPrivateLedger"
     //
-    void recover_ledger_end()
+    void recover_ledger_entries(
+      ::consensus::Index from,
+      ::consensus::Index to,
+      std::vector<uint8_t>&& entries)
     {
       std::lock_guard<pal::Mutex> guard(lock);
+      recovery_reader.add_entries(from, to, std::move(entries));
+      process_recovery_batches_unsafe();
+    }
 
-      if (is_reading_public_ledger())
-      {
-        recover_public_ledger_end_unsafe();
-      }
-      else if (is_reading_private_ledger())
+    void recover_ledger_end(::consensus::Index from)
+    {
+      std::lock_guard<pal::Mutex> guard(lock);
+      recovery_reader.add_no_entries(from);
+      process_recovery_batches_unsafe();
+    }
+
+    void ledger_durable(
+      ::consensus::Index idx, ::consensus::TruncationId truncation_id)
+    {
+      // Reports received before consensus is created are irrelevant, since it
+      // starts from a ledger which is already durable
+      if (consensus != nullptr)
       {
-        recover_private_ledger_end_unsafe();
+        consensus->set_ledger_durable_seqno(idx, truncation_id);
       }
-      else
+    }
+
+    // Applies the batches of ledger entries which have been read, in order.
+    // Reaching the end of the ledger, or failing to apply an entry, ends the
+    // current phase of recovery and stops the reader.
+    void process_recovery_batches_unsafe()
+    {
+      while (auto batch = recovery_reader.next_batch())
       {
-        LOG_FAIL_FMT(
-          "Node in state {} cannot finalise ledger recovery", sm.value());
-        return;
+        if (is_reading_public_ledger())
+        {
+          if (batch->entries.empty())
+          {
+            recover_public_ledger_end_unsafe();
+          }
+          else
+          {
+            recover_public_ledger_entries_unsafe(batch->entries);
+          }
+        }
+        else if (is_reading_private_ledger())
+        {
+          if (batch->entries.empty())
+          {
+            recover_private_ledger_end_unsafe();
+          }
+          else
+          {
+            recover_private_ledger_entries_unsafe(batch->entries);
+          }
+        }
+        else
+        {
+          LOG_FAIL_FMT(
+            "Node in state {} cannot recover ledger entries", sm.value());
+          recovery_reader.stop();
+        }
       }
     }
 
@@ -3136,8 +3194,10 @@ namespace ccf
       // Start reading private security domain of ledger
       sm.advance(NodeStartupState::readingPrivateLedger);
       last_recovered_idx = recovery_store->current_version();
-      read_ledger_entries(
-        last_recovered_idx + 1, last_recovered_idx + recovery_batch_size);
+      // Always read at least one entry, so that reaching the end of the
+      // ledger completes recovery even if there is nothing left to replay
+      recovery_reader.start(
+        last_recovered_idx + 1, std::max(recovery_v, last_recovered_idx + 1));
     }
 
     // NOLINTNEXTLINE(readability-function-cognitive-complexity)
@@ -3552,13 +3612,22 @@ namespace ccf
         throw std::logic_error("History already initialised");
       }
 
-      history = std::make_shared<MerkleTxHistory>(
+      auto merkle_history = std::make_shared<MerkleTxHistory>(
         *network.tables,
         self,
         *node_sign_kp,
         sig_tx_interval,
         sig_ms_interval,
         false /* start timed signatures after first tx */);
+      merkle_history->set_receipt_window(
+        config.ledger_signatures.receipt_window_tx_count);
+      merkle_history->set_signing_job_board(&ccf::tasks::get_main_job_board());
+      if (signature_cache != nullptr)
+      {
+        signature_cache->set_history(merkle_history);
+      }
+
+      history = merkle_history;
       network.tables->set_history(history);
     }
 
@@ -3767,7 +3836,11 @@ namespace ccf
     void ledger_truncate(::consensus::Index idx, bool recovery_mode = false)
     {
       RINGBUFFER_WRITE_MESSAGE(
-        ::consensus::ledger_truncate, to_host, idx, recovery_mode);
+        ::consensus::ledger_truncate,
+        to_host,
+        idx,
+        recovery_mode,
+        ::consensus::TruncationId(0));
     }
 
   public:
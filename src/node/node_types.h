@@ -137,6 +137,12 @@ namespace ccf
     /// produce an equivalent node_inbound on the receiving node)
     DEFINE_RINGBUFFER_MSG_TYPE(node_outbound),
 
+    /// Send data to another node, where the serialised (msg_type, from_id,
+    /// payload) have been deposited in the circuit's BufferHandoff rather than
+    /// written to the ringbuffer. Enclave -> Host
+    /// Args are (to_id, handle)
+    DEFINE_RINGBUFFER_MSG_TYPE(node_outbound_shared),
+
     /// Close connection to another node. Enclave -> Host
     DEFINE_RINGBUFFER_MSG_TYPE(close_node_outbound)
   };
@@ -155,5 +161,9 @@ DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
   ccf::NodeMsgType,
   ccf::NodeId::Value,
   serializer::ByteRange);
+DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
+  ccf::node_outbound_shared,
+  ccf::NodeId::Value,
+  ringbuffer::BufferHandoff::Handle);
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
   ccf::close_node_outbound, ccf::NodeId::Value);
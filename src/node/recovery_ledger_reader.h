@@ -0,0 +1,280 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "consensus/ledger_enclave_types.h"
+#include "ds/internal_logger.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace ccf
+{
+  // Issues the ledger reads made by a node replaying the ledger during
+  // recovery. Several reads are kept in flight, so that the host reads (and
+  // transfers) later batches while earlier ones are being applied. The host
+  // may answer reads out of order, so results are buffered and released
+  // strictly in seqno order. The size of each read adapts: it grows while the
+  // host returns complete batches, and shrinks to what the host returned when
+  // a batch is truncated (eg - to fit in a single ringbuffer message).
+  class RecoveryLedgerReader
+  {
+  public:
+    using Index = ::consensus::Index;
+    using ReadFn = std::function<void(Index from, Index to)>;
+
+    struct Batch
+    {
+      Index from;
+      Index to;
+      // Empty if the ledger has no entry at from, ie - its end was reached
+      std::vector<uint8_t> entries;
+    };
+
+  private:
+    ReadFn read;
+    const size_t max_reads_in_flight;
+    const size_t min_batch_size;
+    const size_t max_batch_size;
+    size_t batch_size;
+
+    bool active = false;
+    Index next_to_release = 0;
+    Index next_to_read = 0;
+    std::optional<Index> last_idx = std::nullopt;
+    std::optional<Index> end_idx = std::nullopt;
+
+    struct Read
+    {
+      Index to;
+      // Issued before the most recent stop(), so its result is discarded
+      bool stale;
+    };
+    std::map<Index, Read> in_flight;
+    std::map<Index, Batch> received;
+    // Ranges (from -> to) which were requested but not returned by the host,
+    // and which are read again before any later seqnos
+    std::map<Index, Index> unread;
+
+    bool has_stale_reads() const
+    {
+      return std::any_of(in_flight.begin(), in_flight.end(), [](const auto& r) {
+        return r.second.stale;
+      });
+    }
+
+    void issue_read(Index from, Index to)
+    {
+      in_flight.insert_or_assign(from, Read{to, false});
+      read(from, to);
+    }
+
+    void issue_reads()
+    {
+      // Reads from a previous replay may cover the same seqnos, so new reads
+      // are only issued once those have all been answered
+      if (!active || has_stale_reads())
+      {
+        return;
+      }
+
+      while (in_flight.size() < max_reads_in_flight)
+      {
+        if (!unread.empty())
+        {
+          auto [from, to] = *unread.begin();
+          unread.erase(unread.begin());
+          if (end_idx.has_value() && from >= end_idx.value())
+          {
+            continue;
+          }
+
+          const auto read_to = std::min<Index>(to, from + batch_size - 1);
+          if (read_to < to)
+          {
+            unread.emplace(read_to + 1, to);
+          }
+          issue_read(from, read_to);
+          continue;
+        }
+
+        if (end_idx.has_value() && next_to_read >= end_idx.value())
+        {
+          return;
+        }
+
+        auto to = next_to_read + batch_size - 1;
+        if (last_idx.has_value())
+        {
+          if (next_to_read > last_idx.value())
+          {
+            return;
+          }
+          to = std::min(to, last_idx.value());
+        }
+
+        issue_read(next_to_read, to);
+        next_to_read = to + 1;
+      }
+    }
+
+    std::optional<Read> take_read(Index from)
+    {
+      auto it = in_flight.find(from);
+      if (it == in_flight.end())
+      {
+        LOG_DEBUG_FMT("Ignoring unexpected recovery ledger read at {}", from);
+        return std::nullopt;
+      }
+
+      auto r = it->second;
+      in_flight.erase(it);
+
+      if (r.stale)
+      {
+        // Now that this is answered, reads for a current replay may proceed
+        issue_reads();
+        return std::nullopt;
+      }
+
+      return r;
+    }
+
+  public:
+    RecoveryLedgerReader(
+      ReadFn read_,
+      size_t max_reads_in_flight_,
+      size_t min_batch_size_,
+      size_t max_batch_size_) :
+      read(std::move(read_)),
+      max_reads_in_flight(std::max<size_t>(max_reads_in_flight_, 1)),
+      min_batch_size(std::max<size_t>(min_batch_size_, 1)),
+      max_batch_size(std::max(max_batch_size_, min_batch_size)),
+      batch_size(min_batch_size)
+    {}
+
+    // Starts replaying from the given seqno, reading up to (and including)
+    // last if it is specified, or otherwise until the end of the ledger
+    void start(Index from, std::optional<Index> last = std::nullopt)
+    {
+      stop();
+
+      active = true;
+      next_to_release = from;
+      next_to_read = from;
+      last_idx = last;
+      end_idx = std::nullopt;
+      batch_size = min_batch_size;
+
+      issue_reads();
+    }
+
+    // Discards all buffered results. Results for reads which are still in
+    // flight will be discarded when they arrive.
+    void stop()
+    {
+      active = false;
+      received.clear();
+      unread.clear();
+      for (auto& [_, r] : in_flight)
+      {
+        r.stale = true;
+      }
+    }
+
+    [[nodiscard]] bool is_active() const
+    {
+      return active;
+    }
+
+    void add_entries(Index from, Index to, std::vector<uint8_t>&& entries)
+    {
+      if (entries.empty() || to < from)
+      {
+        add_no_entries(from);
+        return;
+      }
+
+      const auto r = take_read(from);
+      if (!r.has_value())
+      {
+        return;
+      }
+
+      const auto requested_to = r->to;
+      to = std::min(to, requested_to);
+
+      if (to < requested_to)
+      {
+        // The host returned fewer entries than requested, so fetch the rest
+        // (in place of this read) and make subsequent reads the size the host
+        // is willing to return
+        batch_size = std::max<size_t>(to - from + 1, min_batch_size);
+        unread.emplace(to + 1, requested_to);
+      }
+      else
+      {
+        batch_size = std::min(batch_size * 2, max_batch_size);
+      }
+
+      received.insert_or_assign(from, Batch{from, to, std::move(entries)});
+
+      if (to < requested_to)
+      {
+        issue_reads();
+      }
+    }
+
+    void add_no_entries(Index from)
+    {
+      if (!take_read(from).has_value())
+      {
+        return;
+      }
+
+      // The ledger ends before this seqno, so don't read past it
+      if (!end_idx.has_value() || from < end_idx.value())
+      {
+        end_idx = from;
+      }
+
+      received.insert_or_assign(from, Batch{from, from, {}});
+    }
+
+    // Returns the next batch of entries in seqno order, if it has arrived.
+    // Returns an empty batch once the end of the ledger is reached, after
+    // which this reader is stopped.
+    std::optional<Batch> next_batch()
+    {
+      if (!active)
+      {
+        return std::nullopt;
+      }
+
+      auto it = received.find(next_to_release);
+      if (it == received.end())
+      {
+        return std::nullopt;
+      }
+
+      auto batch = std::move(it->second);
+      received.erase(it);
+
+      if (batch.entries.empty())
+      {
+        stop();
+        return batch;
+      }
+
+      next_to_release = batch.to + 1;
+
+      // Keep the pipeline full before the caller applies this batch
+      issue_reads();
+
+      return batch;
+    }
+  };
+}
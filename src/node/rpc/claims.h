@@ -3,8 +3,12 @@
 #pragma once
 
 #include "ccf/claims_digest.h"
+#include "crypto/sha256_multibuffer.h"
 #include "ds/internal_logger.h"
 
+#include <span>
+#include <vector>
+
 namespace ccf
 {
   static ClaimsDigest no_claims()
@@ -12,12 +16,21 @@ namespace ccf
     return {};
   }
 
+  // Digests from which the Merkle tree leaf of a ledger entry is computed
+  struct EntryLeafComponents
+  {
+    ccf::crypto::Sha256Hash write_set_digest;
+    std::optional<ccf::crypto::Sha256Hash> commit_evidence_digest =
+      std::nullopt;
+    ClaimsDigest claims_digest = no_claims();
+  };
+
   static ccf::crypto::Sha256Hash entry_leaf(
-    const std::vector<uint8_t>& write_set,
-    const std::optional<ccf::crypto::Sha256Hash>& commit_evidence_digest,
-    const ClaimsDigest& claims_digest)
+    const EntryLeafComponents& components)
   {
-    ccf::crypto::Sha256Hash write_set_digest(write_set);
+    const auto& write_set_digest = components.write_set_digest;
+    const auto& commit_evidence_digest = components.commit_evidence_digest;
+    const auto& claims_digest = components.claims_digest;
 
     if (commit_evidence_digest.has_value())
     {
@@ -37,4 +50,59 @@ namespace ccf
     }
     return {write_set_digest, claims_digest.value()};
   }
-}
\ No newline at end of file
+
+  // Equivalent to calling entry_leaf() on each of components, but hashes the
+  // leaves together
+  static std::vector<ccf::crypto::Sha256Hash> entry_leaves(
+    std::span<const EntryLeafComponents> components)
+  {
+    std::vector<ccf::crypto::Sha256Hash> leaves(components.size());
+    std::vector<std::vector<uint8_t>> contents;
+    std::vector<size_t> hashed_indices;
+    for (size_t i = 0; i < components.size(); ++i)
+    {
+      const auto& [write_set_digest, commit_evidence_digest, claims_digest] =
+        components[i];
+      if (!commit_evidence_digest.has_value() && claims_digest.empty())
+      {
+        leaves[i] = write_set_digest;
+        continue;
+      }
+
+      auto& content = contents.emplace_back(
+        write_set_digest.h.begin(), write_set_digest.h.end());
+      if (commit_evidence_digest.has_value())
+      {
+        const auto& h = commit_evidence_digest->h;
+        content.insert(content.end(), h.begin(), h.end());
+      }
+      if (!claims_digest.empty())
+      {
+        const auto& h = claims_digest.value().h;
+        content.insert(content.end(), h.begin(), h.end());
+      }
+      hashed_indices.push_back(i);
+    }
+
+    std::vector<std::span<const uint8_t>> messages(
+      contents.begin(), contents.end());
+    std::vector<ccf::crypto::Sha256Hash> digests(messages.size());
+    ccf::crypto::sha256_many(messages, digests);
+    for (size_t i = 0; i < hashed_indices.size(); ++i)
+    {
+      leaves[hashed_indices[i]] = digests[i];
+    }
+    return leaves;
+  }
+
+  static ccf::crypto::Sha256Hash entry_leaf(
+    const std::vector<uint8_t>& write_set,
+    const std::optional<ccf::crypto::Sha256Hash>& commit_evidence_digest,
+    const ClaimsDigest& claims_digest)
+  {
+    return entry_leaf(EntryLeafComponents{
+      ccf::crypto::Sha256Hash(write_set),
+      commit_evidence_digest,
+      claims_digest});
+  }
+}
@@ -7,26 +7,63 @@
 #include "ccf/crypto/hash_provider.h"
 #include "ccf/http_etag.h"
 #include "ccf/service/tables/nodes.h"
+#include "crypto/openssl/hash.h"
+#include "ds/file_range.h"
 #include "http/http_digest.h"
 #include "node/rpc/ledger_subsystem.h"
+#include "node/rpc_context_impl.h"
 #include "snapshots/filenames.h"
 
 namespace ccf::node
 {
-  // Compute and format the Repr-Digest header value for the given algorithm
-  // and data.
+  // Format the Repr-Digest header value for the given algorithm and digest.
   static std::string format_repr_digest(
-    const std::string& algo_name,
-    ccf::crypto::MDType md,
-    const uint8_t* data,
-    size_t size)
+    const std::string& algo_name, const ccf::crypto::HashBytes& digest)
   {
-    auto hp = ccf::crypto::make_hash_provider();
-    auto digest = hp->hash(data, size, md);
     auto b64 = ccf::crypto::b64_from_raw(digest.data(), digest.size());
     return fmt::format("{}=:{}:", algo_name, b64);
   }
 
+  // Compute digests of a range of a file under each of the given algorithms,
+  // in a single pass over bounded chunks of the file. Returns nullopt if the
+  // range could not be read.
+  static std::optional<std::vector<ccf::crypto::HashBytes>> hash_file_range(
+    const ccf::ds::FileRange& range,
+    const std::vector<ccf::crypto::MDType>& mds)
+  {
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    std::vector<ccf::crypto::OpenSSL::Unique_EVP_MD_CTX> md_ctxs(mds.size());
+    for (size_t i = 0; i < mds.size(); ++i)
+    {
+      ccf::crypto::OpenSSL::CHECK1(EVP_DigestInit_ex(
+        md_ctxs[i], ccf::crypto::OpenSSL::get_md_type(mds[i]), nullptr));
+    }
+
+    const auto read =
+      range.read_chunks(chunk_size, [&](std::span<const uint8_t> chunk) {
+        for (auto& md_ctx : md_ctxs)
+        {
+          ccf::crypto::OpenSSL::CHECK1(
+            EVP_DigestUpdate(md_ctx, chunk.data(), chunk.size()));
+        }
+      });
+    if (!read)
+    {
+      return std::nullopt;
+    }
+
+    std::vector<ccf::crypto::HashBytes> digests;
+    for (auto& md_ctx : md_ctxs)
+    {
+      ccf::crypto::HashBytes digest(EVP_MD_CTX_get_size(md_ctx));
+      ccf::crypto::OpenSSL::CHECK1(
+        EVP_DigestFinal_ex(md_ctx, digest.data(), nullptr));
+      digests.push_back(std::move(digest));
+    }
+    return digests;
+  }
+
   // Helper function to lookup redirect address based on the interface on this
   // node which received the request. Will either return an address, or
   // populate an appropriate error on the response context.
@@ -152,7 +189,10 @@ namespace ccf::node
 
   // Helper function to serve byte ranges from a file stream.
   // This populates the response body, and range-related response headers. This
-  // may produce an error response if an invalid range was requested.
+  // may produce an error response if an invalid range was requested. The file
+  // is only read in bounded chunks, and where the session supports it the
+  // body is streamed from the file as it is sent, rather than read into
+  // memory here.
   //
   // If the request contains a Want-Repr-Digest header, the Repr-Digest
   // response header is set with the digest of the full file (RFC 9530),
@@ -171,10 +211,11 @@ namespace ccf::node
   // function.
   // NOLINTNEXTLINE(readability-function-cognitive-complexity)
   static void fill_range_response_from_file(
-    ccf::endpoints::CommandEndpointContext& ctx, std::ifstream& f)
+    ccf::endpoints::CommandEndpointContext& ctx,
+    const std::shared_ptr<std::ifstream>& f)
   {
-    f.seekg(0, std::ifstream::end);
-    const auto total_size = (size_t)f.tellg();
+    f->seekg(0, std::ifstream::end);
+    const auto total_size = (size_t)f->tellg();
 
     if (total_size == 0)
     {
@@ -372,60 +413,67 @@ namespace ccf::node
       range_start,
       range_end);
 
-    // Read file contents. We need the range content for the response body
-    // (GET) or to compute ETag/Repr-Digest (both GET and HEAD).
-    // If Repr-Digest is requested, read the full file; otherwise read
-    // only the requested range.
-    std::vector<uint8_t> contents;
+    // The file is read in bounded chunks, to compute digests here and to send
+    // the response body later, rather than being held in memory
+    const ccf::ds::FileRange range{f, range_start, range_size};
+    const bool range_is_file = range_start == 0 && range_end == total_size;
+
+    // The ETag is a SHA-256 digest of the response content. If-None-Match may
+    // also match its SHA-384 or SHA-512 digests, so when present these are
+    // computed in the same pass over the file, as is the Repr-Digest if the
+    // range covers the whole file.
+    const auto if_none_match =
+      ctx.rpc_ctx->get_request_header(ccf::http::headers::IF_NONE_MATCH);
+    std::vector<ccf::crypto::MDType> mds = {ccf::crypto::MDType::SHA256};
+    if (if_none_match.has_value())
+    {
+      mds.push_back(ccf::crypto::MDType::SHA384);
+      mds.push_back(ccf::crypto::MDType::SHA512);
+    }
+    if (digest_algo.has_value() && range_is_file)
+    {
+      mds.push_back(digest_algo->second);
+    }
+
+    const auto digests = hash_file_range(range, mds);
+    if (!digests.has_value())
+    {
+      ctx.rpc_ctx->set_error(
+        HTTP_STATUS_INTERNAL_SERVER_ERROR,
+        ccf::errors::InternalError,
+        "Server was unable to read the file correctly");
+      return;
+    }
+
     if (digest_algo.has_value())
     {
-      // Need full file contents for the digest
-      f.seekg(0);
-      std::vector<uint8_t> full_contents(total_size);
-      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-      f.read(reinterpret_cast<char*>(full_contents.data()), total_size);
-      f.close();
-
-      auto bytes_read = static_cast<size_t>(f.gcount());
-      if (bytes_read < range_end)
+      std::optional<ccf::crypto::HashBytes> repr_digest = std::nullopt;
+      if (range_is_file)
       {
-        ctx.rpc_ctx->set_error(
-          HTTP_STATUS_INTERNAL_SERVER_ERROR,
-          ccf::errors::InternalError,
-          "Server was unable to read the file correctly");
-        return;
+        repr_digest = digests->back();
       }
-
-      if (bytes_read == total_size)
+      else
       {
-        ctx.rpc_ctx->set_response_header(
-          ccf::http::headers::REPR_DIGEST,
-          format_repr_digest(
-            digest_algo->first,
-            digest_algo->second,
-            full_contents.data(),
-            full_contents.size()));
+        const auto file_digests =
+          hash_file_range({f, 0, total_size}, {digest_algo->second});
+        if (!file_digests.has_value())
+        {
+          ctx.rpc_ctx->set_error(
+            HTTP_STATUS_INTERNAL_SERVER_ERROR,
+            ccf::errors::InternalError,
+            "Server was unable to read the file correctly");
+          return;
+        }
+        repr_digest = file_digests->front();
       }
 
-      // Extract the requested range
-      contents.assign(
-        full_contents.begin() + range_start, full_contents.begin() + range_end);
-    }
-    else
-    {
-      // Read only the requested range
-      contents.resize(range_size);
-      f.seekg(range_start);
-      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-      f.read(reinterpret_cast<char*>(contents.data()), contents.size());
-      f.close();
+      ctx.rpc_ctx->set_response_header(
+        ccf::http::headers::REPR_DIGEST,
+        format_repr_digest(digest_algo->first, repr_digest.value()));
     }
 
-    // Compute ETag over the response content (RFC 9530 structured field
-    // format)
-    auto hash_provider = ccf::crypto::make_hash_provider();
-    auto sha256_hash = hash_provider->hash(
-      contents.data(), contents.size(), ccf::crypto::MDType::SHA256);
+    // ETag over the response content (RFC 9530 structured field format)
+    const auto& sha256_hash = digests->at(0);
     auto sha256_b64 =
       ccf::crypto::b64_from_raw(sha256_hash.data(), sha256_hash.size());
     auto sha256_etag = fmt::format("sha-256=:{}:", sha256_b64);
@@ -434,8 +482,6 @@ namespace ccf::node
       ccf::http::headers::ETAG, fmt::format("\"{}\"", sha256_etag));
 
     // Check If-None-Match header
-    const auto if_none_match =
-      ctx.rpc_ctx->get_request_header(ccf::http::headers::IF_NONE_MATCH);
     if (if_none_match.has_value())
     {
       try
@@ -446,8 +492,7 @@ namespace ccf::node
 
         if (!matched)
         {
-          auto sha384_hash = hash_provider->hash(
-            contents.data(), contents.size(), ccf::crypto::MDType::SHA384);
+          const auto& sha384_hash = digests->at(1);
           auto sha384_b64 =
             ccf::crypto::b64_from_raw(sha384_hash.data(), sha384_hash.size());
           matched = matcher.matches(fmt::format("sha-384=:{}:", sha384_b64));
@@ -455,8 +500,7 @@ namespace ccf::node
 
         if (!matched)
         {
-          auto sha512_hash = hash_provider->hash(
-            contents.data(), contents.size(), ccf::crypto::MDType::SHA512);
+          const auto& sha512_hash = digests->at(2);
           auto sha512_b64 =
             ccf::crypto::b64_from_raw(sha512_hash.data(), sha512_hash.size());
           matched = matcher.matches(fmt::format("sha-512=:{}:", sha512_b64));
@@ -511,7 +555,25 @@ namespace ccf::node
     }
     else
     {
-      ctx.rpc_ctx->set_response_body(std::move(contents));
+      auto* rpc_ctx_impl =
+        dynamic_cast<ccf::RpcContextImpl*>(ctx.rpc_ctx.get());
+      if (rpc_ctx_impl != nullptr)
+      {
+        rpc_ctx_impl->set_response_body_from_file(ccf::ds::FileRange(range));
+      }
+      else
+      {
+        auto contents = range.read_all();
+        if (!contents.has_value())
+        {
+          ctx.rpc_ctx->set_error(
+            HTTP_STATUS_INTERNAL_SERVER_ERROR,
+            ccf::errors::InternalError,
+            "Server was unable to read the file correctly");
+          return;
+        }
+        ctx.rpc_ctx->set_response_body(std::move(contents.value()));
+      }
     }
   }
 
@@ -873,8 +935,8 @@ namespace ccf::node
       files::fs::path snapshot_path =
         files::fs::path(snapshots_config.directory) / snapshot_name;
 
-      std::ifstream f(snapshot_path, std::ios::binary);
-      if (!f.good())
+      auto f = std::make_shared<std::ifstream>(snapshot_path, std::ios::binary);
+      if (!f->good())
       {
         ctx.rpc_ctx->set_error(
           HTTP_STATUS_NOT_FOUND,
@@ -954,8 +1016,8 @@ namespace ccf::node
       files::fs::path chunk_path =
         files::fs::path(ledger_config.directory) / chunk_name;
 
-      std::ifstream f(chunk_path, std::ios::binary);
-      if (!f.good())
+      auto f = std::make_shared<std::ifstream>(chunk_path, std::ios::binary);
+      if (!f->good())
       {
         ctx.rpc_ctx->set_error(
           HTTP_STATUS_NOT_FOUND,
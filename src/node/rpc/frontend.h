@@ -23,11 +23,14 @@
 #include "node/endpoint_context_impl.h"
 #include "node/node_configuration_subsystem.h"
 #include "service/internal_tables_access.h"
+#include "tasks/basic_task.h"
+#include "tasks/task_system.h"
 
 #define FMT_HEADER_ONLY
 
 #include <atomic>
 #include <fmt/format.h>
+#include <map>
 #include <utility>
 #include <vector>
 
@@ -55,6 +58,34 @@ namespace ccf
     std::shared_ptr<NodeConfigurationInterface> node_configuration_subsystem =
       nullptr;
 
+    // A request to an endpoint with a ReadOnlyBatchingPolicy, waiting to be
+    // executed as part of a batch
+    struct BatchedRequest
+    {
+      std::shared_ptr<ccf::RpcContextImpl> ctx;
+      endpoints::EndpointDefinitionPtr endpoint;
+      std::chrono::high_resolution_clock::time_point start_time;
+
+      // Set if the request could not be completed within the batch, and
+      // should instead be executed individually
+      bool retry = false;
+    };
+
+    struct ReadOnlyBatch
+    {
+      std::string key;
+      std::vector<BatchedRequest> requests;
+      // Set once the batch is closed to new requests, to be executed
+      bool closed = false;
+    };
+
+    // Protects open_batches, and the contents of any batch which is still
+    // open. Each batched endpoint has at most one open batch, which is
+    // executed once it is full, or by a task once its window has elapsed.
+    // No thread waits for a batch: its requests' responses are deferred.
+    ccf::pal::Mutex batch_lock;
+    std::map<std::string, std::shared_ptr<ReadOnlyBatch>> open_batches;
+
     endpoints::EndpointDefinitionPtr find_endpoint(
       std::shared_ptr<ccf::RpcContextImpl> ctx, ccf::kv::CommittableTx& tx)
     {
@@ -605,15 +636,182 @@ namespace ccf
       ctx->get_session_context()->is_forwarding = true;
     }
 
-    void process_command(std::shared_ptr<ccf::RpcContextImpl> ctx)
+    void execute_locally_committed(
+      std::shared_ptr<ccf::RpcContextImpl> ctx,
+      const endpoints::EndpointDefinitionPtr& endpoint,
+      endpoints::CommandEndpointContext& args,
+      const ccf::TxID& tx_id)
     {
-      size_t attempts = 0;
-      endpoints::EndpointDefinitionPtr endpoint = nullptr;
+      try
+      {
+        endpoints.execute_endpoint_locally_committed(endpoint, args, tx_id);
+      }
+      catch (const std::exception& e)
+      {
+        // run default handler to set transaction id in header
+        ctx->clear_response_headers();
+        ccf::endpoints::default_locally_committed_func(args, tx_id);
+        ctx->set_error(
+          HTTP_STATUS_INTERNAL_SERVER_ERROR,
+          ccf::errors::InternalError,
+          fmt::format(
+            "Failed to execute local commit handler func: {}", e.what()));
+      }
+      catch (...)
+      {
+        // run default handler to set transaction id in header
+        ctx->clear_response_headers();
+        ccf::endpoints::default_locally_committed_func(args, tx_id);
+        ctx->set_error(
+          HTTP_STATUS_INTERNAL_SERVER_ERROR,
+          ccf::errors::InternalError,
+          "Failed to execute local commit handler func");
+      }
+    }
 
-      const auto start_time = std::chrono::high_resolution_clock::now();
+    // Executes every request in the batch against a single transaction, which
+    // must not be written to. Requests which cannot be completed here are
+    // marked for retry.
+    // NOLINTNEXTLINE(readability-function-cognitive-complexity)
+    void execute_batch(
+      std::vector<BatchedRequest>& requests,
+      ccf::kv::Consensus* current_consensus)
+    {
+      auto retry_all = [&requests]() {
+        for (auto& request : requests)
+        {
+          request.retry = true;
+        }
+      };
+
+      std::unique_ptr<ccf::kv::CommittableTx> tx_p =
+        tables.create_read_only_committable_tx_ptr();
+      auto& tx = *tx_p;
+
+      // Kept until the transaction is committed, to be passed to locally
+      // committed functions. Null for requests which did not succeed.
+      std::vector<std::unique_ptr<endpoints::EndpointContext>> completed(
+        requests.size());
+
+      for (size_t i = 0; i < requests.size(); ++i)
+      {
+        const auto& ctx = requests[i].ctx;
+        const auto& endpoint = requests[i].endpoint;
+        try
+        {
+          std::unique_ptr<AuthnIdentity> identity =
+            get_authenticated_identity(ctx, tx, endpoint);
+          if (!endpoint->authn_policies.empty() && identity == nullptr)
+          {
+            continue;
+          }
+
+          auto args = std::make_unique<endpoints::EndpointContext>(ctx, tx);
+          args->caller = std::move(identity);
+          endpoints.execute_endpoint(endpoint, *args);
+
+          if (tx.has_writes())
+          {
+            // Other requests may have read, or be about to read, these
+            // writes. Discard them, and execute the rest individually.
+            LOG_FAIL_FMT(
+              "Bad endpoint: {} {} wrote to the KV during batched read-only "
+              "execution",
+              ctx->get_request_verb().c_str(),
+              ctx->get_request_path());
+            retry_all();
+            requests[i].retry = false;
+            ctx->clear_response_headers();
+            ctx->set_error(
+              HTTP_STATUS_INTERNAL_SERVER_ERROR,
+              ccf::errors::InternalError,
+              "Illegal endpoint implementation");
+            return;
+          }
 
-      process_command_inner(ctx, endpoint, attempts);
+          if (
+            !check_session_consistency(ctx, current_consensus) ||
+            !ctx->should_apply_writes() || ctx->response_is_pending)
+          {
+            continue;
+          }
+
+          completed[i] = std::move(args);
+        }
+        catch (const ccf::kv::CompactedVersionConflict& e)
+        {
+          LOG_DEBUG_FMT(
+            "Batched execution conflicted with compaction: {}", e.what());
+          retry_all();
+          return;
+        }
+        catch (RpcException& e)
+        {
+          ctx->clear_response_headers();
+          ctx->set_error(std::move(e.error));
+        }
+        catch (const ccf::JsonParseError& e)
+        {
+          ctx->clear_response_headers();
+          ctx->set_error(
+            HTTP_STATUS_BAD_REQUEST, ccf::errors::InvalidInput, e.describe());
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+          ctx->clear_response_headers();
+          ctx->set_error(
+            HTTP_STATUS_BAD_REQUEST, ccf::errors::InvalidInput, e.what());
+        }
+        catch (const std::exception& e)
+        {
+          ctx->clear_response_headers();
+          ctx->set_error(
+            HTTP_STATUS_INTERNAL_SERVER_ERROR,
+            ccf::errors::InternalError,
+            e.what());
+        }
+      }
+
+      if (tx.commit() != ccf::kv::CommitResult::SUCCESS)
+      {
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+          requests[i].retry = completed[i] != nullptr;
+        }
+        return;
+      }
+
+      const auto tx_id = tx.get_txid();
+      if (!tx_id.has_value() || current_consensus == nullptr)
+      {
+        return;
+      }
+
+      for (size_t i = 0; i < requests.size(); ++i)
+      {
+        if (completed[i] == nullptr)
+        {
+          continue;
+        }
+
+        const auto& ctx = requests[i].ctx;
+        execute_locally_committed(
+          ctx, requests[i].endpoint, *completed[i], tx_id.value());
+
+        if (ctx->consensus_committed_func != nullptr)
+        {
+          ctx->respond_on_commit = ccf::RpcContextImpl::RespondOnCommitInfo{
+            tx_id.value(), ctx->consensus_committed_func, {}, {}, ctx->claims};
+        }
+      }
+    }
 
+    void record_request_completed(
+      const std::shared_ptr<ccf::RpcContextImpl>& ctx,
+      const endpoints::EndpointDefinitionPtr& endpoint,
+      size_t attempts,
+      std::chrono::high_resolution_clock::time_point start_time)
+    {
       const auto end_time = std::chrono::high_resolution_clock::now();
 
       if (endpoint != nullptr)
@@ -642,6 +840,180 @@ namespace ccf
       }
     }
 
+    // Executes a batch which has been closed, then completes the deferred
+    // response of each request in it
+    void complete_batch(ReadOnlyBatch& batch)
+    {
+      auto& requests = batch.requests;
+
+      // No longer pending on the batch, though a handler may mark its own
+      // response as pending again
+      for (auto& request : requests)
+      {
+        request.ctx->response_is_pending = false;
+      }
+
+      try
+      {
+        execute_batch(requests, consensus.load(std::memory_order_acquire));
+      }
+      catch (const std::exception& e)
+      {
+        LOG_FAIL_FMT("Failed to execute batch of requests: {}", e.what());
+        for (auto& request : requests)
+        {
+          request.retry = true;
+        }
+      }
+      catch (...)
+      {
+        LOG_FAIL_FMT("Failed to execute batch of requests");
+        for (auto& request : requests)
+        {
+          request.retry = false;
+          request.ctx->clear_response_headers();
+          request.ctx->set_error(
+            HTTP_STATUS_INTERNAL_SERVER_ERROR,
+            ccf::errors::InternalError,
+            "Failed to execute batch of requests");
+        }
+      }
+
+      for (auto& [ctx, endpoint, start_time, retry] : requests)
+      {
+        size_t attempts = 1;
+        if (retry)
+        {
+          // As if it had not been batched
+          auto retried_endpoint = endpoint;
+          try
+          {
+            process_command_inner(ctx, retried_endpoint, attempts, false);
+          }
+          catch (...)
+          {
+            ctx->clear_response_headers();
+            ctx->set_error(
+              HTTP_STATUS_INTERNAL_SERVER_ERROR,
+              ccf::errors::InternalError,
+              "Failed to execute request");
+          }
+        }
+
+        record_request_completed(ctx, endpoint, attempts, start_time);
+        ctx->deferred_response->complete();
+      }
+    }
+
+    // Adds the request to its endpoint's open batch, or opens a new one, and
+    // returns without waiting for the batch to execute. The response is
+    // completed later, through ctx->deferred_response. Returns false if the
+    // request cannot be batched, and should be executed individually.
+    bool process_batched(
+      const std::shared_ptr<ccf::RpcContextImpl>& ctx,
+      const endpoints::EndpointDefinitionPtr& endpoint)
+    {
+      if (
+        !ctx->can_defer_response || ctx->get_session_context()->is_forwarded)
+      {
+        return false;
+      }
+
+      // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+      const auto& policy = *endpoint->read_only_batching;
+      const auto max_size = std::max<size_t>(policy.max_batch_size, 1);
+
+      std::shared_ptr<ReadOnlyBatch> full_batch = nullptr;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(batch_lock);
+        const auto key = endpoint->dispatch.to_str();
+        auto& batch = open_batches[key];
+        if (batch == nullptr)
+        {
+          batch = std::make_shared<ReadOnlyBatch>();
+          batch->key = key;
+          schedule_batch(batch, policy.window);
+        }
+
+        ctx->response_is_pending = true;
+        ctx->deferred_response = std::make_shared<DeferredResponse>();
+        batch->requests.push_back(
+          {ctx, endpoint, std::chrono::high_resolution_clock::now()});
+
+        if (batch->requests.size() >= max_size)
+        {
+          batch->closed = true;
+          full_batch = std::move(batch);
+          open_batches.erase(key);
+        }
+      }
+
+      // Executed now, rather than waiting for its window to elapse
+      if (full_batch != nullptr)
+      {
+        complete_batch(*full_batch);
+      }
+
+      return true;
+    }
+
+    // Must be called with batch_lock held
+    void schedule_batch(
+      const std::shared_ptr<ReadOnlyBatch>& batch,
+      std::chrono::milliseconds window)
+    {
+      // If the batch fills first, or the frontend is destroyed, this finds
+      // it closed or gone
+      auto task = ccf::tasks::make_basic_task(
+        [this, weak_batch = std::weak_ptr<ReadOnlyBatch>(batch)]() {
+          auto batch = weak_batch.lock();
+          if (batch == nullptr)
+          {
+            return;
+          }
+
+          {
+            std::lock_guard<ccf::pal::Mutex> guard(batch_lock);
+            if (batch->closed)
+            {
+              return;
+            }
+            batch->closed = true;
+            open_batches.erase(batch->key);
+          }
+
+          complete_batch(*batch);
+        },
+        "RpcFrontend::complete_batch");
+
+      if (window.count() == 0)
+      {
+        ccf::tasks::add_task(task);
+      }
+      else
+      {
+        ccf::tasks::add_delayed_task(task, window);
+      }
+    }
+
+    void process_command(std::shared_ptr<ccf::RpcContextImpl> ctx)
+    {
+      size_t attempts = 0;
+      endpoints::EndpointDefinitionPtr endpoint = nullptr;
+
+      const auto start_time = std::chrono::high_resolution_clock::now();
+
+      process_command_inner(ctx, endpoint, attempts, true);
+
+      // A batched request is recorded once its batch completes
+      if (ctx->deferred_response != nullptr)
+      {
+        return;
+      }
+
+      record_request_completed(ctx, endpoint, attempts, start_time);
+    }
+
     void process_command_without_kv(
       std::shared_ptr<ccf::RpcContextImpl> ctx,
       endpoints::EndpointDefinitionPtr& endpoint,
@@ -705,7 +1077,8 @@ namespace ccf
     void process_command_inner(
       std::shared_ptr<ccf::RpcContextImpl> ctx,
       endpoints::EndpointDefinitionPtr& endpoint,
-      size_t& attempts)
+      size_t& attempts,
+      bool allow_batching)
     {
       constexpr auto max_attempts = 30;
       while (attempts < max_attempts)
@@ -762,6 +1135,13 @@ namespace ccf
           return;
         }
 
+        // Read-only endpoints cannot conflict, so execute in a transaction
+        // which does not track its reads
+        if (endpoint->is_read_only() && !endpoints.request_needs_root(*ctx))
+        {
+          tx_p = tables.create_read_only_committable_tx_ptr();
+        }
+
         try
         {
           if (!check_uri_allowed(ctx, endpoint))
@@ -825,6 +1205,15 @@ namespace ccf
             }
           }
 
+          // Batched requests share a transaction with others in their batch,
+          // and are retried individually if that fails
+          if (
+            allow_batching && endpoint->read_only_batching.has_value() &&
+            endpoint->is_read_only() && process_batched(ctx, endpoint))
+          {
+            return;
+          }
+
           std::unique_ptr<AuthnIdentity> identity =
             get_authenticated_identity(ctx, *tx_p, endpoint);
 
@@ -912,37 +1301,11 @@ namespace ccf
               {
                 ccf::TxID tx_id = tx_id_opt.value();
 
-                try
-                {
-                  // Only transactions that acquired one or more map handles
-                  // have a TxID, while others (e.g. unauthenticated commands)
-                  // don't. Also, only report a TxID if the consensus is set, as
-                  // the consensus is required to verify that a TxID is valid.
-                  endpoints.execute_endpoint_locally_committed(
-                    endpoint, args, tx_id);
-                }
-                catch (const std::exception& e)
-                {
-                  // run default handler to set transaction id in header
-                  ctx->clear_response_headers();
-                  ccf::endpoints::default_locally_committed_func(args, tx_id);
-                  ctx->set_error(
-                    HTTP_STATUS_INTERNAL_SERVER_ERROR,
-                    ccf::errors::InternalError,
-                    fmt::format(
-                      "Failed to execute local commit handler func: {}",
-                      e.what()));
-                }
-                catch (...)
-                {
-                  // run default handler to set transaction id in header
-                  ctx->clear_response_headers();
-                  ccf::endpoints::default_locally_committed_func(args, tx_id);
-                  ctx->set_error(
-                    HTTP_STATUS_INTERNAL_SERVER_ERROR,
-                    ccf::errors::InternalError,
-                    "Failed to execute local commit handler func");
-                }
+                // Only transactions that acquired one or more map handles
+                // have a TxID, while others (e.g. unauthenticated commands)
+                // don't. Also, only report a TxID if the consensus is set, as
+                // the consensus is required to verify that a TxID is valid.
+                execute_locally_committed(ctx, endpoint, args, tx_id);
 
                 {
                   if (committed_func != nullptr)
@@ -19,6 +19,7 @@
 #include "ds/files.h"
 #include "ds/std_formatters.h"
 #include "frontend.h"
+#include "indexing/indexer.h"
 #include "node/cose_common.h"
 #include "node/network_state.h"
 #include "node/rpc/file_serving_handlers.h"
@@ -91,10 +92,11 @@ namespace ccf
   struct NodeMetrics
   {
     ccf::SessionMetrics sessions;
+    ccf::indexing::IndexingMetrics indexing;
   };
 
   DECLARE_JSON_TYPE(NodeMetrics);
-  DECLARE_JSON_REQUIRED_FIELDS(NodeMetrics, sessions);
+  DECLARE_JSON_REQUIRED_FIELDS(NodeMetrics, sessions, indexing);
 
   struct GetHistoricalCacheInfo
   {
@@ -444,7 +446,7 @@ namespace ccf
       openapi_info.description =
         "This API provides public, uncredentialed access to service and node "
         "state.";
-      openapi_info.document_version = "5.0.6";
+      openapi_info.document_version = "5.0.7";
     }
 
     // NOLINTNEXTLINE(readability-function-cognitive-complexity)
@@ -1472,6 +1474,11 @@ namespace ccf
       auto node_metrics = [this](auto& args) {
         NodeMetrics nm;
         nm.sessions = node_operation.get_session_metrics();
+        auto indexer = this->context.get_subsystem<indexing::Indexer>();
+        if (indexer != nullptr)
+        {
+          nm.indexing = indexer->get_metrics();
+        }
 
         args.rpc_ctx->set_response_status(HTTP_STATUS_OK);
         args.rpc_ctx->set_response_header(
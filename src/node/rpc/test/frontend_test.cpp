@@ -20,6 +20,7 @@
 #include "node/test/channel_stub.h"
 #include "node_stub.h"
 #include "service/internal_tables_access.h"
+#include "tasks/job_board.h"
 
 #include <doctest/doctest.h>
 #include <iostream>
@@ -230,6 +231,46 @@ public:
   }
 };
 
+class TestReadOnlyBatching : public BaseTestFrontend
+{
+public:
+  static constexpr size_t batch_size = 4;
+
+  ccf::kv::Map<size_t, size_t> values;
+
+  size_t executions = 0;
+
+  TestReadOnlyBatching(ccf::kv::Store& tables) :
+    BaseTestFrontend(tables),
+    values("test_values")
+  {
+    open();
+
+    auto read = [this](ccf::endpoints::ReadOnlyEndpointContext& ctx) {
+      ++executions;
+      auto vs = ctx.tx.ro(values);
+      const auto v = vs->get(0);
+      ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
+      ctx.rpc_ctx->set_response_body(fmt::format(
+        "{} {}", ctx.rpc_ctx->get_request_query(), v.value_or(0)));
+    };
+
+    // The window is long enough that each batch is only executed once full
+    endpoints
+      .make_read_only_endpoint(
+        "/batched_read", HTTP_GET, read, {user_cert_auth_policy})
+      .set_read_only_batching({std::chrono::seconds(10), batch_size})
+      .install();
+
+    // Partial batches are executed as soon as a worker is free
+    endpoints
+      .make_read_only_endpoint(
+        "/batched_read_now", HTTP_GET, read, {user_cert_auth_policy})
+      .set_read_only_batching({std::chrono::milliseconds(0), batch_size})
+      .install();
+  }
+};
+
 class TestTemplatedPaths : public BaseTestFrontend
 {
 public:
@@ -1125,6 +1166,120 @@ TEST_CASE("Alternative endpoints")
   }
 }
 
+TEST_CASE("Read-only batching")
+{
+  NetworkState network;
+  prepare_callers(network);
+  TestReadOnlyBatching frontend(*network.tables);
+  auto consensus = std::make_shared<ccf::kv::test::PrimaryStubConsensus>();
+  frontend.set_consensus_and_history(consensus.get(), nullptr);
+
+  {
+    auto tx = network.tables->create_tx();
+    tx.rw(frontend.values)->put(0, 7);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+
+  auto make_read =
+    [](const std::string& path, size_t i, const auto& session) {
+      auto request = create_simple_request(path);
+      request.set_method(HTTP_GET);
+      request.set_query_param("id", std::to_string(i));
+      auto rpc_ctx = ccf::make_rpc_context(session, request.build_request());
+      rpc_ctx->can_defer_response = true;
+      return rpc_ctx;
+    };
+
+  size_t responded = 0;
+  auto process = [&](const std::shared_ptr<ccf::RpcContextImpl>& rpc_ctx) {
+    frontend.process(rpc_ctx);
+    REQUIRE(rpc_ctx->deferred_response != nullptr);
+    rpc_ctx->deferred_response->on_complete([&responded]() { ++responded; });
+  };
+
+  auto check_read = [](
+                      const std::shared_ptr<ccf::RpcContextImpl>& rpc_ctx,
+                      size_t i) {
+    auto response = parse_response(rpc_ctx->serialise_response());
+    CHECK(response.status == HTTP_STATUS_OK);
+    CHECK(parse_response_body(response) == fmt::format("id={} 7", i));
+    CHECK(response.headers.contains(ccf::http::headers::CCF_TX_ID));
+  };
+
+  {
+    INFO("Requests return without waiting for their batch to fill");
+    std::vector<std::shared_ptr<ccf::RpcContextImpl>> rpc_ctxs;
+    for (size_t i = 0; i < TestReadOnlyBatching::batch_size - 1; ++i)
+    {
+      rpc_ctxs.push_back(make_read("/batched_read", i, user_session));
+      process(rpc_ctxs.back());
+      REQUIRE(rpc_ctxs.back()->response_is_pending);
+    }
+    REQUIRE(responded == 0);
+    REQUIRE(frontend.executions == 0);
+
+    INFO("The request which fills the batch executes it");
+    rpc_ctxs.push_back(make_read("/batched_read", 0, anonymous_session));
+    process(rpc_ctxs.back());
+    REQUIRE(responded == TestReadOnlyBatching::batch_size);
+    REQUIRE(frontend.executions == TestReadOnlyBatching::batch_size - 1);
+
+    INFO("Each request in a batch receives its own response");
+    for (size_t i = 0; i < TestReadOnlyBatching::batch_size - 1; ++i)
+    {
+      REQUIRE_FALSE(rpc_ctxs[i]->response_is_pending);
+      check_read(rpc_ctxs[i], i);
+    }
+
+    auto response = parse_response(rpc_ctxs.back()->serialise_response());
+    CHECK(response.status == HTTP_STATUS_UNAUTHORIZED);
+  }
+
+  {
+    INFO("A partial batch is executed by a task");
+    responded = 0;
+    std::vector<std::shared_ptr<ccf::RpcContextImpl>> rpc_ctxs;
+    for (size_t i = 0; i < 2; ++i)
+    {
+      rpc_ctxs.push_back(make_read("/batched_read_now", i, user_session));
+      process(rpc_ctxs.back());
+    }
+    REQUIRE(responded == 0);
+
+    auto& job_board = ccf::tasks::get_main_job_board();
+    while (auto task = job_board.get_task())
+    {
+      task->do_task();
+    }
+    REQUIRE(responded == rpc_ctxs.size());
+    for (size_t i = 0; i < rpc_ctxs.size(); ++i)
+    {
+      check_read(rpc_ctxs[i], i);
+    }
+  }
+
+  {
+    INFO("Requests which cannot be deferred are executed individually");
+    auto rpc_ctx = make_read("/batched_read", 3, user_session);
+    rpc_ctx->can_defer_response = false;
+    frontend.process(rpc_ctx);
+    REQUIRE(rpc_ctx->deferred_response == nullptr);
+    REQUIRE_FALSE(rpc_ctx->response_is_pending);
+    check_read(rpc_ctx, 3);
+  }
+
+  {
+    INFO("Only read-only endpoints can be batched");
+    auto write = [](ccf::endpoints::EndpointContext& ctx) {
+      ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
+    };
+    REQUIRE_THROWS_AS(
+      frontend.make_endpoint("/batched_write", HTTP_POST, write)
+        .set_read_only_batching({}),
+      std::logic_error);
+  }
+}
+
 TEST_CASE("KV readiness gate")
 {
   NetworkState network;
@@ -4,7 +4,12 @@
 
 #include "ccf/claims_digest.h"
 #include "ccf/endpoint_context.h"
+#include "ccf/pal/locking.h"
 #include "ccf/rpc_context.h"
+#include "ds/file_range.h"
+
+#include <functional>
+#include <mutex>
 
 namespace ccf
 {
@@ -14,6 +19,47 @@ namespace ccf
     HTTP2
   };
 
+  // Hands over a response which is completed after process() returns. The
+  // handler calls complete() once the response is ready, and the session
+  // calls on_complete() with a function which sends it. Whichever is called
+  // second sends the response, on its calling thread.
+  class DeferredResponse
+  {
+    ccf::pal::Mutex lock;
+    bool completed = false;
+    std::function<void()> send = nullptr;
+
+  public:
+    void complete()
+    {
+      std::function<void()> f = nullptr;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        completed = true;
+        f = std::move(send);
+      }
+
+      if (f != nullptr)
+      {
+        f();
+      }
+    }
+
+    void on_complete(std::function<void()> f)
+    {
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        if (!completed)
+        {
+          send = std::move(f);
+          return;
+        }
+      }
+
+      f();
+    }
+  };
+
   // Partial implementation of RpcContext, private to the framework (not visible
   // to apps). Serves 2 purposes:
   // - Default implementation of simple methods accessing member fields
@@ -107,6 +153,19 @@ namespace ccf
         http::headervalues::contenttype::JSON);
     }
 
+    // Sets the response body to a range of an open file. Where the response
+    // can be streamed, the range is only read as it is sent, in bounded
+    // chunks. Otherwise it is read into the response body here.
+    virtual void set_response_body_from_file(ccf::ds::FileRange&& range)
+    {
+      auto contents = range.read_all();
+      if (!contents.has_value())
+      {
+        throw std::runtime_error("Unable to read response body from file");
+      }
+      set_response_body(std::move(contents.value()));
+    }
+
     ccf::endpoints::ConsensusCommittedEndpointFunction
       consensus_committed_func = nullptr;
 
@@ -119,6 +178,12 @@ namespace ccf
     bool response_is_pending = false;
     bool terminate_session = false;
 
+    // Set by sessions which can send a response after process() returns
+    bool can_defer_response = false;
+    // Set by a handler, along with response_is_pending, if it will complete
+    // the response later. Only then may it modify this context again.
+    std::shared_ptr<DeferredResponse> deferred_response = nullptr;
+
     struct RespondOnCommitInfo
     {
       ccf::TxID tx_id;
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ccf/node_subsystem_interface.h"
+#include "ccf/receipt.h"
 #include "ccf/tx_id.h"
 #include "service/tables/signatures.h"
 
@@ -35,6 +36,13 @@ namespace ccf
     [[nodiscard]] virtual std::optional<CachedSignature> get_signature_for(
       ccf::SeqNo seqno) const = 0;
 
+    // Returns a receipt for a committed transaction, produced from a cached
+    // signature and the Merkle tree held in memory, or nullptr if they do not
+    // cover it (eg - because it is too old, or is itself a signature). This
+    // avoids a historical query for recent transactions.
+    [[nodiscard]] virtual TxReceiptImplPtr get_recent_receipt(
+      const ccf::TxID& tx_id) const = 0;
+
     virtual void set_max_cache_size(size_t n) = 0;
   };
 }
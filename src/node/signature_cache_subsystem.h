@@ -2,7 +2,9 @@
 // Licensed under the Apache 2.0 License.
 #pragma once
 
+#include "node/history.h"
 #include "node/signature_cache_interface.h"
+#include "node/tx_receipt_impl.h"
 
 #include <map>
 #include <mutex>
@@ -29,6 +31,7 @@ namespace ccf
 
     std::map<ccf::SeqNo, PendingEntry> cache;
     size_t max_cache_size = DEFAULT_MAX_CACHE_SIZE;
+    std::shared_ptr<MerkleTxHistory> history = nullptr;
     mutable std::mutex cache_mutex;
 
     void evict_oldest()
@@ -95,6 +98,79 @@ namespace ccf
         version};
     }
 
+    [[nodiscard]] TxReceiptImplPtr get_recent_receipt(
+      const ccf::TxID& tx_id) const override
+    {
+      std::shared_ptr<MerkleTxHistory> h = nullptr;
+      std::optional<PrimarySignature> sig = std::nullopt;
+      std::optional<std::vector<uint8_t>> cose_signature = std::nullopt;
+      ccf::SeqNo sig_seqno = 0;
+      {
+        std::lock_guard<std::mutex> guard(cache_mutex);
+
+        // Signatures older than those cached may lie between the transaction
+        // and the first cached signature after it, so only transactions after
+        // the oldest cached signature are known to be covered by the next one
+        if (
+          history == nullptr || cache.empty() ||
+          tx_id.seqno <= cache.begin()->first)
+        {
+          return nullptr;
+        }
+
+        auto it = cache.upper_bound(tx_id.seqno);
+        if (it == cache.end() || std::prev(it)->first == tx_id.seqno)
+        {
+          return nullptr;
+        }
+
+        const auto& [version, entry] = *it;
+        if (!entry.is_complete())
+        {
+          return nullptr;
+        }
+
+        h = history;
+        sig = entry.sig;
+        cose_signature = entry.cose_signature;
+        sig_seqno = version;
+      }
+
+      auto proof = h->get_recent_proof(tx_id, sig_seqno);
+      if (!proof.has_value())
+      {
+        return nullptr;
+      }
+
+      std::optional<std::vector<uint8_t>> raw_sig = std::nullopt;
+      std::optional<ccf::crypto::Pem> cert = std::nullopt;
+      NodeId node{};
+      if (sig.has_value())
+      {
+        raw_sig = sig->sig;
+        cert = sig->cert;
+        node = sig->node;
+      }
+
+      return std::make_shared<TxReceiptImpl>(
+        raw_sig,
+        cose_signature,
+        proof->root,
+        proof->path,
+        node,
+        cert,
+        proof->leaf.write_set_digest,
+        proof->commit_evidence,
+        proof->leaf.claims_digest);
+    }
+
+    // Receipts for recent transactions are produced from this history's tree
+    void set_history(std::shared_ptr<MerkleTxHistory> history_)
+    {
+      std::lock_guard<std::mutex> guard(cache_mutex);
+      history = std::move(history_);
+    }
+
     void on_signature_committed(
       ccf::kv::Version version, const PrimarySignature& sig)
     {
@@ -9,6 +9,7 @@
 #include "crypto/certs.h"
 #include "crypto/openssl/x509_time.h"
 #include "ds/non_blocking.h"
+#include "ds/oversized.h"
 #include "ds/ring_buffer.h"
 #include "node/node_to_node_channel_manager.h"
 #include "node/node_types.h"
@@ -139,10 +140,22 @@ struct NodeOutboundMsg
 };
 
 template <typename T>
-auto read_outbound_msgs(ringbuffer::Circuit& circuit)
+auto read_outbound_msgs(
+  ringbuffer::Circuit& circuit,
+  const ringbuffer::BufferHandoffPtr& buffer_handoff = nullptr)
 {
   std::vector<NodeOutboundMsg<T>> msgs;
 
+  auto read_msg = [&msgs](const NodeId& to, const uint8_t* data, size_t size) {
+    auto msg_type = serialized::read<NodeMsgType>(data, size);
+    NodeId from = serialized::read<NodeId::Value>(data, size);
+    T aad;
+    if (size > sizeof(T))
+      aad = serialized::read<T>(data, size);
+    auto payload = serialized::read(data, size, size);
+    msgs.push_back(NodeOutboundMsg<T>{from, to, msg_type, aad, payload});
+  };
+
   // A call to ringbuffer::Reader::read() may return 0 when there are still
   // messages to read, when it reaches the end of the buffer. The next call to
   // read() will correctly start at the beginning of the buffer and read these
@@ -157,14 +170,20 @@ auto read_outbound_msgs(ringbuffer::Circuit& circuit)
           case node_outbound:
           {
             NodeId to = serialized::read<NodeId::Value>(data, size);
-            auto msg_type = serialized::read<NodeMsgType>(data, size);
-            NodeId from = serialized::read<NodeId::Value>(data, size);
-            T aad;
-            if (size > sizeof(T))
-              aad = serialized::read<T>(data, size);
-            auto payload = serialized::read(data, size, size);
-            msgs.push_back(
-              NodeOutboundMsg<T>{from, to, msg_type, aad, payload});
+            read_msg(to, data, size);
+            break;
+          }
+          case node_outbound_shared:
+          {
+            REQUIRE(buffer_handoff != nullptr);
+            auto [to, handle] =
+              ringbuffer::read_message<node_outbound_shared>(data, size);
+            std::vector<uint8_t> buffer;
+            for (const auto& part : buffer_handoff->claim(handle))
+            {
+              buffer.insert(buffer.end(), part->begin(), part->end());
+            }
+            read_msg(to, buffer.data(), buffer.size());
             break;
           }
           case associate_node_address:
@@ -433,6 +452,134 @@ TEST_CASE_FIXTURE(IORingbuffersFixture, "Client/Server key exchange")
   }
 }
 
+TEST_CASE_FIXTURE(IORingbuffersFixture, "Large messages bypass ringbuffer")
+{
+  auto network_kp = ccf::crypto::make_ec_key_pair(default_curve);
+  auto service_cert = generate_self_signed_cert(network_kp, "CN=Network");
+
+  auto channel1_kp = ccf::crypto::make_ec_key_pair(default_curve);
+  auto channel1_cert =
+    generate_endorsed_cert(channel1_kp, "CN=Node1", network_kp, service_cert);
+
+  auto channel2_kp = ccf::crypto::make_ec_key_pair(default_curve);
+  auto channel2_cert =
+    generate_endorsed_cert(channel2_kp, "CN=Node2", network_kp, service_cert);
+
+  constexpr size_t min_handoff_size = 1024;
+  auto handoff1 = std::make_shared<ringbuffer::BufferHandoff>(min_handoff_size);
+  auto handoff2 = std::make_shared<ringbuffer::BufferHandoff>(min_handoff_size);
+
+  const oversized::WriterConfig writer_config{buffer_size / 2, buffer_size * 4};
+  oversized::WriterFactory owf1(wf1, writer_config, handoff1);
+  oversized::WriterFactory owf2(wf2, writer_config, handoff2);
+
+  auto channels1 = NodeToNodeChannelManager(owf1);
+  channels1.initialize(nid1, service_cert, channel1_kp, channel1_cert);
+  auto channels2 = NodeToNodeChannelManager(owf2);
+  channels2.initialize(nid2, service_cert, channel2_kp, channel2_cert);
+
+  MsgType msg;
+  msg.fill(0x42);
+
+  INFO("Establish channels");
+  {
+    REQUIRE(channels1.send_authenticated(
+      nid2, NodeMsgType::consensus_msg, msg.begin(), msg.size()));
+
+    auto deliver = [](
+                     const std::vector<NodeOutboundMsg<MsgType>>& msgs,
+                     NodeToNodeChannelManager& receiver) {
+      for (const auto& m : msgs)
+      {
+        if (m.type == NodeMsgType::channel_msg)
+        {
+          receiver.recv_channel_message(m.from, m.data());
+        }
+        else
+        {
+          auto hdr = m.authenticated_hdr;
+          const auto* data = m.payload.data();
+          auto size = m.payload.size();
+          REQUIRE(receiver.recv_authenticated(
+            m.from, {hdr.data(), hdr.size()}, data, size));
+        }
+      }
+    };
+
+    for (size_t i = 0; i < 5; ++i)
+    {
+      deliver(read_outbound_msgs<MsgType>(eio1, handoff1), channels2);
+      deliver(read_outbound_msgs<MsgType>(eio2, handoff2), channels1);
+    }
+
+    REQUIRE(channels1.channel_open(nid2));
+    REQUIRE(channels2.channel_open(nid1));
+    REQUIRE(handoff1->pending() == 0);
+    REQUIRE(handoff2->pending() == 0);
+  }
+
+  INFO("Small messages are still written to the ringbuffer");
+  {
+    std::vector<uint8_t> plain_text(min_handoff_size / 2, 0x1);
+    REQUIRE(channels1.send_encrypted(
+      nid2, NodeMsgType::consensus_msg, {msg.begin(), msg.size()}, plain_text));
+    REQUIRE(handoff1->pending() == 0);
+
+    auto msg_ = get_first(eio1, NodeMsgType::consensus_msg);
+    auto decrypted = channels2.recv_encrypted(
+      nid1,
+      {msg_.authenticated_hdr.data(), msg_.authenticated_hdr.size()},
+      msg_.payload.data(),
+      msg_.payload.size());
+
+    REQUIRE(decrypted == plain_text);
+  }
+
+  INFO("Large messages are handed off, and only their handle is written");
+  {
+    // Larger than the ringbuffer itself
+    std::vector<uint8_t> plain_text(buffer_size * 2, 0x2);
+    REQUIRE(channels1.send_encrypted(
+      nid2, NodeMsgType::consensus_msg, {msg.begin(), msg.size()}, plain_text));
+    REQUIRE(handoff1->pending() == 1);
+
+    auto msgs = read_outbound_msgs<MsgType>(eio1, handoff1);
+    REQUIRE(msgs.size() == 1);
+    REQUIRE(handoff1->pending() == 0);
+
+    const auto& msg_ = msgs[0];
+    REQUIRE(msg_.type == NodeMsgType::consensus_msg);
+    REQUIRE(msg_.from == nid1);
+    REQUIRE(msg_.to == nid2);
+
+    auto decrypted = channels2.recv_encrypted(
+      nid1,
+      {msg_.authenticated_hdr.data(), msg_.authenticated_hdr.size()},
+      msg_.payload.data(),
+      msg_.payload.size());
+
+    REQUIRE(decrypted == plain_text);
+  }
+
+  INFO("Handles can only be claimed once");
+  {
+    std::vector<uint8_t> plain_text(min_handoff_size, 0x3);
+    REQUIRE(channels2.send_encrypted(
+      nid1, NodeMsgType::consensus_msg, {msg.begin(), msg.size()}, plain_text));
+    REQUIRE(handoff2->pending() == 1);
+
+    eio2.read_from_inside().read(
+      -1, [&](ringbuffer::Message m, const uint8_t* data, size_t size) {
+        REQUIRE(m == node_outbound_shared);
+        auto [to, handle] =
+          ringbuffer::read_message<node_outbound_shared>(data, size);
+        REQUIRE_FALSE(handoff2->claim(handle).empty());
+        REQUIRE_THROWS_AS(handoff2->claim(handle), std::logic_error);
+      });
+    REQUIRE(handoff2->pending() == 0);
+  }
+}
+
 TEST_CASE_FIXTURE(IORingbuffersFixture, "Replay and out-of-order")
 {
   auto network_kp = ccf::crypto::make_ec_key_pair(default_curve);
@@ -446,6 +446,77 @@ TEST_CASE("Encryptor rollback")
   commit_one(store, map);
 }
 
+TEST_CASE("Deserialise ahead")
+{
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  StringString map("map");
+  ccf::kv::Store primary_store;
+  ccf::kv::Store backup_store;
+
+  auto primary_ledger_secrets = std::make_shared<ccf::LedgerSecrets>();
+  primary_ledger_secrets->init();
+  auto backup_ledger_secrets = std::make_shared<ccf::LedgerSecrets>();
+  {
+    auto tx = primary_store.create_tx();
+    backup_ledger_secrets->init_from_map(primary_ledger_secrets->get(tx));
+  }
+
+  primary_store.set_encryptor(
+    std::make_shared<ccf::NodeEncryptor>(primary_ledger_secrets));
+  primary_store.set_consensus(consensus);
+  backup_store.set_encryptor(
+    std::make_shared<ccf::NodeEncryptor>(backup_ledger_secrets));
+
+  constexpr size_t tx_count = 10;
+  for (size_t i = 0; i < tx_count; ++i)
+  {
+    auto tx = primary_store.create_tx();
+    tx.rw(map)->put(fmt::format("key{}", i), fmt::format("value{}", i));
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+
+  std::vector<std::unique_ptr<ccf::kv::AbstractExecutionWrapper>> wrappers;
+  for (const auto& [_, data, __, ___] : consensus->replica)
+  {
+    wrappers.push_back(backup_store.deserialize(*data));
+  }
+  REQUIRE(wrappers.size() == tx_count);
+
+  INFO("Entries can be deserialised ahead in any order");
+  {
+    for (auto it = wrappers.rbegin(); it != wrappers.rend(); ++it)
+    {
+      (*it)->deserialise_ahead();
+    }
+    REQUIRE(backup_store.current_version() == 0);
+  }
+
+  INFO("A corrupted entry still fails when it is applied");
+  {
+    auto corrupted = *std::get<1>(consensus->replica.front());
+    corrupted.back() ^= 0xff;
+    auto wrapper = backup_store.deserialize(corrupted);
+    wrapper->deserialise_ahead();
+    REQUIRE(wrapper->apply() == ccf::kv::ApplyResult::FAIL);
+  }
+
+  INFO("Entries are applied in order, using the changes deserialised ahead");
+  {
+    for (auto& wrapper : wrappers)
+    {
+      REQUIRE(wrapper->apply() == ccf::kv::ApplyResult::PASS);
+    }
+
+    auto tx = backup_store.create_read_only_tx();
+    for (size_t i = 0; i < tx_count; ++i)
+    {
+      REQUIRE(
+        tx.ro(map)->get(fmt::format("key{}", i)) == fmt::format("value{}", i));
+    }
+    REQUIRE(backup_store.current_version() == primary_store.current_version());
+  }
+}
+
 int main(int argc, char** argv)
 {
   ccf::logger::config::default_init();
@@ -18,6 +18,8 @@
 #include "kv/test/stub_consensus.h"
 #include "node/history.h"
 #include "node/share_manager.h"
+#include "node/signature_cache_subsystem.h"
+#include "tasks/task_system.h"
 
 #include <algorithm>
 #include <random>
@@ -997,6 +999,208 @@ TEST_CASE("Incremental progress")
   }
 }
 
+TEST_CASE("StateCache deserialises ranges across worker threads")
+{
+  auto state = create_and_init_state();
+  auto& kv_store = *state.kv_store;
+
+  // Enough entries to be split into several chunks
+  const auto begin_seqno = kv_store.current_version() + 1;
+  write_transactions_and_signature(
+    kv_store, 4 * ccf::historical::deserialise_chunk_size);
+  const auto end_seqno = kv_store.current_version();
+
+  auto ledger = construct_host_ledger(state.kv_store->get_consensus());
+
+  auto stub_writer = std::make_shared<StubWriter>();
+  ccf::historical::StateCache cache(
+    kv_store, state.ledger_secrets, stub_writer);
+
+  ccf::tasks::set_task_threads(4);
+
+  const ccf::historical::RequestHandle this_handle = 42;
+  REQUIRE(cache.get_store_range(this_handle, begin_seqno, end_seqno).empty());
+
+  {
+    INFO("An unrequested entry in the range is rejected");
+    std::vector<uint8_t> combined;
+    for (auto seqno = begin_seqno - 1; seqno <= end_seqno; ++seqno)
+    {
+      const auto& entry = ledger.at(seqno);
+      combined.insert(combined.end(), entry.begin(), entry.end());
+    }
+    REQUIRE_FALSE(
+      cache.handle_ledger_entries(begin_seqno - 1, end_seqno, combined));
+  }
+
+  {
+    INFO("All requested entries are deserialised and processed in order");
+    auto stores = cache.get_store_range(this_handle, begin_seqno, end_seqno);
+    REQUIRE(stores.size() == end_seqno - begin_seqno + 1);
+    for (auto seqno = begin_seqno; seqno < end_seqno; ++seqno)
+    {
+      validate_business_transaction(stores[seqno - begin_seqno], seqno);
+    }
+  }
+
+  {
+    INFO("Entries which are already available are not reprocessed");
+    std::vector<uint8_t> combined;
+    for (auto seqno = begin_seqno; seqno <= end_seqno; ++seqno)
+    {
+      const auto& entry = ledger.at(seqno);
+      combined.insert(combined.end(), entry.begin(), entry.end());
+    }
+    REQUIRE_FALSE(
+      cache.handle_ledger_entries(begin_seqno, end_seqno, combined));
+  }
+
+  ccf::tasks::set_task_threads(0);
+}
+
+TEST_CASE("StateCache prefetches sequential ranges")
+{
+  auto state = create_and_init_state();
+  auto& kv_store = *state.kv_store;
+
+  const auto begin_seqno = kv_store.current_version() + 1;
+  write_transactions_and_signature(kv_store, 30);
+  const auto end_seqno = kv_store.current_version();
+
+  auto ledger = construct_host_ledger(state.kv_store->get_consensus());
+
+  auto stub_writer = std::make_shared<StubWriter>();
+  ccf::historical::StateCache cache(
+    kv_store, state.ledger_secrets, stub_writer);
+
+  auto provide_ledger_entries = [&](size_t from, size_t to) {
+    std::vector<uint8_t> combined;
+    for (auto seqno = from; seqno <= to; ++seqno)
+    {
+      const auto it = ledger.find(seqno);
+      REQUIRE(it != ledger.end());
+      combined.insert(combined.end(), it->second.begin(), it->second.end());
+    }
+    return cache.handle_ledger_entries(from, to, combined);
+  };
+
+  auto get_read_requests = [&]() {
+    std::vector<std::pair<ccf::SeqNo, ccf::SeqNo>> ranges;
+    for (const auto& write : stub_writer->writes)
+    {
+      const uint8_t* data = write.contents.data();
+      size_t size = write.contents.size();
+      REQUIRE(write.m == ::consensus::ledger_get_range);
+      auto [from_seqno, to_seqno, purpose] =
+        ringbuffer::read_message<::consensus::ledger_get_range>(data, size);
+      ranges.emplace_back(from_seqno, to_seqno);
+    }
+    stub_writer->writes.clear();
+    return ranges;
+  };
+
+  using Ranges = std::vector<std::pair<ccf::SeqNo, ccf::SeqNo>>;
+
+  constexpr auto this_handle = 0;
+  constexpr size_t window = 5;
+
+  INFO("Prefetching is disabled by default");
+  {
+    REQUIRE(cache
+              .get_store_range(this_handle, begin_seqno, begin_seqno + 4)
+              .empty());
+    REQUIRE(cache
+              .get_store_range(this_handle, begin_seqno + 5, begin_seqno + 9)
+              .empty());
+    cache.tick({});
+    REQUIRE(get_read_requests() == Ranges{{begin_seqno + 5, begin_seqno + 9}});
+    REQUIRE(cache.get_prefetch_requested_count() == 0);
+    cache.drop_cached_states(this_handle);
+  }
+
+  cache.set_prefetch_enabled(true);
+
+  auto page = begin_seqno;
+
+  INFO("First request is not prefetched");
+  {
+    REQUIRE(
+      cache.get_store_range(this_handle, page, page + window - 1).empty());
+    cache.tick({});
+    REQUIRE(get_read_requests() == Ranges{{page, page + window - 1}});
+    REQUIRE(provide_ledger_entries(page, page + window - 1));
+    REQUIRE(
+      cache.get_store_range(this_handle, page, page + window - 1).size() ==
+      window);
+    REQUIRE(cache.get_prefetch_requested_count() == 0);
+  }
+
+  INFO("Following request on same handle prefetches the next window");
+  {
+    page += window;
+    REQUIRE(
+      cache.get_store_range(this_handle, page, page + window - 1).empty());
+    REQUIRE(cache.get_prefetch_requested_count() == window);
+    REQUIRE(
+      get_read_requests() ==
+      Ranges{{page + window, page + 2 * window - 1}});
+    cache.tick({});
+    REQUIRE(get_read_requests() == Ranges{{page, page + window - 1}});
+    REQUIRE(provide_ledger_entries(page, page + 2 * window - 1));
+    REQUIRE(
+      cache.get_store_range(this_handle, page, page + window - 1).size() ==
+      window);
+  }
+
+  INFO("Prefetched window is available on first request");
+  {
+    page += window;
+    const auto stores =
+      cache.get_store_range(this_handle, page, page + window - 1);
+    REQUIRE(stores.size() == window);
+    for (size_t i = 0; i < window; ++i)
+    {
+      REQUIRE(stores[i]->current_txid().seqno == page + i);
+    }
+    REQUIRE(cache.get_prefetch_hit_count() == window);
+    REQUIRE(cache.get_prefetch_requested_count() == 2 * window);
+  }
+
+  INFO("Prefetch does not go past the end of the committed ledger");
+  {
+    page = end_seqno - window + 1;
+    cache.get_store_range(this_handle, page - window, page - 1);
+    cache.get_store_range(this_handle, page, end_seqno);
+    cache.tick({});
+    for (const auto& [from, to] : get_read_requests())
+    {
+      REQUIRE(to <= end_seqno);
+    }
+  }
+
+  INFO("Non-sequential request drops prefetched entries");
+  {
+    const auto hits_before = cache.get_prefetch_hit_count();
+    const auto requested_before = cache.get_prefetch_requested_count();
+    cache.get_store_range(
+      this_handle, begin_seqno + window, begin_seqno + 2 * window - 1);
+    cache.get_store_range(
+      this_handle, begin_seqno + 2 * window, begin_seqno + 3 * window - 1);
+    cache.get_store_range(this_handle, begin_seqno, begin_seqno + window - 1);
+    REQUIRE(cache.get_prefetch_hit_count() == hits_before);
+    REQUIRE(cache.get_prefetch_requested_count() == requested_before + window);
+    for (const auto& [from, to] : get_read_requests())
+    {
+      REQUIRE(from >= begin_seqno + 3 * window);
+      REQUIRE(to < begin_seqno + 4 * window);
+    }
+
+    cache.tick({});
+    REQUIRE(
+      get_read_requests() == Ranges{{begin_seqno, begin_seqno + window - 1}});
+  }
+}
+
 TEST_CASE("StateCache soft zero limit with increasing")
 {
   // Try get two states. Shouldn't be able to retrieve anything with 0 cache
@@ -1909,6 +2113,77 @@ TEST_CASE("Valid merkle proof from receipts")
   REQUIRE_FALSE(proof.has_value());
 }
 
+TEST_CASE("Recent receipts from the live tree match historical receipts")
+{
+  auto state = create_and_init_state();
+  auto& kv_store = *state.kv_store;
+
+  auto history =
+    std::dynamic_pointer_cast<ccf::MerkleTxHistory>(kv_store.get_history());
+  REQUIRE(history != nullptr);
+  history->set_receipt_window(100);
+
+  ccf::SignatureCacheSubsystem signature_cache;
+  signature_cache.register_hooks(kv_store);
+
+  const auto first_sig = write_transactions_and_signature(kv_store, 10);
+
+  INFO("No receipts are produced before a history is attached");
+  const auto target_seqno = first_sig + 3;
+  const auto second_sig = write_transactions_and_signature(kv_store, 10);
+  const auto third_sig = write_transactions_and_signature(kv_store, 10);
+  const auto view = kv_store.current_txid().view;
+  REQUIRE(signature_cache.get_recent_receipt({view, target_seqno}) == nullptr);
+
+  signature_cache.set_history(history);
+
+  auto ledger = construct_host_ledger(kv_store.get_consensus());
+  auto writer = std::make_shared<StubWriter>();
+  ccf::historical::StateCache cache(kv_store, state.ledger_secrets, writer);
+
+  {
+    INFO("Receipts for transactions covered by a cached signature match");
+    for (const auto seqno : {target_seqno, second_sig + 1, third_sig - 1})
+    {
+      auto recent = signature_cache.get_recent_receipt({view, seqno});
+      REQUIRE(recent != nullptr);
+
+      REQUIRE(cache.get_state_at(seqno, seqno) == nullptr);
+      const auto sig_seqno = seqno < second_sig ? second_sig : third_sig;
+      REQUIRE(cache.handle_ledger_entry(seqno, ledger.at(seqno)));
+      REQUIRE(cache.handle_ledger_entry(sig_seqno, ledger.at(sig_seqno)));
+      auto historical_state = cache.get_state_at(seqno, seqno);
+      REQUIRE(historical_state != nullptr);
+      const auto& historical = historical_state->receipt;
+      REQUIRE(historical != nullptr);
+
+      REQUIRE(recent->root == historical->root);
+      REQUIRE(*recent->path == *historical->path);
+      REQUIRE(recent->signature == historical->signature);
+      REQUIRE(recent->cose_signature == historical->cose_signature);
+      REQUIRE(recent->node_id == historical->node_id);
+      REQUIRE(recent->write_set_digest == historical->write_set_digest);
+      REQUIRE(recent->commit_evidence == historical->commit_evidence);
+      REQUIRE(recent->claims_digest == historical->claims_digest);
+    }
+  }
+
+  {
+    INFO("Other transactions fall back to historical queries");
+    // Signatures are not given a proof
+    REQUIRE(
+      signature_cache.get_recent_receipt({view, second_sig}) == nullptr);
+    // Not yet signed
+    write_transactions(kv_store, 1);
+    REQUIRE(
+      signature_cache.get_recent_receipt({view, kv_store.current_version()}) ==
+      nullptr);
+    // Wrong view
+    REQUIRE(
+      signature_cache.get_recent_receipt({view + 1, target_seqno}) == nullptr);
+  }
+}
+
 TEST_CASE("Cache size estimation")
 {
   auto state = create_and_init_state();
@@ -2069,7 +2344,7 @@ TEST_CASE("adjust_ranges")
       const std::shared_ptr<ccf::LedgerSecrets>& secrets,
       const ringbuffer::WriterPtr& host_writer) :
       StateCacheImpl(store, secrets, host_writer),
-      request(all_stores)
+      request(all_stores, signature_trees)
     {}
 
     std::pair<SeqNoSet, SeqNoSet> adjust_ranges(const SeqNoSet& seqnos)
@@ -0,0 +1,273 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "crypto/certs.h"
+#include "ds/test/stub_writer.h"
+#include "kv/test/stub_consensus.h"
+#include "node/encryptor.h"
+#include "node/historical_queries.h"
+#include "node/history.h"
+#include "node/ledger_secrets.h"
+#include "node/signature_cache_subsystem.h"
+#include "tasks/task_system.h"
+
+#define PICOBENCH_IMPLEMENT
+#include <picobench/picobench.hpp>
+
+using NumToString = ccf::kv::Map<size_t, std::string>;
+
+inline void clobber_memory()
+{
+  asm volatile("" : : : "memory");
+}
+
+struct EncryptedLedger
+{
+  std::shared_ptr<ccf::kv::Store> kv_store;
+  std::shared_ptr<ccf::LedgerSecrets> ledger_secrets;
+  std::vector<uint8_t> entries;
+  ccf::SeqNo begin_seqno;
+  ccf::SeqNo end_seqno;
+};
+
+static EncryptedLedger build_ledger(size_t tx_count)
+{
+  EncryptedLedger ledger;
+
+  ledger.kv_store = std::make_shared<ccf::kv::Store>();
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  ledger.kv_store->set_consensus(consensus);
+
+  ledger.ledger_secrets = std::make_shared<ccf::LedgerSecrets>();
+  ledger.ledger_secrets->init();
+  ledger.kv_store->set_encryptor(
+    std::make_shared<ccf::NodeEncryptor>(ledger.ledger_secrets));
+
+  ledger.begin_seqno = ledger.kv_store->current_version() + 1;
+  for (size_t i = 0; i < tx_count; ++i)
+  {
+    auto tx = ledger.kv_store->create_tx();
+    auto public_map = tx.rw<NumToString>("public:data");
+    auto private_map = tx.rw<NumToString>("data");
+    const auto s = std::to_string(i);
+    public_map->put(i, s);
+    private_map->put(i, s);
+    if (tx.commit() != ccf::kv::CommitResult::SUCCESS)
+    {
+      throw std::logic_error("Failed to commit transaction");
+    }
+  }
+  ledger.end_seqno = ledger.kv_store->current_version();
+
+  // Concatenate the entries as the host would send them
+  for (const auto& [seqno, data, committable, hooks] : consensus->replica)
+  {
+    ledger.entries.insert(ledger.entries.end(), data->begin(), data->end());
+  }
+
+  return ledger;
+}
+
+// Time taken to decrypt, deserialise and process a whole range of ledger
+// entries, delivered in a single ledger_entry_range message
+template <size_t Workers>
+static void handle_ledger_entries(picobench::state& s)
+{
+  auto ledger = build_ledger(s.iterations());
+
+  auto stub_writer = std::make_shared<StubWriter>();
+  ccf::historical::StateCache cache(
+    *ledger.kv_store, ledger.ledger_secrets, stub_writer);
+
+  const ccf::historical::RequestHandle handle = 0;
+  cache.get_store_range(handle, ledger.begin_seqno, ledger.end_seqno);
+
+  ccf::tasks::set_task_threads(Workers);
+
+  s.start_timer();
+  const auto accepted = cache.handle_ledger_entries(
+    ledger.begin_seqno, ledger.end_seqno, ledger.entries);
+  clobber_memory();
+  s.stop_timer();
+
+  ccf::tasks::set_task_threads(0);
+
+  const auto stores =
+    cache.get_store_range(handle, ledger.begin_seqno, ledger.end_seqno);
+  if (!accepted || stores.size() != s.iterations())
+  {
+    throw std::logic_error("Not all ledger entries were processed");
+  }
+}
+
+struct SignedLedger
+{
+  std::shared_ptr<ccf::kv::Store> kv_store;
+  std::shared_ptr<ccf::LedgerSecrets> ledger_secrets;
+  std::shared_ptr<ccf::MerkleTxHistory> history;
+  ccf::crypto::ECKeyPairPtr node_kp;
+  std::map<ccf::SeqNo, std::vector<uint8_t>> entries;
+  ccf::SeqNo begin_seqno;
+  ccf::SeqNo end_seqno;
+  ccf::SeqNo signature_seqno;
+};
+
+// Ledger of tx_count transactions, preceded and followed by a signature, with
+// a history retaining all of them for receipts
+static SignedLedger build_signed_ledger(
+  size_t tx_count, ccf::SignatureCacheSubsystem& signature_cache)
+{
+  SignedLedger ledger;
+
+  ledger.kv_store = std::make_shared<ccf::kv::Store>();
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  ledger.kv_store->set_consensus(consensus);
+
+  const ccf::NodeId node_id = std::string("node_id");
+  ledger.node_kp = ccf::crypto::make_ec_key_pair();
+  ledger.history = std::make_shared<ccf::MerkleTxHistory>(
+    *ledger.kv_store, node_id, *ledger.node_kp);
+  ledger.history->set_endorsed_certificate({});
+  ledger.history->set_service_signing_identity(
+    std::dynamic_pointer_cast<ccf::crypto::ECKeyPair_OpenSSL>(
+      ccf::crypto::make_ec_key_pair()),
+    ccf::COSESignaturesConfig{});
+  ledger.history->set_receipt_window(tx_count + 1);
+  ledger.kv_store->set_history(ledger.history);
+  ledger.kv_store->initialise_term(2);
+
+  signature_cache.set_history(ledger.history);
+  signature_cache.register_hooks(*ledger.kv_store);
+
+  {
+    auto tx = ledger.kv_store->create_tx();
+    auto nodes = tx.rw<ccf::Nodes>(ccf::Tables::NODES);
+    ccf::NodeInfo ni;
+    const auto valid_from =
+      ccf::ds::to_x509_time_string(std::chrono::system_clock::now());
+    ni.cert = ledger.node_kp->self_sign(
+      "CN=Test node",
+      valid_from,
+      ccf::crypto::compute_cert_valid_to_string(valid_from, 1));
+    ni.status = ccf::NodeStatus::TRUSTED;
+    ni.encryption_pub_key = ledger.node_kp->public_key_pem();
+    nodes->put(node_id, ni);
+    if (tx.commit() != ccf::kv::CommitResult::SUCCESS)
+    {
+      throw std::logic_error("Failed to commit transaction");
+    }
+  }
+
+  ledger.ledger_secrets = std::make_shared<ccf::LedgerSecrets>();
+  ledger.ledger_secrets->init();
+  ledger.kv_store->set_encryptor(
+    std::make_shared<ccf::NodeEncryptor>(ledger.ledger_secrets));
+
+  auto emit_signature = [&]() {
+    ledger.history->emit_signature();
+    const auto version = ledger.kv_store->current_version();
+    consensus->set_last_signature_at(version);
+    ledger.kv_store->compact(version);
+    return version;
+  };
+
+  emit_signature();
+
+  ledger.begin_seqno = ledger.kv_store->current_version() + 1;
+  for (size_t i = 0; i < tx_count; ++i)
+  {
+    auto tx = ledger.kv_store->create_tx();
+    auto public_map = tx.rw<NumToString>("public:data");
+    const auto s = std::to_string(i);
+    public_map->put(i, s);
+    if (tx.commit() != ccf::kv::CommitResult::SUCCESS)
+    {
+      throw std::logic_error("Failed to commit transaction");
+    }
+  }
+  ledger.end_seqno = ledger.kv_store->current_version();
+
+  ledger.signature_seqno = emit_signature();
+
+  for (const auto& [seqno, data, committable, hooks] : consensus->replica)
+  {
+    ledger.entries.emplace(seqno, *data);
+  }
+
+  return ledger;
+}
+
+// Time taken to produce a receipt for every transaction covered by the last
+// signature, from the primary's live Merkle tree
+static void recent_receipts(picobench::state& s)
+{
+  ccf::SignatureCacheSubsystem signature_cache;
+  auto ledger = build_signed_ledger(s.iterations(), signature_cache);
+  const auto view = ledger.kv_store->current_txid().view;
+
+  s.start_timer();
+  for (auto seqno = ledger.begin_seqno; seqno <= ledger.end_seqno; ++seqno)
+  {
+    auto receipt = signature_cache.get_recent_receipt({view, seqno});
+    if (receipt == nullptr)
+    {
+      throw std::logic_error("Missing recent receipt");
+    }
+  }
+  clobber_memory();
+  s.stop_timer();
+}
+
+// Time taken to produce the same receipts through historical queries, once
+// the host has supplied the requested ledger entries
+static void historical_receipts(picobench::state& s)
+{
+  ccf::SignatureCacheSubsystem signature_cache;
+  auto ledger = build_signed_ledger(s.iterations(), signature_cache);
+
+  auto stub_writer = std::make_shared<StubWriter>();
+  ccf::historical::StateCache cache(
+    *ledger.kv_store, ledger.ledger_secrets, stub_writer);
+  const auto& signature_entry = ledger.entries.at(ledger.signature_seqno);
+
+  s.start_timer();
+  for (auto seqno = ledger.begin_seqno; seqno <= ledger.end_seqno; ++seqno)
+  {
+    const ccf::historical::RequestHandle handle = seqno;
+    cache.get_state_at(handle, seqno);
+    cache.handle_ledger_entry(seqno, ledger.entries.at(seqno));
+    cache.handle_ledger_entry(ledger.signature_seqno, signature_entry);
+    auto state = cache.get_state_at(handle, seqno);
+    if (state == nullptr || state->receipt == nullptr)
+    {
+      throw std::logic_error("Missing historical receipt");
+    }
+    cache.drop_cached_states(handle);
+  }
+  clobber_memory();
+  s.stop_timer();
+}
+
+const std::vector<int> sizes = {10'000, 100'000};
+
+PICOBENCH_SUITE("handle_ledger_entries");
+PICOBENCH(handle_ledger_entries<0>).iterations(sizes).samples(1).baseline();
+PICOBENCH(handle_ledger_entries<2>).iterations(sizes).samples(1);
+PICOBENCH(handle_ledger_entries<4>).iterations(sizes).samples(1);
+PICOBENCH(handle_ledger_entries<8>).iterations(sizes).samples(1);
+
+const std::vector<int> receipt_counts = {100, 1'000};
+
+PICOBENCH_SUITE("receipt_latency");
+PICOBENCH(historical_receipts).iterations(receipt_counts).samples(1).baseline();
+PICOBENCH(recent_receipts).iterations(receipt_counts).samples(1);
+
+int main(int argc, char* argv[])
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  auto ret = runner.run();
+  return ret;
+}
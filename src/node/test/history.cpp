@@ -248,6 +248,151 @@ TEST_CASE("Check signing works across rollback")
   }
 }
 
+class BatchDummyConsensus : public DummyConsensus
+{
+public:
+  BatchDummyConsensus(ccf::kv::Store* store_) : DummyConsensus(store_) {}
+
+  bool replicate(const ccf::kv::BatchVector& entries, ccf::View view) override
+  {
+    for (const auto& [version, data, committable, hooks] : entries)
+    {
+      if (store->deserialize(*data)->apply() == ccf::kv::ApplyResult::FAIL)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+TEST_CASE("Check signatures can be signed off the commit path")
+{
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+
+  auto node_kp = ccf::crypto::make_ec_key_pair();
+  auto service_kp = std::dynamic_pointer_cast<ccf::crypto::ECKeyPair_OpenSSL>(
+    ccf::crypto::make_ec_key_pair());
+
+  const auto self_signed = node_kp->self_sign("CN=Node", valid_from, valid_to);
+
+  ccf::tasks::JobBoard job_board;
+
+  ccf::kv::Store primary_store;
+  primary_store.set_encryptor(encryptor);
+  constexpr auto store_term = 2;
+  auto primary_history = std::make_shared<ccf::MerkleTxHistory>(
+    primary_store, ccf::kv::test::PrimaryNodeId, *node_kp);
+  primary_history->set_endorsed_certificate(self_signed);
+  primary_history->set_service_signing_identity(
+    service_kp, ccf::COSESignaturesConfig{});
+  primary_history->set_signing_job_board(&job_board);
+  primary_store.set_history(primary_history);
+  primary_store.initialise_term(store_term);
+
+  ccf::kv::Store backup_store;
+  backup_store.set_encryptor(encryptor);
+  std::shared_ptr<ccf::kv::TxHistory> backup_history =
+    std::make_shared<ccf::MerkleTxHistory>(
+      backup_store, ccf::kv::test::FirstBackupNodeId, *node_kp);
+  backup_history->set_endorsed_certificate(self_signed);
+  backup_history->set_service_signing_identity(
+    service_kp, ccf::COSESignaturesConfig{});
+  backup_store.set_history(backup_history);
+  backup_store.initialise_term(store_term);
+
+  ccf::Nodes nodes(ccf::Tables::NODES);
+  ccf::Service service(ccf::Tables::SERVICE);
+
+  std::shared_ptr<ccf::kv::Consensus> consensus =
+    std::make_shared<BatchDummyConsensus>(&backup_store);
+  primary_store.set_consensus(consensus);
+
+  std::shared_ptr<ccf::kv::Consensus> null_consensus =
+    std::make_shared<DummyConsensus>(nullptr);
+  backup_store.set_consensus(null_consensus);
+
+  INFO("Write certificates");
+  {
+    auto txs = primary_store.create_tx();
+    auto tx = txs.rw(nodes);
+    ccf::NodeInfo ni;
+    ni.encryption_pub_key = node_kp->public_key_pem();
+    ni.cert = self_signed;
+    tx->put(ccf::kv::test::PrimaryNodeId, ni);
+
+    auto stx = txs.rw(service);
+    auto service_info = ccf::ServiceInfo{
+      .cert = service_kp->self_sign("CN=Service", valid_from, valid_to)};
+    stx->put(service_info);
+    REQUIRE(txs.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(backup_store.current_version() == 1);
+  }
+
+  INFO("Signature is signed by a task, and later transactions are held");
+  {
+    primary_history->emit_signature();
+    REQUIRE(job_board.get_summary().pending_tasks == 1);
+    REQUIRE(backup_store.current_version() == 1);
+
+    auto txs = primary_store.create_tx();
+    auto tx = txs.rw(nodes);
+    ccf::NodeInfo ni;
+    tx->put(ccf::kv::test::FirstBackupNodeId, ni);
+    REQUIRE(txs.commit() == ccf::kv::CommitResult::SUCCESS);
+    REQUIRE(backup_store.current_version() == 1);
+  }
+
+  INFO("Once signed, signature and held transactions are replicated");
+  {
+    auto task = job_board.get_task();
+    REQUIRE(task != nullptr);
+    task->do_task();
+    REQUIRE(job_board.get_summary().pending_tasks == 0);
+
+    // The backup has verified the signature
+    REQUIRE(backup_store.current_version() == 3);
+    REQUIRE(
+      primary_history->get_replicated_state_root() ==
+      backup_history->get_replicated_state_root());
+  }
+}
+
+TEST_CASE("Signing tasks which outlive their history do nothing")
+{
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  auto node_kp = ccf::crypto::make_ec_key_pair();
+  auto service_kp = std::dynamic_pointer_cast<ccf::crypto::ECKeyPair_OpenSSL>(
+    ccf::crypto::make_ec_key_pair());
+  const auto self_signed = node_kp->self_sign("CN=Node", valid_from, valid_to);
+
+  ccf::tasks::JobBoard job_board;
+
+  {
+    ccf::kv::Store store;
+    store.set_encryptor(encryptor);
+    auto history = std::make_shared<ccf::MerkleTxHistory>(
+      store, ccf::kv::test::PrimaryNodeId, *node_kp);
+    history->set_endorsed_certificate(self_signed);
+    history->set_service_signing_identity(
+      service_kp, ccf::COSESignaturesConfig{});
+    history->set_signing_job_board(&job_board);
+    store.set_history(history);
+    store.initialise_term(2);
+    store.set_consensus(std::make_shared<DummyConsensus>(nullptr));
+
+    history->emit_signature();
+    REQUIRE(job_board.get_summary().pending_tasks == 1);
+  }
+
+  // The store and history have been destroyed, so the task must not touch
+  // them
+  auto task = job_board.get_task();
+  REQUIRE(task != nullptr);
+  task->do_task();
+  REQUIRE(job_board.get_summary().pending_tasks == 0);
+}
+
 class CompactingConsensus : public ccf::kv::test::StubConsensus
 {
 public:
@@ -1,12 +1,21 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the Apache 2.0 License.
 
+#include "ccf/ds/x509_time_fmt.h"
+#include "crypto/certs.h"
 #include "crypto/openssl/hash.h"
+#include "kv/test/null_encryptor.h"
 #include "kv/test/stub_consensus.h"
 #include "node/history.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
+#include <iostream>
+#include <thread>
+#include <vector>
 #define PICOBENCH_IMPLEMENT
 #include <picobench/picobench.hpp>
 
@@ -138,6 +147,106 @@ static void append_compact(picobench::state& s)
   s.stop_timer();
 }
 
+// Commits one transaction per iteration, and emits a signature every
+// sig_interval transactions. When signatures are signed on the commit path,
+// the committing thread stalls for each signature. With a signing job board,
+// signatures are signed by a worker thread, and later transactions are held
+// (rather than blocked) until each signature is ready. The distribution of
+// per-commit latency shows the jitter introduced by each signature.
+template <size_t SigInterval, bool AsyncSigning>
+static void commit_with_signatures(picobench::state& s)
+{
+  using namespace std::literals;
+  const auto valid_from =
+    ccf::ds::to_x509_time_string(std::chrono::system_clock::now() - 24h);
+  const auto valid_to =
+    ccf::crypto::compute_cert_valid_to_string(valid_from, 365);
+
+  auto node_kp = ccf::crypto::make_ec_key_pair();
+  auto service_kp = std::dynamic_pointer_cast<ccf::crypto::ECKeyPair_OpenSSL>(
+    ccf::crypto::make_ec_key_pair());
+
+  ccf::kv::Store store;
+  store.set_encryptor(std::make_shared<ccf::kv::NullTxEncryptor>());
+  std::shared_ptr<ccf::kv::Consensus> consensus =
+    std::make_shared<DummyConsensus>();
+  store.set_consensus(consensus);
+
+  auto history = std::make_shared<ccf::MerkleTxHistory>(
+    store, ccf::kv::test::PrimaryNodeId, *node_kp);
+  history->set_endorsed_certificate(
+    node_kp->self_sign("CN=Node", valid_from, valid_to));
+  history->set_service_signing_identity(
+    service_kp, ccf::COSESignaturesConfig{});
+  store.set_history(history);
+
+  ccf::tasks::JobBoard job_board;
+  std::atomic<bool> stop = false;
+  std::thread worker;
+  if constexpr (AsyncSigning)
+  {
+    history->set_signing_job_board(&job_board);
+    worker = std::thread([&]() {
+      while (true)
+      {
+        auto task = job_board.wait_for_task(std::chrono::milliseconds(1));
+        if (task != nullptr)
+        {
+          task->do_task();
+        }
+        else if (stop)
+        {
+          break;
+        }
+      }
+    });
+  }
+
+  ccf::kv::Map<size_t, size_t> map("public:map");
+
+  std::vector<std::chrono::nanoseconds> latencies;
+  latencies.reserve(s.iterations());
+
+  size_t idx = 0;
+  s.start_timer();
+  for (auto _ : s)
+  {
+    (void)_;
+    const auto start = std::chrono::steady_clock::now();
+    auto tx = store.create_tx();
+    tx.rw(map)->put(idx, idx);
+    tx.commit();
+
+    if (++idx % SigInterval == 0)
+    {
+      history->emit_signature();
+    }
+    latencies.push_back(std::chrono::steady_clock::now() - start);
+  }
+  s.stop_timer();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](size_t p) {
+    return latencies[(latencies.size() - 1) * p / 100].count();
+  };
+  std::cout << fmt::format(
+                 "commit latency (sig every {}, {} signing) n={}: p50 {}ns, "
+                 "p99 {}ns, max {}ns",
+                 SigInterval,
+                 AsyncSigning ? "async" : "inline",
+                 latencies.size(),
+                 percentile(50),
+                 percentile(99),
+                 latencies.back().count())
+            << std::endl;
+
+  if constexpr (AsyncSigning)
+  {
+    stop = true;
+    worker.join();
+  }
+}
+
 const std::vector<int> sizes = {1000, 10000};
 
 PICOBENCH_SUITE("hash_only");
@@ -155,6 +264,34 @@ PICOBENCH(append_compact<10>).iterations(sizes).baseline();
 PICOBENCH(append_compact<100>).iterations(sizes);
 PICOBENCH(append_compact<1000>).iterations(sizes);
 
+const std::vector<int> commit_counts = {1000, 5000};
+
+static void sig_every_100_inline(picobench::state& s)
+{
+  commit_with_signatures<100, false>(s);
+}
+
+static void sig_every_100_async(picobench::state& s)
+{
+  commit_with_signatures<100, true>(s);
+}
+
+static void sig_every_10_inline(picobench::state& s)
+{
+  commit_with_signatures<10, false>(s);
+}
+
+static void sig_every_10_async(picobench::state& s)
+{
+  commit_with_signatures<10, true>(s);
+}
+
+PICOBENCH_SUITE("commit_with_signatures");
+PICOBENCH(sig_every_100_inline).iterations(commit_counts).baseline();
+PICOBENCH(sig_every_100_async).iterations(commit_counts);
+PICOBENCH(sig_every_10_inline).iterations(commit_counts);
+PICOBENCH(sig_every_10_async).iterations(commit_counts);
+
 int main(int argc, char* argv[])
 {
   ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
@@ -170,6 +170,102 @@ static void serialise_deserialise(picobench::state& s)
   s.stop_timer();
 }
 
+static std::vector<uint8_t> serialised_tree(size_t size)
+{
+  ccf::MerkleTreeHistory t;
+  std::random_device r;
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    ccf::crypto::Sha256Hash h;
+    for (size_t j = 0; j < ccf::crypto::Sha256Hash::SIZE; j++)
+      h.h[j] = r();
+    t.append(h);
+  }
+
+  return t.serialise();
+}
+
+// Proofs for every seqno covered by a signature, extracted from the tree
+// serialised in that signature
+static void range_proofs_individually(picobench::state& s)
+{
+  const auto buf = serialised_tree(s.iterations());
+
+  s.start_timer();
+  ccf::MerkleTreeHistory t(buf);
+  for (auto i = t.begin_index(); i <= t.end_index(); ++i)
+  {
+    auto p = t.get_proof(i);
+    do_not_optimize(p.get_path());
+  }
+  clobber_memory();
+  s.stop_timer();
+}
+
+static void range_proofs_batched(picobench::state& s)
+{
+  const auto buf = serialised_tree(s.iterations());
+
+  s.start_timer();
+  ccf::MerkleTreeHistory t(buf);
+  auto paths = t.get_paths(t.begin_index(), t.end_index());
+  do_not_optimize(paths.data());
+  clobber_memory();
+  s.stop_timer();
+
+  if (paths.size() != t.end_index() - t.begin_index() + 1)
+    throw std::runtime_error("Missing paths");
+}
+
+// Proofs for a range extracted from an already deserialised tree, as when
+// the tree for a signature is cached across requests
+static void range_proofs_batched_cached_tree(picobench::state& s)
+{
+  ccf::MerkleTreeHistory t(serialised_tree(s.iterations()));
+
+  s.start_timer();
+  auto paths = t.get_paths(t.begin_index(), t.end_index());
+  do_not_optimize(paths.data());
+  clobber_memory();
+  s.stop_timer();
+
+  if (paths.size() != t.end_index() - t.begin_index() + 1)
+    throw std::runtime_error("Missing paths");
+}
+
+// Root of a tree which is rebuilt from its leaves, as when a batch of entries
+// is appended before a signature, or when a tree is rebuilt for receipts
+template <typename Tree>
+static void rebuild_root(picobench::state& s)
+{
+  std::vector<merkle::Hash> hashes(s.iterations());
+  std::random_device r;
+  for (auto& h : hashes)
+  {
+    for (auto& b : h.bytes)
+      b = r();
+  }
+
+  s.start_timer();
+  Tree t;
+  for (const auto& h : hashes)
+    t.insert(h);
+  do_not_optimize(t.root());
+  clobber_memory();
+  s.stop_timer();
+}
+
+static void rebuild_root_per_node(picobench::state& s)
+{
+  rebuild_root<ccf::HistoryTree>(s);
+}
+
+static void rebuild_root_batched(picobench::state& s)
+{
+  rebuild_root<ccf::BatchedHistoryTree>(s);
+}
+
 static void serialised_size(picobench::state& s)
 {
   ccf::MerkleTreeHistory t;
@@ -209,6 +305,13 @@ PICOBENCH_SUITE("append_get_proof_verify_v");
 PICOBENCH(append_get_proof_verify_v).iterations(sizes).baseline();
 PICOBENCH_SUITE("serialise_deserialise");
 PICOBENCH(serialise_deserialise).iterations(sizes).baseline();
+PICOBENCH_SUITE("range_proofs");
+PICOBENCH(range_proofs_individually).iterations(sizes).baseline();
+PICOBENCH(range_proofs_batched).iterations(sizes);
+PICOBENCH(range_proofs_batched_cached_tree).iterations(sizes);
+PICOBENCH_SUITE("rebuild_root");
+PICOBENCH(rebuild_root_per_node).iterations(sizes).baseline();
+PICOBENCH(rebuild_root_batched).iterations(sizes);
 // Checks the size of serialised tree, timing results are irrelevant here
 // and since we run a single sample probably not that accurate anyway
 PICOBENCH_SUITE("serialised_size");
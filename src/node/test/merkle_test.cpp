@@ -6,6 +6,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT
 
 #include <doctest/doctest.h>
+#include <numeric>
 
 ccf::crypto::Sha256Hash rand_hash()
 {
@@ -181,6 +182,131 @@ TEST_CASE("First root")
   }
 }
 
+TEST_CASE("Batched paths")
+{
+  constexpr size_t hash_count = 1'000;
+  constexpr auto third = hash_count / 3;
+  constexpr auto two_thirds = 2 * hash_count / 3;
+  std::vector<std::pair<size_t, size_t>> flush_retract = {
+    {0, hash_count}, {third, two_thirds}, {third + 1, two_thirds + 1}};
+  for (auto [flush_index, retract_index] : flush_retract)
+  {
+    ccf::MerkleTreeHistory original_tree;
+    for (size_t i = 0; i < hash_count; ++i)
+    {
+      original_tree.append(rand_hash());
+    }
+    original_tree.flush(flush_index);
+    original_tree.retract(retract_index);
+
+    // Paths are extracted in the same way from a deserialised tree
+    ccf::MerkleTreeHistory tree(original_tree.serialise());
+    const auto begin = tree.begin_index();
+    const auto end = tree.end_index();
+
+    std::vector<std::vector<uint64_t>> index_sets = {
+      {}, {begin}, {end}, {begin, end}};
+    {
+      std::vector<uint64_t> all(end - begin + 1);
+      std::iota(all.begin(), all.end(), begin);
+      index_sets.push_back(all);
+
+      std::vector<uint64_t> some;
+      for (auto i = begin; i <= end; i += 1 + rand() % 20)
+      {
+        some.push_back(i);
+      }
+      index_sets.push_back(some);
+    }
+
+    for (const auto& indices : index_sets)
+    {
+      const auto paths = tree.get_paths(indices);
+      REQUIRE(paths.size() == indices.size());
+
+      const auto root = tree.get_proof(end).get_root();
+      for (size_t i = 0; i < indices.size(); ++i)
+      {
+        auto proof = tree.get_proof(indices[i]);
+        REQUIRE(paths[i]->leaf_index() == indices[i]);
+        REQUIRE(paths[i]->max_index() == end);
+        REQUIRE(*paths[i] == *proof.get_path());
+        REQUIRE(paths[i]->verify(root));
+      }
+    }
+
+    REQUIRE(tree.get_paths(begin, end).size() == end - begin + 1);
+    REQUIRE(tree.get_paths(end, begin).empty());
+
+    if (begin > 0)
+    {
+      REQUIRE_THROWS(tree.get_paths(begin - 1, end));
+    }
+    REQUIRE_THROWS(tree.get_paths(begin, end + 1));
+    REQUIRE_THROWS(tree.get_paths({end, begin}));
+    REQUIRE_THROWS(tree.get_paths({end, end}));
+  }
+}
+
+TEST_CASE("Batched hashing")
+{
+  // HistoryTree hashes one node at a time, while BatchedHistoryTree hashes
+  // a level at a time
+  ccf::HistoryTree expected;
+  ccf::BatchedHistoryTree actual;
+  for (size_t i = 0; i < 2'000; ++i)
+  {
+    const auto h = rand_hash();
+    expected.insert(h.h.data());
+    actual.insert(h.h.data());
+
+    // Root with pending hashes of varying depths
+    if (i % 97 == 0)
+    {
+      REQUIRE(expected.root() == actual.root());
+    }
+
+    // Flushing hashes the nodes which are conflated
+    if (i % 500 == 499)
+    {
+      expected.flush_to(i / 2);
+      actual.flush_to(i / 2);
+    }
+  }
+  REQUIRE(expected.root() == actual.root());
+}
+
+TEST_CASE("Batched entry leaves")
+{
+  // Batches of odd sizes, which do not fill every lane of the multi-buffer
+  // kernels, mixing leaves which are hashed with those which are not
+  for (size_t batch_size : {0, 1, 3, 5, 7, 9, 15, 17, 31, 33, 65})
+  {
+    INFO("Batch size: " << batch_size);
+    std::vector<ccf::EntryLeafComponents> components(batch_size);
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+      auto& c = components[i];
+      c.write_set_digest = rand_hash();
+      if (rand() % 2 == 0)
+      {
+        c.commit_evidence_digest = rand_hash();
+      }
+      if (rand() % 3 == 0)
+      {
+        c.claims_digest.set(rand_hash());
+      }
+    }
+
+    const auto leaves = ccf::entry_leaves(components);
+    REQUIRE(leaves.size() == batch_size);
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+      REQUIRE(leaves[i] == ccf::entry_leaf(components[i]));
+    }
+  }
+}
+
 int main(int argc, char** argv)
 {
   doctest::Context context;
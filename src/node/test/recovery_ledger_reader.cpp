@@ -0,0 +1,213 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "node/recovery_ledger_reader.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <map>
+
+using Index = ccf::RecoveryLedgerReader::Index;
+using Reads = std::vector<std::pair<Index, Index>>;
+
+struct TestReader
+{
+  Reads reads;
+  ccf::RecoveryLedgerReader reader;
+
+  TestReader(size_t max_in_flight, size_t min_batch, size_t max_batch) :
+    reader(
+      [this](Index from, Index to) { reads.emplace_back(from, to); },
+      max_in_flight,
+      min_batch,
+      max_batch)
+  {}
+
+  Reads take_reads()
+  {
+    Reads r;
+    std::swap(r, reads);
+    return r;
+  }
+};
+
+// Entry contents are irrelevant to the reader, it only cares whether a
+// response is empty
+static std::vector<uint8_t> entries_for(Index from, Index to)
+{
+  return std::vector<uint8_t>(to - from + 1, 0x42);
+}
+
+TEST_CASE("Reads are pipelined and released in order")
+{
+  TestReader t(3, 10, 1000);
+
+  t.reader.start(1);
+  REQUIRE(t.take_reads() == Reads{{1, 10}, {11, 20}, {21, 30}});
+
+  // Nothing is released until the earliest read is answered
+  t.reader.add_entries(21, 30, entries_for(21, 30));
+  t.reader.add_entries(11, 20, entries_for(11, 20));
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+  REQUIRE(t.take_reads().empty());
+
+  t.reader.add_entries(1, 10, entries_for(1, 10));
+  for (Index from : {1, 11, 21})
+  {
+    auto batch = t.reader.next_batch();
+    REQUIRE(batch.has_value());
+    REQUIRE(batch->from == from);
+    REQUIRE(batch->to == from + 9);
+    REQUIRE(batch->entries.size() == 10);
+  }
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+
+  // Complete batches double the size of subsequent reads, and releasing a
+  // batch refills the pipeline
+  const auto reads = t.take_reads();
+  REQUIRE(reads.size() == 3);
+  REQUIRE(reads[0].first == 31);
+  REQUIRE(reads[1].first == reads[0].second + 1);
+  REQUIRE(reads[2].first == reads[1].second + 1);
+  REQUIRE(reads[2].second - reads[2].first + 1 == 80);
+}
+
+TEST_CASE("Truncated reads are completed and shrink later reads")
+{
+  TestReader t(2, 10, 1000);
+
+  t.reader.start(1);
+  REQUIRE(t.take_reads() == Reads{{1, 10}, {11, 20}});
+
+  // The host only returned part of the first read
+  t.reader.add_entries(1, 4, entries_for(1, 4));
+  REQUIRE(t.take_reads() == Reads{{5, 10}});
+
+  auto batch = t.reader.next_batch();
+  REQUIRE(batch.has_value());
+  REQUIRE(batch->from == 1);
+  REQUIRE(batch->to == 4);
+  REQUIRE(t.take_reads().empty());
+
+  t.reader.add_entries(11, 20, entries_for(11, 20));
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+
+  t.reader.add_entries(5, 10, entries_for(5, 10));
+  batch = t.reader.next_batch();
+  REQUIRE(batch.has_value());
+  REQUIRE(batch->from == 5);
+  batch = t.reader.next_batch();
+  REQUIRE(batch.has_value());
+  REQUIRE(batch->from == 11);
+}
+
+TEST_CASE("Truncated reads do not exceed the reads in flight")
+{
+  constexpr size_t max_in_flight = 3;
+  TestReader t(max_in_flight, 10, 1000);
+  std::map<Index, Index> in_flight;
+  auto track_reads = [&]() {
+    for (const auto& [from, to] : t.take_reads())
+    {
+      in_flight.emplace(from, to);
+    }
+    REQUIRE(in_flight.size() <= max_in_flight);
+  };
+
+  t.reader.start(1);
+  track_reads();
+
+  // The host returns at most 4 entries per read, answering the latest read
+  // first, until the first 100 entries have been released
+  Index released = 0;
+  while (released < 100)
+  {
+    REQUIRE_FALSE(in_flight.empty());
+    const auto [from, to] = *in_flight.rbegin();
+    in_flight.erase(from);
+    const auto returned_to = std::min(to, from + 3);
+    t.reader.add_entries(from, returned_to, entries_for(from, returned_to));
+    track_reads();
+
+    for (auto batch = t.reader.next_batch(); batch.has_value();
+         batch = t.reader.next_batch())
+    {
+      REQUIRE(batch->from == released + 1);
+      released = batch->to;
+      track_reads();
+    }
+  }
+}
+
+TEST_CASE("End of ledger")
+{
+  TestReader t(3, 10, 10);
+
+  t.reader.start(1);
+  REQUIRE(t.take_reads() == Reads{{1, 10}, {11, 20}, {21, 30}});
+
+  // The ledger ends at 15, and the reads past it are answered first
+  t.reader.add_no_entries(21);
+  t.reader.add_entries(11, 15, entries_for(11, 15));
+  REQUIRE(t.take_reads() == Reads{{16, 20}});
+  t.reader.add_no_entries(16);
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+
+  t.reader.add_entries(1, 10, entries_for(1, 10));
+  REQUIRE(t.reader.next_batch()->from == 1);
+  REQUIRE(t.reader.next_batch()->from == 11);
+
+  // No reads are issued past the end of the ledger
+  REQUIRE(t.take_reads().empty());
+
+  auto end = t.reader.next_batch();
+  REQUIRE(end.has_value());
+  REQUIRE(end->from == 16);
+  REQUIRE(end->entries.empty());
+
+  REQUIRE_FALSE(t.reader.is_active());
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+}
+
+TEST_CASE("Bounded replay")
+{
+  TestReader t(4, 10, 10);
+
+  t.reader.start(5, 27);
+  REQUIRE(t.take_reads() == Reads{{5, 14}, {15, 24}, {25, 27}});
+
+  t.reader.add_entries(5, 14, entries_for(5, 14));
+  t.reader.add_entries(15, 24, entries_for(15, 24));
+  t.reader.add_entries(25, 27, entries_for(25, 27));
+  REQUIRE(t.reader.next_batch()->to == 14);
+  REQUIRE(t.reader.next_batch()->to == 24);
+  REQUIRE(t.reader.next_batch()->to == 27);
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+  REQUIRE(t.take_reads().empty());
+}
+
+TEST_CASE("Results of reads from a stopped replay are discarded")
+{
+  TestReader t(2, 10, 10);
+
+  t.reader.start(1);
+  REQUIRE(t.take_reads() == Reads{{1, 10}, {11, 20}});
+  t.reader.add_no_entries(1);
+  REQUIRE(t.reader.next_batch()->entries.empty());
+
+  // A new replay waits for the outstanding read from the previous one
+  t.reader.start(11);
+  REQUIRE(t.take_reads().empty());
+
+  t.reader.add_entries(11, 20, entries_for(11, 20));
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+  REQUIRE(t.take_reads() == Reads{{11, 20}, {21, 30}});
+
+  t.reader.add_entries(11, 20, entries_for(11, 20));
+  REQUIRE(t.reader.next_batch()->from == 11);
+
+  // Unexpected results are ignored
+  t.reader.add_entries(100, 110, entries_for(100, 110));
+  t.reader.add_no_entries(200);
+  REQUIRE_FALSE(t.reader.next_batch().has_value());
+}
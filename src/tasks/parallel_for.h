@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "tasks/basic_task.h"
+#include "tasks/job_board.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace ccf::tasks
+{
+  namespace detail
+  {
+    struct ParallelForState
+    {
+      using Fn = std::function<void(size_t begin, size_t end)>;
+
+      const Fn fn;
+      const size_t count;
+      const size_t chunk_size;
+      const size_t num_chunks;
+
+      std::atomic<size_t> next_chunk = 0;
+      std::atomic<size_t> completed_chunks = 0;
+
+      std::mutex lock;
+      std::condition_variable all_done;
+      std::exception_ptr first_error = nullptr;
+
+      ParallelForState(Fn fn_, size_t count_, size_t chunk_size_) :
+        fn(std::move(fn_)),
+        count(count_),
+        chunk_size(chunk_size_),
+        num_chunks((count_ + chunk_size_ - 1) / chunk_size_)
+      {}
+
+      // Claims and executes the next unclaimed chunk. Returns false once every
+      // chunk has been claimed.
+      bool run_next_chunk()
+      {
+        const auto chunk = next_chunk.fetch_add(1);
+        if (chunk >= num_chunks)
+        {
+          return false;
+        }
+
+        const auto begin = chunk * chunk_size;
+        const auto end = std::min(begin + chunk_size, count);
+        try
+        {
+          fn(begin, end);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          if (first_error == nullptr)
+          {
+            first_error = std::current_exception();
+          }
+        }
+
+        if (completed_chunks.fetch_add(1) + 1 == num_chunks)
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          all_done.notify_all();
+        }
+
+        return true;
+      }
+    };
+  }
+
+  // Calls fn(begin, end) for each chunk of [0, count), where each chunk
+  // contains at most chunk_size indices. Chunks are offered to the workers
+  // polling job_board, but the calling thread also claims and executes chunks
+  // itself, so this completes even if no workers are available. Chunks may
+  // execute concurrently and in any order. Returns once every chunk has
+  // completed, rethrowing the first exception thrown by any chunk.
+  template <typename Fn>
+  void parallel_for(
+    JobBoard& job_board, size_t count, size_t chunk_size, Fn&& fn)
+  {
+    if (count == 0)
+    {
+      return;
+    }
+
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    if (count <= chunk_size)
+    {
+      fn(0, count);
+      return;
+    }
+
+    auto state = std::make_shared<detail::ParallelForState>(
+      std::forward<Fn>(fn), count, chunk_size);
+
+    // Helper tasks only execute fn while the caller is blocked below, so fn
+    // may safely refer to the caller's stack. Helpers which are scheduled
+    // after every chunk has been claimed do nothing.
+    for (size_t i = 1; i < state->num_chunks; ++i)
+    {
+      job_board.add_task(make_basic_task(
+        [state]() {
+          while (state->run_next_chunk())
+          {
+          }
+        },
+        "parallel_for"));
+    }
+
+    while (state->run_next_chunk())
+    {
+    }
+
+    {
+      std::unique_lock<std::mutex> guard(state->lock);
+      state->all_done.wait(guard, [&state]() {
+        return state->completed_chunks.load() == state->num_chunks;
+      });
+
+      if (state->first_error != nullptr)
+      {
+        std::rethrow_exception(state->first_error);
+      }
+    }
+  }
+}
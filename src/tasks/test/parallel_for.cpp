@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "tasks/parallel_for.h"
+
+#include "tasks/job_board.h"
+#include "tasks/thread_manager.h"
+
+#include <doctest/doctest.h>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("WithoutWorkers" * doctest::test_suite("parallel_for"))
+{
+  ccf::tasks::JobBoard job_board;
+
+  // With no workers, every chunk is executed by the caller
+  std::vector<size_t> visited(1000, 0);
+  size_t calls = 0;
+  ccf::tasks::parallel_for(
+    job_board, visited.size(), 64, [&](size_t begin, size_t end) {
+      REQUIRE(begin < end);
+      REQUIRE(end - begin <= 64);
+      ++calls;
+      for (auto i = begin; i < end; ++i)
+      {
+        ++visited[i];
+      }
+    });
+
+  REQUIRE(calls == 16);
+  for (const auto v : visited)
+  {
+    REQUIRE(v == 1);
+  }
+
+  // Helper tasks left on the board are harmless no-ops
+  REQUIRE(job_board.get_summary().pending_tasks == 15);
+  auto task = job_board.get_task();
+  while (task != nullptr)
+  {
+    task->do_task();
+    task = job_board.get_task();
+  }
+  REQUIRE(calls == 16);
+
+  // Small ranges are executed inline, without any helper tasks
+  ccf::tasks::parallel_for(job_board, 10, 64, [&](size_t begin, size_t end) {
+    REQUIRE(begin == 0);
+    REQUIRE(end == 10);
+    ++calls;
+  });
+  REQUIRE(calls == 17);
+  REQUIRE(job_board.get_summary().pending_tasks == 0);
+
+  ccf::tasks::parallel_for(
+    job_board, 0, 64, [&](size_t, size_t) { REQUIRE(false); });
+}
+
+TEST_CASE("WithWorkers" * doctest::test_suite("parallel_for"))
+{
+  ccf::tasks::JobBoard job_board;
+  ccf::tasks::ThreadManager thread_manager(job_board);
+  thread_manager.set_task_threads(4);
+
+  constexpr size_t count = 100'000;
+  std::vector<size_t> values(count, 0);
+  std::mutex threads_lock;
+  std::set<std::thread::id> threads;
+
+  ccf::tasks::parallel_for(
+    job_board, count, 100, [&](size_t begin, size_t end) {
+      {
+        std::lock_guard<std::mutex> guard(threads_lock);
+        threads.insert(std::this_thread::get_id());
+      }
+      for (auto i = begin; i < end; ++i)
+      {
+        values[i] = i;
+      }
+    });
+
+  // Every chunk has completed by the time parallel_for returns
+  for (size_t i = 0; i < count; ++i)
+  {
+    REQUIRE(values[i] == i);
+  }
+  REQUIRE(!threads.empty());
+
+  // The first exception thrown by a chunk is rethrown to the caller, after
+  // all other chunks have completed
+  std::atomic<size_t> completed = 0;
+  REQUIRE_THROWS_AS(
+    ccf::tasks::parallel_for(
+      job_board,
+      count,
+      100,
+      [&](size_t begin, size_t) {
+        if (begin == 500)
+        {
+          throw std::runtime_error("Bad chunk");
+        }
+        ++completed;
+      }),
+    std::runtime_error);
+  REQUIRE(completed.load() == (count / 100) - 1);
+
+  thread_manager.set_task_threads(0);
+}
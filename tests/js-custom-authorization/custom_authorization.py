@@ -1300,7 +1300,7 @@ def test_reused_interpreter_behaviour(network, args):
             max_cached_interpreters=2,
         )
 
-        # If we round-robin through too many interpreters, we flush them from the LRU cache
+        # Round-robin through too many interpreters flushes them from the LRU
         c.post("/fibonacci/reuse/a", fib_body)
         c.post("/fibonacci/reuse/b", fib_body)
         c.post("/fibonacci/reuse/c", fib_body)
@@ -16,7 +16,13 @@ import infra.proc
 import suite.test_requirements as reqs
 from e2e_logging import test_multi_auth
 from loguru import logger as LOG
-from npm_tests import build_npm_app, deploy_npm_app, test_npm_app, validate_openapi
+from npm_tests import (
+    build_npm_app,
+    deploy_npm_app,
+    test_npm_app,
+    test_npm_app_verify_signature_keys,
+    validate_openapi,
+)
 
 THIS_DIR = os.path.dirname(__file__)
 PARENT_DIR = os.path.normpath(os.path.join(THIS_DIR, os.path.pardir))
@@ -563,6 +569,7 @@ def run(args):
         network = deploy_npm_app(network, args)
 
         network = test_npm_app(network, args)
+        network = test_npm_app_verify_signature_keys(network, args)
         network = test_js_execution_time(network, args)
         network = test_user_cose_authentication(network, args)
         network = test_multi_auth(network, args)
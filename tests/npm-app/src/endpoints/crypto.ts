@@ -185,6 +185,37 @@ export function verifySignature(
   };
 }
 
+interface VerifySignaturesRequest {
+  algorithm: ccfcrypto.SigningAlgorithm;
+  keys: string[];
+  signatures: Base64[];
+  data: Base64;
+  repeats: number;
+  importKeys: boolean;
+}
+
+export function verifySignatures(
+  request: ccfapp.Request<VerifySignaturesRequest>,
+): ccfapp.Response<boolean> {
+  const body = request.body.json();
+  const data = b64ToBuf(body.data);
+  const signatures = body.signatures.map(b64ToBuf);
+  const keys: (string | ccfcrypto.CryptoPublicKey)[] = body.importKeys
+    ? body.keys.map((key) => ccfcrypto.importPublicKey(body.algorithm, key))
+    : body.keys;
+  let result = true;
+  for (let i = 0; i < body.repeats; ++i) {
+    keys.forEach((key, j) => {
+      result =
+        ccfcrypto.verifySignature(body.algorithm, key, signatures[j], data) &&
+        result;
+    });
+  }
+  return {
+    body: result,
+  };
+}
+
 interface DigestRequest {
   algorithm: ccfcrypto.DigestAlgorithm;
   data: Base64;
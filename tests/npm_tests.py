@@ -7,6 +7,7 @@ import json
 import os
 import random
 import subprocess
+import time
 from base64 import b64decode, b64encode
 
 import infra.proc
@@ -1001,3 +1002,68 @@ def test_npm_app(network, args):
         generate_and_verify_jwk(c)
 
     return network
+
+
+@reqs.description("Test verifying signatures against imported and cached keys")
+def test_npm_app_verify_signature_keys(network, args):
+    primary, _ = network.find_nodes()
+
+    algorithm = {"name": "ECDSA", "hash": "SHA-256"}
+    data = rand_bytes(64)
+
+    def make_keys(count):
+        keys, signatures = [], []
+        for _ in range(count):
+            key_priv_pem, key_pub_pem = infra.crypto.generate_ec_keypair()
+            keys.append(key_pub_pem)
+            signature = infra.crypto.sign(algorithm, key_priv_pem, data)
+            signatures.append(b64encode(signature).decode())
+        return keys, signatures
+
+    with primary.client("user0") as c:
+
+        def time_per_verify(keys, signatures, repeats, import_keys):
+            start = time.perf_counter()
+            r = c.post(
+                "/app/verifySignatures",
+                {
+                    "algorithm": algorithm,
+                    "keys": keys,
+                    "signatures": signatures,
+                    "data": b64encode(data).decode(),
+                    "repeats": repeats,
+                    "importKeys": import_keys,
+                },
+            )
+            duration = time.perf_counter() - start
+            assert r.status_code == http.HTTPStatus.OK, r.status_code
+            assert r.body.json() is True, r.body
+            return duration / (len(keys) * repeats)
+
+        # Fewer keys than the node's key cache holds
+        key_count = 200
+        repeats = 10
+
+        # Each key is new to the node, so is parsed on first use
+        keys, signatures = make_keys(key_count)
+        uncached = time_per_verify(keys, signatures, 1, False)
+
+        keys, signatures = make_keys(key_count)
+        time_per_verify(keys, signatures, 1, False)
+        cached = time_per_verify(keys, signatures, repeats, False)
+        imported = time_per_verify(keys, signatures, repeats, True)
+
+        LOG.info(
+            f"Per verification: {uncached * 1e6:.1f}us with new keys, "
+            f"{cached * 1e6:.1f}us with cached keys, "
+            f"{imported * 1e6:.1f}us with imported keys"
+        )
+
+        # Not asserted, since timings are affected by unrelated load on the
+        # host. Correctness is asserted on each response.
+        if not cached < uncached:
+            LOG.error("Expected verification with cached keys to be faster")
+        if not imported < uncached:
+            LOG.error("Expected verification with imported keys to be faster")
+
+    return network